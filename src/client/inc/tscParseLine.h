@@ -22,6 +22,8 @@ extern "C" {
 
 #define SML_TIMESTAMP_SECOND_DIGITS 10
 #define SML_TIMESTAMP_MILLI_SECOND_DIGITS 13
+#define SML_VALUE_SCRATCH_SIZE 128
+#define SML_MIN_LINES_PER_PARSE_THREAD 1024
 
 typedef TSDB_SML_PROTOCOL_TYPE SMLProtocolType;
 
@@ -102,6 +104,7 @@ int32_t convertSmlTimeStamp(TAOS_SML_KV *pVal, char *value,
                             uint16_t len, SSmlLinesInfo* info);
 
 void destroySmlDataPoint(TAOS_SML_DATA_POINT* point);
+int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* failedLines, SSmlLinesInfo* info);
 
 int taos_insert_lines(TAOS* taos, char* lines[], int numLines, SMLProtocolType protocol,
                       SMLTimeStampType tsType, int* affectedRows);
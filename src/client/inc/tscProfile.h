@@ -30,6 +30,12 @@ int  tscBuildQueryStreamDesc(void *pMsg, STscObj *pObj);
 void tscKillQuery(STscObj *pObj, uint32_t killId);
 void tscKillStream(STscObj *pObj, uint32_t killId);
 void tscKillConnection(STscObj *pObj);
+void tscAddQueryProfile(SSqlObj *pSql, SQueryProfileMsg *pMsg);
+// the profile put at the end of the last retrieve rsp of a vnode, NULL if there is none
+SQueryProfileMsg *tscGetQueryProfileMsg(SRetrieveTableRsp *pRsp, int32_t rspLen);
+// adds a profile in network byte order to a total in host byte order
+void tscMergeQueryProfile(SQueryProfileMsg *pTotal, SQueryProfileMsg *pMsg);
+void tscFreeQueryProfile(SSqlObj *pSql);
 
 #ifdef __cplusplus
 }
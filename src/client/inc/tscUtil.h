@@ -91,6 +91,7 @@ typedef struct SJoinSupporter {
   int32_t         totalLen;
   int32_t         num;
   SArray*         pVgroupTables;
+  SArray*         pTidTags;        // qualified <tid, tags> tuples after tags intersection, SArray<STidTags>
 
   int16_t          fillType;      // final result fill type
   int64_t *        fillVal;       // default value for fill
@@ -267,6 +268,7 @@ void tscColumnListCopyAll(SArray* dst, const SArray* src);
 void convertQueryResult(SSqlRes* pRes, SQueryInfo* pQueryInfo, uint64_t objId, bool convertNchar, bool convertJson);
 
 int32_t tscValidateName(SStrToken* pToken, bool escapeEnabled, bool *dbIncluded);
+int32_t tscGetPlainTableName(const char* name, int32_t len, char* dst);
 
 void tscIncStreamExecutionCount(void* pStream);
 
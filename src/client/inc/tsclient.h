@@ -359,6 +359,13 @@ typedef struct SSubqueryState {
   uint64_t numOfRetrievedRows;  // total number of points in this query
 } SSubqueryState;
 
+// execution profile of a query, merged from all vnodes which the query is sent to
+typedef struct SQueryProfile {
+  pthread_mutex_t  mutex;
+  int32_t          numOfVnodes;
+  SQueryProfileMsg total;  // in host byte order, the operators of the same type are merged
+} SQueryProfile;
+
 typedef struct SSqlObj {
   void            *signature;
   int64_t          owner;        // owner of sql object, by which it is executed
@@ -386,6 +393,7 @@ typedef struct SSqlObj {
   SSubqueryState   subState;
   struct SSqlObj **pSubs;
   struct SSqlObj  *rootObj;
+  SQueryProfile   *pProfile;     // only kept by the root object
 
   int64_t          metaRid;
   int64_t          svgroupRid;
@@ -444,6 +452,7 @@ int tsParseSql(SSqlObj *pSql, bool initial);
 
 void tscProcessMsgFromServer(SRpcMsg *rpcMsg, SRpcEpSet *pEpSet);
 int  tscBuildAndSendRequest(SSqlObj *pSql, SQueryInfo* pQueryInfo);
+char *tscEncodeQueryMsgTlv(char *pMsg, int16_t sversion, int16_t tversion);
 
 int  tscRenewTableMeta(SSqlObj *pSql);
 void tscAsyncResultOnError(SSqlObj *pSql);
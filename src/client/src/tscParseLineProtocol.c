@@ -1052,22 +1052,27 @@ static int32_t applyDataPointsWithSqlInsert(TAOS* taos, TAOS_SML_DATA_POINT* poi
   }
   bool batchesExecuted[MAX_SML_SQL_INSERT_BATCHES] = {false};
 
-  for (int i = 0; i < info->numBatches; ++i) {
+  // keep at most tsSmlMaxInflightBatches batches in flight, a new batch is issued as soon as the oldest one returns
+  int32_t maxInflight = MIN(tsSmlMaxInflightBatches, info->numBatches);
+  for (int i = 0; i < maxInflight; ++i) {
     SSmlSqlInsertBatch* insertBatch = &info->batches[i];
     insertBatch->tryTimes = 1;
     taos_query_a(taos, insertBatch->sql, insertCallback, insertBatch);
-    batchesExecuted[i] = true;
   }
-  int32_t triedBatches = info->numBatches;
 
-  while (triedBatches > 0) {
-    for (int i = 0; i < info->numBatches; ++i) {
-      if (batchesExecuted[i]) {
-        tsem_wait(&info->batches[i].sem);
-        info->affectedRows += info->batches[i].affectedRows;
-      }
+  for (int i = 0; i < info->numBatches; ++i) {
+    tsem_wait(&info->batches[i].sem);
+    info->affectedRows += info->batches[i].affectedRows;
+
+    if (i + maxInflight < info->numBatches) {
+      SSmlSqlInsertBatch* insertBatch = &info->batches[i + maxInflight];
+      insertBatch->tryTimes = 1;
+      taos_query_a(taos, insertBatch->sql, insertCallback, insertBatch);
     }
+  }
+  int32_t triedBatches = info->numBatches;
 
+  while (triedBatches > 0) {
     for (int i = 0; i < info->numBatches; ++i) {
       SSmlSqlInsertBatch* b = info->batches + i;
       if (b->resetQueryCache) {
@@ -1096,6 +1101,13 @@ static int32_t applyDataPointsWithSqlInsert(TAOS* taos, TAOS_SML_DATA_POINT* poi
         triedBatches++;
       }
     }
+
+    for (int i = 0; i < info->numBatches; ++i) {
+      if (batchesExecuted[i]) {
+        tsem_wait(&info->batches[i].sem);
+        info->affectedRows += info->batches[i].affectedRows;
+      }
+    }
   }
 
   code = 0;
@@ -1966,36 +1978,20 @@ int32_t convertSmlTimeStamp(TAOS_SML_KV *pVal, char *value,
   return TSDB_CODE_SUCCESS;
 }
 
-static int32_t parseSmlTimeStamp(TAOS_SML_KV **pTS, const char **index, SSmlLinesInfo* info) {
-  const char *start, *cur;
-  int32_t ret = TSDB_CODE_SUCCESS;
-  int len = 0;
-  char key[] = "ts";
-  char *value = NULL;
-
-  start = cur = *index;
-  *pTS = calloc(1, sizeof(TAOS_SML_KV));
-
-  while(*cur != '\0') {
-    cur++;
-    len++;
-  }
+static int32_t parseSmlTimeStamp(TAOS_SML_KV *pTS, const char **index, SSmlLinesInfo* info) {
+  static const char key[] = "ts";
 
-  if (len > 0) {
-    value = calloc(len + 1, 1);
-    memcpy(value, start, len);
-  }
+  // timestamp is the last part of a line, which is terminated by '\0' already, no need to copy it
+  char   *value = (char *)(*index);
+  int32_t len = (int32_t)strlen(value);
 
-  ret = convertSmlTimeStamp(*pTS, value, len, info);
+  int32_t ret = convertSmlTimeStamp(pTS, value, len, info);
   if (ret) {
-    free(value);
-    free(*pTS);
     return ret;
   }
-  free(value);
 
-  (*pTS)->key = calloc(sizeof(key), 1);
-  memcpy((*pTS)->key, key, sizeof(key));
+  pTS->key = malloc(sizeof(key));
+  memcpy(pTS->key, key, sizeof(key));
   return ret;
 }
 
@@ -2058,6 +2054,7 @@ static int32_t parseSmlValue(TAOS_SML_KV *pKV, const char **index,
   const char *start, *cur;
   int32_t     ret = TSDB_CODE_SUCCESS;
   char       *value = NULL;
+  char        scratch[SML_VALUE_SCRATCH_SIZE];
   int16_t     len = 0;
 
   bool   kv_done = false;
@@ -2385,17 +2382,23 @@ static int32_t parseSmlValue(TAOS_SML_KV *pKV, const char **index,
     return TSDB_CODE_TSC_LINE_SYNTAX_ERROR;
   }
 
-  value = calloc(len + 1, 1);
+  // the value is modified during conversion, copy it into the scratch buffer unless it is too long
+  value = (len < SML_VALUE_SCRATCH_SIZE) ? scratch : malloc(len + 1);
   memcpy(value, start, len);
   value[len] = '\0';
   if (!convertSmlValueType(pKV, value, len, info, isTag)) {
     tscError("SML:0x%"PRIx64" Failed to convert sml value string(%s) to any type",
             info->id, value);
-    free(value);
+    if (value != scratch) {
+      free(value);
+    }
     ret = TSDB_CODE_TSC_INVALID_VALUE;
     goto error;
   }
-  free(value);
+
+  if (value != scratch) {
+    free(value);
+  }
 
   *index = (*cur == '\0') ? cur : cur + 1;
   return ret;
@@ -2488,7 +2491,8 @@ static int32_t parseSmlKvPairs(TAOS_SML_KV **pKVs, int *num_kvs,
   if (isField) {
     capacity = 64;
     *pKVs = malloc(capacity * sizeof(TAOS_SML_KV));
-    // leave space for timestamp;
+    // leave space for timestamp, which is parsed in place later;
+    memset(*pKVs, 0, sizeof(TAOS_SML_KV));
     pkv = *pKVs;
     pkv++;
   } else {
@@ -2568,32 +2572,17 @@ done:
   return ret;
 }
 
-static void moveTimeStampToFirstKv(TAOS_SML_DATA_POINT** smlData, TAOS_SML_KV *ts) {
-  TAOS_SML_KV* tsField = (*smlData)->fields;
-  tsField->length = ts->length;
-  tsField->type = ts->type;
-  tsField->value = malloc(ts->length);
-  tsField->key = malloc(strlen(ts->key) + 1);
-  memcpy(tsField->key, ts->key, strlen(ts->key) + 1);
-  memcpy(tsField->value, ts->value, ts->length);
-  (*smlData)->fieldNum = (*smlData)->fieldNum + 1;
-
-  free(ts->key);
-  free(ts->value);
-  free(ts);
-}
-
-int32_t tscParseLine(const char* sql, TAOS_SML_DATA_POINT* smlData, SSmlLinesInfo* info) {
+int32_t tscParseLine(const char* sql, TAOS_SML_DATA_POINT* smlData, SHashObj* keyHashTable, SSmlLinesInfo* info) {
   const char* index = sql;
   int32_t ret = TSDB_CODE_SUCCESS;
   uint8_t has_tags = 0;
-  TAOS_SML_KV *timestamp = NULL;
-  SHashObj *keyHashTable = taosHashInit(32, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, false);
+
+  // the hash table to detect duplicated keys is shared by all lines, reset it for current line
+  taosHashClear(keyHashTable);
 
   ret = parseSmlMeasurement(smlData, &index, &has_tags, info);
   if (ret) {
     tscError("SML:0x%"PRIx64" Unable to parse measurement", info->id);
-    taosHashCleanup(keyHashTable);
     return ret;
   }
   tscDebug("SML:0x%"PRIx64" Parse measurement finished, has_tags:%d", info->id, has_tags);
@@ -2603,7 +2592,6 @@ int32_t tscParseLine(const char* sql, TAOS_SML_DATA_POINT* smlData, SSmlLinesInf
     ret = parseSmlKvPairs(&smlData->tags, &smlData->tagNum, &index, false, smlData, keyHashTable, info);
     if (ret) {
       tscError("SML:0x%"PRIx64" Unable to parse tag", info->id);
-      taosHashCleanup(keyHashTable);
       return ret;
     }
   }
@@ -2613,19 +2601,17 @@ int32_t tscParseLine(const char* sql, TAOS_SML_DATA_POINT* smlData, SSmlLinesInf
   ret = parseSmlKvPairs(&smlData->fields, &smlData->fieldNum, &index, true, smlData, keyHashTable, info);
   if (ret) {
     tscError("SML:0x%"PRIx64" Unable to parse field", info->id);
-    taosHashCleanup(keyHashTable);
     return ret;
   }
   tscDebug("SML:0x%"PRIx64" Parse fields finished, num of fields:%d", info->id, smlData->fieldNum);
-  taosHashCleanup(keyHashTable);
 
-  //Parse timestamp
-  ret = parseSmlTimeStamp(&timestamp, &index, info);
+  //Parse timestamp into the first kv, which is reserved for it
+  ret = parseSmlTimeStamp(smlData->fields, &index, info);
   if (ret) {
     tscError("SML:0x%"PRIx64" Unable to parse timestamp", info->id);
     return ret;
   }
-  moveTimeStampToFirstKv(&smlData, timestamp);
+  smlData->fieldNum = smlData->fieldNum + 1;
   tscDebug("SML:0x%"PRIx64" Parse timestamp finished", info->id);
 
   return TSDB_CODE_SUCCESS;
@@ -2648,13 +2634,19 @@ void destroySmlDataPoint(TAOS_SML_DATA_POINT* point) {
   free(point->childTableName);
 }
 
-int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* failedLines, SSmlLinesInfo* info) {
-  for (int32_t i = 0; i < numLines; ++i) {
+static int32_t tscParseLinesRange(char* lines[], int32_t start, int32_t end, SArray* points, SSmlLinesInfo* info) {
+  SHashObj *keyHashTable = taosHashInit(32, taosGetDefaultHashFunction(TSDB_DATA_TYPE_BINARY), true, false);
+  if (keyHashTable == NULL) {
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  for (int32_t i = start; i < end; ++i) {
     TAOS_SML_DATA_POINT point = {0};
-    int32_t code = tscParseLine(lines[i], &point, info);
+    int32_t code = tscParseLine(lines[i], &point, keyHashTable, info);
     if (code != TSDB_CODE_SUCCESS) {
       tscError("SML:0x%"PRIx64" data point line parse failed. line %d : %s", info->id, i, lines[i]);
       destroySmlDataPoint(&point);
+      taosHashCleanup(keyHashTable);
       return code;
     } else {
       tscDebug("SML:0x%"PRIx64" data point line parse success. line %d", info->id, i);
@@ -2662,9 +2654,99 @@ int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* faile
 
     taosArrayPush(points, &point);
   }
+
+  taosHashCleanup(keyHashTable);
   return TSDB_CODE_SUCCESS;
 }
 
+typedef struct {
+  char**         lines;
+  int32_t        start;
+  int32_t        end;
+  SArray*        points;
+  SSmlLinesInfo* info;
+  int32_t        code;
+} SSmlParseTask;
+
+static void* tscParseLinesThreadFp(void* param) {
+  SSmlParseTask* pTask = param;
+  pTask->code = tscParseLinesRange(pTask->lines, pTask->start, pTask->end, pTask->points, pTask->info);
+  return NULL;
+}
+
+int32_t tscParseLines(char* lines[], int numLines, SArray* points, SArray* failedLines, SSmlLinesInfo* info) {
+  int32_t numOfThreads = MIN(tsSmlParseThreads, numLines / SML_MIN_LINES_PER_PARSE_THREAD);
+  if (numOfThreads <= 1) {
+    return tscParseLinesRange(lines, 0, numLines, points, info);
+  }
+
+  // split the lines into contiguous chunks, each chunk is parsed by one thread with its own key hash and
+  // result array, the results are appended to points in the original line order afterwards.
+  SSmlParseTask* tasks = calloc(numOfThreads, sizeof(SSmlParseTask));
+  pthread_t*     threads = calloc(numOfThreads, sizeof(pthread_t));
+  bool*          started = calloc(numOfThreads, sizeof(bool));
+  if (tasks == NULL || threads == NULL || started == NULL) {
+    tfree(tasks);
+    tfree(threads);
+    tfree(started);
+    return TSDB_CODE_TSC_OUT_OF_MEMORY;
+  }
+
+  int32_t step = numLines / numOfThreads;
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    SSmlParseTask* pTask = &tasks[i];
+    pTask->lines = lines;
+    pTask->start = i * step;
+    pTask->end = (i == numOfThreads - 1) ? numLines : (i + 1) * step;
+    pTask->info = info;
+    pTask->points = taosArrayInit(pTask->end - pTask->start, sizeof(TAOS_SML_DATA_POINT));
+    if (pTask->points == NULL) {
+      pTask->code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+      continue;
+    }
+
+    // the last chunk is parsed by the calling thread
+    if (i == numOfThreads - 1) {
+      break;
+    }
+
+    if (pthread_create(&threads[i], NULL, tscParseLinesThreadFp, pTask) == 0) {
+      started[i] = true;
+    } else {
+      tscDebug("SML:0x%"PRIx64" failed to create parse thread, parse chunk %d in calling thread", info->id, i);
+      tscParseLinesThreadFp(pTask);
+    }
+  }
+
+  SSmlParseTask* pLast = &tasks[numOfThreads - 1];
+  if (pLast->points != NULL) {
+    tscParseLinesThreadFp(pLast);
+  }
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    SSmlParseTask* pTask = &tasks[i];
+    if (started[i]) {
+      pthread_join(threads[i], NULL);
+    }
+
+    if (pTask->code != TSDB_CODE_SUCCESS && code == TSDB_CODE_SUCCESS) {
+      code = pTask->code;
+    }
+
+    // points parsed so far are handed over to the caller, who is responsible for destroying them
+    if (pTask->points != NULL) {
+      taosArrayAddAll(points, pTask->points);
+      taosArrayDestroy(&pTask->points);
+    }
+  }
+
+  tfree(tasks);
+  tfree(threads);
+  tfree(started);
+  return code;
+}
+
 int taos_insert_lines(TAOS* taos, char* lines[], int numLines, SMLProtocolType protocol, SMLTimeStampType tsType, int *affectedRows) {
   int32_t code = 0;
 
@@ -1252,12 +1252,39 @@ static void insertBatchClean(STscStmt* pStmt) {
   pCmd->insertParam.pDataBlocks = tscDestroyBlockArrayList(pSql, pCmd->insertParam.pDataBlocks);
   pCmd->insertParam.numOfTables = 0;
 
+  // the data buffer of each table bound in this execution is kept and reused by the following ones, to avoid
+  // allocating it again for every table whenever the table is bound again.
   STableDataBlocks** p = taosHashIterate(pCmd->insertParam.pTableBlockHashList, NULL);
   while(p) {
-    tfree((*p)->pData);
+    STableDataBlocks* pBlock = *p;
+    if (pBlock->pData != NULL) {
+      memset(pBlock->pData, 0, sizeof(SSubmitBlk));
+      pBlock->ordered  = true;
+      pBlock->prevTS   = INT64_MIN;
+      pBlock->size     = sizeof(SSubmitBlk);
+      pBlock->tsSource = -1;
+    }
+
     p = taosHashIterate(pCmd->insertParam.pTableBlockHashList, p);
   }
 
+  // the buffers of the tables not bound in it are freed, so that the buffers kept are bounded by the tables of one
+  // execution instead of growing with all the tables ever bound. They are allocated again when switched to.
+  if (pStmt->multiTbInsert && pStmt->mtb.pTableBlockHashList != NULL) {
+    p = taosHashIterate(pStmt->mtb.pTableBlockHashList, NULL);
+    while(p) {
+      STableDataBlocks* pBlock = *p;
+      void* uid = taosHashGetDataKey(pStmt->mtb.pTableBlockHashList, p);
+      if (pBlock->pData != NULL && taosHashGet(pCmd->insertParam.pTableBlockHashList, uid, sizeof(uint64_t)) == NULL) {
+        tfree(pBlock->pData);
+        pBlock->nAllocSize = 0;
+        pBlock->size = 0;
+      }
+
+      p = taosHashIterate(pStmt->mtb.pTableBlockHashList, p);
+    }
+  }
+
   taosHashClear(pCmd->insertParam.pTableBlockHashList);
   tscFreeSqlResult(pSql);
   tscFreeSubobj(pSql);
@@ -1697,6 +1724,39 @@ int taos_stmt_prepare(TAOS_STMT* stmt, const char* sql, unsigned long length) {
   STMT_RET(normalStmtPrepare(pStmt));
 }
 
+static int32_t stmtSwitchToPreparedTable(STscStmt* pStmt, uint64_t uid, const char* name) {
+  SSqlObj* pSql = pStmt->pSql;
+  SSqlCmd* pCmd = &pSql->cmd;
+
+  pStmt->mtb.currentUid = uid;
+
+  STableDataBlocks** t1 = (STableDataBlocks**)taosHashGet(pStmt->mtb.pTableBlockHashList, (const char*)&pStmt->mtb.currentUid, sizeof(pStmt->mtb.currentUid));
+  if (t1 == NULL) {
+    tscError("0x%"PRIx64" no table data block in hash list, uid:%" PRId64 , pSql->self, pStmt->mtb.currentUid);
+    return TSDB_CODE_TSC_APP_ERROR;
+  }
+
+  if ((*t1)->pData == NULL) {
+    int32_t code = tscCreateDataBlockData(*t1, TSDB_PAYLOAD_SIZE, (*t1)->pTableMeta->tableInfo.rowSize, sizeof(SSubmitBlk));
+    if (code != TSDB_CODE_SUCCESS) {
+      return code;
+    }
+  }
+
+  SSubmitBlk* pBlk = (SSubmitBlk*) (*t1)->pData;
+  pCmd->batchSize = pBlk->numOfRows;
+  if (pBlk->numOfRows == 0) {
+    (*t1)->prevTS = INT64_MIN;
+  }
+
+  tsSetBlockInfo(pBlk, (*t1)->pTableMeta, pBlk->numOfRows);
+
+  taosHashPut(pCmd->insertParam.pTableBlockHashList, (void *)&pStmt->mtb.currentUid, sizeof(pStmt->mtb.currentUid), (void*)t1, POINTER_BYTES);
+
+  tscDebug("0x%" PRIx64 " table:%s is already prepared, uid:%" PRIu64, pSql->self, name, pStmt->mtb.currentUid);
+  return TSDB_CODE_SUCCESS;
+}
+
 int taos_stmt_set_tbname_tags(TAOS_STMT* stmt, const char* name, TAOS_BIND* tags) {
   STscStmt* pStmt = (STscStmt*)stmt;
   int32_t code = 0;
@@ -1724,6 +1784,17 @@ int taos_stmt_set_tbname_tags(TAOS_STMT* stmt, const char* name, TAOS_BIND* tags
 
   pStmt->last = STMT_SETTBNAME;
 
+  // a plain name is validated in place, the tables that have been prepared are switched to without copying it
+  char      plainName[TSDB_TABLE_NAME_LEN];
+  int32_t   plainLen = tscGetPlainTableName(name, nameLen, plainName);
+  uint64_t* uid = NULL;
+  if (plainLen > 0) {
+    uid = (uint64_t*)taosHashGet(pStmt->mtb.pTableHash, plainName, plainLen);
+    if (uid != NULL) {
+      STMT_RET(stmtSwitchToPreparedTable(pStmt, *uid, plainName));
+    }
+  }
+
   SStrToken tname = {0};
   tname.type = TK_STRING;
   tname.z = (char *)strdup(name);
@@ -1742,38 +1813,11 @@ int taos_stmt_set_tbname_tags(TAOS_STMT* stmt, const char* name, TAOS_BIND* tags
     STMT_RET(invalidOperationMsg(tscGetErrorMsgPayload(&pStmt->pSql->cmd), "name is invalid"));
   }
 
-  uint64_t* uid = (uint64_t*)taosHashGet(pStmt->mtb.pTableHash, tname.z, tname.n);
+  uid = (uint64_t*)taosHashGet(pStmt->mtb.pTableHash, tname.z, tname.n);
   if (uid != NULL) {
-    pStmt->mtb.currentUid = *uid;
-
-    STableDataBlocks** t1 = (STableDataBlocks**)taosHashGet(pStmt->mtb.pTableBlockHashList, (const char*)&pStmt->mtb.currentUid, sizeof(pStmt->mtb.currentUid));
-    if (t1 == NULL) {
-      tscError("0x%"PRIx64" no table data block in hash list, uid:%" PRId64 , pSql->self, pStmt->mtb.currentUid);
-      free(tname.z);
-      STMT_RET(TSDB_CODE_TSC_APP_ERROR);
-    }
-
-    if ((*t1)->pData == NULL) {
-      code = tscCreateDataBlockData(*t1, TSDB_PAYLOAD_SIZE, (*t1)->pTableMeta->tableInfo.rowSize, sizeof(SSubmitBlk));
-      if (code != TSDB_CODE_SUCCESS) {
-        free(tname.z);
-        STMT_RET(code);
-      }
-    }
-
-    SSubmitBlk* pBlk = (SSubmitBlk*) (*t1)->pData;
-    pCmd->batchSize = pBlk->numOfRows;
-    if (pBlk->numOfRows == 0) {
-      (*t1)->prevTS = INT64_MIN;
-    }
-
-    tsSetBlockInfo(pBlk, (*t1)->pTableMeta, pBlk->numOfRows);
-
-    taosHashPut(pCmd->insertParam.pTableBlockHashList, (void *)&pStmt->mtb.currentUid, sizeof(pStmt->mtb.currentUid), (void*)t1, POINTER_BYTES);
-
-    tscDebug("0x%" PRIx64 " table:%s is already prepared, uid:%" PRIu64, pSql->self, tname.z, pStmt->mtb.currentUid);
+    code = stmtSwitchToPreparedTable(pStmt, *uid, tname.z);
     free(tname.z);
-    STMT_RET(TSDB_CODE_SUCCESS);
+    STMT_RET(code);
   }
 
   if (pStmt->mtb.subSet && taosHashGetSize(pStmt->mtb.pTableHash) > 0) {
@@ -2048,6 +2092,92 @@ int taos_stmt_bind_single_param_batch(TAOS_STMT* stmt, TAOS_MULTI_BIND* bind, in
   STMT_RET(insertStmtBindParamBatch(pStmt, bind, colIdx));
 }
 
+int taos_stmt_bind_multi_tables_batch(TAOS_STMT* stmt, const char** names, TAOS_BIND** tags, const int* offsets,
+                                      int numOfTables, TAOS_MULTI_BIND* bind) {
+  STscStmt* pStmt = (STscStmt*)stmt;
+  STMT_CHECK
+
+  if (names == NULL || offsets == NULL || numOfTables <= 0 || bind == NULL || bind->num <= 0) {
+    tscError("0x%"PRIx64" invalid parameter", pStmt->pSql->self);
+    STMT_RET(invalidOperationMsg(tscGetErrorMsgPayload(&pStmt->pSql->cmd), "invalid bind param"));
+  }
+
+  if (!pStmt->isInsert || !pStmt->multiTbInsert) {
+    tscError("0x%"PRIx64" not multiple table insert", pStmt->pSql->self);
+    STMT_RET(invalidOperationMsg(tscGetErrorMsgPayload(&pStmt->pSql->cmd), "not multiple table insert"));
+  }
+
+  // the rows of table i are in range [offsets[i], offsets[i + 1]) of each column, the last one ends at bind->num
+  TAOS_MULTI_BIND* pSlice = NULL;
+  int32_t          numOfParams = 0;
+
+  int32_t code = TSDB_CODE_SUCCESS;
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    int32_t start = offsets[i];
+    int32_t end = (i < numOfTables - 1)? offsets[i + 1] : bind->num;
+    if (start < 0 || end > bind->num || end - start <= 0 || end - start > INT16_MAX) {
+      tscError("0x%"PRIx64" invalid offset of table:%s, range:[%d, %d)", pStmt->pSql->self, names[i], start, end);
+      code = invalidOperationMsg(tscGetErrorMsgPayload(&pStmt->pSql->cmd), "invalid table offset");
+      break;
+    }
+
+    // the tags create the table if it does not exist, the same as binding one table
+    code = taos_stmt_set_tbname_tags(stmt, names[i], (tags != NULL)? tags[i] : NULL);
+    if (code != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    // all tables belong to one super table, the number of parameters is known once the first table is prepared
+    if (pSlice == NULL) {
+      STableDataBlocks** t1 = (STableDataBlocks**)taosHashGet(pStmt->mtb.pTableBlockHashList, (const char*)&pStmt->mtb.currentUid, sizeof(pStmt->mtb.currentUid));
+      if (t1 == NULL) {
+        tscError("0x%"PRIx64" no table data block in hash list, uid:%" PRId64 , pStmt->pSql->self, pStmt->mtb.currentUid);
+        code = TSDB_CODE_TSC_APP_ERROR;
+        break;
+      }
+
+      numOfParams = (*t1)->numOfParams;
+      pSlice = calloc(numOfParams, sizeof(TAOS_MULTI_BIND));
+      if (pSlice == NULL) {
+        code = TSDB_CODE_TSC_OUT_OF_MEMORY;
+        break;
+      }
+    }
+
+    for (int32_t j = 0; j < numOfParams; ++j) {
+      pSlice[j] = bind[j];
+      pSlice[j].buffer  = (char*)bind[j].buffer + bind[j].buffer_length * start;
+      pSlice[j].length  = (bind[j].length != NULL)? bind[j].length + start : NULL;
+      pSlice[j].is_null = (bind[j].is_null != NULL)? bind[j].is_null + start : NULL;
+      pSlice[j].num     = end - start;
+    }
+
+    pStmt->last = STMT_BIND;
+    code = insertStmtBindParamBatch(pStmt, pSlice, -1);
+    if (code != TSDB_CODE_SUCCESS) {
+      break;
+    }
+
+    pStmt->last = STMT_ADD_BATCH;
+    code = insertStmtAddBatch(pStmt);
+    if (code != TSDB_CODE_SUCCESS) {
+      break;
+    }
+  }
+
+  tfree(pSlice);
+
+  // the rows of the tables bound before the failed one are not executed, drop all rows since the last execution
+  if (code != TSDB_CODE_SUCCESS) {
+    tscError("0x%"PRIx64" failed to bind multiple tables, all rows bound since last execution are discarded, code:%s",
+             pStmt->pSql->self, tstrerror(code));
+    insertBatchClean(pStmt);
+    pStmt->last = STMT_PREPARE;
+  }
+
+  STMT_RET(code);
+}
+
 int taos_stmt_add_batch(TAOS_STMT* stmt) {
   STscStmt* pStmt = (STscStmt*)stmt;
   STMT_CHECK
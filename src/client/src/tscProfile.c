@@ -23,6 +23,8 @@
 
 #include "taos.h"
 #include "tscUtil.h"
+#include "tscProfile.h"
+#include "qExecutor.h"
 
 void taos_close_stream(TAOS_STREAM *handle);
 void  tscSaveSlowQueryFp(void *handle, void *tmrId);
@@ -378,3 +380,110 @@ void tscKillConnection(STscObj *pObj) {
   taos_close(pObj);
 }
 
+static void tscMergeOperatorProfile(SQueryProfileMsg *pTotal, SOperatorProfileMsg *pOp) {
+  SOperatorProfileMsg *pDst = NULL;
+  for (int32_t i = 0; i < pTotal->numOfOperators; ++i) {
+    if (pTotal->operators[i].operatorType == pOp->operatorType) {
+      pDst = &pTotal->operators[i];
+      break;
+    }
+  }
+
+  if (pDst == NULL) {
+    if (pTotal->numOfOperators >= TSDB_QUERY_PROF_MAX_OPERATORS) {
+      return;
+    }
+
+    pDst = &pTotal->operators[pTotal->numOfOperators++];
+    pDst->operatorType = pOp->operatorType;
+  }
+
+  pDst->execTimes  += htobe64(pOp->execTimes);
+  pDst->selfTime   += htobe64(pOp->selfTime);
+  pDst->inputRows  += htobe64(pOp->inputRows);
+  pDst->outputRows += htobe64(pOp->outputRows);
+}
+
+SQueryProfileMsg *tscGetQueryProfileMsg(SRetrieveTableRsp *pRsp, int32_t rspLen) {
+  if (pRsp->extend != 1 || rspLen < (int32_t)(sizeof(SRetrieveTableRsp) + sizeof(SQueryProfileMsg))) {
+    return NULL;
+  }
+
+  return (SQueryProfileMsg *)((char *)pRsp + rspLen - sizeof(SQueryProfileMsg));
+}
+
+void tscMergeQueryProfile(SQueryProfileMsg *pTotal, SQueryProfileMsg *pMsg) {
+  pTotal->elapsedTime        += htobe64(pMsg->elapsedTime);
+  pTotal->totalBlocks        += htonl(pMsg->totalBlocks);
+  pTotal->loadBlocks         += htonl(pMsg->loadBlocks);
+  pTotal->loadBlockStatis    += htonl(pMsg->loadBlockStatis);
+  pTotal->discardBlocks      += htonl(pMsg->discardBlocks);
+  pTotal->totalRows          += htobe64(pMsg->totalRows);
+  pTotal->totalCheckedRows   += htobe64(pMsg->totalCheckedRows);
+  pTotal->memRows            += htobe64(pMsg->memRows);
+  pTotal->fileRows           += htobe64(pMsg->fileRows);
+  pTotal->readBytes          += htobe64(pMsg->readBytes);
+  pTotal->decodeBytes        += htobe64(pMsg->decodeBytes);
+  pTotal->spillBytes         += htobe64(pMsg->spillBytes);
+
+  int32_t numOfOperators = MIN(htonl(pMsg->numOfOperators), TSDB_QUERY_PROF_MAX_OPERATORS);
+  for (int32_t i = 0; i < numOfOperators; ++i) {
+    tscMergeOperatorProfile(pTotal, &pMsg->operators[i]);
+  }
+}
+
+void tscAddQueryProfile(SSqlObj *pSql, SQueryProfileMsg *pMsg) {
+  SSqlObj *pRootObj = (pSql->rootObj != NULL) ? pSql->rootObj : pSql;
+
+  // the sub queries of a super table query may receive their rsp at the same time
+  if (pRootObj->pProfile == NULL) {
+    SQueryProfile *pProfile = calloc(1, sizeof(SQueryProfile));
+    if (pProfile == NULL) {
+      tscError("0x%" PRIx64 " failed to allocate query profile", pSql->self);
+      return;
+    }
+
+    pthread_mutex_init(&pProfile->mutex, NULL);
+    if (atomic_val_compare_exchange_ptr(&pRootObj->pProfile, NULL, pProfile) != NULL) {
+      pthread_mutex_destroy(&pProfile->mutex);
+      free(pProfile);
+    }
+  }
+
+  SQueryProfile *pProfile = pRootObj->pProfile;
+
+  pthread_mutex_lock(&pProfile->mutex);
+
+  pProfile->numOfVnodes += 1;
+  tscMergeQueryProfile(&pProfile->total, pMsg);
+
+  pthread_mutex_unlock(&pProfile->mutex);
+}
+
+void tscFreeQueryProfile(SSqlObj *pSql) {
+  SQueryProfile *pProfile = pSql->pProfile;
+  if (pProfile == NULL) {
+    return;
+  }
+
+  SQueryProfileMsg *pTotal = &pProfile->total;
+
+  tscInfo("0x%" PRIx64 " query profile of %d vnodes, vnode elapsed time:%" PRId64 " us, blocks total:%d, loaded:%d, "
+          "statis only:%d, discarded:%d, rows total:%" PRId64 ", checked:%" PRId64 ", from mem:%" PRId64
+          ", from file:%" PRId64,
+          pSql->self, pProfile->numOfVnodes, pTotal->elapsedTime, pTotal->totalBlocks, pTotal->loadBlocks,
+          pTotal->loadBlockStatis, pTotal->discardBlocks, pTotal->totalRows, pTotal->totalCheckedRows,
+          pTotal->memRows, pTotal->fileRows);
+  tscInfo("0x%" PRIx64 " query profile, bytes read:%" PRId64 ", decompressed:%" PRId64 ", spilled:%" PRId64, pSql->self,
+          pTotal->readBytes, pTotal->decodeBytes, pTotal->spillBytes);
+
+  for (int32_t i = 0; i < pTotal->numOfOperators; ++i) {
+    SOperatorProfileMsg *pOp = &pTotal->operators[i];
+    tscInfo("0x%" PRIx64 " query profile, operator:%s, exec times:%" PRId64 ", self time:%" PRId64 " us, input rows:%"
+            PRId64 ", output rows:%" PRId64, pSql->self, getOperatorTypeName(pOp->operatorType), pOp->execTimes,
+            pOp->selfTime, pOp->inputRows, pOp->outputRows);
+  }
+
+  pthread_mutex_destroy(&pProfile->mutex);
+  tfree(pSql->pProfile);
+}
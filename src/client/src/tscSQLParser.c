@@ -8109,6 +8109,7 @@ static void setCreateDBOption(SCreateDbMsg* pMsg, SCreateDbInfo* pCreateDb) {
   pMsg->cacheLastRow = pCreateDb->cachelast;
   pMsg->dbType = pCreateDb->dbType;
   pMsg->partitions = htons(pCreateDb->partitions);
+  pMsg->rollup = -1;  // no clause for it in the grammar yet, the rollup of the server config
 }
 
 int32_t parseCreateDBOptions(SSqlCmd* pCmd, SCreateDbInfo* pCreateDbSql) {
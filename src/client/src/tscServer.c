@@ -909,6 +909,29 @@ static int32_t serializeSqlExpr(SSqlExpr* pExpr, STableMetaInfo* pTableMetaInfo,
   return TSDB_CODE_SUCCESS;
 }
 
+// the TLVs which end an extended query msg: the meta version, the profile request if enabled and the end mark
+char *tscEncodeQueryMsgTlv(char *pMsg, int16_t sversion, int16_t tversion) {
+  STLV *tlv = (STLV *)pMsg;
+  tlv->type = htons(TLV_TYPE_META_VERSION);
+  tlv->len  = htonl(sizeof(int16_t) * 2);
+  *(int16_t*)tlv->value = htons(sversion);
+  *(int16_t*)(tlv->value+sizeof(int16_t)) = htons(tversion);
+  pMsg += sizeof(*tlv) + sizeof(int16_t) * 2;
+
+  if (tsQueryProfile) {
+    tlv = (STLV *)pMsg;
+    tlv->type = htons(TLV_TYPE_QUERY_PROFILE);
+    tlv->len  = htonl(sizeof(int8_t));
+    *(int8_t*)tlv->value = 1;
+    pMsg += sizeof(*tlv) + sizeof(int8_t);
+  }
+
+  tlv = (STLV *)pMsg;
+  tlv->type = htons(TLV_TYPE_END_MARK);
+  tlv->len = 0;
+  return pMsg + sizeof(*tlv);
+}
+
 int tscBuildQueryMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
   SSqlCmd *pCmd = &pSql->cmd;
 
@@ -1181,19 +1204,7 @@ int tscBuildQueryMsg(SSqlObj *pSql, SSqlInfo *pInfo) {
 
 
   pQueryMsg->extend = 1;
-  
-  STLV *tlv = (STLV *)pMsg;
-  tlv->type = htons(TLV_TYPE_META_VERSION);
-  tlv->len  = htonl(sizeof(int16_t) * 2);
-  *(int16_t*)tlv->value = htons(pTableMeta->sversion);
-  *(int16_t*)(tlv->value+sizeof(int16_t)) = htons(pTableMeta->tversion);
-  pMsg += sizeof(*tlv) + sizeof(int16_t) * 2;
-
-  tlv = (STLV *)pMsg;
-  tlv->type = htons(TLV_TYPE_END_MARK);
-  tlv->len = 0;
-  pMsg += sizeof(*tlv);
-
+  pMsg = tscEncodeQueryMsgTlv(pMsg, pTableMeta->sversion, pTableMeta->tversion);
 
   int32_t msgLen = (int32_t)(pMsg - pCmd->payload);
 
@@ -2885,6 +2896,12 @@ int tscProcessRetrieveRspFromNode(SSqlObj *pSql) {
   pRes->completed  = (pRetrieve->completed == 1);
   pRes->data       = pRetrieve->data;
 
+  // the execution profile is put at the end of the last rsp of the query
+  SQueryProfileMsg *pProfileMsg = tscGetQueryProfileMsg(pRetrieve, pRes->rspLen);
+  if (pProfileMsg != NULL) {
+    tscAddQueryProfile(pSql, pProfileMsg);
+  }
+
   SQueryInfo* pQueryInfo = tscGetQueryInfo(pCmd);
   if (tscCreateResPointerInfo(pRes, pQueryInfo) != TSDB_CODE_SUCCESS) {
     return pRes->code;
@@ -451,6 +451,8 @@ static void tscDestroyJoinSupporter(SJoinSupporter* pSupporter) {
     pSupporter->pVgroupTables = NULL;
   }
 
+  taosArrayDestroy(&pSupporter->pTidTags);
+
   tfree(pSupporter->pIdTagList);
   tscTagCondRelease(&pSupporter->tagCond);
   free(pSupporter);
@@ -488,6 +490,105 @@ static void filterVgroupTables(SQueryInfo* pQueryInfo, SArray* pVgroupTables) {
   tfree(list);
 }
 
+static void tidTagsGetJoinTagVal(STidTags* pTidTags, int16_t bytes, tVariant* pTag) {
+  int16_t type = pTidTags->padding;
+
+  // keep identical with the tag value that is generated in vnode for ts_comp
+  if (IS_VAR_DATA_TYPE(type)) {
+    int32_t maxLen = bytes - VARSTR_HEADER_SIZE;
+    int32_t len = (varDataLen(pTidTags->tag) > maxLen)? maxLen:varDataLen(pTidTags->tag);
+    tVariantCreateFromBinary(pTag, varDataVal(pTidTags->tag), len, type);
+  } else {
+    tVariantCreateFromBinary(pTag, pTidTags->tag, bytes, type);
+  }
+}
+
+static int32_t tagVariantCompar(const void* p1, const void* p2) {
+  return tVariantCompare(p1, p2);
+}
+
+/*
+ * The tables, of which the join tag value is absent in the ts-comp data after the timestamp intersection, produce no
+ * result for the join, so they are removed from the secondary stage query.
+ *
+ * For each removed table the secondary stage query saves, in the vnode of the table:
+ *   - the STableIdInfo of the table in the query msg, and its STableQueryInfo;
+ *   - the SBlockInfo of the table in each file set of the query window, SBlockIdx.len bytes of the head file;
+ *   - a ts-comp lookup for each of its blocks, in the files and in memory, which the vnode then discards. These
+ *     blocks are no longer counted in totalBlocks of the query profile;
+ *   - the copy of its rows in memory into a block, which is done before the block is discarded.
+ * It does not save:
+ *   - the load of a data block in the files that has no rows in memory, since such a block was discarded by its tag
+ *     before its data were loaded: loadBlocks, and the bytes read from the .data and .last files, stay the same;
+ *   - anything of the ts-comp stage: every table passing the tag intersection is still scanned over the query window,
+ *     and all of its timestamps are shipped to the client and intersected there;
+ *   - any byte of the ts-comp data sent to a vnode, which is the intersected group of the vnode either way.
+ */
+static void filterVgroupTablesByTsComp(SSqlObj* pSql, STSBuf* pTsBuf, SArray* pTidTags, SArray* pVgroupTables) {
+  size_t numOfTables = taosArrayGetSize(pTidTags);
+  if (numOfTables == 0 || pVgroupTables == NULL) {
+    return;
+  }
+
+  int16_t tagBytes = (int16_t)(pTidTags->elemSize - sizeof(STidTags));
+  SArray* pTagList = taosArrayInit(4, sizeof(tVariant));
+  int32_t numOfRemoved = 0;
+
+  for (int32_t k = 0; k < taosArrayGetSize(pVgroupTables); ++k) {
+    SVgroupTableInfo* p = taosArrayGet(pVgroupTables, k);
+
+    for (int32_t i = 0; i < taosArrayGetSize(pTagList); ++i) {
+      tVariantDestroy(taosArrayGet(pTagList, i));
+    }
+
+    taosArrayClear(pTagList);
+    if (tsBufGetGroupTagList(pTsBuf, p->vgInfo.vgId, pTagList) != TSDB_CODE_SUCCESS ||
+        taosArrayGetSize(pTagList) == 0) {
+      // no ts-comp data of this vgroup, keep its table list intact and go on with the other vgroups
+      continue;
+    }
+
+    taosArraySort(pTagList, tagVariantCompar);
+
+    SArray* pNewList = taosArrayInit(taosArrayGetSize(p->itemList), sizeof(STableIdInfo));
+    for (int32_t i = 0; i < numOfTables; ++i) {
+      STidTags* tt = taosArrayGet(pTidTags, i);
+      if (tt->vgId != p->vgInfo.vgId) {
+        continue;
+      }
+
+      // json and null tags are not pruned
+      bool qualified = true;
+      if (tt->padding != TSDB_DATA_TYPE_JSON && !isNull(tt->tag, tt->padding)) {
+        tVariant t = {0};
+        tidTagsGetJoinTagVal(tt, tagBytes, &t);
+        qualified = (taosArraySearch(pTagList, &t, tagVariantCompar, TD_EQ) != NULL);
+        tVariantDestroy(&t);
+      }
+
+      if (qualified) {
+        STableIdInfo item = {.uid = tt->uid, .tid = tt->tid, .key = INT64_MIN};
+        taosArrayPush(pNewList, &item);
+      }
+    }
+
+    // not expected, since at least one table of this vgroup has generated the ts-comp data, keep the table list intact
+    if (taosArrayGetSize(pNewList) == 0) {
+      tscWarn("0x%"PRIx64" vgId:%d no table is qualified after ts blocks intersecting, keep all %"PRIzu" tables",
+              pSql->self, p->vgInfo.vgId, taosArrayGetSize(p->itemList));
+      taosArrayDestroy(&pNewList);
+      continue;
+    }
+
+    numOfRemoved += (int32_t)(taosArrayGetSize(p->itemList) - taosArrayGetSize(pNewList));
+    taosArrayDestroy(&p->itemList);
+    p->itemList = pNewList;
+  }
+
+  taosArrayDestroyEx(&pTagList, (void (*)(void*))tVariantDestroy);
+  tscDebug("0x%"PRIx64" %d tables removed from secondary query after ts blocks intersecting", pSql->self, numOfRemoved);
+}
+
 static SArray* buildVgroupTableByResult(SQueryInfo* pQueryInfo, SArray* pVgroupTables) {
   int32_t  num = 0;
   int32_t* list = NULL;
@@ -662,6 +763,8 @@ static int32_t tscLaunchRealSubqueries(SSqlObj* pSql) {
       } else {
         filterVgroupTables(pQueryInfo, pTableMetaInfo->pVgroupTables);
       }
+
+      filterVgroupTablesByTsComp(pSql, pQueryInfo->tsBuf, pSupporter->pTidTags, pTableMetaInfo->pVgroupTables);
       pQueryInfo->stableQuery = true;
     }
 
@@ -1392,6 +1495,11 @@ static void tidTagRetrieveCallback(void* param, TAOS_RES* tres, int32_t numOfRow
       SSqlObj* psub = pParentSql->pSubs[m];
       ((SJoinSupporter*)psub->param)->pVgroupTables =  tscVgroupTableInfoDup(pTableMetaInfo->pVgroupTables);
 
+      // the <tid, tags> tuples are kept to prune the tables for the secondary stage query
+      taosArrayDestroy(&((SJoinSupporter*)psub->param)->pTidTags);
+      ((SJoinSupporter*)psub->param)->pTidTags = *s;
+      *s = NULL;
+
       memset(pParentSql->subState.states, 0, sizeof(pParentSql->subState.states[0]) * pParentSql->subState.numOfSub);
       tscDebug("0x%"PRIx64" reset all sub states to 0", pParentSql->self);
       
@@ -1759,6 +1759,7 @@ void tscFreeSqlObj(SSqlObj* pSql) {
   }
 
   tscFreeSubobj(pSql);
+  tscFreeQueryProfile(pSql);
 
   pSql->signature = NULL;
   pSql->fp = NULL;
@@ -3106,6 +3107,37 @@ int32_t tscValidateName(SStrToken* pToken, bool escapeEnabled, bool *dbIncluded)
   return TSDB_CODE_SUCCESS;
 }
 
+/*
+ * A name of letters, digits and '_' only is validated by tscValidateName into its lower case, if it is an identifier.
+ * Its validated name is built in dst without the copy tscValidateName works on, the names of other forms, quoted or
+ * with a database, return 0 and are left to tscValidateName.
+ */
+int32_t tscGetPlainTableName(const char* name, int32_t len, char* dst) {
+  if (len <= 0 || len >= TSDB_TABLE_NAME_LEN) {
+    return 0;
+  }
+
+  for (int32_t i = 0; i < len; ++i) {
+    char c = name[i];
+    if (c >= 'A' && c <= 'Z') {
+      dst[i] = (char)(c - 'A' + 'a');
+    } else if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9') || c == '_') {
+      dst[i] = c;
+    } else {
+      return 0;
+    }
+  }
+  dst[len] = 0;
+
+  // keywords and numbers are not identifiers
+  uint32_t type = 0;
+  if (tGetToken(dst, &type) != (uint32_t)len || type != TK_ID) {
+    return 0;
+  }
+
+  return len;
+}
+
 void tscIncStreamExecutionCount(void* pStream) {
   if (pStream == NULL) {
     return;
@@ -0,0 +1,103 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <inttypes.h>
+
+#include "os.h"
+#include "taos.h"
+#include "taoserror.h"
+#include "hash.h"
+#include "tarray.h"
+#include "tglobal.h"
+#include "tscParseLine.h"
+
+namespace {
+
+const int32_t numOfLines = 8192;
+
+char** genLines() {
+  char** lines = (char**)calloc(numOfLines, POINTER_BYTES);
+  for (int32_t i = 0; i < numOfLines; ++i) {
+    lines[i] = (char*)calloc(1, 256);
+    snprintf(lines[i], 256,
+             "st%d,host=h%d,region=r%d c0=%di32,c1=%d.5,c2=\"s%d\",c3=%s %" PRId64, i % 3, i % 97, i % 5, i, i,
+             i, (i % 2) ? "true" : "false", (int64_t)1626006833639000000 + i);
+  }
+
+  return lines;
+}
+
+SArray* parseLines(char** lines, int32_t numOfThreads) {
+  SSmlLinesInfo* info = (SSmlLinesInfo*)calloc(1, sizeof(SSmlLinesInfo));
+  info->protocol = TSDB_SML_LINE_PROTOCOL;
+  info->tsType = SML_TIME_STAMP_NANO_SECONDS;
+
+  int32_t saved = tsSmlParseThreads;
+  tsSmlParseThreads = numOfThreads;
+
+  SArray* points = (SArray*)taosArrayInit(numOfLines, sizeof(TAOS_SML_DATA_POINT));
+  EXPECT_EQ(tscParseLines(lines, numOfLines, points, NULL, info), TSDB_CODE_SUCCESS);
+
+  tsSmlParseThreads = saved;
+  free(info);
+  return points;
+}
+
+void checkKvs(TAOS_SML_KV* kv1, TAOS_SML_KV* kv2, int32_t num) {
+  for (int32_t i = 0; i < num; ++i) {
+    ASSERT_STREQ(kv1[i].key, kv2[i].key);
+    ASSERT_EQ(kv1[i].type, kv2[i].type);
+    ASSERT_EQ(kv1[i].length, kv2[i].length);
+    ASSERT_EQ(memcmp(kv1[i].value, kv2[i].value, kv1[i].length), 0);
+  }
+}
+
+void destroyPoints(SArray* points) {
+  for (size_t i = 0; i < taosArrayGetSize(points); ++i) {
+    destroySmlDataPoint((TAOS_SML_DATA_POINT*)taosArrayGet(points, i));
+  }
+  taosArrayDestroy(&points);
+}
+
+}  // namespace
+
+// the lines parsed by several threads are identical to the ones parsed by the calling thread, in the same order
+TEST(testCase, sml_parallel_parse_test) {
+  char** lines = genLines();
+
+  SArray* serial = parseLines(lines, 1);
+  SArray* parallel = parseLines(lines, 4);
+  ASSERT_EQ(taosArrayGetSize(serial), (size_t)numOfLines);
+  ASSERT_EQ(taosArrayGetSize(parallel), (size_t)numOfLines);
+
+  for (int32_t i = 0; i < numOfLines; ++i) {
+    TAOS_SML_DATA_POINT* p1 = (TAOS_SML_DATA_POINT*)taosArrayGet(serial, i);
+    TAOS_SML_DATA_POINT* p2 = (TAOS_SML_DATA_POINT*)taosArrayGet(parallel, i);
+
+    ASSERT_STREQ(p1->stableName, p2->stableName);
+    ASSERT_STREQ(p1->childTableName, p2->childTableName);
+    ASSERT_EQ(p1->tagNum, p2->tagNum);
+    ASSERT_EQ(p1->fieldNum, p2->fieldNum);
+    checkKvs(p1->tags, p2->tags, p1->tagNum);
+    checkKvs(p1->fields, p2->fields, p1->fieldNum);
+  }
+
+  // a bad line parsed by a worker thread fails the request
+  char* saved = lines[10];
+  lines[10] = (char*)"st0,host=h0 c0=1i32,c0=2i32 1626006833639000000";
+
+  SArray* bad = (SArray*)taosArrayInit(numOfLines, sizeof(TAOS_SML_DATA_POINT));
+  SSmlLinesInfo* info = (SSmlLinesInfo*)calloc(1, sizeof(SSmlLinesInfo));
+  info->protocol = TSDB_SML_LINE_PROTOCOL;
+  info->tsType = SML_TIME_STAMP_NANO_SECONDS;
+  tsSmlParseThreads = 4;
+  EXPECT_NE(tscParseLines(lines, numOfLines, bad, NULL, info), TSDB_CODE_SUCCESS);
+  tsSmlParseThreads = 1;
+  free(info);
+  destroyPoints(bad);
+  lines[10] = saved;
+
+  destroyPoints(serial);
+  destroyPoints(parallel);
+  for (int32_t i = 0; i < numOfLines; ++i) free(lines[i]);
+  free(lines);
+}
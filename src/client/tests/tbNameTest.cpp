@@ -0,0 +1,77 @@
+#include <gtest/gtest.h>
+#include <iostream>
+#include <string>
+
+#include "os.h"
+#include "taos.h"
+#include "taoserror.h"
+#include "ttoken.h"
+#include "ttokendef.h"
+
+// tscUtil.h brings tsclient.h, whose inline functions do not build as C++
+extern "C" {
+int32_t tscValidateName(SStrToken* pToken, bool escapeEnabled, bool* dbIncluded);
+int32_t tscGetPlainTableName(const char* name, int32_t len, char* dst);
+}
+
+namespace {
+
+// the name a table is known by in a statement, as taos_stmt_set_tbname_tags validates it
+bool validateName(const std::string& name, std::string* validated) {
+  char buf[TSDB_TABLE_FNAME_LEN * 2] = {0};
+  tstrncpy(buf, name.c_str(), sizeof(buf));
+
+  SStrToken token = {0};
+  token.type = TK_STRING;
+  token.z = buf;
+  token.n = (uint32_t)strlen(buf);
+
+  bool dbIncluded = false;
+  if (tscValidateName(&token, true, &dbIncluded) != TSDB_CODE_SUCCESS) {
+    return false;
+  }
+
+  *validated = std::string(token.z, token.n);
+  return true;
+}
+
+std::string plainName(const std::string& name) {
+  char    buf[TSDB_TABLE_NAME_LEN];
+  int32_t len = tscGetPlainTableName(name.c_str(), (int32_t)name.size(), buf);
+  return std::string(buf, len);
+}
+
+}  // namespace
+
+// A plain name is switched to by the name tscValidateName gives it, in lower case. A quoted one keeps its case and is
+// left to tscValidateName, so that Ab and `Ab` stay two tables
+TEST(testCase, stmt_plain_tbname_test) {
+  std::string validated;
+
+  EXPECT_EQ(plainName("Ab"), "ab");
+  EXPECT_EQ(plainName("AB_1"), "ab_1");
+  EXPECT_EQ(plainName("_t0"), "_t0");
+  ASSERT_TRUE(validateName("Ab", &validated));
+  EXPECT_EQ(validated, "ab");
+
+  // the quotes of a quoted name are kept with its case, and the table is another one
+  ASSERT_TRUE(validateName("`Ab`", &validated));
+  EXPECT_EQ(validated, "`Ab`");
+  EXPECT_NE(plainName("Ab"), validated);
+
+  // the other forms are not plain
+  const char* others[] = {"`Ab`", "'Ab'", "\"Ab\"", "db.Ab", "a-b", "a b", "", "123", "select", "t\xe4"};
+  for (const char* name : others) {
+    EXPECT_EQ(plainName(name), "") << name;
+  }
+  EXPECT_EQ(plainName(std::string(TSDB_TABLE_NAME_LEN, 'a')), "");
+
+  // and a plain name is the one tscValidateName gives
+  std::string names[] = {"t1", "T1", "tB_x", "_", "a1b2C3", "d0", std::string(TSDB_TABLE_NAME_LEN - 1, 'X')};
+  for (const std::string& name : names) {
+    std::string plain = plainName(name);
+    ASSERT_NE(plain, "") << name;
+    ASSERT_TRUE(validateName(name, &validated)) << name;
+    EXPECT_EQ(plain, validated) << name;
+  }
+}
@@ -177,6 +177,19 @@ void exprTreeNodeTraverse(tExprNode *pExpr, int32_t numOfRows, tExprOperandInfo
 
 void buildFilterSetFromBinary(void **q, const char *buf, int32_t len);
 
+typedef struct SExprProgram SExprProgram;
+
+/**
+ * compile the arithmetic expression tree into a program run over the blocks by exprProgramExec
+ * @return NULL if the tree is not only numeric arithmetic, which is left to exprTreeNodeTraverse then
+ */
+SExprProgram *exprTreeCompile(tExprNode *pExpr);
+void          exprProgramDestroy(SExprProgram *pProg);
+tExprNode    *exprProgramTree(SExprProgram *pProg);
+
+void exprProgramExec(SExprProgram *pProg, int32_t numOfRows, tExprOperandInfo *output, void *param, int32_t order,
+                     char *(*getSourceDataBlock)(void *, const char *, int32_t));
+
 #ifdef __cplusplus
 }
 #endif
@@ -56,6 +56,14 @@ extern int32_t  tsShellActivityTimer;
 extern uint32_t tsMaxTmrCtrl;
 extern float    tsNumOfThreadsPerCore;
 extern int32_t  tsNumOfCommitThreads;
+extern int32_t  tsEarlyCommitFactor;
+extern int32_t  tsCompactInterval;
+extern float    tsCompactMinScore;
+extern int32_t  tsCompactRateLimit;
+extern int32_t  tsMigrateInterval;
+extern int32_t  tsMigrateRateLimit;
+extern int32_t  tsBlockTargetSize;
+extern int32_t  tsBloomFilter;
 extern float    tsRatioOfQueryCores;
 extern int8_t   tsDaylight;
 extern char     tsTimezone[];
@@ -75,6 +83,7 @@ extern int64_t
 extern int32_t tsRetrieveBlockingModel;  // retrieve threads will be blocked
 
 extern int8_t tsKeepOriginalColumnName;
+extern int8_t tsQueryProfile;
 
 // client
 extern int32_t tsMaxSQLStringLen;
@@ -112,6 +121,7 @@ extern int16_t tsPartitons;
 extern int32_t tsQuorum;
 extern int8_t  tsUpdate;
 extern int8_t  tsCacheLastRow;
+extern int8_t  tsRollup;
 
 // tsdb
 extern bool    tsdbForceKeepFile;
@@ -234,6 +244,8 @@ extern int8_t tsDeadLockKillQuery;
 extern char tsDefaultJSONStrType[];
 extern char tsSmlChildTableName[];
 extern char tsSmlTagNullName[];
+extern int32_t tsSmlParseThreads;
+extern int32_t tsSmlMaxInflightBatches;
 
 
 typedef struct {
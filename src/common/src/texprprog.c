@@ -0,0 +1,379 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+
+#include "taosdef.h"
+#include "tcompare.h"
+#include "texpr.h"
+#include "ttype.h"
+
+/*
+ * An arithmetic expression tree compiled into a flat program of binary operations over double registers. The block is
+ * run through the whole program in chunks of EXPR_PROG_CHUNK_ROWS rows, so that the registers of a chunk stay in the
+ * cache between the operations, instead of a temporary buffer of the block per node. Each column is converted to
+ * double once a chunk, the constant sub trees are folded when compiled, and the registers are allocated once with the
+ * program and reused by all the blocks.
+ *
+ * All the operations give NULL if an operand is NULL, and the division and remainder give NULL by a zero divisor, so
+ * a single NULL mask of the chunk collects them and the NULL values are set in the output at the end of the chunk.
+ */
+#define EXPR_PROG_CHUNK_ROWS 256
+
+enum {
+  EXPR_OPND_CONST = 0,
+  EXPR_OPND_COL   = 1,
+  EXPR_OPND_REG   = 2,
+};
+
+typedef struct SExprOperand {
+  uint8_t kind;
+  bool    isNull;  // a constant NULL, or a constant divided by zero
+  int16_t index;   // of the column or the register
+  double  val;     // of a constant
+} SExprOperand;
+
+typedef struct SExprInstr {
+  uint8_t      optr;
+  int16_t      dst;  // the register of the result, -1 for the output
+  SExprOperand left;
+  SExprOperand right;
+} SExprInstr;
+
+typedef struct SExprProgCol {
+  int16_t     colId;
+  int16_t     type;
+  const char *name;
+  const char *data;  // of the block running
+} SExprProgCol;
+
+struct SExprProgram {
+  tExprNode    *pExpr;
+  int32_t       numOfCols;
+  int32_t       numOfInstrs;
+  int32_t       numOfRegs;
+  SExprProgCol *cols;
+  SExprInstr   *instrs;
+  double       *colBuf;  // numOfCols chunks
+  double       *regBuf;  // numOfRegs chunks
+  uint8_t      *nullMask;
+};
+
+typedef struct SExprCompileSupp {
+  SExprProgram *pProg;
+  int32_t       maxCols;
+  int32_t       maxInstrs;
+  int32_t       topReg;
+} SExprCompileSupp;
+
+static bool exprProgOptrSupported(uint8_t optr) {
+  return optr == TSDB_BINARY_OP_ADD || optr == TSDB_BINARY_OP_SUBTRACT || optr == TSDB_BINARY_OP_MULTIPLY ||
+         optr == TSDB_BINARY_OP_DIVIDE || optr == TSDB_BINARY_OP_REMAINDER;
+}
+
+static bool exprProgTypeSupported(int32_t type) {
+  return IS_SIGNED_NUMERIC_TYPE(type) || IS_UNSIGNED_NUMERIC_TYPE(type) || IS_FLOAT_TYPE(type);
+}
+
+// only the trees of the numeric arithmetic are compiled, the timestamp arithmetic, bitand and the functions are left
+// to exprTreeNodeTraverse
+static bool exprProgSupported(tExprNode *pExpr) {
+  switch (pExpr->nodeType) {
+    case TSQL_NODE_EXPR:
+      return exprProgOptrSupported(pExpr->_node.optr) && exprProgSupported(pExpr->_node.pLeft) &&
+             exprProgSupported(pExpr->_node.pRight);
+    case TSQL_NODE_COL:
+      return exprProgTypeSupported(pExpr->pSchema->type);
+    case TSQL_NODE_VALUE:
+      return exprProgTypeSupported(pExpr->pVal->nType);
+    default:
+      return false;
+  }
+}
+
+static int32_t exprProgCountNodes(tExprNode *pExpr) {
+  if (pExpr->nodeType != TSQL_NODE_EXPR) {
+    return 1;
+  }
+
+  return 1 + exprProgCountNodes(pExpr->_node.pLeft) + exprProgCountNodes(pExpr->_node.pRight);
+}
+
+static FORCE_INLINE bool exprProgIsZero(double v) {
+  return FLT_EQUAL(v, 0);
+}
+
+static FORCE_INLINE double exprProgCalc(uint8_t optr, double l, double r) {
+  switch (optr) {
+    case TSDB_BINARY_OP_ADD:       return l + r;
+    case TSDB_BINARY_OP_SUBTRACT:  return l - r;
+    case TSDB_BINARY_OP_MULTIPLY:  return l * r;
+    case TSDB_BINARY_OP_DIVIDE:    return l / r;
+    default:                       return l - ((int64_t)(l / r)) * r;
+  }
+}
+
+static SExprOperand exprProgFold(uint8_t optr, SExprOperand *pLeft, SExprOperand *pRight) {
+  SExprOperand res = {.kind = EXPR_OPND_CONST};
+
+  bool divide = (optr == TSDB_BINARY_OP_DIVIDE || optr == TSDB_BINARY_OP_REMAINDER);
+  if (pLeft->isNull || pRight->isNull || (divide && exprProgIsZero(pRight->val))) {
+    res.isNull = true;
+  } else {
+    res.val = exprProgCalc(optr, pLeft->val, pRight->val);
+  }
+
+  return res;
+}
+
+static SExprOperand exprProgCompileNode(SExprCompileSupp *pSupp, tExprNode *pExpr) {
+  SExprProgram *pProg = pSupp->pProg;
+  SExprOperand  opnd = {0};
+
+  if (pExpr->nodeType == TSQL_NODE_VALUE) {
+    opnd.kind = EXPR_OPND_CONST;
+    opnd.isNull = isNull((const char *)&pExpr->pVal->i64, pExpr->pVal->nType);
+    if (!opnd.isNull) {
+      GET_TYPED_DATA(opnd.val, double, pExpr->pVal->nType, &pExpr->pVal->i64);
+    }
+    return opnd;
+  }
+
+  if (pExpr->nodeType == TSQL_NODE_COL) {
+    int32_t i = 0;
+    for (; i < pProg->numOfCols; ++i) {
+      if (pProg->cols[i].colId == pExpr->pSchema->colId) break;
+    }
+
+    if (i == pProg->numOfCols) {
+      assert(pProg->numOfCols < pSupp->maxCols);
+      pProg->cols[i].colId = pExpr->pSchema->colId;
+      pProg->cols[i].type = pExpr->pSchema->type;
+      pProg->cols[i].name = pExpr->pSchema->name;
+      pProg->numOfCols++;
+    }
+
+    opnd.kind = EXPR_OPND_COL;
+    opnd.index = (int16_t)i;
+    return opnd;
+  }
+
+  SExprOperand left = exprProgCompileNode(pSupp, pExpr->_node.pLeft);
+  SExprOperand right = exprProgCompileNode(pSupp, pExpr->_node.pRight);
+  if (left.kind == EXPR_OPND_CONST && right.kind == EXPR_OPND_CONST) {
+    return exprProgFold(pExpr->_node.optr, &left, &right);
+  }
+
+  // the registers are taken as a stack in the post order of the tree, so the operands are the top ones
+  pSupp->topReg -= (left.kind == EXPR_OPND_REG) + (right.kind == EXPR_OPND_REG);
+
+  assert(pProg->numOfInstrs < pSupp->maxInstrs);
+  SExprInstr *pInstr = &pProg->instrs[pProg->numOfInstrs++];
+  pInstr->optr = pExpr->_node.optr;
+  pInstr->left = left;
+  pInstr->right = right;
+  pInstr->dst = (int16_t)pSupp->topReg++;
+  pProg->numOfRegs = MAX(pProg->numOfRegs, pSupp->topReg);
+
+  opnd.kind = EXPR_OPND_REG;
+  opnd.index = pInstr->dst;
+  return opnd;
+}
+
+SExprProgram *exprTreeCompile(tExprNode *pExpr) {
+  if (pExpr == NULL || pExpr->nodeType != TSQL_NODE_EXPR || !exprProgSupported(pExpr)) {
+    return NULL;
+  }
+
+  int32_t       numOfNodes = exprProgCountNodes(pExpr);
+  SExprProgram *pProg = calloc(1, sizeof(SExprProgram));
+  if (pProg == NULL) {
+    return NULL;
+  }
+
+  pProg->pExpr = pExpr;
+  pProg->cols = calloc(numOfNodes, sizeof(SExprProgCol));
+  pProg->instrs = calloc(numOfNodes, sizeof(SExprInstr));
+  if (pProg->cols == NULL || pProg->instrs == NULL) {
+    exprProgramDestroy(pProg);
+    return NULL;
+  }
+
+  SExprCompileSupp supp = {.pProg = pProg, .maxCols = numOfNodes, .maxInstrs = numOfNodes, .topReg = 0};
+  SExprOperand     res = exprProgCompileNode(&supp, pExpr);
+
+  // a tree of constants only is left to the tree traverse, which gives a single row for it
+  if (res.kind != EXPR_OPND_REG) {
+    exprProgramDestroy(pProg);
+    return NULL;
+  }
+
+  assert(pProg->numOfInstrs > 0 && pProg->instrs[pProg->numOfInstrs - 1].dst == res.index);
+  pProg->instrs[pProg->numOfInstrs - 1].dst = -1;
+
+  pProg->colBuf = malloc(sizeof(double) * EXPR_PROG_CHUNK_ROWS * MAX(pProg->numOfCols, 1));
+  pProg->regBuf = malloc(sizeof(double) * EXPR_PROG_CHUNK_ROWS * MAX(pProg->numOfRegs, 1));
+  pProg->nullMask = malloc(EXPR_PROG_CHUNK_ROWS);
+  if (pProg->colBuf == NULL || pProg->regBuf == NULL || pProg->nullMask == NULL) {
+    exprProgramDestroy(pProg);
+    return NULL;
+  }
+
+  return pProg;
+}
+
+void exprProgramDestroy(SExprProgram *pProg) {
+  if (pProg == NULL) {
+    return;
+  }
+
+  tfree(pProg->cols);
+  tfree(pProg->instrs);
+  tfree(pProg->colBuf);
+  tfree(pProg->regBuf);
+  tfree(pProg->nullMask);
+  tfree(pProg);
+}
+
+tExprNode *exprProgramTree(SExprProgram *pProg) {
+  return pProg->pExpr;
+}
+
+// convert the rows of a chunk of a column to double, the rows are read backward in the descending order
+#define EXPR_PROG_LOAD(_t, _bits, _nullv)                        \
+  do {                                                           \
+    const _bits *b = (const _bits *)(data);                      \
+    for (int32_t j = 0; j < (len); ++j) {                        \
+      _bits bits = b[(desc) ? (last) - j : (first) + j];         \
+      _t    v;                                                   \
+      memcpy(&v, &bits, sizeof(_t));                             \
+      (dst)[j] = (double)v;                                      \
+      (mask)[j] |= (bits == (_bits)(_nullv));                    \
+    }                                                            \
+  } while (0)
+
+static void exprProgLoadCol(int32_t type, const char *data, int32_t first, int32_t last, bool desc, int32_t len,
+                            double *dst, uint8_t *mask) {
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:   EXPR_PROG_LOAD(int8_t, uint8_t, TSDB_DATA_TINYINT_NULL); break;
+    case TSDB_DATA_TYPE_SMALLINT:  EXPR_PROG_LOAD(int16_t, uint16_t, TSDB_DATA_SMALLINT_NULL); break;
+    case TSDB_DATA_TYPE_INT:       EXPR_PROG_LOAD(int32_t, uint32_t, TSDB_DATA_INT_NULL); break;
+    case TSDB_DATA_TYPE_BIGINT:    EXPR_PROG_LOAD(int64_t, uint64_t, TSDB_DATA_BIGINT_NULL); break;
+    case TSDB_DATA_TYPE_UTINYINT:  EXPR_PROG_LOAD(uint8_t, uint8_t, TSDB_DATA_UTINYINT_NULL); break;
+    case TSDB_DATA_TYPE_USMALLINT: EXPR_PROG_LOAD(uint16_t, uint16_t, TSDB_DATA_USMALLINT_NULL); break;
+    case TSDB_DATA_TYPE_UINT:      EXPR_PROG_LOAD(uint32_t, uint32_t, TSDB_DATA_UINT_NULL); break;
+    case TSDB_DATA_TYPE_UBIGINT:   EXPR_PROG_LOAD(uint64_t, uint64_t, TSDB_DATA_UBIGINT_NULL); break;
+    case TSDB_DATA_TYPE_FLOAT:     EXPR_PROG_LOAD(float, uint32_t, TSDB_DATA_FLOAT_NULL); break;
+    case TSDB_DATA_TYPE_DOUBLE:    EXPR_PROG_LOAD(double, uint64_t, TSDB_DATA_DOUBLE_NULL); break;
+    default:                       assert(0);
+  }
+}
+
+// one operation over a chunk, a constant operand is a scalar. A zero divisor makes the row NULL, as the operators of
+// tarithoperator.c do, the quotient computed for it is replaced by the NULL value in the end.
+#define EXPR_PROG_LOOP(_l, _r)                                              \
+  do {                                                                      \
+    switch (pInstr->optr) {                                                 \
+      case TSDB_BINARY_OP_ADD:                                              \
+        for (int32_t j = 0; j < len; ++j) dst[j] = (_l) + (_r);             \
+        break;                                                              \
+      case TSDB_BINARY_OP_SUBTRACT:                                         \
+        for (int32_t j = 0; j < len; ++j) dst[j] = (_l) - (_r);             \
+        break;                                                              \
+      case TSDB_BINARY_OP_MULTIPLY:                                         \
+        for (int32_t j = 0; j < len; ++j) dst[j] = (_l) * (_r);             \
+        break;                                                              \
+      case TSDB_BINARY_OP_DIVIDE:                                           \
+        for (int32_t j = 0; j < len; ++j) {                                 \
+          mask[j] |= exprProgIsZero(_r);                                    \
+          dst[j] = (_l) / (_r);                                             \
+        }                                                                   \
+        break;                                                              \
+      default:                                                              \
+        for (int32_t j = 0; j < len; ++j) {                                 \
+          mask[j] |= exprProgIsZero(_r);                                    \
+          dst[j] = (_l) - ((int64_t)((_l) / (_r))) * (_r);                  \
+        }                                                                   \
+        break;                                                              \
+    }                                                                       \
+  } while (0)
+
+static const double *exprProgOperandData(SExprProgram *pProg, SExprOperand *pOpnd) {
+  if (pOpnd->kind == EXPR_OPND_COL) {
+    return pProg->colBuf + pOpnd->index * EXPR_PROG_CHUNK_ROWS;
+  }
+
+  return pProg->regBuf + pOpnd->index * EXPR_PROG_CHUNK_ROWS;
+}
+
+static void exprProgExecInstr(SExprProgram *pProg, SExprInstr *pInstr, double *dst, int32_t len) {
+  uint8_t *mask = pProg->nullMask;
+
+  if (pInstr->left.isNull || pInstr->right.isNull) {
+    memset(mask, 1, len);
+    return;
+  }
+
+  if (pInstr->left.kind == EXPR_OPND_CONST) {
+    const double  lv = pInstr->left.val;
+    const double *r = exprProgOperandData(pProg, &pInstr->right);
+    EXPR_PROG_LOOP(lv, r[j]);
+  } else if (pInstr->right.kind == EXPR_OPND_CONST) {
+    const double *l = exprProgOperandData(pProg, &pInstr->left);
+    const double  rv = pInstr->right.val;
+    EXPR_PROG_LOOP(l[j], rv);
+  } else {
+    const double *l = exprProgOperandData(pProg, &pInstr->left);
+    const double *r = exprProgOperandData(pProg, &pInstr->right);
+    EXPR_PROG_LOOP(l[j], r[j]);
+  }
+}
+
+void exprProgramExec(SExprProgram *pProg, int32_t numOfRows, tExprOperandInfo *output, void *param, int32_t order,
+                     char *(*getSourceDataBlock)(void *, const char *, int32_t)) {
+  for (int32_t i = 0; i < pProg->numOfCols; ++i) {
+    SExprProgCol *pCol = &pProg->cols[i];
+    pCol->data = getSourceDataBlock(param, pCol->name, pCol->colId);
+  }
+
+  bool    desc = (order == TSDB_ORDER_DESC);
+  double *out = (double *)output->data;
+
+  for (int32_t start = 0; start < numOfRows; start += EXPR_PROG_CHUNK_ROWS) {
+    int32_t len = MIN(EXPR_PROG_CHUNK_ROWS, numOfRows - start);
+
+    memset(pProg->nullMask, 0, len);
+    for (int32_t i = 0; i < pProg->numOfCols; ++i) {
+      exprProgLoadCol(pProg->cols[i].type, pProg->cols[i].data, start, numOfRows - 1 - start, desc, len,
+                      pProg->colBuf + i * EXPR_PROG_CHUNK_ROWS, pProg->nullMask);
+    }
+
+    for (int32_t i = 0; i < pProg->numOfInstrs; ++i) {
+      SExprInstr *pInstr = &pProg->instrs[i];
+      double     *dst = (pInstr->dst < 0) ? out + start : pProg->regBuf + pInstr->dst * EXPR_PROG_CHUNK_ROWS;
+      exprProgExecInstr(pProg, pInstr, dst, len);
+    }
+
+    for (int32_t j = 0; j < len; ++j) {
+      if (pProg->nullMask[j]) {
+        SET_DOUBLE_NULL(&out[start + j]);
+      }
+    }
+  }
+
+  output->type = TSDB_DATA_TYPE_DOUBLE;
+  output->bytes = sizeof(double);
+  output->numOfRows = (int16_t)numOfRows;
+}
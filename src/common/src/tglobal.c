@@ -60,6 +60,14 @@ int32_t tsMaxConnections = 5000;
 int32_t tsShellActivityTimer = 3;  // second
 float   tsNumOfThreadsPerCore = 1.0f;
 int32_t tsNumOfCommitThreads = 4;
+int32_t tsEarlyCommitFactor = 0;     // commit at totalBlocks/factor blocks when commit threads are idle, 0 disables it
+int32_t tsCompactInterval = 3600;    // seconds between rounds of background compaction, 0 disables it
+float   tsCompactMinScore = 1.0f;    // fragmentation score from which a file set is compacted in background
+int32_t tsCompactRateLimit = 50;     // MB/s read and written by background compaction, 0 for no limit
+int32_t tsMigrateInterval = 60;      // seconds between rounds of background tier migration, 0 migrates in commit
+int32_t tsMigrateRateLimit = 50;     // MB/s copied by background tier migration, 0 for no limit
+int32_t tsBlockTargetSize = 0;  // compressed bytes of a data block sized per table, 0 sizes blocks by rows only
+int32_t tsBloomFilter = 0;  // bloom filters of the data blocks, 0: none, 1: binary/nchar columns, 2: integer columns too
 float   tsRatioOfQueryCores = 1.0f;
 int8_t  tsDaylight = 0;
 char    tsTimezone[TSDB_TIMEZONE_LEN] = {0};
@@ -134,6 +142,9 @@ int32_t tsRetrieveBlockingModel = 0;
 // last_row(*), first(*), last_row(ts, col1, col2) query, the result fields will be the original column name
 int8_t tsKeepOriginalColumnName = 0;
 
+// ask the vnodes to return the execution profile of each query, which is logged by the client
+int8_t tsQueryProfile = 0;
+
 // db parameters
 int32_t tsCacheBlockSize = TSDB_DEFAULT_CACHE_BLOCK_SIZE;
 int32_t tsBlocksPerVnode = TSDB_DEFAULT_TOTAL_BLOCKS;
@@ -151,6 +162,7 @@ int32_t tsQuorum = TSDB_DEFAULT_DB_QUORUM_OPTION;
 int16_t tsPartitons = TSDB_DEFAULT_DB_PARTITON_OPTION;
 int8_t  tsUpdate = TSDB_DEFAULT_DB_UPDATE_OPTION;
 int8_t  tsCacheLastRow = TSDB_DEFAULT_CACHE_LAST_ROW;
+int8_t  tsRollup = TSDB_DEFAULT_DB_ROLLUP;
 int32_t tsMaxVgroupsPerDb = 0;
 int32_t tsMinTablePerVnode = TSDB_TABLES_STEP;
 int32_t tsMaxTablePerVnode = TSDB_DEFAULT_TABLES;
@@ -292,6 +304,8 @@ char tsSmlChildTableName[TSDB_TABLE_NAME_LEN] = ""; //user defined child table n
 char tsSmlTagNullName[TSDB_COL_NAME_LEN] = "_tag_null"; //for line protocol if tag is omitted, add a tag with NULL value
                                                         //to make sure inserted records belongs to the same measurement
                                                         //default name is _tag_null and can be user configurable
+int32_t tsSmlParseThreads = 1;        // threads used to parse a batch of schemaless lines, 1 means sequential
+int32_t tsSmlMaxInflightBatches = 64; // max concurrent insert sql batches issued by one schemaless request
 
 int32_t (*monStartSystemFp)() = NULL;
 void (*monStopSystemFp)() = NULL;
@@ -567,6 +581,87 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  // 0 disables the early commit, the other values must be above 3 to commit before the totalBlocks/3 threshold
+  cfg.option = "earlyCommitFactor";
+  cfg.ptr = &tsEarlyCommitFactor;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 100;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "compactInterval";
+  cfg.ptr = &tsCompactInterval;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 86400 * 30;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_SECOND;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "compactMinScore";
+  cfg.ptr = &tsCompactMinScore;
+  cfg.valType = TAOS_CFG_VTYPE_FLOAT;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0.1f;
+  cfg.maxValue = 100.0f;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "compactRateLimit";
+  cfg.ptr = &tsCompactRateLimit;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 100000;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "migrateInterval";
+  cfg.ptr = &tsMigrateInterval;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 86400;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_SECOND;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "migrateRateLimit";
+  cfg.ptr = &tsMigrateRateLimit;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 100000;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_MB;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "blockTargetSize";
+  cfg.ptr = &tsBlockTargetSize;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 64 * 1024 * 1024;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_BYTE;
+  taosInitConfigOption(cfg);
+
+  cfg.option = "bloomFilter";
+  cfg.ptr = &tsBloomFilter;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = 0;
+  cfg.maxValue = 2;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   cfg.option = "ratioOfQueryCores";
   cfg.ptr = &tsRatioOfQueryCores;
   cfg.valType = TAOS_CFG_VTYPE_FLOAT;
@@ -1040,6 +1135,16 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "rollup";
+  cfg.ptr = &tsRollup;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW;
+  cfg.minValue = TSDB_MIN_DB_ROLLUP;
+  cfg.maxValue = TSDB_MAX_DB_ROLLUP;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   cfg.option = "compressMsgSize";
   cfg.ptr = &tsCompressMsgSize;
   cfg.valType = TAOS_CFG_VTYPE_INT32;
@@ -1130,6 +1235,16 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  cfg.option = "queryProfile";
+  cfg.ptr = &tsQueryProfile;
+  cfg.valType = TAOS_CFG_VTYPE_INT8;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 0;
+  cfg.maxValue = 1;
+  cfg.ptrLength = 1;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   // locale & charset
   cfg.option = "timezone";
   cfg.ptr = tsTimezone;
@@ -1711,6 +1826,28 @@ static void doInitGlobalConfig(void) {
   cfg.unitType = TAOS_CFG_UTYPE_NONE;
   taosInitConfigOption(cfg);
 
+  // threads used to parse the lines of one schemaless request
+  cfg.option = "smlParseThreads";
+  cfg.ptr = &tsSmlParseThreads;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 1;
+  cfg.maxValue = 64;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
+  // max insert batches in flight for one schemaless request
+  cfg.option = "smlMaxInflightBatches";
+  cfg.ptr = &tsSmlMaxInflightBatches;
+  cfg.valType = TAOS_CFG_VTYPE_INT32;
+  cfg.cfgType = TSDB_CFG_CTYPE_B_CONFIG | TSDB_CFG_CTYPE_B_SHOW | TSDB_CFG_CTYPE_B_CLIENT;
+  cfg.minValue = 1;
+  cfg.maxValue = 512;
+  cfg.ptrLength = 0;
+  cfg.unitType = TAOS_CFG_UTYPE_NONE;
+  taosInitConfigOption(cfg);
+
   // flush vnode wal file if walSize > walFlushSize and walSize > cache*0.5*blocks
   cfg.option = "walFlushSize";
   cfg.ptr = &tsdbWalFlushSize;
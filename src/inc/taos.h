@@ -157,6 +157,8 @@ DLL_EXPORT int        taos_stmt_get_param(TAOS_STMT *stmt, int idx, int *type, i
 DLL_EXPORT int        taos_stmt_bind_param(TAOS_STMT *stmt, TAOS_BIND *bind);
 DLL_EXPORT int        taos_stmt_bind_param_batch(TAOS_STMT* stmt, TAOS_MULTI_BIND* bind);
 DLL_EXPORT int        taos_stmt_bind_single_param_batch(TAOS_STMT* stmt, TAOS_MULTI_BIND* bind, int colIdx);
+DLL_EXPORT int        taos_stmt_bind_multi_tables_batch(TAOS_STMT* stmt, const char** names, TAOS_BIND** tags,
+                                                       const int* offsets, int numOfTables, TAOS_MULTI_BIND* bind);
 DLL_EXPORT int        taos_stmt_add_batch(TAOS_STMT *stmt);
 DLL_EXPORT int        taos_stmt_execute(TAOS_STMT *stmt);
 DLL_EXPORT int        taos_stmt_affected_rows(TAOS_STMT *stmt);
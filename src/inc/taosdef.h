@@ -344,6 +344,10 @@ do { \
 #define TSDB_MAX_DB_CACHE_LAST_ROW      3
 #define TSDB_DEFAULT_CACHE_LAST_ROW     0
 
+#define TSDB_MIN_DB_ROLLUP              0
+#define TSDB_MAX_DB_ROLLUP              1
+#define TSDB_DEFAULT_DB_ROLLUP          0
+
 #define TSDB_MIN_FSYNC_PERIOD           0
 #define TSDB_MAX_FSYNC_PERIOD           180000   // millisecond
 #define TSDB_DEFAULT_FSYNC_PERIOD       3000     // three second
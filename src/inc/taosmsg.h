@@ -576,6 +576,34 @@ typedef struct SRetrieveTableRsp {
   char    data[];
 } SRetrieveTableRsp;
 
+#define TSDB_QUERY_PROF_MAX_OPERATORS 16
+
+typedef struct {
+  uint8_t operatorType;
+  int64_t execTimes;
+  int64_t selfTime;    // in microseconds, time spent in the upstream operators is excluded
+  int64_t inputRows;
+  int64_t outputRows;
+} SOperatorProfileMsg;
+
+// appended to the last retrieve rsp of a query when asked by the client, the extend of the rsp is set to 1
+typedef struct SQueryProfileMsg {
+  int64_t elapsedTime;
+  int32_t totalBlocks;
+  int32_t loadBlocks;       // blocks whose data are loaded
+  int32_t loadBlockStatis;  // blocks which are checked with statistics only
+  int32_t discardBlocks;
+  int64_t totalRows;
+  int64_t totalCheckedRows;
+  int64_t memRows;          // rows read from the mem and imem tables
+  int64_t fileRows;         // rows loaded from the data files
+  int64_t readBytes;        // bytes read from the data files
+  int64_t decodeBytes;      // bytes of the column data after decompression
+  int64_t spillBytes;       // bytes of the intermediate results flushed to disk
+  int32_t numOfOperators;
+  SOperatorProfileMsg operators[TSDB_QUERY_PROF_MAX_OPERATORS];
+} SQueryProfileMsg;
+
 typedef struct {
   int32_t  vgId;
   int32_t  dbCfgVersion;
@@ -615,7 +643,8 @@ typedef struct {
   int8_t   cacheLastRow;
   int8_t   dbType;
   int16_t  partitions;
-  int8_t   reserve[5];
+  int8_t   rollup;
+  int8_t   reserve[4];
 } SCreateDbMsg, SAlterDbMsg;
 
 typedef struct {
@@ -777,7 +806,8 @@ typedef struct {
   int32_t  vgCfgVersion;
   int8_t   dbReplica;
   int8_t   dbType;
-  int8_t   reserved[8];
+  int8_t   rollup;
+  int8_t   reserved[7];
 } SVnodeCfg;
 
 typedef struct {
@@ -1021,6 +1051,7 @@ enum {
   TLV_TYPE_END_MARK = -1,
   //TLV_TYPE_DUMMY = 1,
   TLV_TYPE_META_VERSION = 1,
+  TLV_TYPE_QUERY_PROFILE = 2,
 };
 
 #pragma pack(pop)
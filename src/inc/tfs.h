@@ -53,6 +53,8 @@ void tfsDestroy();
 void tfsUpdateInfo(SFSMeta *pFSMeta, STierMeta *tierMetas, int8_t numLevels);
 void tfsGetMeta(SFSMeta *pMeta);
 void tfsAllocDisk(int expLevel, int *level, int *id);
+int  tfsMaxLevel();
+void tfsAllocDiskBySize(int expLevel, int64_t size, int *level, int *id);
 
 const char *TFS_PRIMARY_PATH();
 const char *TFS_DISK_PATH(int level, int id);
@@ -71,6 +71,7 @@ typedef struct {
   int8_t  compression;
   int8_t  update;
   int8_t  cacheLastRow;    // 0:no cache, 1: cache last row, 2: cache last NULL column 3: 1&2
+  int8_t  rollup;          // 0: none, 1: an hourly min/max/sum/count tier written at commit
 } STsdbCfg;
 
 #define CACHE_NO_LAST(c)          ((c)->cacheLastRow == 0)
@@ -249,6 +250,13 @@ typedef struct {
   SArray   *dataBlockInfos;
 } STableBlockDist;
 
+typedef struct {
+  int64_t memRows;      // rows read from the mem and imem tables
+  int64_t fileRows;     // rows loaded from the data files, blocks checked by statistics only are excluded
+  int64_t readBytes;    // bytes read from the data files
+  int64_t decodeBytes;  // bytes of the column data after decompression
+} STsdbQueryCost;
+
 /**
  * Get the data block iterator, starting from position according to the query condition
  *
@@ -338,6 +346,14 @@ void tsdbRetrieveDataBlockInfo(TsdbQueryHandleT *pQueryHandle, SDataBlockInfo *p
  */
 int32_t tsdbRetrieveDataBlockStatisInfo(TsdbQueryHandleT *pQueryHandle, SDataStatis **pBlockStatis);
 
+/**
+ * Check the value against the bloom filter of the column in current data block.
+ *
+ * @val the value in the type of the column
+ * @return false only if no row of current data block has the value in the column
+ */
+bool tsdbDataBlockMayHaveValue(TsdbQueryHandleT *pQueryHandle, int16_t colId, int8_t type, const void *val);
+
 /**
  *
  * The query condition with primary timestamp is passed to iterator during its constructor function,
@@ -398,6 +414,13 @@ int32_t tsdbGetFileBlocksDistInfo(TsdbQueryHandleT* queryHandle, STableBlockDist
 // obtain queryHandle attribute
 int64_t tsdbSkipOffset(TsdbQueryHandleT queryHandle);
 
+/**
+ * get the rows and bytes read by the query handle so far
+ * @param queryHandle
+ * @param pCost
+ */
+void tsdbGetQueryCost(TsdbQueryHandleT queryHandle, STsdbQueryCost *pCost);
+
 /**
  * get the statistics of repo usage
  * @param repo. point to the tsdbrepo
@@ -412,6 +435,7 @@ void tsdbDestroyCommitQueue();
 int  tsdbSyncCommit(STsdbRepo *repo);
 void tsdbIncCommitRef(int vgId);
 void tsdbDecCommitRef(int vgId);
+bool tsdbCommitQueueIdle();
 void tsdbSwitchTable(TsdbQueryHandleT pQueryHandle);
 
 // For TSDB file sync
@@ -420,6 +444,18 @@ int tsdbSyncRecv(void *pRepo, SOCKET socketFd);
 
 // For TSDB Compact
 int tsdbCompact(STsdbRepo *pRepo);
+// compact the most fragmented file set in background if it scores tsCompactMinScore at least, under the disk
+// bandwidth of tsCompactRateLimit. Returns 1 if scheduled, 0 if the repo is busy or backs off after yielding to
+// commits
+int tsdbAutoCompact(STsdbRepo *pRepo);
+// number of file sets which still need background compaction as of the last one
+int tsdbGetCompactCandidates(STsdbRepo *pRepo);
+
+// For TSDB tier migration
+typedef bool (*FMigrateStop)(void *param);
+// copy the file sets on a lower level than their age asks for to the right level, under the disk bandwidth of
+// tsMigrateRateLimit. Commits go on meanwhile. Returns the number of file sets migrated, or -1 on error
+int tsdbMigrate(STsdbRepo *pRepo, FMigrateStop fpStop, void *param);
 
 // For TSDB delete data
 int tsdbDeleteData(STsdbRepo *pRepo, void *param);
@@ -178,7 +178,8 @@ typedef struct {
   int8_t  cacheLastRow;
   int8_t  dbType;
   int16_t partitions;
-  int8_t  reserved[7];
+  int8_t  rollup;
+  int8_t  reserved[6];
 } SDbCfg;
 
 typedef struct SDbObj {
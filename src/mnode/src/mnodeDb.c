@@ -365,6 +365,11 @@ static int32_t mnodeCheckDbCfg(SDbCfg *pCfg) {
     return TSDB_CODE_MND_INVALID_DB_OPTION;
   }
 
+  if (pCfg->rollup < TSDB_MIN_DB_ROLLUP || pCfg->rollup > TSDB_MAX_DB_ROLLUP) {
+    mError("invalid db option rollup:%d valid range: [%d, %d]", pCfg->rollup, TSDB_MIN_DB_ROLLUP, TSDB_MAX_DB_ROLLUP);
+    return TSDB_CODE_MND_INVALID_DB_OPTION;
+  }
+
   if (pCfg->dbType < 0 || pCfg->dbType > 1) {
     mError("invalid db option dbType:%d valid range: [%d, %d]", pCfg->dbType, 0, 1);
     return TSDB_CODE_MND_INVALID_DB_OPTION;
@@ -398,6 +403,7 @@ static void mnodeSetDefaultDbCfg(SDbCfg *pCfg) {
   if (pCfg->quorum < 0) pCfg->quorum = MIN(tsQuorum, pCfg->replications);
   if (pCfg->update < 0) pCfg->update = tsUpdate;
   if (pCfg->cacheLastRow < 0) pCfg->cacheLastRow = tsCacheLastRow;
+  if (pCfg->rollup < 0) pCfg->rollup = tsRollup;
   if (pCfg->dbType < 0) pCfg->dbType = 0;
   if (pCfg->partitions < 0) pCfg->partitions = tsPartitons;
 }
@@ -456,7 +462,8 @@ static int32_t mnodeCreateDb(SAcctObj *pAcct, SCreateDbMsg *pCreate, SMnodeMsg *
     .update              = pCreate->update,
     .cacheLastRow        = pCreate->cacheLastRow,
     .dbType              = pCreate->dbType,
-    .partitions          = pCreate->partitions
+    .partitions          = pCreate->partitions,
+    .rollup              = pCreate->rollup
   };
 
   mnodeSetDefaultDbCfg(&pDb->cfg);
@@ -44,6 +44,12 @@
 #define HTTP_SESSION_ID_LEN         (TSDB_USER_LEN + HTTP_PASSWORD_LEN)
 #define HTTP_STATUS_CODE_NUM        63
 
+#ifndef _TD_NINGSI_60
+#define HTTP_EPOLL_EVENTS           (EPOLLIN | EPOLLPRI | EPOLLWAKEUP | EPOLLERR | EPOLLHUP | EPOLLRDHUP)
+#else
+#define HTTP_EPOLL_EVENTS           (EPOLLIN | EPOLLPRI | EPOLLERR | EPOLLHUP | EPOLLRDHUP)
+#endif
+
 typedef enum HttpReqType {
   HTTP_REQTYPE_OTHERS = 0,
   HTTP_REQTYPE_LOGIN = 1,
@@ -70,7 +76,8 @@ typedef enum {
   HTTP_CMD_TYPE_UN_SPECIFIED,
   HTTP_CMD_TYPE_CREATE_DB,
   HTTP_CMD_TYPE_CREATE_STBALE,
-  HTTP_CMD_TYPE_INSERT
+  HTTP_CMD_TYPE_INSERT,
+  HTTP_CMD_TYPE_INSERT_BATCH
 } HttpSqlCmdType;
 
 typedef enum { HTTP_CMD_STATE_NOT_RUN_YET, HTTP_CMD_STATE_RUN_FINISHED } HttpSqlCmdState;
@@ -149,6 +156,7 @@ typedef struct HttpContext {
   uint8_t            reqType;
   uint8_t            parsed;
   bool               error;
+  int8_t             readSuspended;  // EPOLLIN is removed while a request is in progress
   char               ipstr[22];
   char               user[TSDB_USER_LEN];  // parsed from auth token or login message
   char               pass[HTTP_PASSWORD_LEN];
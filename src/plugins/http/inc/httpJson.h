@@ -42,6 +42,10 @@ typedef struct {
   char*   lst;
   char    buf[JSON_BUFFER_SIZE];
   struct  HttpContext* pContext;
+  char    lastChar;     // last character of the data already sent, for the item separator
+  int64_t tsCacheSec;   // second of the last local timestamp formatted into tsCache
+  int32_t tsCacheLen;
+  char    tsCache[32];
 } JsonBuf;
 
 // http response
@@ -20,6 +20,9 @@
 #include "httpUtil.h"
 #include "httpResp.h"
 
+#define METRICS_ACTION_URL_POS    1
+#define METRICS_PROMETHEUS_ACTION "prometheus"
+
 void metricsInitHandle(HttpServer* httpServer);
 
 bool metricsProcessRequest(struct HttpContext* httpContext);
@@ -178,7 +178,7 @@ void        httpInitParser(HttpParser *parser);
 HttpParser *httpCreateParser(struct HttpContext *pContext);
 void        httpClearParser(HttpParser *parser);
 void        httpDestroyParser(HttpParser *parser);
-int32_t     httpParseBuf(HttpParser *parser, const char *buf, int32_t len);
+int32_t     httpParseBuf(HttpParser *parser, const char *buf, int32_t len, int32_t *consumed);
 char *      httpGetStatusDesc(int32_t statusCode);
 
 #endif
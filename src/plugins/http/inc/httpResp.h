@@ -27,6 +27,9 @@ enum _httpRespTempl {
   HTTP_RESPONSE_CHUNKED_COMPRESS,
   HTTP_RESPONSE_OPTIONS,
   HTTP_RESPONSE_GRAFANA,
+  HTTP_RESPONSE_CHUNKED_BINARY_UN_COMPRESS,
+  HTTP_RESPONSE_CHUNKED_BINARY_COMPRESS,
+  HTTP_RESPONSE_PROMETHEUS,
   HTTP_RESP_END
 };
 
@@ -36,5 +39,6 @@ void httpSendErrorResp(HttpContext *pContext, int32_t errNo);
 void httpSendTaosdInvalidSqlErrorResp(HttpContext *pContext, char* errMsg);
 void httpSendSuccResp(HttpContext *pContext, char *desc);
 void httpSendOptionResp(HttpContext *pContext, char *desc);
+void httpSendPrometheusResp(HttpContext *pContext, const char *body, int32_t bodyLen);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_REST_BIN_H
+#define TDENGINE_REST_BIN_H
+#include <stdbool.h>
+#include "httpHandle.h"
+#include "httpJson.h"
+#include "taos.h"
+
+/*
+ * Columnar result format returned by /rest/sqlb. All integers are little endian and every section
+ * starts at a multiple of 8 bytes, so the buffers of a block can be wrapped as Arrow arrays as is.
+ *
+ *   response := header column* pad block* trailer
+ *   header   := "TDCB" version:u16 numOfCols:u16 precision:u8 reserved:u8[7]
+ *   column   := type:u8 reserved:u8 nameLen:u16 bytes:i32 name:u8[nameLen]
+ *   block    := numOfRows:i64 (validity pad values pad)[numOfCols]
+ *   validity := bitmap of (numOfRows + 7) / 8 bytes, bit i is set when row i is not null
+ *   values   := value[numOfRows] of the column width for fixed length types, or
+ *               offset:i32[numOfRows + 1] pad data for binary, nchar and json
+ *   trailer  := 0:i64 totalRows:i64
+ */
+#define REST_BIN_MAGIC     "TDCB"
+#define REST_BIN_MAGIC_LEN 4
+#define REST_BIN_VERSION   1
+#define REST_BIN_ALIGN     8
+
+void restBuildSqlAffectRowsBin(HttpContext *pContext, HttpSqlCmd *cmd, int32_t affect_rows);
+
+void restStartSqlBin(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result);
+bool restBuildSqlBin(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result, int32_t numOfRows);
+void restStopSqlBin(HttpContext *pContext, HttpSqlCmd *cmd);
+
+#endif
@@ -44,6 +44,7 @@
 #define REST_TIMESTAMP_FMT_LOCAL_STRING 0
 #define REST_TIMESTAMP_FMT_TIMESTAMP    1
 #define REST_TIMESTAMP_FMT_UTC_STRING   2
+#define REST_TIMESTAMP_FMT_BINARY       3
 
 void restBuildSqlAffectRowsJson(HttpContext *pContext, HttpSqlCmd *cmd, int32_t affect_rows);
 
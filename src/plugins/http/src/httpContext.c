@@ -108,6 +108,38 @@ const char *httpContextStateStr(HttpContextState state) {
 
 void httpNotifyContextClose(HttpContext *pContext) { shutdown(pContext->fd, SHUT_WR); }
 
+static void httpModifyContextEpoll(HttpContext *pContext, uint32_t events) {
+  struct epoll_event event = {.events = events, .data.ptr = pContext};
+  if (pContext->fd >= 0 && epoll_ctl(pContext->pThread->pollFd, EPOLL_CTL_MOD, pContext->fd, &event) < 0) {
+    httpDebug("context:%p, fd:%d, failed to modify epoll events:%x, error:%s", pContext, pContext->fd, events,
+              strerror(errno));
+  }
+}
+
+/*
+ * The poll is level-triggered, so bytes of a pipelined request that arrive while the previous one is
+ * still handled would wake the thread on every poll. Stop watching reads until the context is ready.
+ */
+void httpSuspendContextRead(HttpContext *pContext) {
+  if (atomic_load_8(&pContext->readSuspended)) return;
+
+  httpModifyContextEpoll(pContext, HTTP_EPOLL_EVENTS & ~EPOLLIN);
+  atomic_store_8(&pContext->readSuspended, 1);
+  httpTrace("context:%p, fd:%d, suspend read events", pContext, pContext->fd);
+
+  // the request may have finished before read events were removed
+  if (atomic_load_32(&pContext->state) == HTTP_CONTEXT_STATE_READY) {
+    httpResumeContextRead(pContext);
+  }
+}
+
+void httpResumeContextRead(HttpContext *pContext) {
+  if (atomic_val_compare_exchange_8(&pContext->readSuspended, 1, 0) == 1) {
+    httpModifyContextEpoll(pContext, HTTP_EPOLL_EVENTS);
+    httpTrace("context:%p, fd:%d, resume read events", pContext, pContext->fd);
+  }
+}
+
 bool httpAlterContextState(HttpContext *pContext, HttpContextState srcState, HttpContextState destState) {
   return (atomic_val_compare_exchange_32(&pContext->state, srcState, destState) == srcState);
 }
@@ -203,11 +235,13 @@ void httpCloseContextByApp(HttpContext *pContext) {
 
   if (keepAlive) {
     if (httpAlterContextState(pContext, HTTP_CONTEXT_STATE_HANDLING, HTTP_CONTEXT_STATE_READY)) {
+      httpResumeContextRead(pContext);
       httpTrace("context:%p, fd:%d, last state:handling, keepAlive:true, reuse context", pContext, pContext->fd);
     } else if (httpAlterContextState(pContext, HTTP_CONTEXT_STATE_DROPPING, HTTP_CONTEXT_STATE_CLOSED)) {
       httpRemoveContextFromEpoll(pContext);
       httpTrace("context:%p, fd:%d, ast state:dropping, keepAlive:true, close connect", pContext, pContext->fd);
     } else if (httpAlterContextState(pContext, HTTP_CONTEXT_STATE_READY, HTTP_CONTEXT_STATE_READY)) {
+      httpResumeContextRead(pContext);
       httpTrace("context:%p, fd:%d, last state:ready, keepAlive:true, reuse context", pContext, pContext->fd);
     } else if (httpAlterContextState(pContext, HTTP_CONTEXT_STATE_CLOSED, HTTP_CONTEXT_STATE_CLOSED)) {
       httpRemoveContextFromEpoll(pContext);
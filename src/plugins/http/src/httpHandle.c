@@ -43,6 +43,7 @@ bool httpProcessData(HttpContext* pContext) {
   // handle Cross-domain request
   if (strcmp(pContext->parser->method, "OPTIONS") == 0) {
     httpTrace("context:%p, fd:%d, process options request", pContext, pContext->fd);
+    httpClearParser(pContext->parser);
     httpSendOptionResp(pContext, "process options request success");
   } else {
     pthread_mutex_lock(&pContext->ctxMutex);
@@ -38,6 +38,93 @@ char JsonNulTkn[] = "null";
 char JsonTrueTkn[] = "true";
 char JsonFalseTkn[] = "false";
 
+static const char httpDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+static const double httpFixedScale[] = {1E0, 1E1, 1E2, 1E3, 1E4, 1E5, 1E6, 1E7, 1E8, 1E9};
+
+/*
+ * Write the decimal digits of num without a terminating zero, two digits per step. snprintf parses
+ * its format string and takes the locale into account for every value, which dominates the cost of
+ * encoding a large result set.
+ */
+static int32_t httpFormatUInt64(char* dst, uint64_t num) {
+  char  tmp[24];
+  char* p = tmp + sizeof(tmp);
+
+  while (num >= 100) {
+    const char* d = httpDigitPairs + (num % 100) * 2;
+    num /= 100;
+    *--p = d[1];
+    *--p = d[0];
+  }
+
+  if (num >= 10) {
+    const char* d = httpDigitPairs + num * 2;
+    *--p = d[1];
+    *--p = d[0];
+  } else {
+    *--p = (char)('0' + num);
+  }
+
+  int32_t len = (int32_t)(tmp + sizeof(tmp) - p);
+  memcpy(dst, p, (size_t)len);
+  return len;
+}
+
+static int32_t httpFormatInt64(char* dst, int64_t num) {
+  if (num >= 0) {
+    return httpFormatUInt64(dst, (uint64_t)num);
+  }
+
+  *dst = '-';
+  return httpFormatUInt64(dst + 1, ~(uint64_t)num + 1) + 1;
+}
+
+/*
+ * Same output as "%.<places>f" for finite |num| <= 1E10. The integral and fractional parts are
+ * split exactly, and the rounding error of the scaled fraction is recovered with fma so that
+ * values lying exactly halfway are rounded to even like printf does.
+ */
+static int32_t httpFormatFixed(char* dst, double num, int32_t places) {
+  double  scale = httpFixedScale[places];
+  double  absVal = fabs(num);
+  double  intPart = floor(absVal);
+  double  frac = absVal - intPart;
+  double  scaled = frac * scale;
+  double  err = fma(frac, scale, -scaled);
+  double  low = floor(scaled);
+  double  diff = scaled - low;
+  int64_t integer = (int64_t)intPart;
+  int64_t fraction = (int64_t)low;
+
+  if (diff > 0.5 || (diff == 0.5 && (err > 0 || (err == 0 && (fraction & 1))))) {
+    fraction++;
+  }
+
+  if (fraction >= (int64_t)scale) {
+    fraction -= (int64_t)scale;
+    integer++;
+  }
+
+  char* p = dst;
+  if (signbit(num)) {
+    *p++ = '-';
+  }
+
+  p += httpFormatUInt64(p, (uint64_t)integer);
+  *p++ = '.';
+
+  char* end = p + places;
+  for (char* q = end; q > p; fraction /= 10) {
+    *--q = (char)('0' + fraction % 10);
+  }
+
+  return (int32_t)(end - dst);
+}
+
 int32_t httpWriteBufByFd(struct HttpContext* pContext, const char* buf, int32_t sz) {
   int32_t len;
   int32_t countWait = 0;
@@ -144,6 +231,7 @@ int32_t httpWriteJsonBufBody(JsonBuf* buf, bool isTheLast) {
   }
 
   httpWriteBufNoTrace(buf->pContext, "\r\n", 2);
+  if (buf->lst > buf->buf) buf->lastChar = *(buf->lst - 1);
   buf->total += (int32_t)(buf->lst - buf->buf);
   buf->lst = buf->buf;
   memset(buf->buf, 0, (size_t)buf->size);
@@ -184,6 +272,8 @@ void httpInitJsonBuf(JsonBuf* buf, struct HttpContext* pContext) {
   buf->total = 0;
   buf->size = JSON_BUFFER_SIZE;  // option setting
   buf->pContext = pContext;
+  buf->lastChar = 0;
+  buf->tsCacheLen = 0;
   memset(buf->lst, 0, JSON_BUFFER_SIZE);
 
   if (pContext->parser->acceptEncodingGzip == 1 && tsHttpEnableCompress) {
@@ -194,11 +284,11 @@ void httpInitJsonBuf(JsonBuf* buf, struct HttpContext* pContext) {
 }
 
 void httpJsonItemToken(JsonBuf* buf) {
-  char c = *(buf->lst - 1);
+  char c = (buf->lst > buf->buf) ? *(buf->lst - 1) : buf->lastChar;
   if (c == JsonArrStt || c == JsonObjStt || c == JsonPairTkn || c == JsonItmTkn) {
     return;
   }
-  if (buf->lst > buf->buf) httpJsonToken(buf, JsonItmTkn);
+  if (buf->lst > buf->buf || buf->total > 0) httpJsonToken(buf, JsonItmTkn);
 }
 
 void httpJsonString(JsonBuf* buf, char* sVal, int32_t len) {
@@ -253,20 +343,19 @@ void httpJsonStringForTransMean(JsonBuf* buf, char* sVal, int32_t maxLen) {
 void httpJsonInt64(JsonBuf* buf, int64_t num) {
   httpJsonItemToken(buf);
   httpJsonTestBuf(buf, MAX_NUM_STR_SZ);
-  buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%" PRId64, num);
+  buf->lst += httpFormatInt64(buf->lst, num);
 }
 
 void httpJsonUInt64(JsonBuf* buf, uint64_t num) {
   httpJsonItemToken(buf);
   httpJsonTestBuf(buf, MAX_NUM_STR_SZ);
-  buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%" PRIu64, num);
+  buf->lst += httpFormatUInt64(buf->lst, num);
 }
 
 void httpJsonTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
   char       ts[35] = {0};
   
   int32_t fractionLen;
-  char* format = NULL;
   time_t quot = 0;
   int64_t mod = 0;
 
@@ -278,7 +367,6 @@ void httpJsonTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
       }
       quot = t / 1000;
       fractionLen = 5;
-      format = ".%03" PRId64;
       break;
     }
 
@@ -289,7 +377,6 @@ void httpJsonTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
       }
       quot = t / 1000000;
       fractionLen = 8;
-      format = ".%06" PRId64;
       break;
     }
 
@@ -300,7 +387,6 @@ void httpJsonTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
       }
       quot = t / 1000000000;
       fractionLen = 11;
-      format = ".%09" PRId64;
       break;
     }
 
@@ -309,10 +395,22 @@ void httpJsonTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
       assert(false);
   }
 
-  struct tm ptm = {0};
-  localtime_r(&quot, &ptm);
-  int32_t length = (int32_t)strftime(ts, 35, "%Y-%m-%d %H:%M:%S", &ptm);
-  length += snprintf(ts + length, fractionLen, format, mod);
+  // rows of a result set are usually close in time, so reuse the date part of the previous value
+  if (buf->tsCacheLen == 0 || buf->tsCacheSec != (int64_t)quot) {
+    struct tm ptm = {0};
+    localtime_r(&quot, &ptm);
+    buf->tsCacheLen = (int32_t)strftime(buf->tsCache, sizeof(buf->tsCache), "%Y-%m-%d %H:%M:%S", &ptm);
+    buf->tsCacheSec = (int64_t)quot;
+  }
+
+  int32_t length = buf->tsCacheLen;
+  int32_t digits = fractionLen - 2;
+  memcpy(ts, buf->tsCache, (size_t)length);
+  ts[length++] = '.';
+  for (int32_t i = length + digits - 1; i >= length; --i, mod /= 10) {
+    ts[i] = (char)('0' + mod % 10);
+  }
+  length += digits;
 
   httpJsonString(buf, ts, length);
 }
@@ -376,13 +474,13 @@ void httpJsonUtcTimestamp(JsonBuf* buf, int64_t t, int32_t timePrecision) {
 void httpJsonInt(JsonBuf* buf, int32_t num) {
   httpJsonItemToken(buf);
   httpJsonTestBuf(buf, MAX_NUM_STR_SZ);
-  buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%d", num);
+  buf->lst += httpFormatInt64(buf->lst, num);
 }
 
 void httpJsonUInt(JsonBuf* buf, uint32_t num) {
   httpJsonItemToken(buf);
   httpJsonTestBuf(buf, MAX_NUM_STR_SZ);
-  buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%u", num);
+  buf->lst += httpFormatUInt64(buf->lst, num);
 }
 
 void httpJsonFloat(JsonBuf* buf, float num) {
@@ -393,7 +491,7 @@ void httpJsonFloat(JsonBuf* buf, float num) {
   } else if (num > 1E10 || num < -1E10) {
     buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%.5e", num);
   } else {
-    buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%.5f", num);
+    buf->lst += httpFormatFixed(buf->lst, num, 5);
   }
 }
 
@@ -405,7 +503,7 @@ void httpJsonDouble(JsonBuf* buf, double num) {
   } else if (num > 1E10 || num < -1E10) {
     buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%.9e", num);
   } else {
-    buf->lst += snprintf(buf->lst, MAX_NUM_STR_SZ, "%.9f", num);
+    buf->lst += httpFormatFixed(buf->lst, num, 9);
   }
 }
 
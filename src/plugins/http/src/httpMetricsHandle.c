@@ -16,6 +16,7 @@
 #include "os.h"
 #include "taoserror.h"
 #include "tfs.h"
+#include "tmetrics.h"
 
 #include "httpMetricsHandle.h"
 #include "dnode.h"
@@ -27,7 +28,29 @@ void metricsInitHandle(HttpServer* pServer) {
   httpAddMethod(pServer, &metricsDecodeMethod);
 }
 
+static bool metricsProcessPrometheusRequest(HttpContext* pContext) {
+  httpDebug("context:%p, fd:%d, user:%s, process prometheus metrics msg", pContext, pContext->fd, pContext->user);
+
+  int32_t size = taosMetricsNum() * TSDB_METRIC_TEXT_LEN + 1;
+  char*   body = malloc(size);
+  if (body == NULL) {
+    httpError("failed to allocate memory for metrics");
+    httpSendErrorResp(pContext, TSDB_CODE_HTTP_NO_ENOUGH_MEMORY);
+    return false;
+  }
+
+  int32_t len = taosMetricsToPrometheus(body, size);
+  httpSendPrometheusResp(pContext, body, len);
+  free(body);
+  return false;
+}
+
 bool metricsProcessRequest(HttpContext* pContext) {
+  HttpString* action = &pContext->parser->path[METRICS_ACTION_URL_POS];
+  if (action->pos > 0 && strcmp(action->str, METRICS_PROMETHEUS_ACTION) == 0) {
+    return metricsProcessPrometheusRequest(pContext);
+  }
+
   httpDebug("context:%p, fd:%d, user:%s, process admin grant msg", pContext, pContext->fd, pContext->user);
 
   JsonBuf* jsonBuf = httpMallocJsonBuf(pContext);
@@ -1160,13 +1160,14 @@ static int32_t httpParseChar(HttpParser *parser, const char c, int32_t *again) {
   return ok;
 }
 
-int32_t httpParseBuf(HttpParser *parser, const char *buf, int32_t len) {
+int32_t httpParseBuf(HttpParser *parser, const char *buf, int32_t len, int32_t *consumed) {
   HttpContext *pContext = parser->pContext;
   const char * p = buf;
   int32_t      ret = 0;
   int32_t      i = 0;
 
-  while (i < len) {
+  // stop at the end of the request, anything behind it belongs to the next pipelined request
+  while (i < len && !parser->parsed) {
     int32_t again = 0;
     ret = httpParseChar(parser, *p, &again);
     if (ret != 0) {
@@ -1178,5 +1179,6 @@ int32_t httpParseBuf(HttpParser *parser, const char *buf, int32_t len) {
     ++i;
   }
 
+  *consumed = i;
   return ret;
 }
@@ -42,7 +42,12 @@ const char *httpRespTemplate[] = {
     // HTTP_RESPONSE_OPTIONS
     "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sContent-Type: application/json;charset=utf-8\r\nContent-Length: %d\r\nAccess-Control-Allow-Methods: *\r\nAccess-Control-Max-Age: 3600\r\nAccess-Control-Allow-Headers: Origin, X-Requested-With, Content-Type, Accept, authorization\r\n\r\n",
     // HTTP_RESPONSE_GRAFANA
-    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sAccess-Control-Allow-Methods:POST, GET, OPTIONS, DELETE, PUT\r\nAccess-Control-Allow-Headers:Accept, Content-Type\r\nContent-Type: application/json;charset=utf-8\r\nContent-Length: %d\r\n\r\n"
+    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sAccess-Control-Allow-Methods:POST, GET, OPTIONS, DELETE, PUT\r\nAccess-Control-Allow-Headers:Accept, Content-Type\r\nContent-Type: application/json;charset=utf-8\r\nContent-Length: %d\r\n\r\n",
+    // HTTP_RESPONSE_CHUNKED_BINARY_UN_COMPRESS, HTTP_RESPONSE_CHUNKED_BINARY_COMPRESS
+    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sContent-Type: application/octet-stream\r\nTransfer-Encoding: chunked\r\n\r\n",
+    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sContent-Type: application/octet-stream\r\nContent-Encoding: gzip\r\nTransfer-Encoding: chunked\r\n\r\n",
+    // HTTP_RESPONSE_PROMETHEUS
+    "%s 200 OK\r\nAccess-Control-Allow-Origin:*\r\n%sContent-Type: text/plain; version=0.0.4; charset=utf-8\r\nContent-Length: %d\r\n\r\n"
 };
 
 static void httpSendErrorRespImp(HttpContext *pContext, int32_t httpCode, char *httpCodeStr, int32_t errNo, const char *desc) {
@@ -204,6 +209,24 @@ void httpSendSuccResp(HttpContext *pContext, char *desc) {
   httpCloseContextByApp(pContext);
 }
 
+void httpSendPrometheusResp(HttpContext *pContext, const char *body, int32_t bodyLen) {
+  char head[1024] = {0};
+
+  int8_t httpVersion = 0;
+  int8_t keepAlive = 0;
+  if (pContext->parser != NULL) {
+    httpVersion = pContext->parser->httpVersion;
+    keepAlive = pContext->parser->keepAlive;
+  }
+
+  int32_t headLen = sprintf(head, httpRespTemplate[HTTP_RESPONSE_PROMETHEUS], httpVersionStr[httpVersion],
+                            httpKeepAliveStr[keepAlive], bodyLen);
+
+  httpWriteBuf(pContext, head, headLen);
+  httpWriteBufNoTrace(pContext, body, bodyLen);
+  httpCloseContextByApp(pContext);
+}
+
 void httpSendOptionResp(HttpContext *pContext, char *desc) {
   char head[1024] = {0};
   char body[1024] = {0};
@@ -0,0 +1,283 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tglobal.h"
+#include "tsclient.h"
+#include "httpLog.h"
+#include "httpJson.h"
+#include "httpResp.h"
+#include "httpRestHandle.h"
+#include "httpRestJson.h"
+#include "httpRestBin.h"
+
+typedef struct SRestBinCol {
+  uint8_t *validity;
+  char *   values;
+  int32_t *offsets;
+  int32_t  len;
+  int32_t  cap;
+} SRestBinCol;
+
+static bool restBinIsVarType(int32_t type) { return IS_VAR_DATA_TYPE(type) || type == TSDB_DATA_TYPE_JSON; }
+
+static void restBinAppend(JsonBuf *buf, const void *data, int64_t len) {
+  const char *p = data;
+  while (len > 0) {
+    int32_t room = (int32_t)(buf->size - (buf->lst - buf->buf));
+    if (room <= 0) {
+      httpWriteJsonBufBody(buf, false);
+      continue;
+    }
+
+    int32_t n = (int32_t)MIN(room, len);
+    memcpy(buf->lst, p, (size_t)n);
+    buf->lst += n;
+    p += n;
+    len -= n;
+  }
+}
+
+static void restBinPad(JsonBuf *buf) {
+  static const char zeros[REST_BIN_ALIGN] = {0};
+
+  int64_t written = buf->total + (buf->lst - buf->buf);
+  int32_t pad = (int32_t)((REST_BIN_ALIGN - written % REST_BIN_ALIGN) % REST_BIN_ALIGN);
+  restBinAppend(buf, zeros, pad);
+}
+
+static void restBinWriteHead(JsonBuf *buf) {
+  char    msg[1024] = {0};
+  int32_t len = -1;
+
+  HttpParser *pParser = buf->pContext->parser;
+  if (pParser->acceptEncodingGzip == 0 || !tsHttpEnableCompress) {
+    len = sprintf(msg, httpRespTemplate[HTTP_RESPONSE_CHUNKED_BINARY_UN_COMPRESS], httpVersionStr[pParser->httpVersion],
+                  httpKeepAliveStr[pParser->keepAlive]);
+  } else {
+    len = sprintf(msg, httpRespTemplate[HTTP_RESPONSE_CHUNKED_BINARY_COMPRESS], httpVersionStr[pParser->httpVersion],
+                  httpKeepAliveStr[pParser->keepAlive]);
+  }
+
+  httpWriteBuf(buf->pContext, (const char *)msg, len);
+}
+
+static void restBinWriteColumn(JsonBuf *buf, int8_t type, int32_t bytes, const char *name) {
+  uint8_t  colType = (uint8_t)type;
+  uint8_t  reserved = 0;
+  uint16_t nameLen = (uint16_t)strlen(name);
+
+  restBinAppend(buf, &colType, sizeof(colType));
+  restBinAppend(buf, &reserved, sizeof(reserved));
+  restBinAppend(buf, &nameLen, sizeof(nameLen));
+  restBinAppend(buf, &bytes, sizeof(bytes));
+  restBinAppend(buf, name, nameLen);
+}
+
+void restStartSqlBin(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result) {
+  JsonBuf *jsonBuf = httpMallocJsonBuf(pContext);
+  if (jsonBuf == NULL) return;
+
+  httpInitJsonBuf(jsonBuf, pContext);
+  restBinWriteHead(jsonBuf);
+
+  TAOS_FIELD *fields = taos_fetch_fields(result);
+  int32_t     num_fields = taos_num_fields(result);
+  bool        isUpdate = (num_fields == 0) || tscIsUpdateQuery(result);
+
+  char     reserved[7] = {0};
+  uint16_t binVersion = REST_BIN_VERSION;
+  uint16_t numOfCols = isUpdate ? 1 : (uint16_t)num_fields;
+  uint8_t  precision = (uint8_t)taos_result_precision(result);
+
+  restBinAppend(jsonBuf, REST_BIN_MAGIC, REST_BIN_MAGIC_LEN);
+  restBinAppend(jsonBuf, &binVersion, sizeof(binVersion));
+  restBinAppend(jsonBuf, &numOfCols, sizeof(numOfCols));
+  restBinAppend(jsonBuf, &precision, sizeof(precision));
+  restBinAppend(jsonBuf, reserved, sizeof(reserved));
+
+  if (isUpdate) {
+    restBinWriteColumn(jsonBuf, TSDB_DATA_TYPE_INT, sizeof(int32_t), REST_JSON_AFFECT_ROWS);
+  } else {
+    for (int32_t i = 0; i < num_fields; ++i) {
+      restBinWriteColumn(jsonBuf, fields[i].type, fields[i].bytes, fields[i].name);
+    }
+  }
+
+  restBinPad(jsonBuf);
+}
+
+void restBuildSqlAffectRowsBin(HttpContext *pContext, HttpSqlCmd *cmd, int32_t affect_rows) {
+  JsonBuf *jsonBuf = httpMallocJsonBuf(pContext);
+  if (jsonBuf == NULL) return;
+
+  int64_t numOfRows = 1;
+  uint8_t validity = 1;
+
+  restBinAppend(jsonBuf, &numOfRows, sizeof(numOfRows));
+  restBinAppend(jsonBuf, &validity, sizeof(validity));
+  restBinPad(jsonBuf);
+  restBinAppend(jsonBuf, &affect_rows, sizeof(affect_rows));
+  restBinPad(jsonBuf);
+
+  cmd->numOfRows = 1;
+}
+
+static void restBinDestroyCols(SRestBinCol *cols, int32_t num) {
+  for (int32_t i = 0; i < num; ++i) {
+    tfree(cols[i].validity);
+    tfree(cols[i].values);
+    tfree(cols[i].offsets);
+  }
+  free(cols);
+}
+
+static SRestBinCol *restBinCreateCols(TAOS_FIELD *fields, int32_t num, int32_t rows) {
+  SRestBinCol *cols = calloc(num, sizeof(SRestBinCol));
+  if (cols == NULL) return NULL;
+
+  for (int32_t i = 0; i < num; ++i) {
+    cols[i].cap = rows * fields[i].bytes;
+    cols[i].validity = calloc((rows + 7) / 8, 1);
+    cols[i].values = calloc(MAX(cols[i].cap, 1), 1);
+    if (restBinIsVarType(fields[i].type)) {
+      cols[i].offsets = calloc(rows + 1, sizeof(int32_t));
+    }
+
+    if (cols[i].validity == NULL || cols[i].values == NULL ||
+        (restBinIsVarType(fields[i].type) && cols[i].offsets == NULL)) {
+      restBinDestroyCols(cols, num);
+      return NULL;
+    }
+  }
+
+  return cols;
+}
+
+static bool restBinAddVarValue(SRestBinCol *pCol, const char *val, int32_t len) {
+  if (pCol->len + len > pCol->cap) {
+    int32_t cap = MAX(pCol->cap * 2, pCol->len + len);
+    char *  values = realloc(pCol->values, cap);
+    if (values == NULL) return false;
+
+    pCol->values = values;
+    pCol->cap = cap;
+  }
+
+  memcpy(pCol->values + pCol->len, val, len);
+  pCol->len += len;
+  return true;
+}
+
+bool restBuildSqlBin(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result, int32_t numOfRows) {
+  JsonBuf *jsonBuf = httpMallocJsonBuf(pContext);
+  if (jsonBuf == NULL) return false;
+
+  int32_t     num_fields = taos_num_fields(result);
+  TAOS_FIELD *fields = taos_fetch_fields(result);
+  int32_t     maxRows = MIN(numOfRows, tsRestRowLimit - cmd->numOfRows);
+
+  SRestBinCol *cols = restBinCreateCols(fields, num_fields, maxRows);
+  if (cols == NULL) {
+    httpError("context:%p, fd:%d, user:%s, failed to alloc column buffers, rows:%d", pContext, pContext->fd,
+              pContext->user, maxRows);
+    return false;
+  }
+
+  // gather the rows of the block column by column, values are copied in their binary form
+  int32_t rows = 0;
+  for (; rows < maxRows; ++rows) {
+    TAOS_ROW row = taos_fetch_row(result);
+    if (row == NULL) {
+      break;
+    }
+    int32_t *length = taos_fetch_lengths(result);
+
+    for (int32_t i = 0; i < num_fields; ++i) {
+      SRestBinCol *pCol = &cols[i];
+      bool         isVar = restBinIsVarType(fields[i].type);
+
+      if (row[i] != NULL) {
+        pCol->validity[rows >> 3] |= (uint8_t)(1u << (rows & 7));
+        if (!isVar) {
+          memcpy(pCol->values + rows * fields[i].bytes, row[i], fields[i].bytes);
+        } else if (!restBinAddVarValue(pCol, row[i], length[i])) {
+          httpError("context:%p, fd:%d, user:%s, failed to alloc column buffers, rows:%d", pContext, pContext->fd,
+                    pContext->user, maxRows);
+          restBinDestroyCols(cols, num_fields);
+          return false;
+        }
+      }
+
+      if (isVar) {
+        pCol->offsets[rows + 1] = pCol->len;
+      }
+    }
+  }
+
+  if (rows > 0) {
+    int64_t blockRows = rows;
+    restBinAppend(jsonBuf, &blockRows, sizeof(blockRows));
+
+    for (int32_t i = 0; i < num_fields; ++i) {
+      SRestBinCol *pCol = &cols[i];
+
+      restBinAppend(jsonBuf, pCol->validity, (rows + 7) / 8);
+      restBinPad(jsonBuf);
+
+      if (restBinIsVarType(fields[i].type)) {
+        restBinAppend(jsonBuf, pCol->offsets, (int64_t)(rows + 1) * sizeof(int32_t));
+        restBinPad(jsonBuf);
+        restBinAppend(jsonBuf, pCol->values, pCol->len);
+      } else {
+        restBinAppend(jsonBuf, pCol->values, (int64_t)rows * fields[i].bytes);
+      }
+      restBinPad(jsonBuf);
+    }
+  }
+
+  restBinDestroyCols(cols, num_fields);
+  cmd->numOfRows += rows;
+
+  if (pContext->fd <= 0) {
+    httpError("context:%p, fd:%d, user:%s, conn closed, abort retrieve", pContext, pContext->fd, pContext->user);
+    return false;
+  }
+
+  if (cmd->numOfRows >= tsRestRowLimit) {
+    httpDebug("context:%p, fd:%d, user:%s, retrieve rows:%d larger than limit:%d, abort retrieve", pContext,
+              pContext->fd, pContext->user, cmd->numOfRows, tsRestRowLimit);
+    return false;
+  }
+
+  // send the block as a chunk now, the client should not wait for the next fetch
+  httpWriteJsonBufBody(jsonBuf, false);
+
+  httpDebug("context:%p, fd:%d, user:%s, retrieved row:%d", pContext, pContext->fd, pContext->user, cmd->numOfRows);
+  return true;
+}
+
+void restStopSqlBin(HttpContext *pContext, HttpSqlCmd *cmd) {
+  JsonBuf *jsonBuf = httpMallocJsonBuf(pContext);
+  if (jsonBuf == NULL) return;
+
+  int64_t endOfBlocks = 0;
+  int64_t totalRows = cmd->numOfRows;
+  restBinAppend(jsonBuf, &endOfBlocks, sizeof(endOfBlocks));
+  restBinAppend(jsonBuf, &totalRows, sizeof(totalRows));
+
+  httpWriteJsonBufEnd(jsonBuf);
+}
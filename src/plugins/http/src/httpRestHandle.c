@@ -19,6 +19,7 @@
 #include "httpLog.h"
 #include "httpRestHandle.h"
 #include "httpRestJson.h"
+#include "httpRestBin.h"
 #include "tglobal.h"
 
 static HttpDecodeMethod restDecodeMethod = {"rest", restProcessRequest};
@@ -56,6 +57,17 @@ static HttpEncodeMethod restEncodeSqlUtcTimeStringMethod = {
   .setNextCmdFp         = NULL
 };
 
+static HttpEncodeMethod restEncodeSqlBinaryMethod = {
+  .startJsonFp          = restStartSqlBin,
+  .stopJsonFp           = restStopSqlBin,
+  .buildQueryJsonFp     = restBuildSqlBin,
+  .buildAffectRowJsonFp = restBuildSqlAffectRowsBin,
+  .initJsonFp           = NULL,
+  .cleanJsonFp          = NULL,
+  .checkFinishedFp      = NULL,
+  .setNextCmdFp         = NULL
+};
+
 void restInitHandle(HttpServer* pServer) {
   httpAddMethod(pServer, &restDecodeMethod);
   httpAddMethod(pServer, &restDecodeMethod2);
@@ -133,6 +145,8 @@ bool restProcessSqlRequest(HttpContext* pContext, int32_t timestampFmt) {
     pContext->encodeMethod = &restEncodeSqlTimestampMethod;
   } else if (timestampFmt == REST_TIMESTAMP_FMT_UTC_STRING) {
     pContext->encodeMethod = &restEncodeSqlUtcTimeStringMethod;
+  } else if (timestampFmt == REST_TIMESTAMP_FMT_BINARY) {
+    pContext->encodeMethod = &restEncodeSqlBinaryMethod;
   }
 
   return true;
@@ -239,6 +253,8 @@ bool restProcessRequest(struct HttpContext* pContext) {
     return restProcessSqlRequest(pContext, REST_TIMESTAMP_FMT_TIMESTAMP);
   } else if (httpUrlMatch(pContext, REST_ACTION_URL_POS, "sqlutc")) {
     return restProcessSqlRequest(pContext, REST_TIMESTAMP_FMT_UTC_STRING);
+  } else if (httpUrlMatch(pContext, REST_ACTION_URL_POS, "sqlb")) {
+    return restProcessSqlRequest(pContext, REST_TIMESTAMP_FMT_BINARY);
   } else if (httpUrlMatch(pContext, REST_ACTION_URL_POS, "login")) {
     return restProcessLoginRequest(pContext);
   } else if (httpUrlMatch(pContext, REST_ACTION_URL_POS, "udf")) {
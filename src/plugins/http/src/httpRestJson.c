@@ -229,6 +229,9 @@ bool restBuildSqlJson(HttpContext *pContext, HttpSqlCmd *cmd, TAOS_RES *result,
     }
   }
 
+  // send the rows of this block as a chunk now, the client should not wait for the next fetch
+  httpWriteJsonBufBody(jsonBuf, false);
+
   httpDebug("context:%p, fd:%d, user:%s, retrieved row:%d", pContext, pContext->fd, pContext->user, cmd->numOfRows);
   return true;
 }
@@ -184,6 +184,9 @@ static void httpProcessHttpData(void *param) {
       if (!httpAlterContextState(pContext, HTTP_CONTEXT_STATE_READY, HTTP_CONTEXT_STATE_READY)) {
         httpDebug("context:%p, fd:%d, state:%s, not in ready state, ignore read events", pContext, pContext->fd,
                   httpContextStateStr(pContext->state));
+        if (pContext->state == HTTP_CONTEXT_STATE_HANDLING) {
+          httpSuspendContextRead(pContext);
+        }
         httpReleaseContext(pContext/*, true*/);
         continue;
       }
@@ -275,11 +278,7 @@ static void *httpAcceptHttpConnection(void *arg) {
     sprintf(pContext->ipstr, "%s:%u", taosInetNtoa(clientAddr.sin_addr), htons(clientAddr.sin_port));
 
     struct epoll_event event;
-#ifndef _TD_NINGSI_60    
-    event.events = EPOLLIN | EPOLLPRI | EPOLLWAKEUP | EPOLLERR | EPOLLHUP | EPOLLRDHUP;
-#else
-    event.events = EPOLLIN | EPOLLPRI | EPOLLERR | EPOLLHUP | EPOLLRDHUP;
-#endif    
+    event.events = HTTP_EPOLL_EVENTS;
     event.data.ptr = pContext;
     if (epoll_ctl(pThread->pollFd, EPOLL_CTL_ADD, connFd, &event) < 0) {
       httpError("context:%p, fd:%d, ip:%s, thread:%s, failed to add http fd for epoll, error:%s", pContext, connFd,
@@ -375,11 +374,21 @@ static bool httpReadData(HttpContext *pContext) {
   char buf[HTTP_STEP_SIZE + 1] = {0};
 
   while (1) {
-    int32_t nread = (int32_t)taosReadSocket(pContext->fd, buf, HTTP_STEP_SIZE);
+    // peek first, a keep-alive client may already have sent the next request behind this one, and
+    // those bytes must stay in the socket until this request is answered
+    int32_t nread = (int32_t)recv(pContext->fd, buf, HTTP_STEP_SIZE, MSG_PEEK);
     if (nread > 0) {
       buf[nread] = '\0';
       httpTraceL("context:%p, fd:%d, nread:%d content:%s", pContext, pContext->fd, nread, buf);
-      int32_t ok = httpParseBuf(pParser, buf, nread);
+      int32_t consumed = 0;
+      int32_t ok = httpParseBuf(pParser, buf, nread, &consumed);
+
+      if (consumed > 0 && taosReadSocket(pContext->fd, buf, consumed) != consumed) {
+        httpError("context:%p, fd:%d, failed to consume %d bytes, close connect", pContext, pContext->fd, consumed);
+        taosCloseSocket(pContext->fd);
+        httpReleaseContext(pContext/*, false */);
+        return false;
+      }
 
       if (ok) {
         httpError("context:%p, fd:%d, parse failed, ret:%d code:%d close connect", pContext, pContext->fd, ok,
@@ -124,6 +124,7 @@ void httpProcessMultiSqlCallBackImp(void *param, TAOS_RES *result, int32_t code,
               pContext->user, multiCmds->pos, affectRows, sql);
 
     singleCmd->code = 0;
+    singleCmd->numOfRows = affectRows;
 
     if (singleCmd->cmdReturnType == HTTP_CMD_RETURN_TYPE_WITH_RETURN && encode->startJsonFp) {
       (encode->startJsonFp)(pContext, singleCmd, result);
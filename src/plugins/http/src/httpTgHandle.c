@@ -61,6 +61,7 @@
  */
 
 #define TG_MAX_SORT_TAG_SIZE 20
+#define TG_INSERT_SQL_PREFIX "import into"
 
 static HttpDecodeMethod tgDecodeMethod = {"telegraf", tgProcessRquest};
 static HttpEncodeMethod tgQueryMethod = {
@@ -698,7 +699,7 @@ bool tgProcessSingleMetric(HttpContext *pContext, cJSON *metric, char *db) {
   }
 
   // assembling insert sql
-  table_cmd->sql = httpAddToSqlCmdBufferNoTerminal(pContext, "import into %s.%s using %s.%s tags(", db,
+  table_cmd->sql = httpAddToSqlCmdBufferNoTerminal(pContext, TG_INSERT_SQL_PREFIX " %s.%s using %s.%s tags(", db,
                                                    httpGetCmdsString(pContext, table_cmd->table), db,
                                                    httpGetCmdsString(pContext, table_cmd->stable));
   for (int32_t i = 0; i < orderTagsLen; ++i) {
@@ -811,6 +812,62 @@ bool tgProcessSingleMetric(HttpContext *pContext, cJSON *metric, char *db) {
     ]
  }
  */
+/*
+ * Merge the insert commands of a request into one multi-table import, so all metrics are parsed once and
+ * submitted to each vnode in a single message. The per-metric commands stay in place, and are only executed
+ * when the batch fails, e.g. because the database or a super table has to be created first, or when it does not
+ * account for the row of every metric.
+ */
+static bool tgAddBatchInsertCmd(HttpContext *pContext) {
+  HttpSqlCmds *multiCmds = pContext->multiCmds;
+  int32_t      prefixLen = (int32_t)strlen(TG_INSERT_SQL_PREFIX);
+  int32_t      numOfInserts = 0;
+  int64_t      len = prefixLen + 1;
+
+  for (int32_t i = 0; i < multiCmds->size; ++i) {
+    HttpSqlCmd *cmd = multiCmds->cmds + i;
+    if (cmd->cmdType != HTTP_CMD_TYPE_INSERT) continue;
+    len += (int64_t)strlen(httpGetCmdsString(pContext, cmd->sql)) - prefixLen;
+    numOfInserts++;
+  }
+
+  if (numOfInserts <= 1 || len >= tsMaxSQLStringLen) {
+    return false;
+  }
+
+  int32_t sql = httpAddToSqlCmdBufferWithSize(pContext, (int32_t)len);
+  if (sql < 0) {
+    return false;
+  }
+
+  HttpSqlCmd *batch = httpNewSqlCmd(pContext);
+  if (batch == NULL) {
+    return false;
+  }
+  batch->cmdType = HTTP_CMD_TYPE_INSERT_BATCH;
+  batch->cmdReturnType = HTTP_CMD_RETURN_TYPE_NO_RETURN;
+  batch->sql = sql;
+
+  // every insert starts with the prefix followed by a space, so the remainders can be appended as they are
+  char *dst = httpGetCmdsString(pContext, sql);
+  memcpy(dst, TG_INSERT_SQL_PREFIX, (size_t)prefixLen);
+  dst += prefixLen;
+
+  for (int32_t i = 0; i < multiCmds->size; ++i) {
+    HttpSqlCmd *cmd = multiCmds->cmds + i;
+    if (cmd->cmdType != HTTP_CMD_TYPE_INSERT) continue;
+    char *  src = httpGetCmdsString(pContext, cmd->sql) + prefixLen;
+    int32_t srcLen = (int32_t)strlen(src);
+    memcpy(dst, src, (size_t)srcLen);
+    dst += srcLen;
+  }
+  *dst = 0;
+
+  httpDebug("context:%p, fd:%d, merge %d inserts into one batch, sql len:%" PRId64, pContext, pContext->fd,
+            numOfInserts, len);
+  return true;
+}
+
 bool tgProcessQueryRequest(HttpContext *pContext, char *db) {
   httpDebug("context:%p, fd:%d, process telegraf query msg", pContext, pContext->fd);
 
@@ -836,7 +893,7 @@ bool tgProcessQueryRequest(HttpContext *pContext, char *db) {
       return false;
     }
 
-    int32_t cmdSize = size * 2 + 1;
+    int32_t cmdSize = size * 2 + 2;
     if (cmdSize > HTTP_MAX_CMD_SIZE) {
       httpSendErrorResp(pContext, TSDB_CODE_HTTP_TG_METRICS_SIZE);
       cJSON_Delete(root);
@@ -899,6 +956,10 @@ bool tgProcessQueryRequest(HttpContext *pContext, char *db) {
   pContext->encodeMethod = &tgQueryMethod;
   pContext->multiCmds->pos = 2;
 
+  if (tgAddBatchInsertCmd(pContext)) {
+    pContext->multiCmds->pos = (int16_t)(pContext->multiCmds->size - 1);
+  }
+
   return true;
 }
 
@@ -96,6 +96,17 @@ void tgBuildSqlAffectRowsJson(HttpContext *pContext, HttpSqlCmd *cmd, int32_t af
   httpJsonPairIntVal(jsonBuf, "affected_rows", 13, affect_rows);
 }
 
+/*
+ * Drop the batch, the last command, so that the metrics are imported one by one from the first insert on, each with
+ * its own status, affected rows and create-on-demand handling. A batch refused by one vnode may have written the rows
+ * of the others already. Replaying them is idempotent: a row keeps its timestamp and values, so it replaces itself
+ * or is discarded as a duplicate timestamp, and only the write is repeated.
+ */
+static void tgDropBatchCmd(HttpSqlCmds *multiCmds, HttpSqlCmd *cmd) {
+  cmd->cmdState = HTTP_CMD_STATE_RUN_FINISHED;
+  multiCmds->size = (int16_t)(multiCmds->size - 1);
+}
+
 bool tgCheckFinished(struct HttpContext *pContext, HttpSqlCmd *cmd, int32_t code) {
   HttpSqlCmds *multiCmds = pContext->multiCmds;
   httpDebug("context:%p, fd:%d, check telegraf command, code:%s, state:%d, type:%d, rettype:%d, tags:%d", pContext,
@@ -121,6 +132,13 @@ bool tgCheckFinished(struct HttpContext *pContext, HttpSqlCmd *cmd, int32_t code
       }
     } else {
     }
+  } else if (cmd->cmdType == HTTP_CMD_TYPE_INSERT_BATCH) {
+    // the caller moves on to the next command, the first insert
+    tgDropBatchCmd(multiCmds, cmd);
+    multiCmds->pos = 1;
+    httpDebug("context:%p, fd:%d, code:%s, batch import failed, try import one by one", pContext, pContext->fd,
+              tstrerror(code));
+    return false;
   } else if (cmd->cmdType == HTTP_CMD_TYPE_CREATE_DB) {
     cmd->cmdState = HTTP_CMD_STATE_RUN_FINISHED;
     httpDebug("context:%p, fd:%d, code:%s, create database failed", pContext, pContext->fd, tstrerror(code));
@@ -141,6 +159,31 @@ void tgSetNextCmd(struct HttpContext *pContext, HttpSqlCmd *cmd, int32_t code) {
 
   if (cmd->cmdType == HTTP_CMD_TYPE_INSERT) {
     multiCmds->pos = (int16_t)(multiCmds->pos + 2);
+  } else if (cmd->cmdType == HTTP_CMD_TYPE_INSERT_BATCH) {
+    // each insert carries the single row of its metric, so the batch wrote every metric only if it affected as many
+    // rows as it has inserts. Otherwise the rows of each metric are told by importing them one by one
+    int32_t numOfInserts = 0;
+    for (int32_t i = 0; i < multiCmds->size; ++i) {
+      if (multiCmds->cmds[i].cmdType == HTTP_CMD_TYPE_INSERT) numOfInserts++;
+    }
+
+    if (cmd->numOfRows != numOfInserts) {
+      httpDebug("context:%p, fd:%d, batch import affected %d rows of %d metrics, try import one by one", pContext,
+                pContext->fd, cmd->numOfRows, numOfInserts);
+      tgDropBatchCmd(multiCmds, cmd);
+      multiCmds->pos = 2;
+      return;
+    }
+
+    for (int32_t i = 0; i < multiCmds->size; ++i) {
+      HttpSqlCmd *insert = multiCmds->cmds + i;
+      if (insert->cmdType != HTTP_CMD_TYPE_INSERT) continue;
+      insert->code = code;
+      tgStartQueryJson(pContext, insert, NULL);
+      tgBuildSqlAffectRowsJson(pContext, insert, 1);
+      tgStopQueryJson(pContext, insert);
+    }
+    multiCmds->pos = multiCmds->size;
   } else if (cmd->cmdType == HTTP_CMD_TYPE_CREATE_DB) {
     multiCmds->pos++;
   } else if (cmd->cmdType == HTTP_CMD_TYPE_CREATE_STBALE) {
@@ -0,0 +1,195 @@
+#include <gtest/gtest.h>
+#include <cfloat>
+#include <cstdarg>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+
+#include "httpTestUtil.h"
+#include "taosdef.h"
+
+// the http headers declare no C linkage of their own
+extern "C" {
+#include "httpInt.h"
+#include "httpJson.h"
+}
+
+namespace {
+
+// The values of a result set as the json writers format them, each into an empty buffer
+class HttpJsonTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memset(&context, 0, sizeof(context));
+    memset(&parser, 0, sizeof(parser));
+    context.fd = -1;
+    context.parser = &parser;
+    buf = (JsonBuf *)calloc(1, sizeof(JsonBuf));
+    httpInitJsonBuf(buf, &context);
+  }
+
+  void TearDown() override { free(buf); }
+
+  std::string written() { return std::string(buf->buf, buf->lst - buf->buf); }
+
+  template <typename F>
+  std::string format(F write) {
+    buf->lst = buf->buf;
+    write(buf);
+    return written();
+  }
+
+  HttpContext context;
+  HttpParser  parser;
+  JsonBuf *   buf;
+};
+
+std::string printed(const char *format, ...) {
+  char    str[64];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(str, sizeof(str), format, args);
+  va_end(args);
+  return str;
+}
+
+// what httpJsonFloat and httpJsonDouble wrote with snprintf for every value
+std::string printedReal(double num, int32_t places) {
+  if (std::isinf(num) || std::isnan(num)) return "null";
+  if (num > 1E10 || num < -1E10) return printed(places == 5 ? "%.5e" : "%.9e", num);
+  return printed(places == 5 ? "%.5f" : "%.9f", num);
+}
+
+// what httpJsonStringForTransMean writes for the first maxLen bytes of a value
+std::string escaped(const std::string &val, size_t maxLen) {
+  std::string json = "\"";
+  for (size_t i = 0; i < val.size() && i < maxLen && val[i] != 0; ++i) {
+    if (val[i] == '"' || val[i] == '\\') json += '\\';
+    json += val[i];
+  }
+  return json + "\"";
+}
+
+}  // namespace
+
+// The integers are written as by snprintf with %d, %u, PRId64 and PRIu64, the limits included
+TEST_F(HttpJsonTest, integers) {
+  const int64_t i64s[] = {0, 1, -1, 9, 10, -10, 99, 100, -100, 12345, INT32_MAX, INT32_MIN, (int64_t)INT32_MAX + 1,
+                          999999999999LL, 1000000000000LL, INT64_MAX, INT64_MIN, INT64_MIN + 1};
+  for (int64_t v : i64s) {
+    EXPECT_EQ(format([v](JsonBuf *b) { httpJsonInt64(b, v); }), printed("%" PRId64, v));
+    EXPECT_EQ(format([v](JsonBuf *b) { httpJsonInt(b, (int32_t)v); }), printed("%d", (int32_t)v));
+  }
+
+  const uint64_t u64s[] = {0, 1, 9, 10, 99, 100, UINT32_MAX, (uint64_t)UINT32_MAX + 1, INT64_MAX,
+                           (uint64_t)INT64_MAX + 1, UINT64_MAX - 1, UINT64_MAX};
+  for (uint64_t v : u64s) {
+    EXPECT_EQ(format([v](JsonBuf *b) { httpJsonUInt64(b, v); }), printed("%" PRIu64, v));
+    EXPECT_EQ(format([v](JsonBuf *b) { httpJsonUInt(b, (uint32_t)v); }), printed("%u", (uint32_t)v));
+  }
+
+  // every length of digits of both signs
+  std::mt19937_64 rand(7);
+  for (int32_t i = 0; i < 100000; ++i) {
+    int64_t v = (int64_t)(rand() >> (rand() % 64));
+    if (i % 2) v = -v;
+    ASSERT_EQ(format([v](JsonBuf *b) { httpJsonInt64(b, v); }), printed("%" PRId64, v));
+  }
+}
+
+// The floats and doubles are written as by snprintf with %.5f and %.9f, with -0, the denormals, the values rounded to
+// a carry and the limit of the fixed notation
+TEST_F(HttpJsonTest, reals) {
+  const double dbls[] = {0.0,
+                         -0.0,
+                         DBL_MIN,
+                         -DBL_MIN,
+                         std::numeric_limits<double>::denorm_min(),
+                         -std::numeric_limits<double>::denorm_min(),
+                         DBL_MIN / 3,
+                         FLT_MIN,
+                         std::numeric_limits<float>::denorm_min(),
+                         -std::numeric_limits<float>::denorm_min(),
+                         0.5,
+                         -0.5,
+                         0.1,
+                         0.0000049999,
+                         0.000005,
+                         0.0000050001,
+                         0.0000000005,
+                         0.00000000049999999,
+                         -0.0000000005,
+                         0.9999999999,
+                         0.999995,
+                         -0.9999999999,
+                         1.0000000005,
+                         2.5,
+                         123456.123456789,
+                         9999999999.9999999,
+                         9999999999.99999,
+                         -9999999999.99999,
+                         1E10,
+                         -1E10,
+                         std::nextafter(1E10, 2E10),
+                         std::nextafter(-1E10, -2E10),
+                         1E11,
+                         DBL_MAX,
+                         -DBL_MAX,
+                         std::numeric_limits<double>::infinity(),
+                         -std::numeric_limits<double>::infinity(),
+                         std::numeric_limits<double>::quiet_NaN()};
+
+  for (double v : dbls) {
+    EXPECT_EQ(format([v](JsonBuf *b) { httpJsonDouble(b, v); }), printedReal(v, 9)) << v;
+
+    float f = (float)v;
+    EXPECT_EQ(format([f](JsonBuf *b) { httpJsonFloat(b, f); }), printedReal(f, 5)) << f;
+  }
+
+  // values of every magnitude of the fixed notation, and the fractions of few bits that are near the halfway
+  std::mt19937_64                        rand(11);
+  std::uniform_real_distribution<double> mantissa(-10, 10);
+  for (int32_t i = 0; i < 200000; ++i) {
+    double v = mantissa(rand) * std::pow(10, (int32_t)(rand() % 20) - 10);
+    if (i % 4 == 0) v = std::ldexp((double)(int64_t)(rand() % 2000001 - 1000000), -(int32_t)(rand() % 40));
+
+    ASSERT_EQ(format([v](JsonBuf *b) { httpJsonDouble(b, v); }), printedReal(v, 9)) << v;
+    float f = (float)v;
+    ASSERT_EQ(format([f](JsonBuf *b) { httpJsonFloat(b, f); }), printedReal(f, 5)) << f;
+  }
+}
+
+// A binary is quoted with its quotes and backslashes escaped, up to its length or its first zero, and a value longer
+// than the buffer once escaped is sent over several chunks
+TEST_F(HttpJsonTest, strings) {
+  SHttpTestConn conn;
+  context.fd = conn.serverFd();
+
+  std::string values[] = {"", "abc", "\"", "\\", "a\"b\\c\"", std::string(TSDB_MAX_BINARY_LEN, '"'),
+                          std::string(TSDB_MAX_BINARY_LEN, '\\'), std::string(JSON_BUFFER_SIZE - 100, 'x') + "\"\\",
+                          std::string("a\0b", 3)};
+  std::string binary;
+  for (int32_t i = 0; i < (int32_t)TSDB_MAX_BINARY_LEN; ++i) {
+    binary += (i % 7 == 0) ? '"' : (i % 11 == 0) ? '\\' : (char)('a' + i % 26);
+  }
+
+  httpInitJsonBuf(buf, &context);
+  httpWriteJsonBufHead(buf);
+
+  std::string expect;
+  for (std::string &v : values) {
+    httpJsonStringForTransMean(buf, &v[0], (int32_t)v.size());
+    expect += (expect.empty() ? "" : ",") + escaped(v, v.size());
+  }
+
+  // a value ends at the length given
+  httpJsonStringForTransMean(buf, &binary[0], (int32_t)binary.size() - 5);
+  expect += "," + escaped(binary, binary.size() - 5);
+  httpWriteJsonBufEnd(buf);
+
+  std::string head, body;
+  ASSERT_TRUE(conn.dechunk(&head, &body));
+  EXPECT_EQ(body.size(), expect.size());
+  EXPECT_TRUE(body == expect);
+}
@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+
+#include "os.h"
+#include "dnode.h"
+#include "monitor.h"
+#include "httpTestUtil.h"
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+// The http plugin is linked into taosd, which provides these. The tests run the plugin without a dnode
+int32_t dnodeGetDnodeId() { return 1; }
+
+SDnodeStatisInfo dnodeGetStatisInfo() {
+  SDnodeStatisInfo info;
+  memset(&info, 0, sizeof(info));
+  return info;
+}
+
+SMonHttpStatus *monGetHttpStatusHashTableEntry(int32_t code) { return NULL; }
+
+SHttpTestConn::SHttpTestConn() {
+  fds[0] = fds[1] = -1;
+  if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) {
+    ADD_FAILURE() << "socketpair: " << strerror(errno);
+    return;
+  }
+
+  // the server writes blocking, so the test reads at its pace only what fits here
+  int32_t size = 4 * 1024 * 1024;
+  setsockopt(fds[0], SOL_SOCKET, SO_SNDBUF, &size, sizeof(size));
+  setsockopt(fds[1], SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+  fcntl(fds[1], F_SETFL, O_NONBLOCK);
+}
+
+SHttpTestConn::~SHttpTestConn() {
+  if (fds[0] >= 0) close(fds[0]);
+  if (fds[1] >= 0) close(fds[1]);
+}
+
+const std::string &SHttpTestConn::read() {
+  char buf[65536];
+  for (ssize_t n; (n = ::read(fds[1], buf, sizeof(buf))) > 0;) response.append(buf, (size_t)n);
+  return response;
+}
+
+bool SHttpTestConn::dechunk(std::string *head, std::string *body) {
+  read();
+  size_t end = response.find("\r\n\r\n");
+  if (end == std::string::npos) return false;
+
+  *head = response.substr(0, end);
+  body->clear();
+  for (size_t pos = end + 4; pos < response.size();) {
+    size_t eol = response.find("\r\n", pos);
+    if (eol == std::string::npos) return false;
+
+    size_t len = strtoul(response.substr(pos, eol - pos).c_str(), NULL, 16);
+    if (len == 0) return response.substr(eol) == "\r\n\r\n";
+    if (response.substr(eol + 2 + len, 2) != "\r\n") return false;
+
+    body->append(response, eol + 2, len);
+    pos = eol + 2 + len + 2;
+  }
+
+  return false;
+}
@@ -0,0 +1,25 @@
+#ifndef TDENGINE_HTTP_TEST_UTIL_H
+#define TDENGINE_HTTP_TEST_UTIL_H
+
+#include <string>
+
+// A connection of which the server writes to one end and the test reads the other
+class SHttpTestConn {
+ public:
+  SHttpTestConn();
+  ~SHttpTestConn();
+
+  int serverFd() const { return fds[0]; }
+
+  // what the server sent so far
+  const std::string &read();
+
+  // the head of a chunked response and its body without the chunk framing, false if the last chunk is missing
+  bool dechunk(std::string *head, std::string *body);
+
+ private:
+  int         fds[2];
+  std::string response;
+};
+
+#endif  // TDENGINE_HTTP_TEST_UTIL_H
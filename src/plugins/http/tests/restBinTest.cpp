@@ -0,0 +1,285 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+#include "httpTestUtil.h"
+#include "taoserror.h"
+
+// the http headers declare no C linkage of their own
+extern "C" {
+#include "httpInt.h"
+#include "httpJson.h"
+#include "httpRestBin.h"
+#include "httpRestJson.h"
+}
+
+namespace {
+
+struct SCell {
+  bool        null;
+  std::string bytes;  // the value as the client returns it, the data only for binary
+
+  bool operator==(const SCell &o) const { return null == o.null && (null || bytes == o.bytes); }
+};
+
+typedef std::vector<std::vector<SCell>> SRows;
+
+std::ostream &operator<<(std::ostream &os, const SCell &cell) {
+  return cell.null ? os << "null" : os << cell.bytes.size() << " bytes";
+}
+
+// A result set of the client, of which the test gives the rows
+struct SFakeResult {
+  std::vector<TAOS_FIELD> fields;
+  SRows                   rows;
+  size_t                  next;
+  int32_t                 precision;
+  std::vector<void *>     row;
+  std::vector<int32_t>    lengths;
+};
+
+template <typename T>
+SCell fixedCell(T v) {
+  return SCell{false, std::string((const char *)&v, sizeof(v))};
+}
+
+SCell nullCell() { return SCell{true, ""}; }
+SCell binCell(const std::string &s) { return SCell{false, s}; }
+
+TAOS_FIELD field(const char *name, uint8_t type, int16_t bytes) {
+  TAOS_FIELD f;
+  memset(&f, 0, sizeof(f));
+  tstrncpy(f.name, name, sizeof(f.name));
+  f.type = type;
+  f.bytes = bytes;
+  return f;
+}
+
+bool isVarType(uint8_t type) {
+  return type == TSDB_DATA_TYPE_BINARY || type == TSDB_DATA_TYPE_NCHAR || type == TSDB_DATA_TYPE_JSON;
+}
+
+}  // namespace
+
+// The calls of the client the encoder makes, answered from the fake result. The test defines them in the executable,
+// which the dynamic linker searches before libtaos
+extern "C" {
+TAOS_FIELD *taos_fetch_fields(TAOS_RES *res) { return ((SFakeResult *)res)->fields.data(); }
+int         taos_num_fields(TAOS_RES *res) { return (int)((SFakeResult *)res)->fields.size(); }
+int         taos_result_precision(TAOS_RES *res) { return ((SFakeResult *)res)->precision; }
+bool        tscIsUpdateQuery(void *pSql) { return false; }
+
+TAOS_ROW taos_fetch_row(TAOS_RES *res) {
+  SFakeResult *pRes = (SFakeResult *)res;
+  if (pRes->next >= pRes->rows.size()) return NULL;
+
+  std::vector<SCell> &cells = pRes->rows[pRes->next++];
+  pRes->row.assign(cells.size(), NULL);
+  pRes->lengths.assign(cells.size(), 0);
+  for (size_t i = 0; i < cells.size(); ++i) {
+    if (cells[i].null) continue;
+    pRes->row[i] = &cells[i].bytes[0];
+    pRes->lengths[i] = (int32_t)cells[i].bytes.size();
+  }
+  return pRes->row.data();
+}
+
+int *taos_fetch_lengths(TAOS_RES *res) { return ((SFakeResult *)res)->lengths.data(); }
+}
+
+namespace {
+
+// Reads the body of a /rest/sqlb response by the layout in httpRestBin.h, the integers byte by byte as little endian
+class SBinReader {
+ public:
+  explicit SBinReader(const std::string &data) : body(data), pos(0) {}
+
+  uint64_t uint(int32_t bytes) {
+    EXPECT_LE(pos + bytes, body.size());
+    uint64_t v = 0;
+    for (int32_t i = 0; i < bytes && pos < body.size(); ++i) {
+      v |= (uint64_t)(uint8_t)body[pos++] << (8 * i);
+    }
+    return v;
+  }
+
+  std::string bytes(size_t n) {
+    EXPECT_LE(pos + n, body.size());
+    std::string s = body.substr(pos, n);
+    pos += n;
+    return s;
+  }
+
+  // the padding up to the next section is zeros
+  void pad() {
+    while (pos % REST_BIN_ALIGN != 0) {
+      ASSERT_LT(pos, body.size());
+      EXPECT_EQ(body[pos], 0) << pos;
+      pos++;
+    }
+  }
+
+  bool   aligned() const { return pos % REST_BIN_ALIGN == 0; }
+  size_t left() const { return body.size() - pos; }
+
+ private:
+  std::string body;
+  size_t      pos;
+};
+
+// A /rest/sqlb request answered on a socket pair, of which the test reads the other end
+class RestBinTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memset(&context, 0, sizeof(context));
+    memset(&parser, 0, sizeof(parser));
+    memset(&cmd, 0, sizeof(cmd));
+    context.fd = conn.serverFd();
+    context.parser = &parser;
+
+    result.next = 0;
+    result.precision = TSDB_TIME_PRECISION_MICRO;
+  }
+
+  void TearDown() override { httpFreeJsonBuf(&context); }
+
+  // the body of the chunked response
+  std::string body() {
+    std::string head, data;
+    EXPECT_TRUE(conn.dechunk(&head, &data));
+    EXPECT_NE(head.find("Content-Type: application/octet-stream"), std::string::npos);
+    EXPECT_NE(head.find("Transfer-Encoding: chunked"), std::string::npos);
+    return data;
+  }
+
+  // the header and the columns, which are to be those of the result
+  void readHeader(SBinReader &reader, const std::vector<TAOS_FIELD> &fields) {
+    EXPECT_EQ(reader.bytes(REST_BIN_MAGIC_LEN), REST_BIN_MAGIC);
+    EXPECT_EQ(reader.uint(2), REST_BIN_VERSION);
+    EXPECT_EQ(reader.uint(2), fields.size());
+    EXPECT_EQ(reader.uint(1), (uint64_t)result.precision);
+    EXPECT_EQ(reader.bytes(7), std::string(7, '\0'));
+
+    for (const TAOS_FIELD &f : fields) {
+      EXPECT_EQ(reader.uint(1), f.type);
+      EXPECT_EQ(reader.uint(1), 0u);
+      uint64_t nameLen = reader.uint(2);
+      EXPECT_EQ((int32_t)reader.uint(4), f.bytes);
+      EXPECT_EQ(reader.bytes(nameLen), f.name);
+    }
+    reader.pad();
+  }
+
+  // a block, as rows of cells. A null fixed length value is zeros, a null binary one is empty
+  SRows readBlock(SBinReader &reader, const std::vector<TAOS_FIELD> &fields) {
+    EXPECT_TRUE(reader.aligned());
+    int64_t numOfRows = (int64_t)reader.uint(8);
+    SRows   rows(numOfRows, std::vector<SCell>(fields.size()));
+
+    for (size_t c = 0; c < fields.size(); ++c) {
+      std::string validity = reader.bytes((numOfRows + 7) / 8);
+      reader.pad();
+      for (int64_t r = 0; r < numOfRows; ++r) {
+        rows[r][c].null = ((uint8_t)validity[r >> 3] & (1u << (r & 7))) == 0;
+      }
+
+      if (!isVarType(fields[c].type)) {
+        for (int64_t r = 0; r < numOfRows; ++r) {
+          rows[r][c].bytes = reader.bytes(fields[c].bytes);
+          if (rows[r][c].null) {
+            EXPECT_EQ(rows[r][c].bytes, std::string(fields[c].bytes, '\0'));
+          }
+        }
+      } else {
+        std::vector<int32_t> offsets;
+        for (int64_t r = 0; r <= numOfRows; ++r) offsets.push_back((int32_t)reader.uint(4));
+        reader.pad();
+        EXPECT_EQ(offsets[0], 0);
+
+        std::string data = reader.bytes(offsets[numOfRows]);
+        for (int64_t r = 0; r < numOfRows; ++r) {
+          EXPECT_LE(offsets[r], offsets[r + 1]);
+          rows[r][c].bytes = data.substr(offsets[r], offsets[r + 1] - offsets[r]);
+          if (rows[r][c].null) {
+            EXPECT_EQ(rows[r][c].bytes, "");
+          }
+        }
+      }
+      reader.pad();
+    }
+
+    return rows;
+  }
+
+  HttpContext   context;
+  HttpParser    parser;
+  HttpSqlCmd    cmd;
+  SFakeResult   result;
+  SHttpTestConn conn;
+};
+
+}  // namespace
+
+// A result of fixed length and binary columns with nulls, over two fetches of which the second takes more than one
+// json buffer, decodes to the rows of the result
+TEST_F(RestBinTest, resultSet) {
+  result.fields = {field("ts", TSDB_DATA_TYPE_TIMESTAMP, 8), field("v", TSDB_DATA_TYPE_INT, 4),
+                   field("name", TSDB_DATA_TYPE_BINARY, 24), field("f", TSDB_DATA_TYPE_DOUBLE, 8)};
+
+  SRows first = {{fixedCell<int64_t>(1000), fixedCell<int32_t>(0x01020304), binCell("abc"), fixedCell(0.5)},
+                 {fixedCell<int64_t>(2000), nullCell(), nullCell(), fixedCell(-1.25)},
+                 {fixedCell<int64_t>(3000), fixedCell<int32_t>(-1), binCell(""), nullCell()}};
+  SRows second;
+  for (int32_t i = 0; i < 2000; ++i) {
+    std::string name = "row-" + std::to_string(i) + std::string(i % 13, 'x');
+    second.push_back({fixedCell<int64_t>(4000 + i), i % 3 == 0 ? nullCell() : fixedCell<int32_t>(i),
+                      i % 5 == 0 ? nullCell() : binCell(name), fixedCell((double)i / 4)});
+  }
+  result.rows = first;
+  result.rows.insert(result.rows.end(), second.begin(), second.end());
+
+  restStartSqlBin(&context, &cmd, &result);
+  ASSERT_TRUE(restBuildSqlBin(&context, &cmd, &result, (int32_t)first.size()));
+  ASSERT_TRUE(restBuildSqlBin(&context, &cmd, &result, (int32_t)second.size()));
+  ASSERT_TRUE(restBuildSqlBin(&context, &cmd, &result, 10));
+  restStopSqlBin(&context, &cmd);
+  EXPECT_EQ(cmd.numOfRows, (int32_t)(first.size() + second.size()));
+
+  std::string body = this->body();
+  EXPECT_GT(body.size(), (size_t)JSON_BUFFER_SIZE);
+  SBinReader reader(body);
+
+  // the int is written low byte first
+  size_t at = body.find(std::string("\x04\x03\x02\x01", 4));
+  EXPECT_NE(at, std::string::npos);
+  EXPECT_EQ(at % 4, 0u);
+
+  readHeader(reader, result.fields);
+  EXPECT_EQ(readBlock(reader, result.fields), first);
+  EXPECT_EQ(readBlock(reader, result.fields), second);
+
+  // the fetch that found no rows wrote no block
+  EXPECT_TRUE(reader.aligned());
+  EXPECT_EQ(reader.uint(8), 0u);
+  EXPECT_EQ(reader.uint(8), first.size() + second.size());
+  EXPECT_EQ(reader.left(), 0u);
+}
+
+// A statement without a result set answers with the affected rows as a one row int column
+TEST_F(RestBinTest, affectedRows) {
+  restStartSqlBin(&context, &cmd, &result);
+  restBuildSqlAffectRowsBin(&context, &cmd, 7);
+  restStopSqlBin(&context, &cmd);
+
+  std::vector<TAOS_FIELD> fields = {field(REST_JSON_AFFECT_ROWS, TSDB_DATA_TYPE_INT, 4)};
+  SBinReader              reader(body());
+
+  readHeader(reader, fields);
+  SRows rows = readBlock(reader, fields);
+  ASSERT_EQ(rows.size(), 1u);
+  EXPECT_EQ(rows[0][0], fixedCell<int32_t>(7));
+
+  EXPECT_EQ(reader.uint(8), 0u);
+  EXPECT_EQ(reader.uint(8), 1u);
+  EXPECT_EQ(reader.left(), 0u);
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "taoserror.h"
+
+// the http headers declare no C linkage of their own
+extern "C" {
+#include "httpInt.h"
+#include "httpSql.h"
+#include "httpTgJson.h"
+
+bool tgProcessQueryRequest(HttpContext *pContext, char *db);
+}
+
+namespace {
+
+const char *tgInsertPrefix = "import into";
+
+// A telegraf request as the handler gets it, with no connection to answer to
+class TgBatchTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    memset(&context, 0, sizeof(context));
+    memset(&parser, 0, sizeof(parser));
+    context.fd = -1;
+    context.parser = &parser;
+  }
+
+  void TearDown() override {
+    httpFreeMultiCmds(&context);
+    httpFreeJsonBuf(&context);
+  }
+
+  bool process(const std::string &body) {
+    request = body;
+    parser.body.str = &request[0];
+    parser.body.pos = (int32_t)request.size();
+
+    char db[] = "db";
+    return tgProcessQueryRequest(&context, db);
+  }
+
+  HttpSqlCmds *cmds() { return context.multiCmds; }
+  std::string  sql(HttpSqlCmd *cmd) { return httpGetCmdsString(&context, cmd->sql); }
+
+  // the response written so far, after the head of the metrics array
+  std::string response() {
+    JsonBuf *buf = context.jsonBuf;
+    return std::string(buf->buf, buf->lst - buf->buf);
+  }
+
+  HttpContext context;
+  HttpParser  parser;
+  std::string request;
+};
+
+std::string metric(const char *name, const char *host, int64_t ts, double value) {
+  return std::string("{\"fields\":{\"value\":") + std::to_string(value) + "},\"name\":\"" + name +
+         "\",\"tags\":{\"host\":\"" + host + "\"},\"timestamp\":" + std::to_string(ts) + "}";
+}
+
+// two tables of the super table cpu and one of mem
+std::string threeMetrics() {
+  return "{\"metrics\":[" + metric("cpu", "h1", 1000, 1) + "," + metric("cpu", "h2", 1000, 2) + "," +
+         metric("mem", "h1", 1000, 3) + "]}";
+}
+
+int countOf(const std::string &s, const std::string &sub) {
+  int n = 0;
+  for (size_t pos = s.find(sub); pos != std::string::npos; pos = s.find(sub, pos + sub.size())) n++;
+  return n;
+}
+
+}  // namespace
+
+// The inserts of the metrics of a request are merged into one import, run first
+TEST_F(TgBatchTest, merge) {
+  ASSERT_TRUE(process(threeMetrics()));
+
+  // create database, then create stable and insert per metric, then the batch
+  ASSERT_EQ(cmds()->size, 8);
+  EXPECT_EQ(cmds()->pos, 7);
+
+  HttpSqlCmd *batch = cmds()->cmds + 7;
+  EXPECT_EQ(batch->cmdType, HTTP_CMD_TYPE_INSERT_BATCH);
+  EXPECT_EQ(batch->cmdReturnType, HTTP_CMD_RETURN_TYPE_NO_RETURN);
+
+  std::string expect = tgInsertPrefix;
+  for (int i = 2; i < 8; i += 2) {
+    ASSERT_EQ(cmds()->cmds[i].cmdType, HTTP_CMD_TYPE_INSERT);
+    std::string insert = sql(cmds()->cmds + i);
+    ASSERT_EQ(insert.compare(0, strlen(tgInsertPrefix), tgInsertPrefix), 0);
+    expect += insert.substr(strlen(tgInsertPrefix));
+  }
+  EXPECT_EQ(sql(batch), expect);
+}
+
+// A single metric has nothing to merge
+TEST_F(TgBatchTest, single) {
+  ASSERT_TRUE(process("{\"metrics\":[" + metric("cpu", "h1", 1000, 1) + "]}"));
+  ASSERT_EQ(cmds()->size, 3);
+  EXPECT_EQ(cmds()->pos, 2);
+  EXPECT_EQ(cmds()->cmds[2].cmdType, HTTP_CMD_TYPE_INSERT);
+}
+
+// A batch that wrote the row of every metric reports each of them as imported
+TEST_F(TgBatchTest, succeed) {
+  ASSERT_TRUE(process(threeMetrics()));
+  tgInitQueryJson(&context);
+  size_t head = response().size();
+
+  HttpSqlCmd *batch = cmds()->cmds + cmds()->pos;
+  batch->numOfRows = 3;
+  tgSetNextCmd(&context, batch, TSDB_CODE_SUCCESS);
+
+  EXPECT_EQ(cmds()->pos, cmds()->size);
+  std::string resp = response().substr(head);
+  EXPECT_EQ(countOf(resp, "\"affected_rows\":1,\"status\":\"succ\"}"), 3) << resp;
+  EXPECT_EQ(countOf(resp, "\"table\":\"cpu_h2\""), 1) << resp;
+  EXPECT_EQ(countOf(resp, "\"table\":\"mem_h1\""), 1) << resp;
+}
+
+// A batch that affected fewer rows than it has metrics is replayed one by one from the first insert, with nothing
+// reported for it
+TEST_F(TgBatchTest, partial) {
+  ASSERT_TRUE(process(threeMetrics()));
+  tgInitQueryJson(&context);
+  size_t head = response().size();
+
+  HttpSqlCmd *batch = cmds()->cmds + cmds()->pos;
+  batch->numOfRows = 2;
+  tgSetNextCmd(&context, batch, TSDB_CODE_SUCCESS);
+
+  EXPECT_EQ(cmds()->size, 7);
+  EXPECT_EQ(cmds()->pos, 2);
+  EXPECT_EQ(response().size(), head);
+}
+
+// A failed batch is dropped and the caller moves on to the first insert, which creates the database or the super
+// table on demand
+TEST_F(TgBatchTest, fail) {
+  ASSERT_TRUE(process(threeMetrics()));
+
+  HttpSqlCmd *batch = cmds()->cmds + cmds()->pos;
+  EXPECT_FALSE(tgCheckFinished(&context, batch, TSDB_CODE_MND_INVALID_TABLE_NAME));
+  EXPECT_EQ(batch->cmdState, HTTP_CMD_STATE_RUN_FINISHED);
+  EXPECT_EQ(cmds()->size, 7);
+  EXPECT_EQ(cmds()->pos + 1, 2);
+
+  // the first insert then fails on the missing super table, and goes back to create it
+  cmds()->pos = 2;
+  EXPECT_FALSE(tgCheckFinished(&context, cmds()->cmds + 2, TSDB_CODE_MND_INVALID_TABLE_NAME));
+  EXPECT_EQ(cmds()->pos + 1, 1);
+  EXPECT_EQ(cmds()->cmds[1].cmdType, HTTP_CMD_TYPE_CREATE_STBALE);
+}
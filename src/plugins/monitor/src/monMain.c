@@ -19,6 +19,7 @@
 #include "taoserror.h"
 #include "tfs.h"
 #include "tlog.h"
+#include "tmetrics.h"
 #include "ttimer.h"
 #include "tutil.h"
 #include "tsclient.h"
@@ -130,6 +131,7 @@ typedef enum {
   MON_CMD_CREATE_TB_GRANTS,
   MON_CMD_CREATE_MT_RESTFUL,
   MON_CMD_CREATE_TB_RESTFUL,
+  MON_CMD_CREATE_MT_METRICS,
   MON_CMD_MAX
 } EMonCmd;
 
@@ -174,6 +176,7 @@ static void  monSaveVgroupsInfo();
 static void  monSaveDisksInfo();
 static void  monSaveGrantsInfo();
 static void  monSaveHttpReqInfo();
+static void  monSaveMetricsInfo();
 static void  monGetSysStats();
 static void *monThreadFunc(void *param);
 static void  monBuildMonitorSql(char *sql, int32_t cmd);
@@ -323,6 +326,7 @@ static void *monThreadFunc(void *param) {
         monSaveDisksInfo();
         monSaveGrantsInfo();
         monSaveHttpReqInfo();
+        monSaveMetricsInfo();
         monSaveSystemInfo();
       }
     }
@@ -475,6 +479,12 @@ static void monBuildMonitorSql(char *sql, int32_t cmd) {
   } else if (cmd == MON_CMD_CREATE_TB_RESTFUL) {
     snprintf(sql, SQL_LENGTH, "create table if not exists %s.restful_%d using %s.restful_info tags(%d, '%s')", tsMonitorDbName,
              dnodeGetDnodeId(), tsMonitorDbName, dnodeGetDnodeId(), tsLocalEp);
+  } else if (cmd == MON_CMD_CREATE_MT_METRICS) {
+    snprintf(sql, SQL_LENGTH,
+             "create table if not exists %s.metrics_info(ts timestamp"
+             ", val bigint, sum_val bigint, p50 bigint, p90 bigint, p99 bigint, p999 bigint, max_val bigint"
+             ") tags (dnode_id int, dnode_ep binary(%d), name binary(%d))",
+             tsMonitorDbName, TSDB_EP_LEN, TSDB_METRIC_NAME_LEN);
   }
 
   sql[SQL_LENGTH] = 0;
@@ -1310,6 +1320,45 @@ static void monSaveHttpReqInfo() {
   }
 }
 
+static void monSaveMetricsInfo() {
+  int64_t         ts = taosGetTimestampUs();
+  char *          sql = tsMonitor.sql;
+  SMetricSnapshot snaps[TSDB_METRIC_MAX_NUM];
+  int32_t         num = taosMetricsGetSnapshots(snaps, TSDB_METRIC_MAX_NUM);
+  int32_t         pos = 0;
+
+  // one table for each metric of the dnode, several metrics are saved by one insert while the sql is not full
+  for (int32_t i = 0; i < num; ++i) {
+    SMetricSnapshot *pSnap = &snaps[i];
+    if (pos == 0) {
+      pos = snprintf(sql, SQL_LENGTH, "insert into");
+    }
+
+    pos += snprintf(sql + pos, SQL_LENGTH - pos,
+                    " %s.metrics_%d_%s using %s.metrics_info tags(%d, '%s', '%s') values(%" PRId64 ", %" PRId64
+                    ", %" PRId64 ", %" PRId64 ", %" PRId64 ", %" PRId64 ", %" PRId64 ", %" PRId64 ")",
+                    tsMonitorDbName, dnodeGetDnodeId(), pSnap->name, tsMonitorDbName, dnodeGetDnodeId(), tsLocalEp,
+                    pSnap->name, ts, pSnap->value, pSnap->sum, pSnap->p50, pSnap->p90, pSnap->p99, pSnap->p999,
+                    pSnap->max);
+
+    if (i < num - 1 && pos < SQL_LENGTH - TSDB_METRIC_TEXT_LEN) continue;
+
+    monDebug("save metrics, sql:%s", sql);
+    pos = 0;
+
+    void *  res = taos_query(tsMonitor.conn, tsMonitor.sql);
+    int32_t code = taos_errno(res);
+    taos_free_result(res);
+
+    if (code != 0) {
+      monError("failed to save metrics info, reason:%s, sql:%s", tstrerror(code), tsMonitor.sql);
+    } else {
+      monIncSubmitReqCnt();
+      monDebug("successfully to save metrics info, sql:%s", tsMonitor.sql);
+    }
+  }
+}
+
 static void monExecSqlCb(void *param, TAOS_RES *result, int32_t code) {
   int32_t c = taos_errno(result);
   if (c != TSDB_CODE_SUCCESS) {
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_QAGGKERNEL_H
+#define TDENGINE_QAGGKERNEL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+/*
+ * Aggregate kernels over the values of a numeric column in a data block. The kernels of a type are chosen once for a
+ * block, the ones checking the NULL values only if the block may have any.
+ */
+typedef struct SAggKernelRes {
+  int32_t numOfElems;  // the not NULL values
+  int32_t minIndex;    // the last minimum and the first maximum, as the row by row comparisons of min/max pick
+  int32_t maxIndex;    // them, set only if the positions are asked for, -1 if all the values are NaN
+  union {
+    int64_t  isum;
+    uint64_t usum;
+    double   dsum;  // float and double
+  };
+  union {
+    int64_t  imin;
+    uint64_t umin;
+    double   dmin;
+  };
+  union {
+    int64_t  imax;
+    uint64_t umax;
+    double   dmax;
+  };
+} SAggKernelRes;
+
+typedef struct SAggKernel {
+  int32_t (*count)(const void *pData, int32_t numOfRows);
+  void    (*sum)(const void *pData, int32_t numOfRows, SAggKernelRes *pRes);
+  void    (*minMax)(const void *pData, int32_t numOfRows, bool withIndex, SAggKernelRes *pRes);
+} SAggKernel;
+
+/**
+ * @return the kernels of the column type, NULL if the type is not numeric
+ */
+const SAggKernel *getAggKernel(int32_t type, bool hasNull);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_QAGGKERNEL_H
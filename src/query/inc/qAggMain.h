@@ -135,12 +135,13 @@ enum {
 #define QUERY_IS_FREE_RESOURCE(type)     (((type)&TSDB_QUERY_TYPE_FREE_RESOURCE) != 0)
 
 typedef struct SScalarExprSupport {
-  SExprInfo   *pExprInfo;
-  int32_t      numOfCols;
-  SColumnInfo *colList;
-  void        *exprList;   // client side used
-  int32_t      offset;
-  char**       data;
+  SExprInfo    *pExprInfo;
+  int32_t       numOfCols;
+  SColumnInfo  *colList;
+  void         *exprList;   // client side used
+  int32_t       offset;
+  char**        data;
+  SExprProgram *pProg;      // the compiled pExprInfo->pExpr, NULL to traverse the tree
 } SScalarExprSupport;
 
 typedef struct SQLPreAggVal {
@@ -165,12 +165,15 @@ typedef struct {
     uint8_t operatorType; //for operator event
     int32_t abortCode; //for query abort event
   };
+  int64_t rows; //rows generated by the operator, for after operator exec event
 } SQueryProfEvent;
 
 typedef struct {
   uint8_t operatorType;
   int64_t sumSelfTime;
   int64_t sumRunTimes;
+  int64_t sumInputRows;
+  int64_t sumOutputRows;
 } SOperatorProfResult;
 
 typedef struct SQueryCostInfo {
@@ -412,6 +415,7 @@ typedef struct SQInfo {
   int64_t          startExecTs; // start to exec timestamp
   int64_t          lastRetrieveTs; // last retrieve timestamp  
   char*            sql;         // query sql string
+  int8_t           profile;     // return the execution profile to client when the query is completed
   SQueryCostInfo   summary;
 } SQInfo;
 
@@ -436,6 +440,7 @@ typedef struct SQueryParam {
   SUdfInfo        *pUdfInfo;
   int16_t         schemaVersion;
   int16_t         tagVersion;
+  int8_t          queryProfile;
 } SQueryParam;
 
 typedef struct SColumnDataParam{
@@ -682,6 +687,7 @@ void copyTsColoum(SSDataBlock* pRes, SQLFunctionCtx* pCtx, int32_t numOfOutput);
 
 void freeParam(SQueryParam *param);
 int32_t convertQueryMsg(SQueryTableMsg *pQueryMsg, SQueryParam* param);
+char   *decodeQueryMsgTlv(char *pMsg, SQueryParam *param);
 int32_t createQueryFunc(SQueriedTableInfo* pTableInfo, int32_t numOfOutput, SExprInfo** pExprInfo,
                         SSqlExpr** pExprMsg, SColumnInfo* pTagCols, int32_t queryType, void* pMsg, SUdfInfo* pUdfInfo);
 
@@ -722,9 +728,13 @@ size_t getResultSize(SQInfo *pQInfo, int64_t *numOfRows);
 void setQueryKilled(SQInfo *pQInfo);
 
 void publishOperatorProfEvent(SOperatorInfo* operatorInfo, EQueryProfEventType eventType);
+void publishOperatorProfEndEvent(SOperatorInfo* operatorInfo, SSDataBlock* pBlock);
 void publishQueryAbortEvent(SQInfo* pQInfo, int32_t code);
 void calculateOperatorProfResults(SQInfo* pQInfo);
 void queryCostStatis(SQInfo *pQInfo);
+void buildQueryProfileMsg(SQInfo *pQInfo, SQueryProfileMsg *pMsg);
+void doAppendQueryProfile(SQInfo *pQInfo, SRetrieveTableRsp **pRsp, int32_t *contLen);
+const char* getOperatorTypeName(uint8_t operatorType);
 
 void freeQInfo(SQInfo *pQInfo);
 void freeQueryAttr(SQueryAttr *pQuery);
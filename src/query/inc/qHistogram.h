@@ -59,6 +59,7 @@ SHistogramInfo* tHistogramCreate(int32_t numOfBins);
 SHistogramInfo* tHistogramCreateFrom(void* pBuf, int32_t numOfBins);
 
 int32_t tHistogramAdd(SHistogramInfo** pHisto, double val);
+int32_t tHistogramAddN(SHistogramInfo** pHisto, double val, int64_t num);  // num copies of val, in one bin
 int64_t tHistogramSum(SHistogramInfo* pHisto, double v);
 
 double* tHistogramUniform(SHistogramInfo* pHisto, double* ratio, int32_t num);
@@ -138,6 +138,15 @@ int32_t dumpFileBlockByGroupId(STSBuf* pTSBuf, int32_t id, void* buf, int32_t* l
 
 STSElem tsBufFindElemStartPosByTag(STSBuf* pTSBuf, tVariant* pTag);
 
+/**
+ * collect the tag values of all comp blocks that belong to the group of given id, the traverse cursor is reset
+ * @param pTSBuf
+ * @param id       group id
+ * @param pTagList SArray<tVariant>, tag values are appended as copies, which should be destroyed by caller
+ * @return
+ */
+int32_t tsBufGetGroupTagList(STSBuf* pTSBuf, int32_t id, SArray* pTagList);
+
 bool tsBufIsValidElem(STSElem* pElem);
 
 #ifdef __cplusplus
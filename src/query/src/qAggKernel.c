@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "os.h"
+#include "taosdef.h"
+#include "qAggKernel.h"
+
+/*
+ * The values are reduced into AGG_LANES independent accumulators without branches, a NULL value is masked out
+ * instead of skipped, so that the compiler turns the loops into vector instructions of the target. The lanes are
+ * reduced horizontally at the end of the block.
+ */
+#define AGG_LANES 32
+
+// test the NULL value with one typed load, reading a value as both _t and _bits defeats the vectorizer. The NULL of
+// float and double is a NaN, so the loops over the typed values skip every NaN. A NaN which is not the NULL can be
+// written by the clients though: it never wins a comparison of min/max, as in the row by row loop, and the sum
+// counts the NaN values apart from the NULL ones to turn into NaN as the row by row sum does. The value of a NULL
+// summed is masked to 0 with the bits of an integer, since the compilers turn a select into a branch.
+#define AGG_INT_IS_NULL(_v, _bits, _nullv)     ((_bits)(_v) == (_bits)(_nullv))
+#define AGG_FLT_IS_NULL(_v, _bits, _nullv)     ((_v) != (_v))
+#define AGG_INT_IS_NAN(_v)                     0
+#define AGG_FLT_IS_NAN(_v)                     ((_v) != (_v))
+#define AGG_INT_SUMMAND(_v, _st, _bits, _nullv) ((_st)(_v) & -(_st)!AGG_INT_IS_NULL(_v, _bits, _nullv))
+#define AGG_FLT_SUMMAND(_v, _st, _bits, _nullv) (AGG_FLT_IS_NULL(_v, _bits, _nullv) ? (_st)0 : (_st)(_v))
+
+static int32_t countAll(const void *pData, int32_t numOfRows) {
+  return numOfRows;
+}
+
+#define DEFINE_AGG_KERNELS(_n, _t, _bits, _nullv, _st, _r, _tmax, _tmin, _k)                                 \
+  static int32_t countNull_##_n(const void *pData, int32_t numOfRows) {                                      \
+    const _bits *b = (const _bits *)pData;                                                                   \
+    int32_t      cnt[AGG_LANES] = {0};                                                                       \
+    int32_t      i = 0;                                                                                      \
+    for (; i + AGG_LANES <= numOfRows; i += AGG_LANES) {                                                     \
+      for (int32_t j = 0; j < AGG_LANES; ++j) cnt[j] += (b[i + j] != (_bits)(_nullv));                       \
+    }                                                                                                        \
+    int32_t num = 0;                                                                                         \
+    for (; i < numOfRows; ++i) num += (b[i] != (_bits)(_nullv));                                             \
+    for (int32_t j = 0; j < AGG_LANES; ++j) num += cnt[j];                                                   \
+    return num;                                                                                              \
+  }                                                                                                          \
+                                                                                                             \
+  static void sum_##_n(const void *pData, int32_t numOfRows, SAggKernelRes *pRes) {                          \
+    const _t *d = (const _t *)pData;                                                                         \
+    _st       acc[AGG_LANES] = {0};                                                                          \
+    int32_t   i = 0;                                                                                         \
+    for (; i + AGG_LANES <= numOfRows; i += AGG_LANES) {                                                     \
+      for (int32_t j = 0; j < AGG_LANES; ++j) acc[j] += (_st)d[i + j];                                       \
+    }                                                                                                        \
+    _st sum = 0;                                                                                             \
+    for (; i < numOfRows; ++i) sum += (_st)d[i];                                                             \
+    for (int32_t j = 0; j < AGG_LANES; ++j) sum += acc[j];                                                   \
+    pRes->numOfElems = numOfRows;                                                                            \
+    pRes->_r##sum = sum;                                                                                     \
+  }                                                                                                          \
+                                                                                                             \
+  static void sumNull_##_n(const void *pData, int32_t numOfRows, SAggKernelRes *pRes) {                      \
+    const _t *d = (const _t *)pData;                                                                         \
+    _st       acc[AGG_LANES] = {0};                                                                          \
+    int32_t   nan[AGG_LANES] = {0};                                                                          \
+    int32_t   i = 0;                                                                                         \
+    for (; i + AGG_LANES <= numOfRows; i += AGG_LANES) {                                                     \
+      for (int32_t j = 0; j < AGG_LANES; ++j) {                                                              \
+        acc[j] += AGG_##_k##_SUMMAND(d[i + j], _st, _bits, _nullv);                                          \
+        nan[j] += AGG_##_k##_IS_NAN(d[i + j]);                                                               \
+      }                                                                                                      \
+    }                                                                                                        \
+    _st     sum = 0;                                                                                         \
+    int32_t numOfNan = 0;                                                                                    \
+    for (; i < numOfRows; ++i) {                                                                             \
+      if (!AGG_##_k##_IS_NULL(d[i], _bits, _nullv)) sum += (_st)d[i];                                        \
+      numOfNan += AGG_##_k##_IS_NAN(d[i]);                                                                   \
+    }                                                                                                        \
+    for (int32_t j = 0; j < AGG_LANES; ++j) {                                                                \
+      sum += acc[j];                                                                                         \
+      numOfNan += nan[j];                                                                                    \
+    }                                                                                                        \
+    pRes->numOfElems = countNull_##_n(pData, numOfRows);                                                     \
+    pRes->_r##sum = (numOfNan > numOfRows - pRes->numOfElems) ? (_st)NAN : sum;                              \
+  }                                                                                                          \
+                                                                                                             \
+  static void minMaxImpl_##_n(const void *pData, int32_t numOfRows, bool hasNull, bool withIndex,            \
+                              SAggKernelRes *pRes) {                                                         \
+    const _t *d = (const _t *)pData;                                                                         \
+    _t        mn[AGG_LANES], mx[AGG_LANES];                                                                  \
+    int32_t   i = 0;                                                                                         \
+    for (int32_t j = 0; j < AGG_LANES; ++j) {                                                                \
+      mn[j] = (_tmax);                                                                                       \
+      mx[j] = (_tmin);                                                                                       \
+    }                                                                                                        \
+    for (; i + AGG_LANES <= numOfRows; i += AGG_LANES) {                                                     \
+      for (int32_t j = 0; j < AGG_LANES; ++j) {                                                              \
+        bool notNull = !hasNull || !AGG_##_k##_IS_NULL(d[i + j], _bits, _nullv);                             \
+        _t   vmin = notNull ? d[i + j] : (_tmax);                                                            \
+        _t   vmax = notNull ? d[i + j] : (_tmin);                                                            \
+        mn[j] = vmin < mn[j] ? vmin : mn[j];                                                                 \
+        mx[j] = vmax > mx[j] ? vmax : mx[j];                                                                 \
+      }                                                                                                      \
+    }                                                                                                        \
+    for (; i < numOfRows; ++i) {                                                                             \
+      if (hasNull && AGG_##_k##_IS_NULL(d[i], _bits, _nullv)) continue;                                      \
+      mn[0] = d[i] < mn[0] ? d[i] : mn[0];                                                                   \
+      mx[0] = d[i] > mx[0] ? d[i] : mx[0];                                                                   \
+    }                                                                                                        \
+    for (int32_t j = 1; j < AGG_LANES; ++j) {                                                                \
+      mn[0] = mn[j] < mn[0] ? mn[j] : mn[0];                                                                 \
+      mx[0] = mx[j] > mx[0] ? mx[j] : mx[0];                                                                 \
+    }                                                                                                        \
+    pRes->numOfElems = hasNull ? countNull_##_n(pData, numOfRows) : numOfRows;                               \
+    pRes->_r##min = mn[0];                                                                                   \
+    pRes->_r##max = mx[0];                                                                                   \
+    pRes->minIndex = -1;                                                                                     \
+    pRes->maxIndex = -1;                                                                                     \
+    if (!withIndex || pRes->numOfElems == 0) return;                                                         \
+    /* a NULL or a NaN equals no value, and none is found if all the values are NaN */                       \
+    for (i = numOfRows - 1; i >= 0 && pRes->minIndex < 0; --i) {                                             \
+      if (d[i] == mn[0]) pRes->minIndex = i;                                                                 \
+    }                                                                                                        \
+    for (i = 0; i < numOfRows && pRes->maxIndex < 0; ++i) {                                                  \
+      if (d[i] == mx[0]) pRes->maxIndex = i;                                                                 \
+    }                                                                                                        \
+  }                                                                                                          \
+                                                                                                             \
+  static void minMax_##_n(const void *pData, int32_t numOfRows, bool withIndex, SAggKernelRes *pRes) {       \
+    minMaxImpl_##_n(pData, numOfRows, false, withIndex, pRes);                                               \
+  }                                                                                                          \
+                                                                                                             \
+  static void minMaxNull_##_n(const void *pData, int32_t numOfRows, bool withIndex, SAggKernelRes *pRes) {   \
+    minMaxImpl_##_n(pData, numOfRows, true, withIndex, pRes);                                                \
+  }                                                                                                          \
+                                                                                                             \
+  static const SAggKernel aggKernels_##_n[2] = {{countAll, sum_##_n, minMax_##_n},                           \
+                                                {countNull_##_n, sumNull_##_n, minMaxNull_##_n}};
+
+DEFINE_AGG_KERNELS(tinyint, int8_t, uint8_t, TSDB_DATA_TINYINT_NULL, int64_t, i, INT8_MAX, INT8_MIN, INT)
+DEFINE_AGG_KERNELS(smallint, int16_t, uint16_t, TSDB_DATA_SMALLINT_NULL, int64_t, i, INT16_MAX, INT16_MIN, INT)
+DEFINE_AGG_KERNELS(int, int32_t, uint32_t, TSDB_DATA_INT_NULL, int64_t, i, INT32_MAX, INT32_MIN, INT)
+DEFINE_AGG_KERNELS(bigint, int64_t, uint64_t, TSDB_DATA_BIGINT_NULL, int64_t, i, INT64_MAX, INT64_MIN, INT)
+DEFINE_AGG_KERNELS(utinyint, uint8_t, uint8_t, TSDB_DATA_UTINYINT_NULL, uint64_t, u, UINT8_MAX, 0, INT)
+DEFINE_AGG_KERNELS(usmallint, uint16_t, uint16_t, TSDB_DATA_USMALLINT_NULL, uint64_t, u, UINT16_MAX, 0, INT)
+DEFINE_AGG_KERNELS(uint, uint32_t, uint32_t, TSDB_DATA_UINT_NULL, uint64_t, u, UINT32_MAX, 0, INT)
+DEFINE_AGG_KERNELS(ubigint, uint64_t, uint64_t, TSDB_DATA_UBIGINT_NULL, uint64_t, u, UINT64_MAX, 0, INT)
+// the infinities are values too, so the lanes of float and double start at them
+DEFINE_AGG_KERNELS(float, float, uint32_t, TSDB_DATA_FLOAT_NULL, double, d, INFINITY, -INFINITY, FLT)
+DEFINE_AGG_KERNELS(double, double, uint64_t, TSDB_DATA_DOUBLE_NULL, double, d, INFINITY, -INFINITY, FLT)
+
+const SAggKernel *getAggKernel(int32_t type, bool hasNull) {
+  int32_t k = hasNull ? 1 : 0;
+
+  switch (type) {
+    case TSDB_DATA_TYPE_TINYINT:   return &aggKernels_tinyint[k];
+    case TSDB_DATA_TYPE_SMALLINT:  return &aggKernels_smallint[k];
+    case TSDB_DATA_TYPE_INT:       return &aggKernels_int[k];
+    case TSDB_DATA_TYPE_BIGINT:
+    case TSDB_DATA_TYPE_TIMESTAMP: return &aggKernels_bigint[k];
+    case TSDB_DATA_TYPE_UTINYINT:  return &aggKernels_utinyint[k];
+    case TSDB_DATA_TYPE_USMALLINT: return &aggKernels_usmallint[k];
+    case TSDB_DATA_TYPE_UINT:      return &aggKernels_uint[k];
+    case TSDB_DATA_TYPE_UBIGINT:   return &aggKernels_ubigint[k];
+    case TSDB_DATA_TYPE_FLOAT:     return &aggKernels_float[k];
+    case TSDB_DATA_TYPE_DOUBLE:    return &aggKernels_double[k];
+    default:                       return NULL;
+  }
+}
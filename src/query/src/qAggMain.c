@@ -22,6 +22,7 @@
 #include "tsdb.h"
 
 #include "qAggMain.h"
+#include "qAggKernel.h"
 #include "qFill.h"
 #include "qHistogram.h"
 #include "qPercentile.h"
@@ -127,9 +128,6 @@ typedef struct SFirstLastInfo {
 typedef struct SFirstLastInfo SLastrowInfo;
 typedef struct SPercentileInfo {
   tMemBucket *pMemBucket;
-  int32_t     stage;
-  double      minval;
-  double      maxval;
   int64_t     numOfElems;
 } SPercentileInfo;
 
@@ -365,8 +363,56 @@ static uint8_t hllCountNum(void *ele, int32_t elesize, int32_t *buk) {
   return count;
 }
 
+/*
+ * Summarize current block by its statistics. Return 0 if all values are null. If all not null values are identical,
+ * the value is copied into buf in the input type and the number of not null values is returned. Otherwise, or if the
+ * statistics are not available, return -1 and the raw data has to be scanned.
+ */
+static int32_t getIdenticalBlockValue(SQLFunctionCtx *pCtx, char *buf) {
+  if (!pCtx->preAggVals.isSet || !IS_NUMERIC_TYPE(pCtx->inputType)) {
+    return -1;
+  }
+
+  SDataStatis *pStatis = &pCtx->preAggVals.statis;
+
+  int32_t notNullElems = pCtx->size - pStatis->numOfNull;
+  if (notNullElems <= 0) {
+    return 0;
+  }
+
+  if (pStatis->min != pStatis->max) {
+    return -1;
+  }
+
+  if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+    SET_TYPED_DATA(buf, pCtx->inputType, pStatis->min);
+  } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+    SET_TYPED_DATA(buf, pCtx->inputType, (uint64_t)pStatis->min);
+  } else {
+    SET_TYPED_DATA(buf, pCtx->inputType, GET_DOUBLE_VAL(&pStatis->min));
+  }
+
+  return notNullElems;
+}
+
 static void hll_function(SQLFunctionCtx *pCtx) {
   SHLLInfo *pHLLInfo = getOutputInfo(pCtx);
+
+  char    buf[sizeof(int64_t)] = {0};
+  int32_t numOfElems = getIdenticalBlockValue(pCtx, buf);
+  if (numOfElems >= 0) {
+    if (numOfElems > 0) {
+      int32_t index = 0;
+      uint8_t count = hllCountNum(buf, pCtx->inputBytes, &index);
+      if (count > pHLLInfo->buckets[index]) {
+        pHLLInfo->buckets[index] = count;
+      }
+    }
+
+    GET_RES_INFO(pCtx)->numOfRes = 1;
+    return;
+  }
+
   for (int32_t i = 0; i < pCtx->size; ++i) {
     char *val = GET_INPUT_DATA(pCtx, i);
     if (isNull(val, pCtx->inputType)) {
@@ -911,7 +957,10 @@ static void count_function(SQLFunctionCtx *pCtx) {
   if (pCtx->preAggVals.isSet) {
     numOfElem = pCtx->size - pCtx->preAggVals.statis.numOfNull;
   } else {
-    if (pCtx->hasNull) {
+    const SAggKernel *pKernel = getAggKernel(pCtx->inputType, true);
+    if (pCtx->hasNull && pKernel != NULL) {
+      numOfElem = (*pKernel->count)(GET_INPUT_DATA_LIST(pCtx), pCtx->size);
+    } else if (pCtx->hasNull) {
       for (int32_t i = 0; i < pCtx->size; ++i) {
         char *val = GET_INPUT_DATA(pCtx, i);
         if (isNull(val, pCtx->inputType)) {
@@ -963,41 +1012,6 @@ int32_t countRequired(SQLFunctionCtx *pCtx, STimeWindow* w, int32_t colId) {
 int32_t noDataRequired(SQLFunctionCtx *pCtx, STimeWindow* w, int32_t colId) {
   return BLK_DATA_NO_NEEDED;
 }
-#define LIST_ADD_N_DOUBLE_FLOAT(x, ctx, p, t, numOfElem, tsdbType)              \
-  do {                                                                \
-    t *d = (t *)(p);                                               \
-    for (int32_t i = 0; i < (ctx)->size; ++i) {                    \
-      if (((ctx)->hasNull) && isNull((char *)&(d)[i], tsdbType)) { \
-        continue;                                                  \
-      };                                                           \
-      SET_DOUBLE_VAL(&(x) , GET_DOUBLE_VAL(&(x)) + GET_FLOAT_VAL(&(d)[i]));                                               \
-      (numOfElem)++;                                               \
-    }                                                              \
-  } while(0)
-#define LIST_ADD_N_DOUBLE(x, ctx, p, t, numOfElem, tsdbType)              \
-  do {                                                                \
-    t *d = (t *)(p);                                               \
-    for (int32_t i = 0; i < (ctx)->size; ++i) {                    \
-      if (((ctx)->hasNull) && isNull((char *)&(d)[i], tsdbType)) { \
-        continue;                                                  \
-      };                                                           \
-      SET_DOUBLE_VAL(&(x) , (x) + (d)[i]);                                               \
-      (numOfElem)++;                                               \
-    }                                                              \
-  } while(0)
-
-#define LIST_ADD_N(x, ctx, p, t, numOfElem, tsdbType)              \
-  do {                                                                \
-    t *d = (t *)(p);                                               \
-    for (int32_t i = 0; i < (ctx)->size; ++i) {                    \
-      if (((ctx)->hasNull) && isNull((char *)&(d)[i], tsdbType)) { \
-        continue;                                                  \
-      };                                                           \
-      (x) += (d)[i];                                               \
-      (numOfElem)++;                                               \
-    }                                                              \
-  } while(0)
-
 #define UPDATE_DATA(ctx, left, right, num, sign, k) \
   do {                                              \
     if (((left) < (right)) ^ (sign)) {              \
@@ -1016,20 +1030,15 @@ int32_t noDataRequired(SQLFunctionCtx *pCtx, STimeWindow* w, int32_t colId) {
     }                                                       \
   } while (0)
 
-#define LOOPCHECK_N(val, list, ctx, tsdbType, sign, num)          \
-  for (int32_t i = 0; i < ((ctx)->size); ++i) {                   \
-    if ((ctx)->hasNull && isNull((char *)&(list)[i], tsdbType)) { \
-      continue;                                                   \
-    }                                                             \
-    TSKEY key = (ctx)->ptsList != NULL? GET_TS_DATA(ctx, i):0;    \
-    UPDATE_DATA(ctx, val, (list)[i], num, sign, key);             \
-  }
-
-#define TYPED_LOOPCHECK_N(type, data, list, ctx, tsdbType, sign, notNullElems) \
-  do {                                                                         \
-    type *_data = (type *)data;                                                \
-    type *_list = (type *)list;                                                \
-    LOOPCHECK_N(*_data, _list, ctx, tsdbType, sign, notNullElems);             \
+// the result of a block computed by the aggregate kernel replaces the output if it wins, as UPDATE_DATA does by row
+#define UPDATE_BY_KERNEL_RES(ctx, type, output, val, sign, ts) \
+  do {                                                         \
+    type *_output = (type *)(output);                          \
+    type  _val = (type)(val);                                  \
+    if ((*_output < _val) ^ (sign)) {                          \
+      *_output = _val;                                         \
+      DO_UPDATE_TAG_COLUMNS(ctx, ts);                          \
+    }                                                          \
   } while (0)
 
 static void do_sum(SQLFunctionCtx *pCtx) {
@@ -1051,39 +1060,21 @@ static void do_sum(SQLFunctionCtx *pCtx) {
       SET_DOUBLE_VAL(retVal, *retVal + GET_DOUBLE_VAL((const char*)&(pCtx->preAggVals.statis.sum)));
     }
   } else {  // computing based on the true data block
-    void *pData = GET_INPUT_DATA_LIST(pCtx);
-    notNullElems = 0;
+    const SAggKernel *pKernel = getAggKernel(pCtx->inputType, pCtx->hasNull);
+    SAggKernelRes     res = {0};
 
-    if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-      int64_t *retVal = (int64_t *)pCtx->pOutput;
+    if (pKernel != NULL) {
+      (*pKernel->sum)(GET_INPUT_DATA_LIST(pCtx), pCtx->size, &res);
+      notNullElems = res.numOfElems;
+    }
 
-      if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int8_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int16_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int32_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, int64_t, notNullElems, pCtx->inputType);
-      }
+    if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+      *(int64_t *)pCtx->pOutput += res.isum;
     } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-      uint64_t *retVal = (uint64_t *)pCtx->pOutput;
-
-      if (pCtx->inputType == TSDB_DATA_TYPE_UTINYINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint8_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_USMALLINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint16_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_UINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint32_t, notNullElems, pCtx->inputType);
-      } else if (pCtx->inputType == TSDB_DATA_TYPE_UBIGINT) {
-        LIST_ADD_N(*retVal, pCtx, pData, uint64_t, notNullElems, pCtx->inputType);
-      }
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE) {
-      double *retVal = (double *)pCtx->pOutput;
-      LIST_ADD_N_DOUBLE(*retVal, pCtx, pData, double, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
+      *(uint64_t *)pCtx->pOutput += res.usum;
+    } else if (IS_FLOAT_TYPE(pCtx->inputType)) {
       double *retVal = (double *)pCtx->pOutput;
-      LIST_ADD_N_DOUBLE_FLOAT(*retVal, pCtx, pData, float, notNullElems, pCtx->inputType);
+      SET_DOUBLE_VAL(retVal, *retVal + res.dsum);
     }
   }
 
@@ -1257,28 +1248,20 @@ static void avg_function(SQLFunctionCtx *pCtx) {
       *pVal += GET_DOUBLE_VAL((const char *)&(pCtx->preAggVals.statis.sum));
     }
   } else {
-    void *pData = GET_INPUT_DATA_LIST(pCtx);
+    const SAggKernel *pKernel = getAggKernel(pCtx->inputType, pCtx->hasNull);
+    SAggKernelRes     res = {0};
 
-    if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int8_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int16_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int32_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, int64_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE) {
-      LIST_ADD_N_DOUBLE(*pVal, pCtx, pData, double, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
-      LIST_ADD_N_DOUBLE_FLOAT(*pVal, pCtx, pData, float, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UTINYINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint8_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_USMALLINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint16_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint32_t, notNullElems, pCtx->inputType);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UBIGINT) {
-      LIST_ADD_N(*pVal, pCtx, pData, uint64_t, notNullElems, pCtx->inputType);
+    if (pKernel != NULL) {
+      (*pKernel->sum)(GET_INPUT_DATA_LIST(pCtx), pCtx->size, &res);
+      notNullElems = res.numOfElems;
+    }
+
+    if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+      *pVal += (double)res.isum;
+    } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+      *pVal += (double)res.usum;
+    } else if (IS_FLOAT_TYPE(pCtx->inputType)) {
+      *pVal += res.dsum;
     }
   }
 
@@ -1452,54 +1435,62 @@ static void minMax_function(SQLFunctionCtx *pCtx, char *pOutput, int32_t isMin,
     return;
   }
 
-  void  *p = GET_INPUT_DATA_LIST(pCtx);
-  TSKEY *tsList = GET_TS_LIST(pCtx);
+  const SAggKernel *pKernel = getAggKernel(pCtx->inputType, pCtx->hasNull);
+  SAggKernelRes     res = {0};
+  TSKEY *           tsList = GET_TS_LIST(pCtx);
 
   *notNullElems = 0;
+  if (pKernel == NULL || pCtx->inputType == TSDB_DATA_TYPE_TIMESTAMP) {
+    return;
+  }
 
-  if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-    if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-      TYPED_LOOPCHECK_N(int8_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-      TYPED_LOOPCHECK_N(int16_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-      int32_t *pData = p;
-      int32_t *retVal = (int32_t*) pOutput;
+  // the position of the result is only needed by the tag and ts columns selected with it
+  (*pKernel->minMax)(GET_INPUT_DATA_LIST(pCtx), pCtx->size, pCtx->tagInfo.numOfTagCols > 0, &res);
+  *notNullElems = res.numOfElems;
+  if (res.numOfElems == 0) {
+    return;
+  }
 
-      for (int32_t i = 0; i < pCtx->size; ++i) {
-        if (pCtx->hasNull && isNull((const char*)&pData[i], pCtx->inputType)) {
-          continue;
-        }
+  int32_t index = isMin ? res.minIndex : res.maxIndex;
+  if (pCtx->tagInfo.numOfTagCols > 0 && index < 0) {
+    return;  // all the values are NaN, none of them is the result
+  }
 
-        if ((*retVal < pData[i]) ^ isMin) {
-          *retVal = pData[i];
-          if(tsList) {
-            TSKEY k = tsList[i];
-            DO_UPDATE_TAG_COLUMNS(pCtx, k);
-          }
-        }
-        *notNullElems += 1;
-      }
-#if defined(_DEBUG_VIEW)
-      qDebug("max value updated:%d", *retVal);
-#endif
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT) {
-      TYPED_LOOPCHECK_N(int64_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    }
-  } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-    if (pCtx->inputType == TSDB_DATA_TYPE_UTINYINT) {
-      TYPED_LOOPCHECK_N(uint8_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_USMALLINT) {
-      TYPED_LOOPCHECK_N(uint16_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UINT) {
-      TYPED_LOOPCHECK_N(uint32_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    } else if (pCtx->inputType == TSDB_DATA_TYPE_UBIGINT) {
-      TYPED_LOOPCHECK_N(uint64_t, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-    }
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE) {
-    TYPED_LOOPCHECK_N(double, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
-    TYPED_LOOPCHECK_N(float, pOutput, p, pCtx, pCtx->inputType, isMin, *notNullElems);
+  TSKEY key = (tsList != NULL && index >= 0) ? tsList[index] : 0;
+
+  switch (pCtx->inputType) {
+    case TSDB_DATA_TYPE_TINYINT:
+      UPDATE_BY_KERNEL_RES(pCtx, int8_t, pOutput, isMin ? res.imin : res.imax, isMin, key);
+      break;
+    case TSDB_DATA_TYPE_SMALLINT:
+      UPDATE_BY_KERNEL_RES(pCtx, int16_t, pOutput, isMin ? res.imin : res.imax, isMin, key);
+      break;
+    case TSDB_DATA_TYPE_INT:
+      UPDATE_BY_KERNEL_RES(pCtx, int32_t, pOutput, isMin ? res.imin : res.imax, isMin, key);
+      break;
+    case TSDB_DATA_TYPE_BIGINT:
+      UPDATE_BY_KERNEL_RES(pCtx, int64_t, pOutput, isMin ? res.imin : res.imax, isMin, key);
+      break;
+    case TSDB_DATA_TYPE_UTINYINT:
+      UPDATE_BY_KERNEL_RES(pCtx, uint8_t, pOutput, isMin ? res.umin : res.umax, isMin, key);
+      break;
+    case TSDB_DATA_TYPE_USMALLINT:
+      UPDATE_BY_KERNEL_RES(pCtx, uint16_t, pOutput, isMin ? res.umin : res.umax, isMin, key);
+      break;
+    case TSDB_DATA_TYPE_UINT:
+      UPDATE_BY_KERNEL_RES(pCtx, uint32_t, pOutput, isMin ? res.umin : res.umax, isMin, key);
+      break;
+    case TSDB_DATA_TYPE_UBIGINT:
+      UPDATE_BY_KERNEL_RES(pCtx, uint64_t, pOutput, isMin ? res.umin : res.umax, isMin, key);
+      break;
+    case TSDB_DATA_TYPE_FLOAT:
+      UPDATE_BY_KERNEL_RES(pCtx, float, pOutput, isMin ? res.dmin : res.dmax, isMin, key);
+      break;
+    case TSDB_DATA_TYPE_DOUBLE:
+      UPDATE_BY_KERNEL_RES(pCtx, double, pOutput, isMin ? res.dmin : res.dmax, isMin, key);
+      break;
+    default:
+      break;
   }
 }
 
@@ -2810,86 +2801,84 @@ static bool percentile_function_setup(SQLFunctionCtx *pCtx, SResultRowCellInfo*
     return false;
   }
 
-  // in the first round, get the min-max value of all involved data
+  // the bucket is created lazily, its range is seeded by the first block that has data
   SPercentileInfo *pInfo = GET_ROWCELL_INTERBUF(pResultInfo);
-  SET_DOUBLE_VAL(&pInfo->minval, DBL_MAX);
-  SET_DOUBLE_VAL(&pInfo->maxval, -DBL_MAX);
+  pInfo->pMemBucket = NULL;
   pInfo->numOfElems = 0;
 
   return true;
 }
 
-static void percentile_function(SQLFunctionCtx *pCtx) {
-  int32_t notNullElems = 0;
-  
-  SResultRowCellInfo *pResInfo = GET_RES_INFO(pCtx);
-  SPercentileInfo *pInfo = GET_ROWCELL_INTERBUF(pResInfo);
-
-  if (pCtx->currentStage == REPEAT_SCAN && pInfo->stage == 0) {
-    pInfo->stage += 1;
+/*
+ * get the value range of current block, the block statistics are used if exist, otherwise the block is scanned.
+ * return false if all data in current block are null.
+ */
+static bool percentile_block_range(SQLFunctionCtx *pCtx, double *minval, double *maxval) {
+  if (pCtx->preAggVals.isSet) {
+    if (pCtx->size == pCtx->preAggVals.statis.numOfNull) {
+      return false;
+    }
 
-    // all data are null, set it completed
-    if (pInfo->numOfElems == 0) {
-      pResInfo->complete = true;
-      
-      return;
+    if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+      *minval = (double)GET_INT64_VAL(&pCtx->preAggVals.statis.min);
+      *maxval = (double)GET_INT64_VAL(&pCtx->preAggVals.statis.max);
+    } else if (IS_FLOAT_TYPE(pCtx->inputType)) {
+      *minval = GET_DOUBLE_VAL(&pCtx->preAggVals.statis.min);
+      *maxval = GET_DOUBLE_VAL(&pCtx->preAggVals.statis.max);
+    } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+      *minval = (double)GET_UINT64_VAL(&pCtx->preAggVals.statis.min);
+      *maxval = (double)GET_UINT64_VAL(&pCtx->preAggVals.statis.max);
     } else {
-      pInfo->pMemBucket = tMemBucketCreate(pCtx->inputBytes, pCtx->inputType, pInfo->minval, pInfo->maxval);
-    }
-  }
-
-  // the first stage, only acquire the min/max value
-  if (pInfo->stage == 0) {
-    if (pCtx->preAggVals.isSet) {
-      double tmin = 0.0, tmax = 0.0;
-      if (IS_SIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-        tmin = (double)GET_INT64_VAL(&pCtx->preAggVals.statis.min);
-        tmax = (double)GET_INT64_VAL(&pCtx->preAggVals.statis.max);
-      } else if (IS_FLOAT_TYPE(pCtx->inputType)) {
-        tmin = GET_DOUBLE_VAL(&pCtx->preAggVals.statis.min);
-        tmax = GET_DOUBLE_VAL(&pCtx->preAggVals.statis.max);
-      } else if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
-        tmin = (double)GET_UINT64_VAL(&pCtx->preAggVals.statis.min);
-        tmax = (double)GET_UINT64_VAL(&pCtx->preAggVals.statis.max);
-      } else {
-        assert(true);
-      }
+      assert(true);
+    }
 
-      if (GET_DOUBLE_VAL(&pInfo->minval) > tmin) {
-        SET_DOUBLE_VAL(&pInfo->minval, tmin);
-      }
+    return true;
+  }
 
-      if (GET_DOUBLE_VAL(&pInfo->maxval) < tmax) {
-        SET_DOUBLE_VAL(&pInfo->maxval, tmax);
-      }
+  bool found = false;
+  *minval = DBL_MAX;
+  *maxval = -DBL_MAX;
 
-      pInfo->numOfElems += (pCtx->size - pCtx->preAggVals.statis.numOfNull);
-    } else {
-      for (int32_t i = 0; i < pCtx->size; ++i) {
-        char *data = GET_INPUT_DATA(pCtx, i);
-        if (pCtx->hasNull && isNull(data, pCtx->inputType)) {
-          continue;
-        }
+  for (int32_t i = 0; i < pCtx->size; ++i) {
+    char *data = GET_INPUT_DATA(pCtx, i);
+    if (pCtx->hasNull && isNull(data, pCtx->inputType)) {
+      continue;
+    }
 
-        double v = 0;
-        GET_TYPED_DATA(v, double, pCtx->inputType, data);
+    double v = 0;
+    GET_TYPED_DATA(v, double, pCtx->inputType, data);
 
-        if (v < GET_DOUBLE_VAL(&pInfo->minval)) {
-          SET_DOUBLE_VAL(&pInfo->minval, v);
-        }
+    *minval = MIN(*minval, v);
+    *maxval = MAX(*maxval, v);
+    found = true;
+  }
 
-        if (v > GET_DOUBLE_VAL(&pInfo->maxval)) {
-          SET_DOUBLE_VAL(&pInfo->maxval, v);
-        }
+  return found;
+}
 
-        pInfo->numOfElems += 1;
-      }
+static void percentile_function(SQLFunctionCtx *pCtx) {
+  int32_t notNullElems = 0;
+  
+  SResultRowCellInfo *pResInfo = GET_RES_INFO(pCtx);
+  SPercentileInfo *pInfo = GET_ROWCELL_INTERBUF(pResInfo);
+
+  /*
+   * all data are bucketed in a single scan. The values out of the seed range fall into the first or the last
+   * slot, and only the slot that holds the required rank is split again when the percentile is calculated.
+   */
+  if (pInfo->pMemBucket == NULL) {
+    double minval = 0, maxval = 0;
+    if (!percentile_block_range(pCtx, &minval, &maxval)) {
+      return;
     }
 
-    return;
+    pInfo->pMemBucket = tMemBucketCreate(pCtx->inputBytes, pCtx->inputType, minval, maxval);
+    if (pInfo->pMemBucket == NULL) {
+      qError("failed to create percentile bucket, range:%f-%f", minval, maxval);
+      return;
+    }
   }
 
-  // the second stage, calculate the true percentile value
   for (int32_t i = 0; i < pCtx->size; ++i) {
     char *data = GET_INPUT_DATA(pCtx, i);
     if (pCtx->hasNull && isNull(data, pCtx->inputType)) {
@@ -2900,6 +2889,7 @@ static void percentile_function(SQLFunctionCtx *pCtx) {
     tMemBucketPut(pInfo->pMemBucket, data, 1);
   }
   
+  pInfo->numOfElems += notNullElems;
   SET_VAL(pCtx, notNullElems, 1);
   pResInfo->hasResult = DATA_SET_FLAG;
 }
@@ -2957,6 +2947,21 @@ static void tdigest_do(SQLFunctionCtx *pCtx) {
     return ;
   }
 
+  char buf[sizeof(int64_t)] = {0};
+  notNullElems = getIdenticalBlockValue(pCtx, buf);
+  if (notNullElems >= 0) {
+    if (notNullElems > 0) {
+      double v = 0;
+      GET_TYPED_DATA(v, double, pCtx->inputType, buf);
+      tdigestAdd(pAPerc->pTDigest, v, notNullElems);
+
+      SET_VAL(pCtx, notNullElems, 1);
+      pResInfo->hasResult = DATA_SET_FLAG;
+    }
+    return;
+  }
+
+  notNullElems = 0;
   for (int32_t i = 0; i < pCtx->size; ++i) {
     char *data = GET_INPUT_DATA(pCtx, i);
     if (pCtx->hasNull && isNull(data, pCtx->inputType)) {
@@ -3073,7 +3078,22 @@ static void apercentile_function(SQLFunctionCtx *pCtx) {
   buildHistogramInfo(pInfo);
 
   assert(pInfo->pHisto->elems != NULL);
-  
+
+  char buf[sizeof(int64_t)] = {0};
+  notNullElems = getIdenticalBlockValue(pCtx, buf);
+  if (notNullElems >= 0) {
+    if (notNullElems > 0) {
+      double v = 0;
+      GET_TYPED_DATA(v, double, pCtx->inputType, buf);
+      tHistogramAddN(&pInfo->pHisto, v, notNullElems);
+
+      SET_VAL(pCtx, notNullElems, 1);
+      pResInfo->hasResult = DATA_SET_FLAG;
+    }
+    return;
+  }
+
+  notNullElems = 0;
   for (int32_t i = 0; i < pCtx->size; ++i) {
     char *data = GET_INPUT_DATA(pCtx, i);
     if (pCtx->hasNull && isNull(data, pCtx->inputType)) {
@@ -3850,25 +3870,13 @@ static void scalar_expr_function(SQLFunctionCtx *pCtx) {
   SScalarExprSupport *sas = (SScalarExprSupport *)pCtx->param[1].pz;
   tExprOperandInfo output;
   output.data = pCtx->pOutput;
-  exprTreeNodeTraverse(sas->pExprInfo->pExpr, pCtx->size, &output, sas, pCtx->order, getScalarExprColumnData);
-}
-
-#define LIST_MINMAX_N(ctx, minOutput, maxOutput, elemCnt, data, type, tsdbType, numOfNotNullElem) \
-  {                                                                                               \
-    type *inputData = (type *)data;                                                               \
-    for (int32_t i = 0; i < elemCnt; ++i) {                                                       \
-      if ((ctx)->hasNull && isNull((char *)&inputData[i], tsdbType)) {                            \
-        continue;                                                                                 \
-      }                                                                                           \
-      if (inputData[i] < minOutput) {                                                             \
-        minOutput = (double)inputData[i];                                                                 \
-      }                                                                                           \
-      if (inputData[i] > maxOutput) {                                                             \
-        maxOutput = (double)inputData[i];                                                                 \
-      }                                                                                           \
-      numOfNotNullElem++;                                                                         \
-    }                                                                                             \
+
+  if (sas->pProg != NULL && exprProgramTree(sas->pProg) == sas->pExprInfo->pExpr) {
+    exprProgramExec(sas->pProg, pCtx->size, &output, sas, pCtx->order, getScalarExprColumnData);
+  } else {
+    exprTreeNodeTraverse(sas->pExprInfo->pExpr, pCtx->size, &output, sas, pCtx->order, getScalarExprColumnData);
   }
+}
 
 /////////////////////////////////////////////////////////////////////////////////
 static bool spread_function_setup(SQLFunctionCtx *pCtx, SResultRowCellInfo* pResInfo) {
@@ -3928,31 +3936,37 @@ static void spread_function(SQLFunctionCtx *pCtx) {
     goto _spread_over;
   }
   
-  void *pData = GET_INPUT_DATA_LIST(pCtx);
+  const SAggKernel *pKernel = getAggKernel(pCtx->inputType, pCtx->hasNull);
+  SAggKernelRes     res = {0};
   numOfElems = 0;
-  
-  if (pCtx->inputType == TSDB_DATA_TYPE_TINYINT) {
-    LIST_MINMAX_N(pCtx, pInfo->min, pInfo->max, pCtx->size, pData, int8_t, pCtx->inputType, numOfElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_SMALLINT) {
-    LIST_MINMAX_N(pCtx, pInfo->min, pInfo->max, pCtx->size, pData, int16_t, pCtx->inputType, numOfElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_INT) {
-    LIST_MINMAX_N(pCtx, pInfo->min, pInfo->max, pCtx->size, pData, int32_t, pCtx->inputType, numOfElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_BIGINT || pCtx->inputType == TSDB_DATA_TYPE_TIMESTAMP) {
-    LIST_MINMAX_N(pCtx, pInfo->min, pInfo->max, pCtx->size, pData, int64_t, pCtx->inputType, numOfElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_DOUBLE) {
-    LIST_MINMAX_N(pCtx, pInfo->min, pInfo->max, pCtx->size, pData, double, pCtx->inputType, numOfElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_FLOAT) {
-    LIST_MINMAX_N(pCtx, pInfo->min, pInfo->max, pCtx->size, pData, float, pCtx->inputType, numOfElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_UTINYINT) {
-    LIST_MINMAX_N(pCtx, pInfo->min, pInfo->max, pCtx->size, pData, uint8_t, pCtx->inputType, numOfElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_USMALLINT) {
-    LIST_MINMAX_N(pCtx, pInfo->min, pInfo->max, pCtx->size, pData, uint16_t, pCtx->inputType, numOfElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_UINT) {
-    LIST_MINMAX_N(pCtx, pInfo->min, pInfo->max, pCtx->size, pData, uint32_t, pCtx->inputType, numOfElems);
-  } else if (pCtx->inputType == TSDB_DATA_TYPE_UBIGINT) {
-    LIST_MINMAX_N(pCtx, pInfo->min, pInfo->max, pCtx->size, pData, uint64_t, pCtx->inputType, numOfElems);
+
+  if (pKernel != NULL) {
+    (*pKernel->minMax)(GET_INPUT_DATA_LIST(pCtx), pCtx->size, false, &res);
+    numOfElems = res.numOfElems;
   }
-  
+
+  if (numOfElems > 0) {
+    double minVal, maxVal;
+    if (IS_UNSIGNED_NUMERIC_TYPE(pCtx->inputType)) {
+      minVal = (double)res.umin;
+      maxVal = (double)res.umax;
+    } else if (IS_FLOAT_TYPE(pCtx->inputType)) {
+      minVal = res.dmin;
+      maxVal = res.dmax;
+    } else {
+      minVal = (double)res.imin;
+      maxVal = (double)res.imax;
+    }
+
+    if (minVal < pInfo->min) {
+      pInfo->min = minVal;
+    }
+
+    if (maxVal > pInfo->max) {
+      pInfo->max = maxVal;
+    }
+  }
+
   if (!pCtx->hasNull) {
     assert(pCtx->size == numOfElems);
   }
@@ -1472,6 +1472,173 @@ static void doWindowBorderInterpolation(SOperatorInfo* pOperatorInfo, SSDataBloc
   }
 }
 
+static int64_t gcdOfTimeSpan(int64_t a, int64_t b) {
+  while (b != 0) {
+    int64_t t = a % b;
+    a = b;
+    b = t;
+  }
+
+  return a;
+}
+
+static bool isPaneStatisFunction(int32_t functionId) {
+  return functionId == TSDB_FUNC_COUNT || functionId == TSDB_FUNC_SUM || functionId == TSDB_FUNC_AVG ||
+         functionId == TSDB_FUNC_MIN || functionId == TSDB_FUNC_MAX || functionId == TSDB_FUNC_SPREAD;
+}
+
+/*
+ * In a sliding time window query, each row belongs to interval/sliding overlapping windows. If all functions can be
+ * calculated from the pre-aggregated statistics of the rows, the rows are aggregated once into non-overlapping
+ * panes of gcd(interval, sliding), and each window is composed of the statistics of the panes it covers.
+ */
+static bool isPaneIntervalAgg(SOperatorInfo* pOperatorInfo, SSDataBlock* pSDataBlock) {
+  SQueryAttr* pQueryAttr = pOperatorInfo->pRuntimeEnv->pQueryAttr;
+  SInterval*  pInterval = &pQueryAttr->interval;
+
+  if (pInterval->sliding >= pInterval->interval || pInterval->offset != 0 || pInterval->intervalUnit == 'n' ||
+      pInterval->intervalUnit == 'y' || pInterval->slidingUnit == 'n' || pInterval->slidingUnit == 'y') {
+    return false;
+  }
+
+  if (!QUERY_IS_ASC_QUERY(pQueryAttr) || pQueryAttr->timeWindowInterpo || pSDataBlock->pDataBlock == NULL) {
+    return false;
+  }
+
+  STableIntervalOperatorInfo* pInfo = (STableIntervalOperatorInfo*)pOperatorInfo->info;
+  for (int32_t k = 0; k < pOperatorInfo->numOfOutput; ++k) {
+    SQLFunctionCtx* pCtx = &pInfo->pCtx[k];
+    int32_t         functionId = pCtx->functionId;
+
+    if (functionId == TSDB_FUNC_TS || functionId == TSDB_FUNC_TAG) {
+      continue;
+    }
+
+    if (functionId < 0 || !isPaneStatisFunction(functionId)) {
+      return false;
+    }
+
+    SColIndex* pColIndex = &pOperatorInfo->pExpr[k].base.colInfo;
+    if (!TSDB_COL_IS_NORMAL_COL(pColIndex->flag) || pCtx->pInput == NULL || pCtx->tagInfo.numOfTagCols > 0 ||
+        !(IS_NUMERIC_TYPE(pCtx->inputType) || pCtx->inputType == TSDB_DATA_TYPE_TIMESTAMP)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static void doApplyFunctionsOnPane(SQueryRuntimeEnv* pRuntimeEnv, SQLFunctionCtx* pCtx, STimeWindow* pWin,
+                                   int32_t offset, int32_t numOfRows, TSKEY* tsCol, SDataStatis* pStatis,
+                                   int32_t numOfOutput) {
+  for (int32_t k = 0; k < numOfOutput; ++k) {
+    SQLPreAggVal preAggVals = pCtx[k].preAggVals;
+    bool         hasNull = pCtx[k].hasNull;
+    char*        start = pCtx[k].pInput;
+
+    pCtx[k].size    = numOfRows;
+    pCtx[k].startTs = pWin->skey;
+    pCtx[k].endTs   = pWin->ekey;
+    pCtx[k].ptsList = &tsCol[offset];
+    if (pCtx[k].pInput != NULL) {
+      pCtx[k].pInput = (char*)pCtx[k].pInput + offset * pCtx[k].inputBytes;
+    }
+
+    int32_t functionId = pCtx[k].functionId;
+    if (isPaneStatisFunction(functionId)) {
+      pCtx[k].preAggVals.statis = pStatis[k];
+      pCtx[k].preAggVals.isSet  = true;
+      pCtx[k].hasNull = (pStatis[k].numOfNull > 0);
+    }
+
+    if (functionNeedToExecute(pRuntimeEnv, &pCtx[k])) {
+      aAggs[functionId].xFunction(&pCtx[k]);
+    }
+
+    if (GET_RES_INFO(&(pCtx[k]))->numOfRes == -1) {
+      qError("result num is too large.");
+      longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_RESULT_TOO_LARGE);
+    }
+
+    pCtx[k].preAggVals = preAggVals;
+    pCtx[k].hasNull = hasNull;
+    pCtx[k].pInput = start;
+  }
+}
+
+static void hashIntervalAggByPane(SOperatorInfo* pOperatorInfo, SResultRowInfo* pResultRowInfo,
+                                  SSDataBlock* pSDataBlock, TSKEY* tsCols, int32_t tableGroupId) {
+  STableIntervalOperatorInfo* pInfo = (STableIntervalOperatorInfo*)pOperatorInfo->info;
+
+  SQueryRuntimeEnv* pRuntimeEnv = pOperatorInfo->pRuntimeEnv;
+  SQueryAttr*       pQueryAttr = pRuntimeEnv->pQueryAttr;
+  SInterval*        pInterval = &pQueryAttr->interval;
+  int32_t           numOfOutput = pOperatorInfo->numOfOutput;
+  bool              masterScan = IS_MASTER_SCAN(pRuntimeEnv);
+
+  int64_t paneSize = gcdOfTimeSpan(pInterval->interval, pInterval->sliding);
+
+  SDataStatis* pStatis = calloc(numOfOutput, sizeof(SDataStatis));
+  if (pStatis == NULL) {
+    longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+  }
+
+  int32_t rows = pSDataBlock->info.rows;
+  int32_t startPos = 0;
+  while (startPos < rows) {
+    // pane boundaries are aligned with the start of the windows that cover current row
+    TSKEY   ts = tsCols[startPos];
+    TSKEY   firstWinKey = taosTimeTruncate(ts, pInterval, pQueryAttr->precision);
+    TSKEY   paneSkey = firstWinKey + ((ts - firstWinKey) / paneSize) * paneSize;
+    TSKEY   paneEkey = paneSkey + paneSize - 1;
+    int32_t endPos = startPos + 1;
+    if (tsCols[rows - 1] <= paneEkey) {
+      endPos = rows;
+    } else {
+      while (endPos < rows && tsCols[endPos] <= paneEkey) {
+        ++endPos;
+      }
+    }
+
+    int32_t numOfRows = endPos - startPos;
+    for (int32_t k = 0; k < numOfOutput; ++k) {
+      SQLFunctionCtx* pCtx = &pInfo->pCtx[k];
+      if (!isPaneStatisFunction(pCtx->functionId)) {
+        continue;
+      }
+
+      SDataStatis* p = &pStatis[k];
+      memset(p, 0, sizeof(SDataStatis));
+      tDataTypes[pCtx->inputType].statisFunc((char*)pCtx->pInput + startPos * pCtx->inputBytes, numOfRows, &p->min,
+                                             &p->max, &p->sum, &p->minIndex, &p->maxIndex, &p->numOfNull);
+    }
+
+    // merge the pane into all windows covering it, the windows are visited in ascending order of start key
+    for (TSKEY wkey = taosTimeTruncate(paneSkey, pInterval, pQueryAttr->precision); wkey <= paneSkey;
+         wkey += pInterval->sliding) {
+      STimeWindow w = {.skey = wkey, .ekey = wkey + pInterval->interval - 1};
+      if (w.ekey > pQueryAttr->window.ekey) {
+        w.ekey = pQueryAttr->window.ekey;
+      }
+
+      SResultRow* pResult = NULL;
+      int32_t ret = setResultOutputBufByKey(pRuntimeEnv, pResultRowInfo, pSDataBlock->info.tid, &w, masterScan,
+                                            &pResult, tableGroupId, pInfo->pCtx, numOfOutput, pInfo->rowCellInfoOffset);
+      if (ret != TSDB_CODE_SUCCESS || pResult == NULL) {
+        tfree(pStatis);
+        longjmp(pRuntimeEnv->env, TSDB_CODE_QRY_OUT_OF_MEMORY);
+      }
+
+      doApplyFunctionsOnPane(pRuntimeEnv, pInfo->pCtx, &w, startPos, numOfRows, tsCols, pStatis, numOfOutput);
+    }
+
+    startPos = endPos;
+  }
+
+  tfree(pStatis);
+  updateResultRowInfoActiveIndex(pResultRowInfo, pQueryAttr, pRuntimeEnv->current->lastKey);
+}
+
 static void hashIntervalAgg(SOperatorInfo* pOperatorInfo, SResultRowInfo* pResultRowInfo, SSDataBlock* pSDataBlock, int32_t tableGroupId) {
   STableIntervalOperatorInfo* pInfo = (STableIntervalOperatorInfo*)pOperatorInfo->info;
 
@@ -1492,6 +1659,11 @@ static void hashIntervalAgg(SOperatorInfo* pOperatorInfo, SResultRowInfo* pResul
            tsCols[pSDataBlock->info.rows - 1] == pSDataBlock->info.window.ekey);
   }
 
+  if (isPaneIntervalAgg(pOperatorInfo, pSDataBlock)) {
+    hashIntervalAggByPane(pOperatorInfo, pResultRowInfo, pSDataBlock, tsCols, tableGroupId);
+    return;
+  }
+
   int32_t startPos = ascQuery ? 0 : (pSDataBlock->info.rows - 1);
   TSKEY   ts = getStartTsKey(pQueryAttr, &pSDataBlock->info.window, tsCols, pSDataBlock->info.rows);
 
@@ -1893,7 +2065,7 @@ static bool functionNeedToExecute(SQueryRuntimeEnv *pRuntimeEnv, SQLFunctionCtx
 
   // in the reverse table scan, only the following functions need to be executed
   if (IS_REVERSE_SCAN(pRuntimeEnv) ||
-      (pRuntimeEnv->scanFlag == REPEAT_SCAN && functionId != TSDB_FUNC_STDDEV && functionId != TSDB_FUNC_PERCT && functionId != TSDB_FUNC_APERCT)) {
+      (pRuntimeEnv->scanFlag == REPEAT_SCAN && functionId != TSDB_FUNC_STDDEV && functionId != TSDB_FUNC_APERCT)) {
     return false;
   }
 
@@ -2070,7 +2242,14 @@ static SQLFunctionCtx* createSQLFunctionCtx(SQueryRuntimeEnv* pRuntimeEnv, SExpr
       pCtx->param[2].i64 = pQueryAttr->window.ekey;
       pCtx->param[2].nType = TSDB_DATA_TYPE_BIGINT;
     } else if (functionId == TSDB_FUNC_SCALAR_EXPR) {
-      pCtx->param[1].pz = (char*) &pRuntimeEnv->sasArray[i];
+      SScalarExprSupport* sas = &pRuntimeEnv->sasArray[i];
+      pCtx->param[1].pz = (char*) sas;
+
+      // compile the arithmetic once for the query, rather than traverse the tree for each block
+      if (sas->pProg == NULL || exprProgramTree(sas->pProg) != pExpr[i].pExpr) {
+        exprProgramDestroy(sas->pProg);
+        sas->pProg = exprTreeCompile(pExpr[i].pExpr);
+      }
     }
   }
 
@@ -2428,6 +2607,7 @@ static void teardownQueryRuntimeEnv(SQueryRuntimeEnv *pRuntimeEnv) {
     for(int32_t i = 0; i < pQueryAttr->numOfOutput; ++i) {
       tfree(pRuntimeEnv->sasArray[i].data);
       tfree(pRuntimeEnv->sasArray[i].colList);
+      exprProgramDestroy(pRuntimeEnv->sasArray[i].pProg);
     }
 
     tfree(pRuntimeEnv->sasArray);
@@ -2847,6 +3027,20 @@ static FORCE_INLINE bool doFilterByBlockStatistics(SQueryRuntimeEnv* pRuntimeEnv
   return filterRangeExecute(pQueryAttr->pFilters, pDataStatis, pQueryAttr->numOfCols, numOfRows);
 }
 
+static bool dataBlockMayHaveValue(void* param, int16_t colId, int8_t type, const void* val) {
+  return tsdbDataBlockMayHaveValue(param, colId, type, val);
+}
+
+static FORCE_INLINE bool doFilterByBlockBloom(SQueryRuntimeEnv* pRuntimeEnv, TsdbQueryHandleT pQueryHandle) {
+  SQueryAttr* pQueryAttr = pRuntimeEnv->pQueryAttr;
+
+  if (pQueryAttr->pFilters == NULL) {
+    return true;
+  }
+
+  return filterBloomExecute(pQueryAttr->pFilters, pQueryHandle, dataBlockMayHaveValue);
+}
+
 static bool overlapWithTimeWindow(SQueryAttr* pQueryAttr, SDataBlockInfo* pBlockInfo) {
   STimeWindow w = {0};
 
@@ -3147,6 +3341,38 @@ static uint32_t doFilterByBlockTimeWindow(STableScanInfo* pTableScanInfo, SSData
   return status;
 }
 
+/*
+ * The approximate functions (hyperloglog, apercentile) need the raw data in general, but a block with only null or
+ * identical values can be summarized by its statistics. Check if all functions can be calculated with the block
+ * statistics only, so that the data block does not need to be loaded.
+ */
+static bool isBlockAnsweredByStatistics(STableScanInfo* pTableScanInfo, SSDataBlock* pBlock) {
+  SQLFunctionCtx* pCtx = pTableScanInfo->pCtx;
+
+  for (int32_t i = 0; i < pTableScanInfo->numOfOutput; ++i) {
+    int32_t functionId = pCtx[i].functionId;
+    if (functionId < 0 || TSDB_FUNC_IS_SCALAR(functionId)) {
+      return false;
+    }
+
+    SColIndex* pColIndex = &pTableScanInfo->pExpr[i].base.colInfo;
+    if (functionId == TSDB_FUNC_HYPERLOGLOG || functionId == TSDB_FUNC_APERCT) {
+      if (!TSDB_COL_IS_NORMAL_COL(pColIndex->flag) || !IS_NUMERIC_TYPE(pCtx[i].inputType)) {
+        return false;
+      }
+
+      SDataStatis* pStatis = &pBlock->pBlockStatis[pColIndex->colIndex];
+      if (pStatis->numOfNull != pBlock->info.rows && pStatis->min != pStatis->max) {
+        return false;
+      }
+    } else if (aAggs[functionId].dataReqFunc(&pCtx[i], &pBlock->info.window, pColIndex->colId) == BLK_DATA_ALL_NEEDED) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
 void doSetFilterColumnInfo(SSingleColumnFilterInfo* pFilterInfo, int32_t numOfFilterCols, SSDataBlock* pBlock) {
   // set the initial static data value filter expression
   for (int32_t i = 0; i < numOfFilterCols; ++i) {
@@ -3314,6 +3540,22 @@ int32_t loadDataBlockOnDemand(SQueryRuntimeEnv* pRuntimeEnv, STableScanInfo* pTa
       return TSDB_CODE_SUCCESS;
     }
 
+    // no row of the block has the value of an equal condition by the bloom filter of the column
+    if (!doFilterByBlockBloom(pRuntimeEnv, pTableScanInfo->pQueryHandle)) {
+      pCost->discardBlocks += 1;
+      qDebug("QInfo:0x%"PRIx64" data block discard by bloom filter, brange:%" PRId64 "-%" PRId64 ", rows:%d", pQInfo->qId,
+             pBlockInfo->window.skey, pBlockInfo->window.ekey, pBlockInfo->rows);
+      (*status) = BLK_DATA_DISCARD;
+      return TSDB_CODE_SUCCESS;
+    }
+
+    if (pQueryAttr->simpleAgg && pRuntimeEnv->pTsBuf == NULL && pQueryAttr->pFilters == NULL &&
+        !pQueryAttr->groupbyColumn && pBlock->pBlockStatis != NULL &&
+        isBlockAnsweredByStatistics(pTableScanInfo, pBlock)) {
+      (*status) = BLK_DATA_STATIS_NEEDED;
+      return TSDB_CODE_SUCCESS;
+    }
+
     pCost->totalCheckedRows += pBlockInfo->rows;
     pCost->loadBlocks += 1;
     pBlock->pDataBlock = tsdbRetrieveDataBlock(pTableScanInfo->pQueryHandle, NULL);
@@ -4559,12 +4801,13 @@ int32_t doFillTimeIntervalGapsInResults(SFillInfo* pFillInfo, SSDataBlock *pOutp
   return pOutput->info.rows;
 }
 
-void publishOperatorProfEvent(SOperatorInfo* operatorInfo, EQueryProfEventType eventType) {
+static void doPublishOperatorProfEvent(SOperatorInfo* operatorInfo, EQueryProfEventType eventType, int64_t rows) {
   SQueryProfEvent event = {0};
 
   event.eventType    = eventType;
   event.eventTime    = taosGetTimestampUs();
   event.operatorType = operatorInfo->operatorType;
+  event.rows         = rows;
 
   if (operatorInfo->pRuntimeEnv) {
     SQInfo* pQInfo = operatorInfo->pRuntimeEnv->qinfo;
@@ -4574,6 +4817,14 @@ void publishOperatorProfEvent(SOperatorInfo* operatorInfo, EQueryProfEventType e
   }
 }
 
+void publishOperatorProfEvent(SOperatorInfo* operatorInfo, EQueryProfEventType eventType) {
+  doPublishOperatorProfEvent(operatorInfo, eventType, 0);
+}
+
+void publishOperatorProfEndEvent(SOperatorInfo* operatorInfo, SSDataBlock* pBlock) {
+  doPublishOperatorProfEvent(operatorInfo, QUERY_PROF_AFTER_OPERATOR_EXEC, (pBlock != NULL) ? pBlock->info.rows : 0);
+}
+
 void publishQueryAbortEvent(SQInfo* pQInfo, int32_t code) {
   SQueryProfEvent event;
   event.eventType = QUERY_PROF_QUERY_ABORT;
@@ -4591,6 +4842,7 @@ typedef struct  {
   int64_t endTime;
   int64_t selfTime;
   int64_t descendantsTime;
+  int64_t inputRows;
 } SOperatorStackItem;
 
 static void doOperatorExecProfOnce(SOperatorStackItem* item, SQueryProfEvent* event, SArray* opStack, SHashObj* profResults) {
@@ -4602,16 +4854,27 @@ static void doOperatorExecProfOnce(SOperatorStackItem* item, SQueryProfEvent* ev
     ancestor->descendantsTime += item->selfTime;
   }
 
+  // the output of an operator is the input of the operator which invokes it
+  int64_t outputRows = (event->eventType == QUERY_PROF_AFTER_OPERATOR_EXEC) ? event->rows : 0;
+  if (taosArrayGetSize(opStack) > 0) {
+    SOperatorStackItem* parent = taosArrayGetLast(opStack);
+    parent->inputRows += outputRows;
+  }
+
   uint8_t operatorType = item->operatorType;
   SOperatorProfResult* result = taosHashGet(profResults, &operatorType, sizeof(operatorType));
   if (result != NULL) {
     result->sumRunTimes++;
     result->sumSelfTime += item->selfTime;
+    result->sumInputRows += item->inputRows;
+    result->sumOutputRows += outputRows;
   } else {
     SOperatorProfResult opResult;
     opResult.operatorType = operatorType;
     opResult.sumSelfTime = item->selfTime;
     opResult.sumRunTimes = 1;
+    opResult.sumInputRows = item->inputRows;
+    opResult.sumOutputRows = outputRows;
     taosHashPut(profResults, &(operatorType), sizeof(operatorType),
                 &opResult, sizeof(opResult));
   }
@@ -4643,6 +4906,7 @@ void calculateOperatorProfResults(SQInfo* pQInfo) {
       opItem.operatorType = event->operatorType;
       opItem.beginTime = event->eventTime;
       opItem.descendantsTime = 0;
+      opItem.inputRows = 0;
       taosArrayPush(opStack, &opItem);
     } else if (event->eventType == QUERY_PROF_AFTER_OPERATOR_EXEC) {
       SOperatorStackItem* item = taosArrayPop(opStack);
@@ -4656,6 +4920,8 @@ void calculateOperatorProfResults(SQInfo* pQInfo) {
     }
   }
 
+  // the events are accumulated into the results, so the results can be calculated again when more events arrive
+  taosArrayClear(pQInfo->summary.queryProfEvents);
   taosArrayDestroy(&opStack);
 }
 
@@ -4692,11 +4958,94 @@ void queryCostStatis(SQInfo *pQInfo) {
   if (pSummary->operatorProfResults) {
     SOperatorProfResult* opRes = taosHashIterate(pSummary->operatorProfResults, NULL);
     while (opRes != NULL) {
-      qDebug("QInfo:0x%" PRIx64 " :cost summary: operator : %d, exec times: %" PRId64 ", self time: %" PRId64,
-             pQInfo->qId, opRes->operatorType, opRes->sumRunTimes, opRes->sumSelfTime);
+      qDebug("QInfo:0x%" PRIx64 " :cost summary: operator : %d, exec times: %" PRId64 ", self time: %" PRId64
+             ", input rows: %" PRId64 ", output rows: %" PRId64,
+             pQInfo->qId, opRes->operatorType, opRes->sumRunTimes, opRes->sumSelfTime, opRes->sumInputRows,
+             opRes->sumOutputRows);
+      opRes = taosHashIterate(pSummary->operatorProfResults, opRes);
+    }
+  }
+}
+
+const char* getOperatorTypeName(uint8_t operatorType) {
+  static const char* names[] = {
+      [OP_TableScan]                 = "TableScan",
+      [OP_DataBlocksOptScan]         = "DataBlocksOptScan",
+      [OP_TableSeqScan]              = "TableSeqScan",
+      [OP_TagScan]                   = "TagScan",
+      [OP_TableBlockInfoScan]        = "TableBlockInfoScan",
+      [OP_Aggregate]                 = "Aggregate",
+      [OP_Project]                   = "Project",
+      [OP_Groupby]                   = "Groupby",
+      [OP_Limit]                     = "Limit",
+      [OP_SLimit]                    = "SLimit",
+      [OP_TimeWindow]                = "TimeWindow",
+      [OP_SessionWindow]             = "SessionWindow",
+      [OP_Fill]                      = "Fill",
+      [OP_MultiTableAggregate]       = "MultiTableAggregate",
+      [OP_MultiTableTimeInterval]    = "MultiTableTimeInterval",
+      [OP_DummyInput]                = "DummyInput",
+      [OP_MultiwayMergeSort]         = "MultiwayMergeSort",
+      [OP_GlobalAggregate]           = "GlobalAggregate",
+      [OP_Filter]                    = "Filter",
+      [OP_Distinct]                  = "Distinct",
+      [OP_Join]                      = "Join",
+      [OP_StateWindow]               = "StateWindow",
+      [OP_TimeEvery]                 = "TimeEvery",
+      [OP_AllMultiTableTimeInterval] = "AllMultiTableTimeInterval",
+      [OP_Order]                     = "Order",
+  };
+
+  if (operatorType >= tListLen(names) || names[operatorType] == NULL) {
+    return "Unknown";
+  }
+
+  return names[operatorType];
+}
+
+void buildQueryProfileMsg(SQInfo *pQInfo, SQueryProfileMsg *pMsg) {
+  SQueryRuntimeEnv *pRuntimeEnv = &pQInfo->runtimeEnv;
+  SQueryCostInfo   *pSummary = &pQInfo->summary;
+
+  calculateOperatorProfResults(pQInfo);
+
+  STsdbQueryCost cost = {0};
+  tsdbGetQueryCost(pRuntimeEnv->pQueryHandle, &cost);
+
+  memset(pMsg, 0, sizeof(SQueryProfileMsg));
+  pMsg->elapsedTime      = htobe64(pSummary->elapsedTime);
+  pMsg->totalBlocks      = htonl(pSummary->totalBlocks);
+  pMsg->loadBlocks       = htonl(pSummary->loadBlocks);
+  pMsg->loadBlockStatis  = htonl(pSummary->loadBlockStatis);
+  pMsg->discardBlocks    = htonl(pSummary->discardBlocks);
+  pMsg->totalRows        = htobe64(pSummary->totalRows);
+  pMsg->totalCheckedRows = htobe64(pSummary->totalCheckedRows);
+  pMsg->memRows          = htobe64(cost.memRows);
+  pMsg->fileRows         = htobe64(cost.fileRows);
+  pMsg->readBytes        = htobe64(cost.readBytes);
+  pMsg->decodeBytes      = htobe64(cost.decodeBytes);
+  pMsg->spillBytes       = htobe64((pRuntimeEnv->pResultBuf != NULL) ? pRuntimeEnv->pResultBuf->statis.flushBytes : 0);
+
+  int32_t numOfOperators = 0;
+  if (pSummary->operatorProfResults != NULL) {
+    SOperatorProfResult* opRes = taosHashIterate(pSummary->operatorProfResults, NULL);
+    while (opRes != NULL && numOfOperators < TSDB_QUERY_PROF_MAX_OPERATORS) {
+      SOperatorProfileMsg* pOpMsg = &pMsg->operators[numOfOperators++];
+      pOpMsg->operatorType = opRes->operatorType;
+      pOpMsg->execTimes    = htobe64(opRes->sumRunTimes);
+      pOpMsg->selfTime     = htobe64(opRes->sumSelfTime);
+      pOpMsg->inputRows    = htobe64(opRes->sumInputRows);
+      pOpMsg->outputRows   = htobe64(opRes->sumOutputRows);
+
       opRes = taosHashIterate(pSummary->operatorProfResults, opRes);
     }
+
+    if (opRes != NULL) {
+      taosHashCancelIterate(pSummary->operatorProfResults, opRes);
+    }
   }
+
+  pMsg->numOfOperators = htonl(numOfOperators);
 }
 
 //static void updateOffsetVal(SQueryRuntimeEnv *pRuntimeEnv, SDataBlockInfo *pBlockInfo) {
@@ -5892,7 +6241,7 @@ static SSDataBlock* doSort(void* param, bool* newgroup) {
   while(1) {
     publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
     pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
-    publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(pOperator->upstream[0], pBlock);
 
     // start to flush data into disk and try do multiway merge sort
     if (pBlock == NULL) {
@@ -6022,7 +6371,7 @@ static SSDataBlock* doAggregate(void* param, bool* newgroup) {
   while(1) {
     publishOperatorProfEvent(upstream, QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock* pBlock = upstream->exec(upstream, newgroup);
-    publishOperatorProfEvent(upstream, QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(upstream, pBlock);
 
     if (pBlock == NULL) {
       break;
@@ -6082,7 +6431,7 @@ static SSDataBlock* doSTableAggregate(void* param, bool* newgroup) {
   while(1) {
     publishOperatorProfEvent(upstream, QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock* pBlock = upstream->exec(upstream, newgroup);
-    publishOperatorProfEvent(upstream, QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(upstream, pBlock);
 
     if (pBlock == NULL) {
       break;
@@ -6182,7 +6531,7 @@ static SSDataBlock* doProjectOperation(void* param, bool* newgroup) {
     // The upstream exec may change the value of the newgroup, so use a local variable instead.
     publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock* pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
-    publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(pOperator->upstream[0], pBlock);
 
     if (pBlock == NULL) {
       //assert(*newgroup == false);
@@ -6255,7 +6604,7 @@ static SSDataBlock* doLimit(void* param, bool* newgroup) {
   while (1) {
     publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
     pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
-    publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(pOperator->upstream[0], pBlock);
 
     if (pBlock == NULL) {
       doSetOperatorCompleted(pOperator);
@@ -6324,7 +6673,7 @@ static SSDataBlock* doFilter(void* param, bool* newgroup) {
   while (1) {
     publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock *pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
-    publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(pOperator->upstream[0], pBlock);
 
     if (pBlock == NULL) {
       break;
@@ -6382,7 +6731,7 @@ static SSDataBlock* doIntervalAgg(void* param, bool* newgroup) {
   while(1) {
     publishOperatorProfEvent(upstream, QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock* pBlock = upstream->exec(upstream, newgroup);
-    publishOperatorProfEvent(upstream, QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(upstream, pBlock);
 
     if (pBlock == NULL) {
       break;
@@ -6817,7 +7166,7 @@ static SSDataBlock* doTimeEvery(void* param, bool* newgroup) {
     // The upstream exec may change the value of the newgroup, so use a local variable instead.
     publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock* pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
-    publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(pOperator->upstream[0], pBlock);
 
     if (pBlock == NULL) {
       if (!pEveryInfo->groupDone) {
@@ -6930,7 +7279,7 @@ static SSDataBlock* doSTableIntervalAgg(void* param, bool* newgroup) {
   while(1) {
     publishOperatorProfEvent(upstream, QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock* pBlock = upstream->exec(upstream, newgroup);
-    publishOperatorProfEvent(upstream, QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(upstream, pBlock);
 
     if (pBlock == NULL) {
       break;
@@ -7072,7 +7421,7 @@ static SSDataBlock* doStateWindowAgg(void *param, bool* newgroup) {
   while (1) {
     publishOperatorProfEvent(upstream, QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock* pBlock = upstream->exec(upstream, newgroup);
-    publishOperatorProfEvent(upstream, QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(upstream, pBlock);
 
     if (pBlock == NULL) {
       break;
@@ -7134,7 +7483,7 @@ static SSDataBlock* doSessionWindowAgg(void* param, bool* newgroup) {
   while(1) {
     publishOperatorProfEvent(upstream, QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock* pBlock = upstream->exec(upstream, newgroup);
-    publishOperatorProfEvent(upstream, QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(upstream, pBlock);
     if (pBlock == NULL) {
       break;
     }
@@ -7187,7 +7536,7 @@ static SSDataBlock* hashGroupbyAggregate(void* param, bool* newgroup) {
   while(1) {
     publishOperatorProfEvent(upstream, QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock* pBlock = upstream->exec(upstream, newgroup);
-    publishOperatorProfEvent(upstream, QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(upstream, pBlock);
     if (pBlock == NULL) {
       break;
     }
@@ -7270,7 +7619,7 @@ static SSDataBlock* doFill(void* param, bool* newgroup) {
   while(1) {
     publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
     SSDataBlock* pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
-    publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(pOperator->upstream[0], pBlock);
 
     if (*newgroup) {
       assert(pBlock != NULL);
@@ -7329,7 +7678,7 @@ static SSDataBlock* doFill(void* param, bool* newgroup) {
 static int32_t getNumOfScanTimes(SQueryAttr* pQueryAttr) {
   for(int32_t i = 0; i < pQueryAttr->numOfOutput; ++i) {
     int32_t functionId = pQueryAttr->pExpr1[i].base.functionId;
-    if (functionId == TSDB_FUNC_STDDEV || functionId == TSDB_FUNC_PERCT) {
+    if (functionId == TSDB_FUNC_STDDEV) {
       return 2;
     }
   }
@@ -8384,7 +8733,7 @@ static SSDataBlock* hashDistinct(void* param, bool* newgroup) {
   while(1) {
     publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_BEFORE_OPERATOR_EXEC);
     pBlock = pOperator->upstream[0]->exec(pOperator->upstream[0], newgroup);
-    publishOperatorProfEvent(pOperator->upstream[0], QUERY_PROF_AFTER_OPERATOR_EXEC);
+    publishOperatorProfEndEvent(pOperator->upstream[0], pBlock);
 
     if (pBlock == NULL) {
       doSetOperatorCompleted(pOperator);
@@ -8641,6 +8990,39 @@ static int32_t deserializeColFilterInfo(SColumnFilterInfo* pColFilters, int16_t
  * @param pExpr
  * @return
  */
+// the TLVs which end an extended query msg, up to the end mark. Unknown types are skipped
+char *decodeQueryMsgTlv(char *pMsg, SQueryParam *param) {
+  STLV *tlv = NULL;
+  while (1) {
+    tlv = (STLV *)pMsg;
+    tlv->type = ntohs(tlv->type);
+    tlv->len = ntohl(tlv->len);
+    if (tlv->type == TLV_TYPE_END_MARK) {
+      break;
+    }
+    switch(tlv->type) {
+      case TLV_TYPE_META_VERSION: {
+        assert(tlv->len == 2*sizeof(int16_t));
+        param->schemaVersion = ntohs(*(int16_t*)tlv->value);
+        param->tagVersion = ntohs(*(int16_t*)(tlv->value + sizeof(int16_t)));
+        pMsg += sizeof(*tlv) + tlv->len;
+        break;
+      }
+      case TLV_TYPE_QUERY_PROFILE: {
+        assert(tlv->len == sizeof(int8_t));
+        param->queryProfile = *(int8_t*)tlv->value;
+        pMsg += sizeof(*tlv) + tlv->len;
+        break;
+      }
+      default: {
+        pMsg += sizeof(*tlv) + tlv->len;
+        break;
+      }
+    }
+  }
+  return pMsg + sizeof(STLV);
+}
+
 int32_t convertQueryMsg(SQueryTableMsg *pQueryMsg, SQueryParam* param) {
   int32_t code = TSDB_CODE_SUCCESS;
 
@@ -8968,28 +9350,7 @@ int32_t convertQueryMsg(SQueryTableMsg *pQueryMsg, SQueryParam* param) {
   if (pQueryMsg->extend) {
     pMsg += pQueryMsg->sqlstrLen;
 
-    STLV *tlv = NULL;
-    while (1) {
-      tlv = (STLV *)pMsg;
-      tlv->type = ntohs(tlv->type);
-      tlv->len = ntohl(tlv->len);
-      if (tlv->type == TLV_TYPE_END_MARK) {
-        break;
-      }
-      switch(tlv->type) {
-        case TLV_TYPE_META_VERSION: {
-          assert(tlv->len == 2*sizeof(int16_t));
-          param->schemaVersion = ntohs(*(int16_t*)tlv->value);
-          param->tagVersion = ntohs(*(int16_t*)(tlv->value + sizeof(int16_t)));
-          pMsg += sizeof(*tlv) + tlv->len;
-          break;
-        }
-        default: {
-          pMsg += sizeof(*tlv) + tlv->len;
-          break;
-        }
-      }
-    }
+    pMsg = decodeQueryMsgTlv(pMsg, param);
   }
 
   qDebug("qmsg:%p query %d tables, type:%d, qrange:%" PRId64 "-%" PRId64 ", numOfGroupbyTagCols:%d, order:%d, "
@@ -3497,6 +3497,39 @@ bool filterRangeExecute(SFilterInfo *info, SDataStatis *pDataStatis, int32_t num
   return ret;
 }
 
+// A block is not needed if every group has an equal unit whose value the block does not have in the column, by the
+// bloom filter of the column checked through fp
+bool filterBloomExecute(SFilterInfo *info, void *param, filter_has_val_func fp) {
+  if (FILTER_EMPTY_RES(info)) {
+    return false;
+  }
+
+  if (FILTER_ALL_RES(info) || info->cunits == NULL) {
+    return true;
+  }
+
+  for (uint32_t g = 0; g < info->groupNum; ++g) {
+    SFilterGroup *group = &info->groups[g];
+    bool          absent = false;
+
+    for (uint32_t u = 0; u < group->unitNum && !absent; ++u) {
+      SFilterComUnit *cunit = &info->cunits[group->unitIdxs[u]];
+
+      if (cunit->optr != TSDB_RELATION_EQUAL || cunit->valData == NULL || cunit->dataType == TSDB_DATA_TYPE_JSON) {
+        continue;
+      }
+
+      absent = !(*fp)(param, (int16_t)cunit->colId, (int8_t)cunit->dataType, cunit->valData);
+    }
+
+    if (!absent) {
+      return true;
+    }
+  }
+
+  return false;
+}
+
 
 
 int32_t filterGetTimeRange(SFilterInfo *info, STimeWindow       *win) {
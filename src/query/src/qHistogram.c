@@ -119,7 +119,7 @@
 //    }
 //}
 
-static int32_t histogramCreateBin(SHistogramInfo* pHisto, int32_t index, double val);
+static int32_t histogramCreateBin(SHistogramInfo* pHisto, int32_t index, double val, int64_t num);
 
 SHistogramInfo* tHistogramCreate(int32_t numOfEntries) {
   /* need one redundant slot */
@@ -155,7 +155,10 @@ SHistogramInfo* tHistogramCreateFrom(void* pBuf, int32_t numOfBins) {
   return pBuf;
 }
 
-int32_t tHistogramAdd(SHistogramInfo** pHisto, double val) {
+int32_t tHistogramAdd(SHistogramInfo** pHisto, double val) { return tHistogramAddN(pHisto, val, 1); }
+
+int32_t tHistogramAddN(SHistogramInfo** pHisto, double val, int64_t num) {
+  assert(num > 0);
   if (*pHisto == NULL) {
     *pHisto = tHistogramCreate(MAX_HISTOGRAM_BIN);
   }
@@ -165,7 +168,7 @@ int32_t tHistogramAdd(SHistogramInfo** pHisto, double val) {
   assert(idx >= 0 && idx < (*pHisto)->maxEntries && (*pHisto)->elems != NULL);
 
   if ((*pHisto)->elems[idx].val == val && idx >= 0) {
-    (*pHisto)->elems[idx].num += 1;
+    (*pHisto)->elems[idx].num += num;
 
     if ((*pHisto)->numOfEntries == 0) {
       (*pHisto)->numOfEntries += 1;
@@ -181,7 +184,7 @@ int32_t tHistogramAdd(SHistogramInfo** pHisto, double val) {
       assert((*pHisto)->elems[(*pHisto)->numOfEntries].val <= val);
     }
 
-    histogramCreateBin(*pHisto, idx, val);
+    histogramCreateBin(*pHisto, idx, val, num);
   }
 #else
   tSkipListKey key = tSkipListCreateKey(TSDB_DATA_TYPE_DOUBLE, &val, tDataTypes[TSDB_DATA_TYPE_DOUBLE].nSize);
@@ -197,7 +200,7 @@ int32_t tHistogramAdd(SHistogramInfo** pHisto, double val) {
 
   if (pEntry1->num == 0) { /* it is a new node */
     (*pHisto)->numOfEntries += 1;
-    pEntry1->num += 1;
+    pEntry1->num += num;
 
     /* number of entries reaches the upper limitation */
     if (pResNode->pForward[0] != NULL) {
@@ -343,7 +346,7 @@ int32_t tHistogramAdd(SHistogramInfo** pHisto, double val) {
   } else {
     SHistBin* pEntry = (SHistBin*)pResNode->pData;
     assert(pEntry->val == val);
-    pEntry->num += 1;
+    pEntry->num += num;
   }
 
 #endif
@@ -355,7 +358,7 @@ int32_t tHistogramAdd(SHistogramInfo** pHisto, double val) {
     (*pHisto)->min = val;
   }
 
-  (*pHisto)->numOfElems += 1;
+  (*pHisto)->numOfElems += num;
   return 0;
 }
 
@@ -412,7 +415,7 @@ static void histogramMergeImpl(SHistBin* pHistBin, int32_t* size) {
 }
 
 /* optimize this procedure */
-int32_t histogramCreateBin(SHistogramInfo* pHisto, int32_t index, double val) {
+int32_t histogramCreateBin(SHistogramInfo* pHisto, int32_t index, double val, int64_t num) {
 #if defined(USE_ARRAYLIST)
   int32_t remain = pHisto->numOfEntries - index;
   if (remain > 0) {
@@ -421,7 +424,7 @@ int32_t histogramCreateBin(SHistogramInfo* pHisto, int32_t index, double val) {
 
   assert(index >= 0 && index <= pHisto->maxEntries);
 
-  pHisto->elems[index].num = 1;
+  pHisto->elems[index].num = num;
   pHisto->elems[index].val = val;
   pHisto->numOfEntries += 1;
 
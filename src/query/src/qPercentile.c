@@ -124,8 +124,11 @@ int32_t tBucketIntHash(tMemBucket *pBucket, const void *value) {
 
   int32_t index = -1;
 
-  if (v > pBucket->range.i64MaxVal || v < pBucket->range.i64MinVal) {
-    return index;
+  // values out of the seed range are kept in the first or the last slot, which keeps slots ordered
+  if (v < pBucket->range.i64MinVal) {
+    return 0;
+  } else if (v > pBucket->range.i64MaxVal) {
+    return pBucket->numOfSlots - 1;
   }
   
   // divide the value range into 1024 buckets
@@ -151,8 +154,11 @@ int32_t tBucketUintHash(tMemBucket *pBucket, const void *value) {
 
   int32_t index = -1;
 
-  if (v > pBucket->range.u64MaxVal || v < pBucket->range.u64MinVal) {
-    return index;
+  // values out of the seed range are kept in the first or the last slot, which keeps slots ordered
+  if (v < pBucket->range.u64MinVal) {
+    return 0;
+  } else if (v > pBucket->range.u64MaxVal) {
+    return pBucket->numOfSlots - 1;
   }
   
   // divide the value range into 1024 buckets
@@ -182,8 +188,11 @@ int32_t tBucketDoubleHash(tMemBucket *pBucket, const void *value) {
 
   int32_t index = -1;
 
-  if (v > pBucket->range.dMaxVal || v < pBucket->range.dMinVal) {
-    return index;
+  // values out of the seed range are kept in the first or the last slot, which keeps slots ordered
+  if (v < pBucket->range.dMinVal) {
+    return 0;
+  } else if (v > pBucket->range.dMaxVal) {
+    return pBucket->numOfSlots - 1;
   }
 
   // divide a range of [dMinVal, dMaxVal] into 1024 buckets
@@ -495,6 +504,41 @@ double getPercentileImpl(tMemBucket *pMemBucket, int32_t count, double fraction)
   return 0;
 }
 
+/*
+ * the bucket range only seeds the slot boundaries, values out of it are kept in the first and the last slot.
+ * the actual range of data is covered by the first and the last slot that have data.
+ */
+static MinMaxEntry getDataRange(tMemBucket *pMemBucket) {
+  MinMaxEntry range = pMemBucket->range;
+
+  int32_t first = 0;
+  while (first < pMemBucket->numOfSlots && pMemBucket->pSlots[first].info.size == 0) {
+    ++first;
+  }
+
+  int32_t last = pMemBucket->numOfSlots - 1;
+  while (last >= 0 && pMemBucket->pSlots[last].info.size == 0) {
+    --last;
+  }
+
+  if (first > last) {
+    return range;
+  }
+
+  if (IS_SIGNED_NUMERIC_TYPE(pMemBucket->type)) {
+    range.i64MinVal = pMemBucket->pSlots[first].range.i64MinVal;
+    range.i64MaxVal = pMemBucket->pSlots[last].range.i64MaxVal;
+  } else if (IS_UNSIGNED_NUMERIC_TYPE(pMemBucket->type)) {
+    range.u64MinVal = pMemBucket->pSlots[first].range.u64MinVal;
+    range.u64MaxVal = pMemBucket->pSlots[last].range.u64MaxVal;
+  } else {
+    range.dMinVal = pMemBucket->pSlots[first].range.dMinVal;
+    range.dMaxVal = pMemBucket->pSlots[last].range.dMaxVal;
+  }
+
+  return range;
+}
+
 double getPercentile(tMemBucket *pMemBucket, double percent) {
   if (pMemBucket->total == 0) {
     return 0.0;
@@ -509,7 +553,8 @@ double getPercentile(tMemBucket *pMemBucket, double percent) {
 
   // find the min/max value, no need to scan all data in bucket
   if (fabs(percent - 100.0) < DBL_EPSILON || (percent < DBL_EPSILON)) {
-    MinMaxEntry* pRange = &pMemBucket->range;
+    MinMaxEntry  range = getDataRange(pMemBucket);
+    MinMaxEntry* pRange = &range;
 
     if (IS_SIGNED_NUMERIC_TYPE(pMemBucket->type)) {
       double v = (double)(fabs(percent - 100) < DBL_EPSILON ? pRange->i64MaxVal : pRange->i64MinVal);
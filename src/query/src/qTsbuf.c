@@ -1138,6 +1138,40 @@ STSElem tsBufFindElemStartPosByTag(STSBuf* pTSBuf, tVariant* pTag) {
   return el;
 }
 
+int32_t tsBufGetGroupTagList(STSBuf* pTSBuf, int32_t id, SArray* pTagList) {
+  int32_t j = tsBufFindGroupById(pTSBuf->pData, pTSBuf->numOfGroups, id);
+  if (j == -1) {
+    return TSDB_CODE_SUCCESS;
+  }
+
+  STSGroupBlockInfo* pBlockInfo = &pTSBuf->pData[j].info;
+  if (fseek(pTSBuf->f, pBlockInfo->offset, SEEK_SET) != 0) {
+    return TAOS_SYSTEM_ERROR(errno);
+  }
+
+  // only the tag area of each block is required, no need to decompress the timestamps
+  for (int32_t i = 0; i < pBlockInfo->numOfBlocks; ++i) {
+    if (readDataFromDisk(pTSBuf, TSDB_ORDER_ASC, false) == NULL) {
+      tsBufResetPos(pTSBuf);
+      return TSDB_CODE_QRY_SYS_ERROR;
+    }
+
+    // blocks of the same tag are consecutive in one group
+    size_t num = taosArrayGetSize(pTagList);
+    if (num > 0 && tVariantCompare(taosArrayGet(pTagList, num - 1), &pTSBuf->block.tag) == 0) {
+      continue;
+    }
+
+    tVariant t = {0};
+    tVariantAssign(&t, &pTSBuf->block.tag);
+    taosArrayPush(pTagList, &t);
+  }
+
+  // the block buffer has been overwritten, the cursor is not valid anymore
+  tsBufResetPos(pTSBuf);
+  return TSDB_CODE_SUCCESS;
+}
+
 bool tsBufIsValidElem(STSElem* pElem) {
   return pElem->id >= 0;
 }
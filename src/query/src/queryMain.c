@@ -26,6 +26,7 @@
 #include "query.h"
 #include "queryLog.h"
 #include "tlosertree.h"
+#include "tmetrics.h"
 #include "ttype.h"
 
 typedef struct SQueryMgmt {
@@ -35,6 +36,9 @@ typedef struct SQueryMgmt {
   bool            closed;
 } SQueryMgmt;
 
+static SMetric *tsQueryExecLatency = NULL;
+static SMetric *tsQueryRunning = NULL;
+
 static void queryMgmtKillQueryFn(void* handle, void* param1) {
   void** fp = (void**)handle;
   qKillQuery(*fp);
@@ -193,6 +197,7 @@ int32_t qCreateQueryInfo(void* tsdb, int32_t vgId, SQueryTableMsg* pQueryMsg, qi
     goto _over;
   }
   param.pUdfInfo = NULL;
+  ((SQInfo*)(*pQInfo))->profile = param.queryProfile;
 
   code = initQInfo(&pQueryMsg->tsBuf, tsdb, NULL, *pQInfo, &param, (char*)pQueryMsg, pQueryMsg->prevResultLen, NULL);
 
@@ -260,6 +265,7 @@ bool qTableQuery(qinfo_t qinfo, uint64_t *qId) {
   // error occurs, record the error code and return to client
   int32_t ret = setjmp(pQInfo->runtimeEnv.env);
   if (ret != TSDB_CODE_SUCCESS) {
+    taosMetricAdd(tsQueryRunning, -1);  // the error is raised while the operators are executed
     publishQueryAbortEvent(pQInfo, ret);
     pQInfo->code = ret;
     qDebug("QInfo:0x%"PRIx64" query abort due to error/cancel occurs, code:%s", pQInfo->qId, tstrerror(pQInfo->code));
@@ -271,13 +277,17 @@ bool qTableQuery(qinfo_t qinfo, uint64_t *qId) {
   bool newgroup = false;
   publishOperatorProfEvent(pRuntimeEnv->proot, QUERY_PROF_BEFORE_OPERATOR_EXEC);
 
+  taosMetricAdd(tsQueryRunning, 1);
   int64_t st = taosGetTimestampUs();
   pRuntimeEnv->outputBuf = pRuntimeEnv->proot->exec(pRuntimeEnv->proot, &newgroup);
-  pQInfo->summary.elapsedTime += (taosGetTimestampUs() - st);
+  int64_t el = taosGetTimestampUs() - st;
+  pQInfo->summary.elapsedTime += el;
+  taosMetricObserve(tsQueryExecLatency, el);
+  taosMetricAdd(tsQueryRunning, -1);
 #ifdef TEST_IMPL
   waitMoment(pQInfo);
 #endif
-  publishOperatorProfEvent(pRuntimeEnv->proot, QUERY_PROF_AFTER_OPERATOR_EXEC);
+  publishOperatorProfEndEvent(pRuntimeEnv->proot, pRuntimeEnv->outputBuf);
   pRuntimeEnv->resultInfo.total += GET_NUM_OF_RESULTS(pRuntimeEnv);
 
   if (isQueryKilled(pQInfo)) {
@@ -339,6 +349,23 @@ int32_t qRetrieveQueryResultInfo(qinfo_t qinfo, bool* buildRes, void* pRspContex
   return code;
 }
 
+// the profile is put at the end of the rsp, so the client can locate it no matter how the data are compressed
+void doAppendQueryProfile(SQInfo *pQInfo, SRetrieveTableRsp **pRsp, int32_t *contLen) {
+  int32_t len = *contLen + (int32_t)sizeof(SQueryProfileMsg);
+
+  SRetrieveTableRsp *pNew = (SRetrieveTableRsp *)rpcReallocCont(*pRsp, len);
+  if (pNew == NULL) {
+    qError("QInfo:0x%"PRIx64" failed to append query profile since out of memory", pQInfo->qId);
+    return;
+  }
+
+  buildQueryProfileMsg(pQInfo, (SQueryProfileMsg *)((char *)pNew + *contLen));
+  pNew->extend = 1;
+
+  *pRsp = pNew;
+  *contLen = len;
+}
+
 int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp **pRsp, int32_t *contLen, bool* continueExec) {
   SQInfo *pQInfo = (SQInfo *)qinfo;
   int32_t compLen = 0;
@@ -404,6 +431,10 @@ int32_t qDumpRetrieveResult(qinfo_t qinfo, SRetrieveTableRsp **pRsp, int32_t *co
     *continueExec = false;
     (*pRsp)->completed = 1;  // notify no more result to client
     qDebug("QInfo:0x%"PRIx64" no more results to retrieve", pQInfo->qId);
+
+    if (pQInfo->profile && pQInfo->code == TSDB_CODE_SUCCESS) {
+      doAppendQueryProfile(pQInfo, pRsp, contLen);
+    }
   } else {
     *continueExec = true;
     qDebug("QInfo:0x%"PRIx64" has more results to retrieve", pQInfo->qId);
@@ -483,6 +514,9 @@ void* qOpenQueryMgmt(int32_t vgId) {
 
   pthread_mutex_init(&pQueryMgmt->lock, NULL);
 
+  tsQueryExecLatency = taosMetricHistogram("taosd_query_exec_latency_us", "time of each execution of a query in vnode");
+  tsQueryRunning = taosMetricGauge("taosd_query_running", "number of queries being executed in vnode");
+
   qDebug("vgId:%d, open querymgmt success", vgId);
   return pQueryMgmt;
 }
@@ -180,7 +180,7 @@ void tdigestAdd(TDigest* t, double x, int64_t w) {
 
     int32_t i = t->num_buffered_pts;
     if(i > 0 && t->buffered_pts[i-1].value == x ) {
-        t->buffered_pts[i].weight = w;
+        t->buffered_pts[i-1].weight += w;
     } else {
         t->buffered_pts[i].value  = x;
         t->buffered_pts[i].weight = w;
@@ -0,0 +1,286 @@
+#include <gtest/gtest.h>
+#include <sys/time.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#include "taos.h"
+#include "taosdef.h"
+#include "qAggKernel.h"
+
+namespace {
+
+const int32_t numOfRowsPerBlock = 4096;
+const int32_t numOfBlocks = 2048;
+
+int64_t getTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+bool isFltType(int32_t type) { return type == TSDB_DATA_TYPE_FLOAT || type == TSDB_DATA_TYPE_DOUBLE; }
+
+// the lanes of a kernel add the values in another order than a row by row loop, so the sums differ by rounding
+double sumTolerance(int32_t type, double sum) {
+  return (type == TSDB_DATA_TYPE_FLOAT ? 1e-6 : 1e-12) * std::max(1.0, std::fabs(sum));
+}
+
+// the row by row loop the kernels replace
+template <typename T, typename B>
+int32_t refSum(const T *d, int32_t n, B nullv, double *sum, T *mn, T *mx, int32_t *minIndex, int32_t *maxIndex) {
+  int32_t num = 0;
+  for (int32_t i = 0; i < n; ++i) {
+    if (*(const B *)&d[i] == nullv) continue;
+    *sum += d[i];
+    if (num == 0 || d[i] <= *mn) {
+      *mn = d[i];
+      *minIndex = i;
+    }
+    if (num == 0 || d[i] > *mx) {
+      *mx = d[i];
+      *maxIndex = i;
+    }
+    num++;
+  }
+  return num;
+}
+
+template <typename T, typename B>
+void checkKernel(int32_t type, B nullv, bool hasNull) {
+  const int32_t n = 1000 + 3;
+  T             d[n];
+  for (int32_t i = 0; i < n; ++i) {
+    // the values of float and double are not integers, so that the order they are summed in rounds differently
+    d[i] = isFltType(type) ? (T)((i * 37) % 101) / 3 : (T)((i * 37) % 101);
+    if (hasNull && i % 7 == 3) *(B *)&d[i] = nullv;
+  }
+
+  double  sum = 0;
+  T       mn = 0, mx = 0;
+  int32_t minIndex = -1, maxIndex = -1;
+  int32_t num = refSum<T, B>(d, n, nullv, &sum, &mn, &mx, &minIndex, &maxIndex);
+
+  const SAggKernel *pKernel = getAggKernel(type, hasNull);
+  ASSERT_TRUE(pKernel != NULL);
+
+  SAggKernelRes res = {0};
+  EXPECT_EQ((*pKernel->count)(d, n), num);
+
+  (*pKernel->sum)(d, n, &res);
+  EXPECT_EQ(res.numOfElems, num);
+  if (isFltType(type)) {
+    EXPECT_NEAR(res.dsum, sum, sumTolerance(type, sum));
+  } else if (type >= TSDB_DATA_TYPE_UTINYINT) {
+    EXPECT_EQ(res.usum, (uint64_t)sum);
+  } else {
+    EXPECT_EQ(res.isum, (int64_t)sum);
+  }
+
+  (*pKernel->minMax)(d, n, true, &res);
+  EXPECT_EQ(res.numOfElems, num);
+  EXPECT_EQ(res.minIndex, minIndex);
+  EXPECT_EQ(res.maxIndex, maxIndex);
+  EXPECT_EQ(d[res.minIndex], mn);
+  EXPECT_EQ(d[res.maxIndex], mx);
+}
+
+// The NULL of float and double is a NaN, which compares unequal to everything, itself included. A NULL in a lane, in
+// the tail of the block, or a block of NULLs only, is neither summed nor taken as the min or the max
+template <typename T, typename B>
+void checkFltNull(int32_t type, B nullv) {
+  const int32_t n = 64 + 5;
+  T             d[n];
+  T             null;
+  *(B *)&null = nullv;
+  ASSERT_TRUE(std::isnan(null));
+
+  double sum = 0;
+  for (int32_t i = 0; i < n; ++i) {
+    d[i] = (T)(i + 1) / 4;
+    if (i == 0 || i == 31 || i == 40 || i == n - 1) {
+      d[i] = null;
+    } else {
+      sum += d[i];
+    }
+  }
+
+  const SAggKernel *pKernel = getAggKernel(type, true);
+  ASSERT_TRUE(pKernel != NULL);
+  SAggKernelRes res = {0};
+
+  EXPECT_EQ((*pKernel->count)(d, n), n - 4);
+  (*pKernel->sum)(d, n, &res);
+  EXPECT_EQ(res.numOfElems, n - 4);
+  EXPECT_FALSE(std::isnan(res.dsum));
+  EXPECT_NEAR(res.dsum, sum, sumTolerance(type, sum));
+
+  (*pKernel->minMax)(d, n, true, &res);
+  EXPECT_EQ(res.numOfElems, n - 4);
+  EXPECT_EQ(res.minIndex, 1);
+  EXPECT_EQ(res.maxIndex, n - 2);
+  EXPECT_EQ(res.dmin, d[1]);
+  EXPECT_EQ(res.dmax, d[n - 2]);
+
+  for (int32_t i = 0; i < n; ++i) d[i] = null;
+  EXPECT_EQ((*pKernel->count)(d, n), 0);
+  (*pKernel->sum)(d, n, &res);
+  EXPECT_EQ(res.numOfElems, 0);
+  EXPECT_EQ(res.dsum, 0);
+  (*pKernel->minMax)(d, n, true, &res);
+  EXPECT_EQ(res.numOfElems, 0);
+  EXPECT_EQ(res.minIndex, -1);
+  EXPECT_EQ(res.maxIndex, -1);
+}
+
+// The infinities are values, and a NaN which is not the NULL is counted, turns the sum into NaN as the row by row
+// sum does, and is never the min or the max. The positions stay in the block whatever the values
+template <typename T>
+void checkFltSpecial(int32_t type) {
+  const int32_t n = 64 + 5;
+  T             d[n];
+  const T       inf = std::numeric_limits<T>::infinity();
+  const T       nan = std::numeric_limits<T>::quiet_NaN();
+
+  for (int32_t k = 0; k < 2; ++k) {
+    const SAggKernel *pKernel = getAggKernel(type, k == 1);
+    ASSERT_TRUE(pKernel != NULL);
+    SAggKernelRes res = {0};
+
+    for (T v : {inf, -inf}) {
+      for (int32_t i = 0; i < n; ++i) d[i] = v;
+      (*pKernel->minMax)(d, n, true, &res);
+      EXPECT_EQ(res.numOfElems, n);
+      EXPECT_EQ(res.dmin, v);
+      EXPECT_EQ(res.dmax, v);
+      EXPECT_EQ(res.minIndex, n - 1);
+      EXPECT_EQ(res.maxIndex, 0);
+    }
+
+    for (int32_t i = 0; i < n; ++i) d[i] = nan;
+    EXPECT_EQ((*pKernel->count)(d, n), n);
+    (*pKernel->sum)(d, n, &res);
+    EXPECT_EQ(res.numOfElems, n);
+    EXPECT_TRUE(std::isnan(res.dsum));
+    (*pKernel->minMax)(d, n, true, &res);
+    EXPECT_EQ(res.numOfElems, n);
+    EXPECT_EQ(res.minIndex, -1);
+    EXPECT_EQ(res.maxIndex, -1);
+
+    // a NaN in a lane and in the tail
+    for (int32_t i = 0; i < n; ++i) d[i] = (T)i;
+    d[3] = nan;
+    d[n - 1] = nan;
+    (*pKernel->sum)(d, n, &res);
+    EXPECT_TRUE(std::isnan(res.dsum));
+    (*pKernel->minMax)(d, n, true, &res);
+    EXPECT_EQ(res.numOfElems, n);
+    EXPECT_EQ(res.minIndex, 0);
+    EXPECT_EQ(res.maxIndex, n - 2);
+    EXPECT_EQ(res.dmax, (double)(n - 2));
+  }
+}
+
+// the loops of sum() and min()/max() the kernels replace, one aggregate a pass as the functions run
+template <typename T, typename B>
+double refSumOnly(const T *d, int32_t n, B nullv) {
+  double sum = 0;
+  for (int32_t i = 0; i < n; ++i) {
+    if (*(const B *)&d[i] == nullv) continue;
+    sum += d[i];
+  }
+  return sum;
+}
+
+template <typename T, typename B>
+T refMinMax(const T *d, int32_t n, B nullv, T *mx) {
+  T mn = d[0];
+  *mx = d[0];
+  for (int32_t i = 0; i < n; ++i) {
+    if (*(const B *)&d[i] == nullv) continue;
+    if (d[i] < mn) mn = d[i];
+    if (d[i] > *mx) *mx = d[i];
+  }
+  return mn;
+}
+
+double rowsPerUs(int64_t elapsed) {
+  return (double)numOfRowsPerBlock * numOfBlocks / (elapsed > 0 ? elapsed : 1);
+}
+
+template <typename T, typename B>
+void benchKernel(const char *name, int32_t type, B nullv, bool hasNull) {
+  T *d = (T *)malloc(sizeof(T) * numOfRowsPerBlock);
+  for (int32_t i = 0; i < numOfRowsPerBlock; ++i) {
+    d[i] = (T)(i % 1000 + 1);
+    if (hasNull && i % 100 == 50) *(B *)&d[i] = nullv;
+  }
+
+  const SAggKernel *pKernel = getAggKernel(type, hasNull);
+  SAggKernelRes     res = {0};
+  double            x = 0;
+  T                 mx = 0;
+
+  int64_t start = getTimeUs();
+  for (int32_t k = 0; k < numOfBlocks; ++k) x += refSumOnly<T, B>(d, numOfRowsPerBlock, nullv);
+  int64_t refSumElapsed = getTimeUs() - start;
+
+  start = getTimeUs();
+  for (int32_t k = 0; k < numOfBlocks; ++k) x += refMinMax<T, B>(d, numOfRowsPerBlock, nullv, &mx) + mx;
+  int64_t refMinMaxElapsed = getTimeUs() - start;
+
+  start = getTimeUs();
+  for (int32_t k = 0; k < numOfBlocks; ++k) {
+    (*pKernel->sum)(d, numOfRowsPerBlock, &res);
+    x += res.numOfElems;
+  }
+  int64_t sumElapsed = getTimeUs() - start;
+
+  start = getTimeUs();
+  for (int32_t k = 0; k < numOfBlocks; ++k) {
+    (*pKernel->minMax)(d, numOfRowsPerBlock, false, &res);
+    x += res.numOfElems;
+  }
+  int64_t minMaxElapsed = getTimeUs() - start;
+  EXPECT_GT(x, 0);
+
+  printf("%-8s hasNull:%d, sum row by row %.1f, kernel %.1f Mrows/s; min/max row by row %.1f, kernel %.1f Mrows/s\n",
+         name, hasNull, rowsPerUs(refSumElapsed), rowsPerUs(sumElapsed), rowsPerUs(refMinMaxElapsed),
+         rowsPerUs(minMaxElapsed));
+  free(d);
+}
+
+}  // namespace
+
+TEST(testCase, aggKernelTest) {
+  for (int32_t k = 0; k < 2; ++k) {
+    bool hasNull = (k == 1);
+    checkKernel<int8_t, uint8_t>(TSDB_DATA_TYPE_TINYINT, TSDB_DATA_TINYINT_NULL, hasNull);
+    checkKernel<int32_t, uint32_t>(TSDB_DATA_TYPE_INT, TSDB_DATA_INT_NULL, hasNull);
+    checkKernel<int64_t, uint64_t>(TSDB_DATA_TYPE_BIGINT, TSDB_DATA_BIGINT_NULL, hasNull);
+    checkKernel<uint16_t, uint16_t>(TSDB_DATA_TYPE_USMALLINT, TSDB_DATA_USMALLINT_NULL, hasNull);
+    checkKernel<float, uint32_t>(TSDB_DATA_TYPE_FLOAT, TSDB_DATA_FLOAT_NULL, hasNull);
+    checkKernel<double, uint64_t>(TSDB_DATA_TYPE_DOUBLE, TSDB_DATA_DOUBLE_NULL, hasNull);
+  }
+
+  EXPECT_TRUE(getAggKernel(TSDB_DATA_TYPE_BINARY, true) == NULL);
+}
+
+TEST(testCase, aggKernelFltNullTest) {
+  checkFltNull<float, uint32_t>(TSDB_DATA_TYPE_FLOAT, TSDB_DATA_FLOAT_NULL);
+  checkFltNull<double, uint64_t>(TSDB_DATA_TYPE_DOUBLE, TSDB_DATA_DOUBLE_NULL);
+}
+
+TEST(testCase, aggKernelFltSpecialTest) {
+  checkFltSpecial<float>(TSDB_DATA_TYPE_FLOAT);
+  checkFltSpecial<double>(TSDB_DATA_TYPE_DOUBLE);
+}
+
+TEST(testCase, aggKernelBench) {
+  for (int32_t k = 0; k < 2; ++k) {
+    benchKernel<int32_t, uint32_t>("int", TSDB_DATA_TYPE_INT, TSDB_DATA_INT_NULL, k == 1);
+    benchKernel<int64_t, uint64_t>("bigint", TSDB_DATA_TYPE_BIGINT, TSDB_DATA_BIGINT_NULL, k == 1);
+    benchKernel<double, uint64_t>("double", TSDB_DATA_TYPE_DOUBLE, TSDB_DATA_DOUBLE_NULL, k == 1);
+  }
+}
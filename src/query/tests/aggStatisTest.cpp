@@ -0,0 +1,189 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "qAggMain.h"
+#include "taos.h"
+#include "taosdef.h"
+#include "ttype.h"
+
+namespace {
+
+const int32_t numOfRows = 100;
+
+// one aggregate of a normal table query, fed block by block either with the rows or with the statistics of a block
+class SAggRunner {
+ public:
+  SAggRunner(int16_t functionId, int16_t type, int32_t bytes, int32_t algo = ALGO_DEFAULT) {
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.functionId = functionId;
+    ctx.inputType = type;
+    ctx.inputBytes = bytes;
+
+    int16_t outputType = 0;
+    int32_t outputBytes = 0, interBytes = 0;
+    EXPECT_EQ(getResultDataInfo(type, bytes, functionId, 0, &outputType, &outputBytes, &interBytes, 0, false, NULL),
+              TSDB_CODE_SUCCESS);
+    ctx.outputType = outputType;
+    ctx.outputBytes = outputBytes;
+    ctx.interBufBytes = interBytes;
+
+    output.resize(outputBytes);
+    cell.resize(sizeof(SResultRowCellInfo) + interBytes);
+    ctx.pOutput = output.data();
+    ctx.resultInfo = (SResultRowCellInfo *)cell.data();
+
+    if (functionId == TSDB_FUNC_APERCT) {
+      ctx.numOfParams = 2;
+      ctx.param[0].nType = TSDB_DATA_TYPE_DOUBLE;
+      ctx.param[0].dKey = 50;
+      ctx.param[1].nType = TSDB_DATA_TYPE_INT;
+      ctx.param[1].i64 = algo;
+    }
+
+    aAggs[functionId].init(&ctx, ctx.resultInfo);
+  }
+
+  void addRows(void *data, int32_t size, bool hasNull) {
+    ctx.pInput = data;
+    ctx.size = size;
+    ctx.hasNull = hasNull;
+    ctx.preAggVals.isSet = false;
+    aAggs[ctx.functionId].xFunction(&ctx);
+  }
+
+  // the block is not given, so that a function reading it crashes
+  void addStatis(int32_t size, const SDataStatis &statis) {
+    ctx.pInput = NULL;
+    ctx.size = size;
+    ctx.hasNull = statis.numOfNull > 0;
+    ctx.preAggVals.isSet = true;
+    ctx.preAggVals.statis = statis;
+    aAggs[ctx.functionId].xFunction(&ctx);
+  }
+
+  const char *finalize() {
+    aAggs[ctx.functionId].xFinalize(&ctx);
+    return ctx.pOutput;
+  }
+
+  int16_t outputType() const { return ctx.outputType; }
+
+ private:
+  SQLFunctionCtx    ctx;
+  std::vector<char> output;
+  std::vector<char> cell;
+};
+
+// a block of int of which the rows from nullFrom on are NULL and the others v, with its statistics
+SDataStatis intBlock(int32_t *data, int32_t v, int32_t nullFrom) {
+  SDataStatis statis = {0};
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    if (i < nullFrom) {
+      data[i] = v;
+    } else {
+      setNull((char *)&data[i], TSDB_DATA_TYPE_INT, sizeof(int32_t));
+    }
+  }
+
+  statis.numOfNull = (int16_t)(numOfRows - nullFrom);
+  statis.min = statis.max = v;
+  statis.sum = (int64_t)v * nullFrom;
+  return statis;
+}
+
+SDataStatis doubleBlock(double *data, double v) {
+  SDataStatis statis = {0};
+  for (int32_t i = 0; i < numOfRows; ++i) data[i] = v;
+
+  SET_DOUBLE_VAL(&statis.min, v);
+  SET_DOUBLE_VAL(&statis.max, v);
+  SET_DOUBLE_VAL(&statis.sum, v * numOfRows);
+  return statis;
+}
+
+}  // namespace
+
+// A block of NULLs only, or of one value and NULLs, is counted by hyperloglog from its statistics as from its rows
+TEST(testCase, hll_statis_test) {
+  int32_t data[numOfRows];
+  int32_t other[numOfRows];
+  for (int32_t i = 0; i < numOfRows; ++i) other[i] = i * 13;
+
+  for (int32_t nullFrom : {numOfRows, numOfRows / 3, 0}) {
+    SAggRunner byRows(TSDB_FUNC_HYPERLOGLOG, TSDB_DATA_TYPE_INT, sizeof(int32_t));
+    SAggRunner byStatis(TSDB_FUNC_HYPERLOGLOG, TSDB_DATA_TYPE_INT, sizeof(int32_t));
+
+    SDataStatis statis = intBlock(data, 7, nullFrom);
+    byRows.addRows(data, numOfRows, nullFrom < numOfRows);
+    byStatis.addStatis(numOfRows, statis);
+
+    uint64_t count = *(uint64_t *)byRows.finalize();
+    EXPECT_EQ(*(uint64_t *)byStatis.finalize(), count) << nullFrom;
+    EXPECT_EQ(count, nullFrom > 0 ? 1u : 0u) << nullFrom;
+  }
+
+  // and merges with the rows of another block the same
+  SAggRunner byRows(TSDB_FUNC_HYPERLOGLOG, TSDB_DATA_TYPE_INT, sizeof(int32_t));
+  SAggRunner byStatis(TSDB_FUNC_HYPERLOGLOG, TSDB_DATA_TYPE_INT, sizeof(int32_t));
+  SDataStatis statis = intBlock(data, -5, numOfRows / 2);
+  byRows.addRows(data, numOfRows, true);
+  byRows.addRows(other, numOfRows, false);
+  byStatis.addStatis(numOfRows, statis);
+  byStatis.addRows(other, numOfRows, false);
+  EXPECT_EQ(*(uint64_t *)byStatis.finalize(), *(uint64_t *)byRows.finalize());
+
+  double dbl[numOfRows];
+  SAggRunner dblByRows(TSDB_FUNC_HYPERLOGLOG, TSDB_DATA_TYPE_DOUBLE, sizeof(double));
+  SAggRunner dblByStatis(TSDB_FUNC_HYPERLOGLOG, TSDB_DATA_TYPE_DOUBLE, sizeof(double));
+  statis = doubleBlock(dbl, 2.5);
+  dblByRows.addRows(dbl, numOfRows, false);
+  dblByStatis.addStatis(numOfRows, statis);
+  EXPECT_EQ(*(uint64_t *)dblByStatis.finalize(), *(uint64_t *)dblByRows.finalize());
+}
+
+// apercentile takes the value of such a block once with the weight of its rows, for the histogram and for the
+// t-digest, and a block of NULLs only leaves the result as its rows do
+TEST(testCase, apercentile_statis_test) {
+  int32_t data[numOfRows];
+  int32_t other[numOfRows];
+  for (int32_t i = 0; i < numOfRows; ++i) other[i] = i;
+
+  for (int32_t algo : {ALGO_DEFAULT, ALGO_TDIGEST}) {
+    SAggRunner  nullByRows(TSDB_FUNC_APERCT, TSDB_DATA_TYPE_INT, sizeof(int32_t), algo);
+    SAggRunner  nullByStatis(TSDB_FUNC_APERCT, TSDB_DATA_TYPE_INT, sizeof(int32_t), algo);
+    SDataStatis statis = intBlock(data, 0, 0);
+    nullByRows.addRows(data, numOfRows, true);
+    nullByStatis.addStatis(numOfRows, statis);
+    const char *nullRes = nullByRows.finalize();
+    EXPECT_EQ(memcmp(nullByStatis.finalize(), nullRes, sizeof(double)), 0) << algo;
+    if (algo == ALGO_DEFAULT) {
+      EXPECT_TRUE(isNull(nullRes, nullByRows.outputType()));
+    }
+
+    // one value only, the percentile is that value whatever the NULLs
+    SAggRunner identical(TSDB_FUNC_APERCT, TSDB_DATA_TYPE_INT, sizeof(int32_t), algo);
+    statis = intBlock(data, 42, numOfRows / 2);
+    identical.addStatis(numOfRows, statis);
+    identical.addStatis(numOfRows, statis);
+    EXPECT_DOUBLE_EQ(*(double *)identical.finalize(), 42) << algo;
+
+    // the statistics weigh the value as its rows do: 150 rows of 42 out of 250 make 42 the median
+    SAggRunner byRows(TSDB_FUNC_APERCT, TSDB_DATA_TYPE_INT, sizeof(int32_t), algo);
+    SAggRunner byStatis(TSDB_FUNC_APERCT, TSDB_DATA_TYPE_INT, sizeof(int32_t), algo);
+    intBlock(data, 42, numOfRows);
+    byRows.addRows(other, numOfRows, false);
+    byStatis.addRows(other, numOfRows, false);
+    for (int32_t i = 0; i < 3; ++i) {
+      byRows.addRows(data, numOfRows / 2, false);
+      byStatis.addStatis(numOfRows / 2, {0, (int64_t)42 * numOfRows / 2, 42, 42, 0, 0, 0});
+    }
+
+    double expect = *(double *)byRows.finalize();
+    EXPECT_NEAR(expect, 42, 1) << algo;
+    if (algo == ALGO_DEFAULT) {
+      EXPECT_DOUBLE_EQ(*(double *)byStatis.finalize(), expect);
+    } else {
+      EXPECT_NEAR(*(double *)byStatis.finalize(), expect, 1);
+    }
+  }
+}
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+#include <sys/time.h>
+#include <iostream>
+
+#include "taos.h"
+#include "taosdef.h"
+#include "texpr.h"
+#include "ttype.h"
+
+namespace {
+
+const int32_t numOfRows = 4096;
+
+typedef struct SColData {
+  int16_t colId;
+  char   *data;
+} SColData;
+
+typedef struct SBlockData {
+  int32_t  numOfCols;
+  SColData cols[4];
+} SBlockData;
+
+char *getColData(void *param, const char *name, int32_t colId) {
+  SBlockData *pBlock = (SBlockData *)param;
+  for (int32_t i = 0; i < pBlock->numOfCols; ++i) {
+    if (pBlock->cols[i].colId == colId) return pBlock->cols[i].data;
+  }
+
+  assert(0);
+  return NULL;
+}
+
+tExprNode *colNode(int16_t colId, int8_t type) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_COL;
+  pNode->pSchema = (SSchema *)calloc(1, sizeof(SSchema));
+  pNode->pSchema->colId = colId;
+  pNode->pSchema->type = type;
+  pNode->pSchema->bytes = tDataTypes[type].bytes;
+  snprintf(pNode->pSchema->name, tListLen(pNode->pSchema->name), "c%d", colId);
+  pNode->resultType = type;
+  pNode->resultBytes = tDataTypes[type].bytes;
+  return pNode;
+}
+
+tExprNode *valNode(int64_t i64, double d, int32_t type) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_VALUE;
+  pNode->pVal = (tVariant *)calloc(1, sizeof(tVariant));
+  pNode->pVal->nType = type;
+  if (type == TSDB_DATA_TYPE_DOUBLE) {
+    pNode->pVal->dKey = d;
+  } else {
+    pNode->pVal->i64 = i64;
+  }
+  pNode->resultType = type;
+  pNode->resultBytes = tDataTypes[type].bytes;
+  return pNode;
+}
+
+tExprNode *exprNode(uint8_t optr, tExprNode *pLeft, tExprNode *pRight) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_EXPR;
+  pNode->_node.optr = optr;
+  pNode->_node.pLeft = pLeft;
+  pNode->_node.pRight = pRight;
+  pNode->resultType = TSDB_DATA_TYPE_DOUBLE;
+  pNode->resultBytes = sizeof(double);
+  return pNode;
+}
+
+// c1 bigint, c2 float, c3 int, c4 double, with NULL values and zeros
+void initBlock(SBlockData *pBlock) {
+  int64_t *p1 = (int64_t *)malloc(sizeof(int64_t) * numOfRows);
+  float   *p2 = (float *)malloc(sizeof(float) * numOfRows);
+  int32_t *p3 = (int32_t *)malloc(sizeof(int32_t) * numOfRows);
+  double  *p4 = (double *)malloc(sizeof(double) * numOfRows);
+
+  for (int32_t i = 0; i < numOfRows; ++i) {
+    p1[i] = (int64_t)i * 1000 + 7;
+    p2[i] = (float)(i % 113) / 4;
+    p3[i] = i % 17;
+    p4[i] = (double)(i % 101) - 50.5;
+    if (i % 31 == 5) *(uint64_t *)&p1[i] = TSDB_DATA_BIGINT_NULL;
+    if (i % 37 == 6) *(uint32_t *)&p2[i] = TSDB_DATA_FLOAT_NULL;
+    if (i % 41 == 7) *(uint32_t *)&p3[i] = TSDB_DATA_INT_NULL;
+    if (i % 43 == 8) *(uint64_t *)&p4[i] = TSDB_DATA_DOUBLE_NULL;
+  }
+
+  pBlock->numOfCols = 4;
+  pBlock->cols[0] = {1, (char *)p1};
+  pBlock->cols[1] = {2, (char *)p2};
+  pBlock->cols[2] = {3, (char *)p3};
+  pBlock->cols[3] = {4, (char *)p4};
+}
+
+void checkExpr(SBlockData *pBlock, tExprNode *pExpr) {
+  SExprProgram *pProg = exprTreeCompile(pExpr);
+  ASSERT_TRUE(pProg != NULL);
+
+  double *pExpect = (double *)malloc(sizeof(double) * numOfRows);
+  double *pRes = (double *)malloc(sizeof(double) * numOfRows);
+
+  for (int32_t k = 0; k < 2; ++k) {
+    int32_t order = (k == 0) ? TSDB_ORDER_ASC : TSDB_ORDER_DESC;
+
+    tExprOperandInfo expect = {0};
+    expect.data = (char *)pExpect;
+    exprTreeNodeTraverse(pExpr, numOfRows, &expect, pBlock, order, getColData);
+
+    tExprOperandInfo res = {0};
+    res.data = (char *)pRes;
+    exprProgramExec(pProg, numOfRows, &res, pBlock, order, getColData);
+
+    EXPECT_EQ(res.type, TSDB_DATA_TYPE_DOUBLE);
+    EXPECT_EQ(res.numOfRows, expect.numOfRows);
+    EXPECT_EQ(memcmp(pRes, pExpect, sizeof(double) * numOfRows), 0);
+  }
+
+  free(pExpect);
+  free(pRes);
+  exprProgramDestroy(pProg);
+}
+
+int64_t getTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+void freeBlock(SBlockData *pBlock) {
+  for (int32_t i = 0; i < pBlock->numOfCols; ++i) free(pBlock->cols[i].data);
+}
+
+}  // namespace
+
+TEST(testCase, exprProgramTest) {
+  SBlockData block = {0};
+  initBlock(&block);
+
+  // c3 * 2 + c2
+  tExprNode *pExpr = exprNode(TSDB_BINARY_OP_ADD,
+                              exprNode(TSDB_BINARY_OP_MULTIPLY, colNode(3, TSDB_DATA_TYPE_INT),
+                                       valNode(2, 0, TSDB_DATA_TYPE_BIGINT)),
+                              colNode(2, TSDB_DATA_TYPE_FLOAT));
+  checkExpr(&block, pExpr);
+  tExprTreeDestroy(pExpr, NULL);
+
+  // (c1 - c4) / c3 * 3600, with zero divisors
+  pExpr = exprNode(TSDB_BINARY_OP_MULTIPLY,
+                   exprNode(TSDB_BINARY_OP_DIVIDE,
+                            exprNode(TSDB_BINARY_OP_SUBTRACT, colNode(1, TSDB_DATA_TYPE_BIGINT),
+                                     colNode(4, TSDB_DATA_TYPE_DOUBLE)),
+                            colNode(3, TSDB_DATA_TYPE_INT)),
+                   valNode(3600, 0, TSDB_DATA_TYPE_BIGINT));
+  checkExpr(&block, pExpr);
+  tExprTreeDestroy(pExpr, NULL);
+
+  // 100 % c3 - c1 % c2 * c2
+  pExpr = exprNode(TSDB_BINARY_OP_SUBTRACT,
+                   exprNode(TSDB_BINARY_OP_REMAINDER, valNode(100, 0, TSDB_DATA_TYPE_BIGINT),
+                            colNode(3, TSDB_DATA_TYPE_INT)),
+                   exprNode(TSDB_BINARY_OP_MULTIPLY,
+                            exprNode(TSDB_BINARY_OP_REMAINDER, colNode(1, TSDB_DATA_TYPE_BIGINT),
+                                     colNode(2, TSDB_DATA_TYPE_FLOAT)),
+                            colNode(2, TSDB_DATA_TYPE_FLOAT)));
+  checkExpr(&block, pExpr);
+  tExprTreeDestroy(pExpr, NULL);
+
+  // (2.5 * 4 - 1) * c4, folded to a constant when compiled
+  pExpr = exprNode(TSDB_BINARY_OP_MULTIPLY,
+                   exprNode(TSDB_BINARY_OP_SUBTRACT,
+                            exprNode(TSDB_BINARY_OP_MULTIPLY, valNode(0, 2.5, TSDB_DATA_TYPE_DOUBLE),
+                                     valNode(4, 0, TSDB_DATA_TYPE_BIGINT)),
+                            valNode(1, 0, TSDB_DATA_TYPE_BIGINT)),
+                   colNode(4, TSDB_DATA_TYPE_DOUBLE));
+  checkExpr(&block, pExpr);
+  tExprTreeDestroy(pExpr, NULL);
+
+  // c4 / 0 is NULL on all rows
+  pExpr = exprNode(TSDB_BINARY_OP_DIVIDE, colNode(4, TSDB_DATA_TYPE_DOUBLE), valNode(0, 0, TSDB_DATA_TYPE_BIGINT));
+  checkExpr(&block, pExpr);
+  tExprTreeDestroy(pExpr, NULL);
+
+  // the constants only and the bitand are left to the tree traverse
+  pExpr = exprNode(TSDB_BINARY_OP_ADD, valNode(1, 0, TSDB_DATA_TYPE_BIGINT), valNode(2, 0, TSDB_DATA_TYPE_BIGINT));
+  EXPECT_TRUE(exprTreeCompile(pExpr) == NULL);
+  tExprTreeDestroy(pExpr, NULL);
+
+  pExpr = exprNode(TSDB_BINARY_OP_BITAND, colNode(3, TSDB_DATA_TYPE_INT), colNode(3, TSDB_DATA_TYPE_INT));
+  EXPECT_TRUE(exprTreeCompile(pExpr) == NULL);
+  tExprTreeDestroy(pExpr, NULL);
+
+  freeBlock(&block);
+}
+
+TEST(testCase, exprProgramBench) {
+  SBlockData block = {0};
+  initBlock(&block);
+
+  // (c1 - c4) / c3 * 3600
+  tExprNode *pExpr = exprNode(TSDB_BINARY_OP_MULTIPLY,
+                              exprNode(TSDB_BINARY_OP_DIVIDE,
+                                       exprNode(TSDB_BINARY_OP_SUBTRACT, colNode(1, TSDB_DATA_TYPE_BIGINT),
+                                                colNode(4, TSDB_DATA_TYPE_DOUBLE)),
+                                       colNode(3, TSDB_DATA_TYPE_INT)),
+                              valNode(3600, 0, TSDB_DATA_TYPE_BIGINT));
+  SExprProgram    *pProg = exprTreeCompile(pExpr);
+  double          *pOut = (double *)malloc(sizeof(double) * numOfRows);
+  tExprOperandInfo output = {0};
+  output.data = (char *)pOut;
+
+  const int32_t numOfBlocks = 500;
+  int64_t       start = getTimeUs();
+  for (int32_t k = 0; k < numOfBlocks; ++k) {
+    exprTreeNodeTraverse(pExpr, numOfRows, &output, &block, TSDB_ORDER_ASC, getColData);
+  }
+  int64_t treeElapsed = getTimeUs() - start;
+
+  start = getTimeUs();
+  for (int32_t k = 0; k < numOfBlocks; ++k) {
+    exprProgramExec(pProg, numOfRows, &output, &block, TSDB_ORDER_ASC, getColData);
+  }
+  int64_t progElapsed = getTimeUs() - start;
+
+  double rows = (double)numOfRows * numOfBlocks;
+  printf("(c1-c4)/c3*3600, %.0f rows, tree traverse %.1f Mrows/s, program %.1f Mrows/s\n", rows,
+         rows / (treeElapsed > 0 ? treeElapsed : 1), rows / (progElapsed > 0 ? progElapsed : 1));
+
+  free(pOut);
+  exprProgramDestroy(pProg);
+  tExprTreeDestroy(pExpr, NULL);
+  freeBlock(&block);
+}
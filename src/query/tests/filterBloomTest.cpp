@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+#include <map>
+#include <set>
+#include <string>
+
+#include "taos.h"
+#include "taosdef.h"
+#include "tbuffer.h"
+#include "texpr.h"
+
+#include "qFilter.h"
+
+namespace {
+
+const int16_t intColId = 1;
+const int16_t binColId = 2;
+const int16_t ncharColId = 3;
+
+// The values of the columns of a block, by the bytes a bloom filter hashes them with: the payload of a var data, the
+// fixed bytes of an integer
+typedef std::map<int16_t, std::set<std::string>> SBlockVals;
+
+std::string valKey(int8_t type, const void *val) {
+  if (IS_VAR_DATA_TYPE(type)) return std::string((const char *)varDataVal(val), varDataLen(val));
+  return std::string((const char *)val, tDataTypes[type].bytes);
+}
+
+// an exact filter, so that a block is excluded only when it does not have the value
+bool blockHasValue(void *param, int16_t colId, int8_t type, const void *val) {
+  SBlockVals *pVals = (SBlockVals *)param;
+  auto        it = pVals->find(colId);
+  return it != pVals->end() && it->second.count(valKey(type, val)) > 0;
+}
+
+std::string ucs4(const std::string &str) {
+  std::string s;
+  for (char c : str) {
+    uint32_t cp = (uint8_t)c;
+    s.append((const char *)&cp, TSDB_NCHAR_SIZE);
+  }
+  return s;
+}
+
+tExprNode *colNode(int16_t colId, int8_t type, int16_t bytes) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_COL;
+  pNode->pSchema = (SSchema *)calloc(1, sizeof(SSchema));
+  snprintf(pNode->pSchema->name, sizeof(pNode->pSchema->name), "c%d", colId);
+  pNode->pSchema->type = type;
+  pNode->pSchema->bytes = bytes;
+  pNode->pSchema->colId = colId;
+  return pNode;
+}
+
+tExprNode *intNode(int64_t v) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_VALUE;
+  pNode->pVal = (tVariant *)calloc(1, sizeof(tVariant));
+  pNode->pVal->nType = TSDB_DATA_TYPE_BIGINT;
+  pNode->pVal->i64 = v;
+  return pNode;
+}
+
+tExprNode *strNode(const std::string &str) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_VALUE;
+  pNode->pVal = (tVariant *)calloc(1, sizeof(tVariant));
+  pNode->pVal->nType = TSDB_DATA_TYPE_BINARY;
+  pNode->pVal->pz = strdup(str.c_str());
+  pNode->pVal->nLen = (int32_t)str.size();
+  return pNode;
+}
+
+// the value list of IN as the client serializes it
+tExprNode *strSetNode(int8_t type, const std::vector<std::string> &strs) {
+  SBufferWriter bw = tbufInitWriter(NULL, false);
+  tbufWriteUint32(&bw, type);
+  tbufWriteInt32(&bw, (int32_t)strs.size());
+  for (const std::string &str : strs) {
+    std::string s = (type == TSDB_DATA_TYPE_NCHAR) ? ucs4(str) : str;
+    tbufWriteBinary(&bw, s.data(), s.size());
+  }
+
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_VALUE;
+  pNode->pVal = (tVariant *)calloc(1, sizeof(tVariant));
+  pNode->pVal->nType = TSDB_DATA_TYPE_BINARY;
+  pNode->pVal->nLen = (int32_t)tbufTell(&bw);
+  pNode->pVal->pz = tbufGetData(&bw, true);
+  return pNode;
+}
+
+tExprNode *exprNode(uint8_t optr, tExprNode *pLeft, tExprNode *pRight) {
+  tExprNode *pNode = (tExprNode *)calloc(1, sizeof(tExprNode));
+  pNode->nodeType = TSQL_NODE_EXPR;
+  pNode->_node.optr = optr;
+  pNode->_node.pLeft = pLeft;
+  pNode->_node.pRight = pRight;
+  return pNode;
+}
+
+tExprNode *intEq(int64_t v) { return exprNode(TSDB_RELATION_EQUAL, colNode(intColId, TSDB_DATA_TYPE_INT, 4), intNode(v)); }
+
+tExprNode *binEq(const std::string &str) {
+  return exprNode(TSDB_RELATION_EQUAL, colNode(binColId, TSDB_DATA_TYPE_BINARY, 32 + VARSTR_HEADER_SIZE), strNode(str));
+}
+
+tExprNode *ncharEq(const std::string &str) {
+  return exprNode(TSDB_RELATION_EQUAL, colNode(ncharColId, TSDB_DATA_TYPE_NCHAR, 32 * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE),
+                  strNode(str));
+}
+
+// whether the block may be needed by the condition, the tree is consumed
+bool mayNeedBlock(tExprNode *pTree, SBlockVals *pVals) {
+  SFilterInfo *pInfo = NULL;
+  EXPECT_EQ(filterInitFromTree(pTree, (void **)&pInfo, 0), TSDB_CODE_SUCCESS);
+  tExprTreeDestroy(pTree, NULL);
+
+  bool res = (pInfo == NULL) || filterBloomExecute(pInfo, pVals, blockHasValue);
+  filterFreeInfo(pInfo);
+  return res;
+}
+
+}  // namespace
+
+// The equal conditions rule out a block only if in every group of the filter one of them has a value the block does
+// not have, and the other operators never do
+TEST(FilterBloomTest, neverExcludesHeldValue) {
+  int32_t    v1 = 1, v2 = 2;
+  SBlockVals vals;
+  vals[intColId] = {std::string((char *)&v1, 4), std::string((char *)&v2, 4)};
+  vals[binColId] = {"a", "bc"};
+  vals[ncharColId] = {ucs4("nv")};
+
+  // equal, by the bytes of the column type and by the payload of a var data, UCS-4 for nchar
+  EXPECT_TRUE(mayNeedBlock(intEq(2), &vals));
+  EXPECT_FALSE(mayNeedBlock(intEq(9), &vals));
+  EXPECT_TRUE(mayNeedBlock(binEq("bc"), &vals));
+  EXPECT_FALSE(mayNeedBlock(binEq("b"), &vals));
+  EXPECT_TRUE(mayNeedBlock(ncharEq("nv"), &vals));
+  EXPECT_FALSE(mayNeedBlock(ncharEq("n"), &vals));
+
+  // groups
+  EXPECT_TRUE(mayNeedBlock(exprNode(TSDB_RELATION_OR, intEq(9), binEq("a")), &vals));
+  EXPECT_FALSE(mayNeedBlock(exprNode(TSDB_RELATION_OR, intEq(9), binEq("z")), &vals));
+  EXPECT_FALSE(mayNeedBlock(exprNode(TSDB_RELATION_AND, intEq(9), binEq("a")), &vals));
+  EXPECT_TRUE(mayNeedBlock(exprNode(TSDB_RELATION_AND, intEq(1), binEq("a")), &vals));
+
+  // other operators
+  EXPECT_TRUE(mayNeedBlock(
+      exprNode(TSDB_RELATION_GREATER, colNode(intColId, TSDB_DATA_TYPE_INT, 4), intNode(100)), &vals));
+  EXPECT_TRUE(mayNeedBlock(exprNode(TSDB_RELATION_OR, intEq(9),
+                                    exprNode(TSDB_RELATION_LESS, colNode(intColId, TSDB_DATA_TYPE_INT, 4), intNode(0))),
+                           &vals));
+
+  // IN, whether the block has one of the values or none
+  EXPECT_TRUE(mayNeedBlock(exprNode(TSDB_RELATION_IN, colNode(binColId, TSDB_DATA_TYPE_BINARY, 32 + VARSTR_HEADER_SIZE),
+                                    strSetNode(TSDB_DATA_TYPE_BINARY, {"z", "bc"})),
+                           &vals));
+  EXPECT_TRUE(mayNeedBlock(exprNode(TSDB_RELATION_IN, colNode(binColId, TSDB_DATA_TYPE_BINARY, 32 + VARSTR_HEADER_SIZE),
+                                    strSetNode(TSDB_DATA_TYPE_BINARY, {"y", "z"})),
+                           &vals));
+  EXPECT_TRUE(mayNeedBlock(
+      exprNode(TSDB_RELATION_IN, colNode(ncharColId, TSDB_DATA_TYPE_NCHAR, 32 * TSDB_NCHAR_SIZE + VARSTR_HEADER_SIZE),
+               strSetNode(TSDB_DATA_TYPE_NCHAR, {"y", "z"})),
+      &vals));
+
+  // a block none of whose rows has the value
+  SBlockVals none;
+  EXPECT_FALSE(mayNeedBlock(intEq(1), &none));
+}
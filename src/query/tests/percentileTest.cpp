@@ -245,6 +245,40 @@ void unsignedDataTest() {
 
 }
 
+// the seed range only covers part of the data, values out of it must still be counted
+void outOfSeedRangeTest() {
+  printf("running %s\n", __FUNCTION__);
+
+  tMemBucket *pBucket = tMemBucketCreate(sizeof(int64_t), TSDB_DATA_TYPE_BIGINT, 400, 600);
+  for (int32_t i = 0; i <= 1000; ++i) {
+    int64_t val = i;
+    tMemBucketPut(pBucket, &val, 1);
+  }
+
+  double result = getPercentile(pBucket, 0);
+  ASSERT_DOUBLE_EQ(result, 0);
+
+  result = getPercentile(pBucket, 100);
+  ASSERT_DOUBLE_EQ(result, 1000);
+
+  result = getPercentile(pBucket, 10);
+  ASSERT_DOUBLE_EQ(result, 100);
+
+  result = getPercentile(pBucket, 99);
+  ASSERT_DOUBLE_EQ(result, 990);
+  tMemBucketDestroy(pBucket);
+
+  pBucket = tMemBucketCreate(sizeof(double), TSDB_DATA_TYPE_DOUBLE, 0, 1);
+  for (int32_t i = 0; i < 300000; ++i) {
+    double val = i * 0.5;
+    tMemBucketPut(pBucket, &val, 1);
+  }
+
+  result = getPercentile(pBucket, 50);
+  ASSERT_DOUBLE_EQ(result, 74999.75);
+  tMemBucketDestroy(pBucket);
+}
+
 }  // namespace
 
 TEST(testCase, percentileTest) {
@@ -254,4 +288,5 @@ TEST(testCase, percentileTest) {
   doubleDataTest();
   unsignedDataTest();
   largeDataTest();
+  outOfSeedRangeTest();
 }
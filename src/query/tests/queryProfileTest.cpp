@@ -0,0 +1,169 @@
+#include <gtest/gtest.h>
+#include <vector>
+
+#include "taos.h"
+#include "taosdef.h"
+#include "taosmsg.h"
+#include "tglobal.h"
+#include "trpc.h"
+
+extern "C" {
+#include "qExecutor.h"
+
+// the encoder and the decoder of the client, whose headers do not compile as C++
+char             *tscEncodeQueryMsgTlv(char *pMsg, int16_t sversion, int16_t tversion);
+SQueryProfileMsg *tscGetQueryProfileMsg(SRetrieveTableRsp *pRsp, int32_t rspLen);
+void              tscMergeQueryProfile(SQueryProfileMsg *pTotal, SQueryProfileMsg *pMsg);
+}
+
+namespace {
+
+// the TLVs as the client writes them, decoded as the vnode does. Returns the bytes the decoder took
+size_t roundTrip(char *buf, size_t offset, int16_t sversion, int16_t tversion, SQueryParam *param) {
+  char *end = tscEncodeQueryMsgTlv(buf + offset, sversion, tversion);
+  memset(param, 0, sizeof(SQueryParam));
+
+  char *next = decodeQueryMsgTlv(buf, param);
+  EXPECT_EQ(next, end);
+  return next - buf;
+}
+
+void pushEvent(SArray *pEvents, EQueryProfEventType type, uint8_t operatorType, int64_t time, int64_t rows) {
+  SQueryProfEvent event;
+  memset(&event, 0, sizeof(event));
+  event.eventType = type;
+  event.operatorType = operatorType;
+  event.eventTime = time;
+  event.rows = rows;
+  taosArrayPush(pEvents, &event);
+}
+
+// a query of an aggregate over a scan of 100 rows, of whose 50 us the scan took 30
+SQInfo *createQInfo() {
+  SQInfo *pQInfo = (SQInfo *)calloc(1, sizeof(SQInfo));
+
+  SQueryCostInfo *pSummary = &pQInfo->summary;
+  pSummary->elapsedTime = 123456;
+  pSummary->totalBlocks = 7;
+  pSummary->loadBlocks = 3;
+  pSummary->loadBlockStatis = 2;
+  pSummary->discardBlocks = 1;
+  pSummary->totalRows = 1LL << 40;
+  pSummary->totalCheckedRows = 100;
+
+  pSummary->queryProfEvents = (SArray *)taosArrayInit(4, sizeof(SQueryProfEvent));
+  pSummary->operatorProfResults =
+      taosHashInit(8, taosGetDefaultHashFunction(TSDB_DATA_TYPE_TINYINT), true, HASH_NO_LOCK);
+  pushEvent(pSummary->queryProfEvents, QUERY_PROF_BEFORE_OPERATOR_EXEC, OP_Aggregate, 0, 0);
+  pushEvent(pSummary->queryProfEvents, QUERY_PROF_BEFORE_OPERATOR_EXEC, OP_TableScan, 10, 0);
+  pushEvent(pSummary->queryProfEvents, QUERY_PROF_AFTER_OPERATOR_EXEC, OP_TableScan, 40, 100);
+  pushEvent(pSummary->queryProfEvents, QUERY_PROF_AFTER_OPERATOR_EXEC, OP_Aggregate, 50, 1);
+  return pQInfo;
+}
+
+void destroyQInfo(SQInfo *pQInfo) {
+  taosArrayDestroy(&pQInfo->summary.queryProfEvents);
+  taosHashCleanup(pQInfo->summary.operatorProfResults);
+  free(pQInfo);
+}
+
+SOperatorProfileMsg *findOperator(SQueryProfileMsg *pTotal, uint8_t operatorType) {
+  for (int32_t i = 0; i < pTotal->numOfOperators; ++i) {
+    if (pTotal->operators[i].operatorType == operatorType) return &pTotal->operators[i];
+  }
+  return NULL;
+}
+
+}  // namespace
+
+// The vnode takes the versions of the meta and the profile request the client writes, whatever TLVs of unknown types
+// come before them
+TEST(testCase, query_msg_tlv_test) {
+  std::vector<char> buf(256);
+  SQueryParam       param;
+  int8_t            queryProfile = tsQueryProfile;
+
+  tsQueryProfile = 0;
+  size_t len = roundTrip(buf.data(), 0, 3, 12, &param);
+  EXPECT_EQ(len, sizeof(STLV) * 2 + sizeof(int16_t) * 2);
+  EXPECT_EQ(param.schemaVersion, 3);
+  EXPECT_EQ(param.tagVersion, 12);
+  EXPECT_EQ(param.queryProfile, 0);
+
+  tsQueryProfile = 1;
+  len = roundTrip(buf.data(), 0, -1, 0x1234, &param);
+  EXPECT_EQ(len, sizeof(STLV) * 3 + sizeof(int16_t) * 2 + sizeof(int8_t));
+  EXPECT_EQ(param.schemaVersion, -1);
+  EXPECT_EQ(param.tagVersion, 0x1234);
+  EXPECT_EQ(param.queryProfile, 1);
+
+  // a TLV of a later version
+  STLV *tlv = (STLV *)buf.data();
+  tlv->type = htons(100);
+  tlv->len = htonl(5);
+  memset(tlv->value, 0xff, 5);
+  roundTrip(buf.data(), sizeof(STLV) + 5, 8, 9, &param);
+  EXPECT_EQ(param.schemaVersion, 8);
+  EXPECT_EQ(param.tagVersion, 9);
+  EXPECT_EQ(param.queryProfile, 1);
+
+  tsQueryProfile = queryProfile;
+}
+
+// The profile appended to the last rsp of a vnode is found at its end by the client, which adds it to those of the
+// other vnodes in host byte order
+TEST(testCase, query_profile_rsp_test) {
+  SQInfo *pQInfo = createQInfo();
+
+  const int32_t      dataLen = 37;
+  int32_t            contLen = (int32_t)sizeof(SRetrieveTableRsp) + dataLen;
+  SRetrieveTableRsp *pRsp = (SRetrieveTableRsp *)rpcMallocCont(contLen);
+  memset(pRsp, 0, contLen);
+  memset(pRsp->data, 'x', dataLen);
+
+  // no profile unless the rsp is extended
+  EXPECT_TRUE(tscGetQueryProfileMsg(pRsp, contLen) == NULL);
+
+  doAppendQueryProfile(pQInfo, &pRsp, &contLen);
+  ASSERT_EQ(contLen, (int32_t)(sizeof(SRetrieveTableRsp) + dataLen + sizeof(SQueryProfileMsg)));
+  EXPECT_EQ(pRsp->extend, 1);
+  EXPECT_EQ(pRsp->data[dataLen - 1], 'x');
+
+  SQueryProfileMsg *pMsg = tscGetQueryProfileMsg(pRsp, contLen);
+  ASSERT_TRUE(pMsg != NULL);
+  EXPECT_EQ((char *)pMsg, pRsp->data + dataLen);
+  EXPECT_TRUE(tscGetQueryProfileMsg(pRsp, (int32_t)sizeof(SRetrieveTableRsp)) == NULL);
+
+  // of two vnodes
+  SQueryProfileMsg total;
+  memset(&total, 0, sizeof(total));
+  tscMergeQueryProfile(&total, pMsg);
+  tscMergeQueryProfile(&total, pMsg);
+
+  EXPECT_EQ(total.elapsedTime, 2 * 123456);
+  EXPECT_EQ(total.totalBlocks, 14);
+  EXPECT_EQ(total.loadBlocks, 6);
+  EXPECT_EQ(total.loadBlockStatis, 4);
+  EXPECT_EQ(total.discardBlocks, 2);
+  EXPECT_EQ(total.totalRows, 1LL << 41);
+  EXPECT_EQ(total.totalCheckedRows, 200);
+  EXPECT_EQ(total.memRows, 0);
+  EXPECT_EQ(total.readBytes, 0);
+  EXPECT_EQ(total.spillBytes, 0);
+
+  ASSERT_EQ(total.numOfOperators, 2);
+  SOperatorProfileMsg *pScan = findOperator(&total, OP_TableScan);
+  SOperatorProfileMsg *pAgg = findOperator(&total, OP_Aggregate);
+  ASSERT_TRUE(pScan != NULL && pAgg != NULL);
+  EXPECT_EQ(pScan->execTimes, 2);
+  EXPECT_EQ(pScan->selfTime, 60);
+  EXPECT_EQ(pScan->inputRows, 0);
+  EXPECT_EQ(pScan->outputRows, 200);
+  EXPECT_EQ(pAgg->execTimes, 2);
+  EXPECT_EQ(pAgg->selfTime, 40);
+  EXPECT_EQ(pAgg->inputRows, 200);
+  EXPECT_EQ(pAgg->outputRows, 2);
+
+  rpcFreeCont(pRsp);
+  destroyQInfo(pQInfo);
+}
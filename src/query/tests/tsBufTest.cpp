@@ -161,6 +161,64 @@ void multiVnodeTagsTest() {
   tsBufDestroy(pTSBuf);
 }
 
+void groupTagListTest() {
+  STSBuf* pTSBuf = tsBufCreate(true, TSDB_ORDER_ASC);
+
+  int32_t num = 10000;
+  int32_t numOfTags = 10;
+  int32_t step = 30;
+
+  // vnode 1 holds the even tags, vnode 2 holds the odd ones
+  for (int32_t j = 1; j <= 2; ++j) {
+    int64_t  start = 10000000;
+    tVariant t = {0};
+    t.nType = TSDB_DATA_TYPE_BIGINT;
+
+    for (int32_t i = j - 1; i < numOfTags; i += 2) {
+      int64_t* list = createTsList(num, start, step);
+      t.i64 = i;
+
+      tsBufAppend(pTSBuf, j, &t, (const char*)list, num * sizeof(int64_t));
+      free(list);
+
+      start += step * num;
+    }
+  }
+
+  tsBufFlush(pTSBuf);
+
+  for (int32_t j = 1; j <= 2; ++j) {
+    SArray* pTagList = (SArray*)taosArrayInit(4, sizeof(tVariant));
+    EXPECT_EQ(tsBufGetGroupTagList(pTSBuf, j, pTagList), TSDB_CODE_SUCCESS);
+    EXPECT_EQ(taosArrayGetSize(pTagList), numOfTags / 2);
+
+    for (int32_t i = 0; i < taosArrayGetSize(pTagList); ++i) {
+      tVariant* p = (tVariant*)taosArrayGet(pTagList, i);
+      EXPECT_EQ(p->i64, i * 2 + (j - 1));
+      tVariantDestroy(p);
+    }
+
+    taosArrayDestroy(&pTagList);
+  }
+
+  // unknown group id
+  SArray* pTagList = (SArray*)taosArrayInit(4, sizeof(tVariant));
+  EXPECT_EQ(tsBufGetGroupTagList(pTSBuf, 3, pTagList), TSDB_CODE_SUCCESS);
+  EXPECT_EQ(taosArrayGetSize(pTagList), 0);
+  taosArrayDestroy(&pTagList);
+
+  // the traverse is still available after collecting the tag list
+  tsBufResetPos(pTSBuf);
+  EXPECT_TRUE(tsBufNextPos(pTSBuf));
+
+  STSElem elem = tsBufGetElem(pTSBuf);
+  EXPECT_EQ(elem.id, 1);
+  EXPECT_EQ(elem.tag->i64, 0);
+  EXPECT_EQ(elem.ts, 10000000);
+
+  tsBufDestroy(pTSBuf);
+}
+
 void loadDataTest() {
   STSBuf* pTSBuf = tsBufCreate(true, TSDB_ORDER_ASC);
 
@@ -506,6 +564,7 @@ TEST(testCase, tsBufTest) {
   largeTSTest();
   multiTagsTest();
   multiVnodeTagsTest();
+  groupTagListTest();
   loadDataTest();
   invalidFileTest();
 //    randomIncTsTest();
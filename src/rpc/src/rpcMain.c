@@ -21,6 +21,7 @@
 #include "tutil.h"
 #include "lz4.h"
 #include "tref.h"
+#include "tmetrics.h"
 #include "taoserror.h"
 #include "tsocket.h"
 #include "tglobal.h"
@@ -83,6 +84,7 @@ typedef struct {
   int8_t    redirect;   // flag to indicate redirect
   int8_t    connType;   // connection type
   int64_t   rid;        // refId returned by taosAddRef
+  int64_t   sendTime;   // when the app sent the request, in us
   SRpcMsg  *pRsp;       // for synchronous API
   tsem_t   *pSem;       // for synchronous API
   SRpcEpSet *pSet;      // for synchronous API 
@@ -135,6 +137,9 @@ int tsRpcOverhead;
 
 static int     tsRpcRefId = -1;
 static int32_t tsRpcNum = 0;
+static SMetric *tsRpcRecvMsgs = NULL;
+static SMetric *tsRpcRecvBytes = NULL;
+static SMetric *tsRpcReqLatency = NULL;
 //static pthread_once_t tsRpcInit = PTHREAD_ONCE_INIT;
 
 // server:0 client:1  tcp:2 udp:0
@@ -229,6 +234,10 @@ int32_t rpcInit(void) {
 
   tsRpcRefId = taosOpenRef(200, rpcFree);
 
+  tsRpcRecvMsgs = taosMetricCounter("taosd_rpc_received_msgs_total", "messages received from peers");
+  tsRpcRecvBytes = taosMetricCounter("taosd_rpc_received_bytes_total", "bytes received from peers");
+  tsRpcReqLatency = taosMetricHistogram("taosd_rpc_request_latency_us", "time from sending a request to its response");
+
   return 0;
 }
  
@@ -415,6 +424,8 @@ void rpcSendRequest(void *shandle, const SRpcEpSet *pEpSet, SRpcMsg *pMsg, int64
   pContext->rid = taosAddRef(tsRpcRefId, pContext);
   if (pRid) *pRid = pContext->rid;
 
+  pContext->sendTime = taosGetTimestampUs();
+
   rpcSendReqToServer(pRpc, pContext);
 }
 
@@ -1091,6 +1102,9 @@ static void *rpcProcessMsgFromPeer(SRecvInfo *pRecv) {
     return NULL;
   }
 
+  taosMetricAdd(tsRpcRecvMsgs, 1);
+  taosMetricAdd(tsRpcRecvBytes, pRecv->msgLen);
+
   terrno = 0;
   SRpcReqContext *pContext;
   pConn = rpcProcessMsgHead(pRpc, pRecv, &pContext);
@@ -1131,6 +1145,8 @@ static void *rpcProcessMsgFromPeer(SRecvInfo *pRecv) {
 static void rpcNotifyClient(SRpcReqContext *pContext, SRpcMsg *pMsg) {
   SRpcInfo       *pRpc = pContext->pRpc;
 
+  taosMetricObserve(tsRpcReqLatency, taosGetTimestampUs() - pContext->sendTime);
+
   pContext->pConn = NULL;
   if (pContext->pRsp) { 
     // for synchronous API
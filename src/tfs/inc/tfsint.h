@@ -87,6 +87,7 @@ void   tfsDestroyTier(STier *pTier);
 SDisk *tfsMountDiskToTier(STier *pTier, SDiskCfg *pCfg);
 void   tfsUpdateTierInfo(STier *pTier, STierMeta *pTierMeta);
 int    tfsAllocDiskOnTier(STier *pTier);
+int    tfsAllocDiskOnTierBySize(STier *pTier, int64_t size);
 void   tfsGetTierMeta(STier *pTier, STierMeta *pTierMeta);
 void   tfsPosNextId(STier *pTier);
 
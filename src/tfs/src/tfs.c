@@ -117,6 +117,7 @@ void tfsDestroy() {
   for (int level = 0; level < TFS_NLEVEL(); level++) {
     tfsDestroyTier(TFS_TIER_AT(level));
   }
+  pfs->nlevel = 0;
 }
 
 void tfsUpdateInfo(SFSMeta *pFSMeta, STierMeta *tierMetas, int8_t numTiers) {
@@ -181,6 +182,26 @@ void tfsAllocDisk(int expLevel, int *level, int *id) {
   *id = TFS_UNDECIDED_ID;
 }
 
+int tfsMaxLevel() { return TFS_NLEVEL() - 1; }
+
+/* Allocate a disk for a file of the given size, balanced by free space across the disks of the tier
+ */
+void tfsAllocDiskBySize(int expLevel, int64_t size, int *level, int *id) {
+  ASSERT(expLevel >= 0);
+
+  *level = MIN(expLevel, TFS_NLEVEL() - 1);
+  *id = TFS_UNDECIDED_ID;
+
+  while (*level >= 0) {
+    *id = tfsAllocDiskOnTierBySize(TFS_TIER_AT(*level), size);
+    if (*id != TFS_UNDECIDED_ID) return;
+    (*level)--;
+  }
+
+  *level = TFS_UNDECIDED_LEVEL;
+  *id = TFS_UNDECIDED_ID;
+}
+
 const char *TFS_PRIMARY_PATH() { return DISK_DIR(TFS_PRIMARY_DISK()); }
 const char *TFS_DISK_PATH(int level, int id) { return DISK_DIR(TFS_DISK_AT(level, id)); }
 
@@ -146,6 +146,33 @@ int tfsAllocDiskOnTier(STier *pTier) {
   return id;
 }
 
+// Allocate the disk with the most free space which can hold size bytes. The size is taken from the free space of
+// the disk until the next tfsUpdateTierInfo, so large files allocated in a row spread over the disks of the tier
+int tfsAllocDiskOnTierBySize(STier *pTier, int64_t size) {
+  ASSERT(pTier->ndisk > 0);
+  int id = TFS_UNDECIDED_ID;
+
+  tfsLockTier(pTier);
+
+  // start from nextid, so disks with the same free space, e.g. on one file system, are taken in turn
+  for (int i = 0; i < pTier->ndisk; i++) {
+    int    cid = (pTier->nextid + i) % pTier->ndisk;
+    SDisk *pDisk = DISK_AT_TIER(pTier, cid);
+    if (DISK_FREE_SIZE(pDisk) - size < TFS_MIN_DISK_FREE_SIZE) continue;
+    if (id == TFS_UNDECIDED_ID || DISK_FREE_SIZE(pDisk) > DISK_FREE_SIZE(DISK_AT_TIER(pTier, id))) {
+      id = cid;
+    }
+  }
+
+  if (id != TFS_UNDECIDED_ID) {
+    DISK_FREE_SIZE(DISK_AT_TIER(pTier, id)) -= size;
+    pTier->nextid = (id + 1) % pTier->ndisk;
+  }
+
+  tfsUnLockTier(pTier);
+  return id;
+}
+
 void tfsGetTierMeta(STier *pTier, STierMeta *pTierMeta) {
   ASSERT(pTierMeta != NULL);
 
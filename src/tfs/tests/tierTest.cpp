@@ -0,0 +1,45 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "tfsint.h"
+
+#define MB (1024 * 1024L)
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+TEST(TfsTierTest, allocDiskBySize) {
+  STier    tier;
+  SDiskCfg cfg = {0};
+  int64_t  frees[] = {100 * MB, 200 * MB, 200 * MB};
+
+  ASSERT_EQ(tfsInitTier(&tier, 1), 0);
+  for (int id = 0; id < 3; id++) {
+    snprintf(cfg.dir, sizeof(cfg.dir), "/tmp/tfsTest/disk%d", id);
+    cfg.level = 1;
+    ASSERT_TRUE(tfsMountDiskToTier(&tier, &cfg) != NULL);
+    DISK_FREE_SIZE(DISK_AT_TIER(&tier, id)) = frees[id];
+  }
+
+  // the disk with the most space left, the tie taken in turn
+  EXPECT_EQ(tfsAllocDiskOnTierBySize(&tier, 60 * MB), 1);
+  EXPECT_EQ(tfsAllocDiskOnTierBySize(&tier, 60 * MB), 2);
+  EXPECT_EQ(tfsAllocDiskOnTierBySize(&tier, 60 * MB), 1);
+  EXPECT_EQ(DISK_FREE_SIZE(DISK_AT_TIER(&tier, 0)), 100 * MB);
+  EXPECT_EQ(DISK_FREE_SIZE(DISK_AT_TIER(&tier, 1)), 80 * MB);
+  EXPECT_EQ(DISK_FREE_SIZE(DISK_AT_TIER(&tier, 2)), 140 * MB);
+
+  // no disk keeps TFS_MIN_DISK_FREE_SIZE free after it
+  EXPECT_EQ(tfsAllocDiskOnTierBySize(&tier, 100 * MB), TFS_UNDECIDED_ID);
+  EXPECT_EQ(DISK_FREE_SIZE(DISK_AT_TIER(&tier, 2)), 140 * MB);
+
+  // exactly TFS_MIN_DISK_FREE_SIZE left is fine
+  EXPECT_EQ(tfsAllocDiskOnTierBySize(&tier, 90 * MB), 2);
+  EXPECT_EQ(tfsAllocDiskOnTierBySize(&tier, 50 * MB), 0);
+  EXPECT_EQ(tfsAllocDiskOnTierBySize(&tier, 30 * MB), 1);
+  EXPECT_EQ(tfsAllocDiskOnTierBySize(&tier, 1 * MB), TFS_UNDECIDED_ID);
+
+  tfsDestroyTier(&tier);
+}
@@ -32,6 +32,8 @@ typedef struct {
   int            nElasticBlocks;
   int64_t        index;
   SList*         bufBlockList;  
+  int32_t        nFreeBlocks;  // blocks of bufBlockList and all the blocks of the pool, set under the repo lock and
+  int32_t        nAllBlocks;   // read atomically without it by the commit queue
 } STsdbBufPool;
 
 #define TSDB_BUFFER_RESERVE 1024  // Reseve 1K as commit threshold
@@ -43,6 +45,7 @@ void          tsdbCloseBufPool(STsdbRepo* pRepo);
 SListNode*    tsdbAllocBufBlockFromPool(STsdbRepo* pRepo);
 int           tsdbExpandPool(STsdbRepo* pRepo, int32_t oldTotalBlocks);
 void          tsdbRecycleBufferBlock(STsdbBufPool* pPool, SListNode *pNode, bool bELastic);
+void          tsdbUpdatePoolBlocks(STsdbBufPool* pPool);
 
 // health cite
 STsdbBufBlock *tsdbNewBufBlock(int bufBlockSize);
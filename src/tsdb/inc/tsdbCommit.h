@@ -30,6 +30,8 @@ typedef struct {
 } SKVRecord;
 
 #define TSDB_DEFAULT_BLOCK_ROWS(maxRows) ((maxRows)*4 / 5)
+#define TSDB_BLOCK_HIT_ROWS_FACTOR 16  // rows of a block per row the queries take from it
+#define TSDB_BLOCK_ROWS_HYSTERESIS 2   // times the rows of the blocks of a table are off before they move
 
 void  tsdbGetRtnSnap(STsdbRepo *pRepo, SRtn *pRtn);
 int   tsdbEncodeKVRecord(void **buf, SKVRecord *pRecord);
@@ -41,6 +43,7 @@ int tsdbWriteBlockIdx(SDFile *pHeadf, SArray *pIdxA, void **ppBuf);
 int   tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile *pDFileAggr, SDataCols *pDataCols,
                          SBlock *pBlock, bool isLast, bool isSuper, void **ppBuf, void **ppCBuf, void **ppExBuf);
 int   tsdbApplyRtn(STsdbRepo *pRepo);
+int   tsdbTableMaxBlockRows(STsdbRepo *pRepo, STable *pTable);
 
 // commit control command 
 int tsdbCommitControl(STsdbRepo* pRepo, SControlDataInfo* pCtlDataInfo);
@@ -24,6 +24,10 @@ typedef enum {
   COMMIT_CONFIG_REQ,
 } TSDB_REQ_T;
 
-int tsdbScheduleCommit(STsdbRepo *pRepo, void* param, TSDB_REQ_T req);
+// Below this factor the early commit threshold totalBlocks/earlyCommitFactor is not earlier than the normal one.
+#define TSDB_MIN_EARLY_COMMIT_FACTOR 4
+
+int  tsdbScheduleCommit(STsdbRepo *pRepo, void* param, TSDB_REQ_T req);
+bool tsdbNeedEarlyCommit(int totalBlocks, int nMemBlocks);
 
 #endif /* _TD_TSDB_COMMIT_QUEUE_H_ */
\ No newline at end of file
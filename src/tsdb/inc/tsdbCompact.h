@@ -19,7 +19,34 @@
 extern "C" {
 #endif
 
-void *tsdbCompactImpl(STsdbRepo *pRepo);
+typedef struct {
+  int     fid;
+  int64_t headSize;  // sizes of the files when the file set was scored, it is scored again when they change
+  int64_t dataSize;
+  int64_t lastSize;
+  double  score;
+} SCompactScore;
+
+// what the fragmentation of a file set is scored by
+typedef struct {
+  int     tblocks;       // total blocks
+  int     nSubBlocks;    // # of blocks with sub-blocks
+  int     nSmallBlocks;  // # of blocks with rows < defaultRows or > maxRows of the table
+  int64_t usedSize;      // bytes of the data and last files used by the blocks
+  int64_t fileSize;      // bytes of the data and last files
+} SCompactStat;
+
+// request of a background compaction, which compacts the most fragmented file set only
+typedef struct {
+  double minScore;
+  int    fid;
+  bool   yielded;  // a commit waits, the tables not compacted yet are kept as they are
+} SCompactReq;
+
+void  *tsdbCompactImpl(STsdbRepo *pRepo, SCompactReq *pReq);
+double tsdbCalcCompactScore(const SCompactStat *pStat);
+int    tsdbPickCompactScore(SArray *aScores, double minScore, int *candidates);
+bool   tsdbCompactBackedOff(int32_t yields, int64_t yieldTime, int64_t now);
 
 #ifdef __cplusplus
 }
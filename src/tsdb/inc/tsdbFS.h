@@ -64,6 +64,20 @@ typedef struct {
   SArray*     df;    // data file array
 } SFSStatus;
 
+// tids of the tables with blocks in a file set version and where their last keys are, the readers skip the file sets
+// without any block of the tables they read in the query window before opening them
+typedef struct {
+  int      fid;
+  char     hname[TSDB_FILENAME_LEN];  // name and magic of the head file identify the version
+  uint32_t hmagic;
+  int32_t  maxTid;
+  TSKEY    minKey;   // the key range of the file set is cut into TSDB_TBLIDX_PARTS parts of partLen
+  int64_t  partLen;
+  uint8_t* lastParts;  // 0 if table tid has no block in the file set, or else its last key is before part lastParts[tid]
+} SFSetTblIdx;
+
+#define TSDB_TBLIDX_PARTS 255
+
 typedef struct {
   pthread_rwlock_t lock;
 
@@ -72,6 +86,9 @@ typedef struct {
   SHashObj*  metaCacheComp;   // meta cache for compact
   bool       intxn;
   SFSStatus* nstatus;  // new status
+
+  pthread_mutex_t tblIdxMutex;
+  SArray*         tblIdx;  // SFSetTblIdx sorted by fid, of the file sets in the current status
 } STsdbFS;
 
 #define FS_CURRENT_STATUS(pfs) ((pfs)->cstatus)
@@ -107,6 +124,8 @@ void       tsdbFSIterInit(SFSIter *pIter, STsdbFS *pfs, int direction);
 void       tsdbFSIterSeek(SFSIter *pIter, int fid);
 SDFileSet *tsdbFSIterNext(SFSIter *pIter);
 int        tsdbLoadMetaCache(STsdbRepo *pRepo, bool recoverMeta);
+void       tsdbFSSetTblIdx(STsdbFS *pfs, const SDFileSet *pSet, SArray *aBlkIdx, TSKEY minKey, TSKEY maxKey);
+int        tsdbFSetHasTables(STsdbFS *pfs, const SDFileSet *pSet, const int32_t *tids, int ntids, TSKEY skey);
 
 static FORCE_INLINE int tsdbRLockFS(STsdbFS* pFs) {
   int code = pthread_rwlock_rdlock(&(pFs->lock));
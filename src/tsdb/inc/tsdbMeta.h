@@ -51,6 +51,10 @@ typedef struct STable {
   bool           hasRestoreLastColumn;
   int            lastColSVersion;
   int16_t        cacheLastConfigVersion;
+  int32_t        blkBytesPerRow;  // compressed bytes per row of the data blocks written, for block sizing
+  int32_t        blkHitRows;      // rows the queries take from each data block loaded, for block sizing
+  int32_t        blkMaxRows;      // max rows of the data blocks of the table, from the two stats above
+  struct SHotCols* hotCols;       // columns the queries load, written next to each other in the data blocks
   T_REF_DECLARE()
 } STable;
 
@@ -67,12 +71,16 @@ typedef struct {
 } STsdbMeta;
 
 #define TSDB_INIT_NTABLES 1024
+#define TSDB_HOT_COLS_BYTES (TSDB_MAX_COLUMNS / 8)  // bitmap of the column ids, the ones beyond are never hot
+#define TSDB_IS_HOT_COL(bitmap, colId) \
+  ((colId) >= 0 && (colId) < TSDB_MAX_COLUMNS && ((bitmap)[(colId) / 8] & (1 << ((colId) % 8))) != 0)
 #define TABLE_TYPE(t) (t)->type
 #define TABLE_NAME(t) (t)->name
 #define TABLE_CHAR_NAME(t) TABLE_NAME(t)->data
 #define TABLE_UID(t) (t)->tableId.uid
 #define TABLE_TID(t) (t)->tableId.tid
 #define TABLE_SUID(t) (t)->suid
+#define TABLE_BLK_STAT(t) ((TABLE_TYPE(t) == TSDB_CHILD_TABLE) ? (t)->pSuper : (t))  // child tables share the stats
 // #define TSDB_META_FILE_MAGIC(m) KVSTORE_MAGIC((m)->pStore)
 #define TSDB_RLOCK_TABLE(t) taosRLockLatch(&((t)->latch))
 #define TSDB_RUNLOCK_TABLE(t) taosRUnLockLatch(&((t)->latch))
@@ -90,6 +98,10 @@ int        tsdbRLockRepoMeta(STsdbRepo* pRepo);
 int        tsdbUnlockRepoMeta(STsdbRepo* pRepo);
 void       tsdbRefTable(STable* pTable);
 void       tsdbUnRefTable(STable* pTable);
+void       tsdbUpdateBlkBytesPerRow(STable* pTable, int rows, int len);
+void       tsdbUpdateBlkHitRows(STable* pTable, int64_t rows, int64_t blocks, int32_t maxRows);
+void       tsdbUpdateHotCols(STable* pTable, int16_t* colIds, int numOfColIds);
+bool       tsdbGetHotCols(STable* pTable, uint8_t* bitmap);
 void       tsdbUpdateTableSchema(STsdbRepo* pRepo, STable* pTable, STSchema* pSchema, bool insertAct);
 int        tsdbRestoreTable(STsdbRepo* pRepo, void* cont, int contLen);
 void       tsdbOrgMeta(STsdbRepo* pRepo);
@@ -51,13 +51,16 @@ typedef struct {
 #endif
 
 /**
+ * bloom;      // some column of the block has a bloom filter in .smad/.smal. The top bit of the algorithm byte, which
+ *             // the blocks written before it leave 0
  * keyLen;     // key column length, keyOffset = offset+sizeof(SBlockData)+sizeof(SBlockCol)*numOfCols
  * numOfCols;  // not including timestamp column
  */
 #define SBlockFieldsP0    \
   int64_t last : 1;       \
   int64_t offset : 63;    \
-  int32_t algorithm : 8;  \
+  int32_t algorithm : 7;  \
+  int32_t bloom : 1;      \
   int32_t numOfRows : 24; \
   int32_t len;            \
   int32_t keyLen;         \
@@ -120,7 +123,7 @@ typedef struct {
 typedef struct {
   int16_t  colId;
   uint8_t  offsetH;
-  uint8_t  reserved;  // reserved field, not used
+  uint8_t  flags;  // TSDB_BLOCK_COL_BLOOM, 0 in the blocks written before
   int32_t  len;
   uint32_t type : 8;
   uint32_t offset : 24;
@@ -128,6 +131,14 @@ typedef struct {
 
 #define SBlockCol SBlockColV1      // latest SBlockCol definition
 
+#define TSDB_BLOCK_COL_BLOOM 0x1  // the column has a bloom filter in .smad/.smal
+
+// The bloom filters of a block follow its aggr part in .smad/.smal, TSDB_BLOOM_BYTES(numOfRows) bytes for each column
+// flagged TSDB_BLOCK_COL_BLOOM in the order of the SBlockCol part, then a checksum of them all.
+#define TSDB_BLOOM_BITS_PER_ROW 10  // about 1% false positives with 7 hashes
+#define TSDB_BLOOM_HASHES 7
+#define TSDB_BLOOM_BYTES(rows) ((((int32_t)(rows) * TSDB_BLOOM_BITS_PER_ROW + 63) / 64) * 8)
+
 typedef struct {
   int16_t colId;
   int16_t maxIndex;
@@ -161,20 +172,48 @@ typedef struct {
 
 typedef void SAggrBlkData;  // SBlockCol cols[];
 
+// head file of a file set version mapped read-only, shared by the readers of the version
+typedef struct SHeadMap {
+  struct SHeadMap *next;
+  char             fname[TSDB_FILENAME_LEN];
+  int              fid;
+  ino_t            ino;  // a file written again under the same name is mapped again
+  int64_t          size;
+  int32_t          refCount;
+  bool             stale;  // out of the cache, unmapped when the last reader releases it
+  void *           addr;
+  SArray *         aBlkIdx;  // SBlockIdx array decoded from the mapped file
+} SHeadMap;
+
+typedef struct {
+  pthread_mutex_t mutex;
+  SHeadMap *      maps;     // the most recently acquired first
+  int             nmaps;
+  int             maxMaps;  // the least recently acquired maps beyond it are dropped once no reader holds them
+} SHeadMapCache;
+
 struct SReadH {
   STsdbRepo * pRepo;
   SDFileSet   rSet;     // FSET to read
   SArray *    aBlkIdx;  // SBlockIdx array
+  SHeadMap *  pHeadMap; // mapped head file of rSet, aBlkIdx is not used if it is set
   STable *    pTable;   // table to read
   SBlockIdx * pBlkIdx;  // current reading table SBlockIdx
   int         cidx;
-  SBlockInfo *  pBlkInfo;  // SBlockInfoV#
+  SBlockInfo *  pBlkInfo;  // SBlockInfoV#, points into pHeadMap or pBlkInfoBuf
+  SBlockInfo *  pBlkInfoBuf;
   SBlockData *pBlkData;  // Block info
   SAggrBlkData *pAggrBlkData;  // Aggregate Block info
+  void *      pBloomBuf;    // column ids and bloom filters of the block at bloomOffset
+  int64_t     bloomOffset;  // offset of the block whose bloom filters are loaded, 0 if none
+  bool        bloomLast;
+  int         nBlooms;
   SDataCols * pDCols[2];
   void *      pBuf;   // buffer
   void *      pCBuf;  // compression buffer
   void *      pExBuf;  // extra buffer
+  int64_t     readBytes;    // bytes read from the data files, through a head map included
+  int64_t     decodeBytes;  // bytes of the column data after decompression
 };
 
 #define TSDB_READ_REPO(rh) ((rh)->pRepo)
@@ -186,6 +225,7 @@ struct SReadH {
 #define TSDB_READ_LAST_FILE(rh) TSDB_DFILE_IN_SET(TSDB_READ_FSET(rh), TSDB_FILE_LAST)
 #define TSDB_READ_SMAD_FILE(rh) TSDB_DFILE_IN_SET(TSDB_READ_FSET(rh), TSDB_FILE_SMAD)
 #define TSDB_READ_SMAL_FILE(rh) TSDB_DFILE_IN_SET(TSDB_READ_FSET(rh), TSDB_FILE_SMAL)
+#define TSDB_READ_BLKIDX_ARRAY(rh) ((rh)->pHeadMap ? (rh)->pHeadMap->aBlkIdx : (rh)->aBlkIdx)
 #define TSDB_READ_BUF(rh) ((rh)->pBuf)
 #define TSDB_READ_COMP_BUF(rh) ((rh)->pCBuf)
 #define TSDB_READ_EXBUF(rh) ((rh)->pExBuf)
@@ -224,12 +264,26 @@ int   tsdbLoadBlockIdx(SReadH *pReadh);
 int   tsdbSetReadTable(SReadH *pReadh, STable *pTable);
 int   tsdbLoadBlockInfo(SReadH *pReadh, void **pTarget, uint32_t *extendedLen);
 int   tsdbLoadBlockData(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlockInfo);
+int   tsdbLoadBlockDelta(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo);
 int   tsdbLoadBlockDataCols(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo, int16_t *colIds, int numOfColsIds);
 int   tsdbLoadBlockStatis(SReadH *pReadh, SBlock *pBlock);
 int   tsdbLoadBlockOffset(SReadH *pReadh, SBlock *pBlock);
 int   tsdbEncodeSBlockIdx(void **buf, SBlockIdx *pIdx);
 void *tsdbDecodeSBlockIdx(void *buf, SBlockIdx *pIdx);
 void  tsdbGetBlockStatis(SReadH *pReadh, SDataStatis *pStatis, int numOfCols, SBlock *pBlock);
+int   tsdbBlockMayHaveValue(SReadH *pReadh, SBlock *pBlock, int16_t colId, int8_t type, const void *val);
+
+// tsdbBloom.c
+bool    tsdbBloomColType(int8_t type);
+int32_t tsdbBloomKey(int8_t type, const void *val, const void **ppKey);
+void    tsdbBloomAdd(uint8_t *pBloom, int32_t nbytes, const void *key, int32_t len);
+bool    tsdbBloomMayContain(const uint8_t *pBloom, int32_t nbytes, const void *key, int32_t len);
+
+// tsdbHeadMap.c
+int       tsdbInitHeadMaps(STsdbRepo *pRepo);
+void      tsdbDestroyHeadMaps(STsdbRepo *pRepo);
+SHeadMap *tsdbAcquireHeadMap(STsdbRepo *pRepo, SDFileSet *pSet);
+void      tsdbReleaseHeadMap(STsdbRepo *pRepo, SHeadMap *pMap);
 
 static FORCE_INLINE int tsdbMakeRoom(void **ppBuf, size_t size) {
   void * pBuf = *ppBuf;
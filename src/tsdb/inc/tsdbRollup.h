@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TD_TSDB_ROLLUP_H_
+#define _TD_TSDB_ROLLUP_H_
+
+#define TSDB_ROLLUP_DIR "rollup"  // under the tsdb root dir, on the primary disk
+
+typedef union {
+  int64_t  i64;
+  uint64_t u64;
+  double   f64;
+} SRollupVal;
+
+// The values of a numeric column of a table in one hour. sum, min and max are i64 for the signed types, u64 for the
+// unsigned ones and f64 for float and double
+typedef struct {
+  uint64_t   uid;
+  TSKEY      skey;  // first key of the hour
+  int16_t    colId;
+  int8_t     type;
+  int64_t    count;  // rows with a value in the column
+  SRollupVal sum;
+  SRollupVal min;
+  SRollupVal max;
+} SRollupRec;
+
+// the rows of a table in [skey, ekey] changed in a file set, and the hours over them are to be rolled up again
+typedef struct {
+  STable *pTable;
+  TSKEY   skey;
+  TSKEY   ekey;
+} SRollupRange;
+
+int tsdbUpdateRollup(STsdbRepo *pRepo, SDFileSet *pSet, SArray *aRanges);
+int tsdbApplyRollupRtn(STsdbRepo *pRepo, int minFid);
+int tsdbReadRollup(STsdbRepo *pRepo, uint64_t uid, TSKEY skey, TSKEY ekey, SArray *pRecs);
+
+#endif /* _TD_TSDB_ROLLUP_H_ */
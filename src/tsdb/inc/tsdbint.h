@@ -70,6 +70,8 @@ extern "C" {
 #include "tsdbDelete.h"
 // Commit Queue
 #include "tsdbCommitQueue.h"
+// Rollup
+#include "tsdbRollup.h"
 
 #include "tsdbRowMergeBuf.h"
 // Main definitions
@@ -99,7 +101,13 @@ struct STsdbRepo {
 
   SMergeBuf       mergeBuf;  //used when update=2
   int8_t          compactState;  // compact state: inCompact/noCompact/waitingCompact?
+  int32_t         compactCandidates;  // file sets left for background compaction when it last scored them
+  SArray*         compactScores;      // SCompactScore, fragmentation of the file sets as last scored
+  int32_t         commitWaiting;      // writers waiting for the running commit or compaction to finish
+  int32_t         compactYields;      // background compactions yielded to commits in a row
+  int64_t         compactYieldTime;   // when the last one yielded, in ms
   int8_t          deleteState;  // truncate state: inTruncate/noTruncate/waitingTruncate
+  SHeadMapCache   headMaps;     // head files mapped for the readers
 
   pthread_t*      pthread;
 };
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tglobal.h"
+#include "hashfunc.h"
+#include "tsdbint.h"
+
+// Bloom filters of the columns of a data block, a value is added with its bytes as stored in the block, i.e. the
+// payload of a binary or nchar value and the fixed bytes of an integer. The TSDB_BLOOM_HASHES bit positions are
+// derived from one hash of the value by double hashing.
+
+// if the columns of the type get bloom filters in the blocks written
+bool tsdbBloomColType(int8_t type) {
+  if (tsBloomFilter >= 1 && IS_VAR_DATA_TYPE(type)) return true;
+  if (tsBloomFilter >= 2 && (IS_SIGNED_NUMERIC_TYPE(type) || IS_UNSIGNED_NUMERIC_TYPE(type))) return true;
+  return false;
+}
+
+// return the length of the key of the value, -1 if values of the type have no bloom filter
+int32_t tsdbBloomKey(int8_t type, const void *val, const void **ppKey) {
+  if (IS_VAR_DATA_TYPE(type)) {
+    *ppKey = varDataVal(val);
+    return varDataLen(val);
+  }
+
+  if (IS_SIGNED_NUMERIC_TYPE(type) || IS_UNSIGNED_NUMERIC_TYPE(type)) {
+    *ppKey = val;
+    return TYPE_BYTES[type];
+  }
+
+  return -1;
+}
+
+void tsdbBloomAdd(uint8_t *pBloom, int32_t nbytes, const void *key, int32_t len) {
+  uint32_t nbits = (uint32_t)nbytes * 8;
+  uint32_t h = MurmurHash3_32((const char *)key, (uint32_t)len);
+  uint32_t delta = (h >> 17) | (h << 15);
+
+  for (int i = 0; i < TSDB_BLOOM_HASHES; i++) {
+    uint32_t bit = h % nbits;
+    pBloom[bit / 8] |= (uint8_t)(1 << (bit % 8));
+    h += delta;
+  }
+}
+
+bool tsdbBloomMayContain(const uint8_t *pBloom, int32_t nbytes, const void *key, int32_t len) {
+  uint32_t nbits = (uint32_t)nbytes * 8;
+  uint32_t h = MurmurHash3_32((const char *)key, (uint32_t)len);
+  uint32_t delta = (h >> 17) | (h << 15);
+
+  for (int i = 0; i < TSDB_BLOOM_HASHES; i++) {
+    uint32_t bit = h % nbits;
+    if ((pBloom[bit / 8] & (1 << (bit % 8))) == 0) return false;
+    h += delta;
+  }
+
+  return true;
+}
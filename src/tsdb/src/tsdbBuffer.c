@@ -82,6 +82,7 @@ int tsdbOpenBufPool(STsdbRepo *pRepo) {
 
     pPool->nBufBlocks++;
   }
+  tsdbUpdatePoolBlocks(pPool);
 
   tsdbDebug("vgId:%d buffer pool is opened! bufBlockSize:%d tBufBlocks:%d nBufBlocks:%d", REPO_ID(pRepo),
             pPool->bufBlockSize, pPool->tBufBlocks, pPool->nBufBlocks);
@@ -137,6 +138,7 @@ SListNode *tsdbAllocBufBlockFromPool(STsdbRepo *pRepo) {
 
   SListNode *    pNode = tdListPopHead(pBufPool->bufBlockList);
   ASSERT(pNode != NULL);
+  tsdbUpdatePoolBlocks(pBufPool);
   STsdbBufBlock *pBufBlock = NULL;
   tdListNodeGetData(pBufPool->bufBlockList, pNode, (void *)(&pBufBlock));
 
@@ -195,6 +197,7 @@ int tsdbExpandPool(STsdbRepo* pRepo, int32_t oldTotalBlocks) {
   } 
 
 err:
+  tsdbUpdatePoolBlocks(pPool);
   tsdbUnlockRepo(pRepo);
   return err;
 }
@@ -211,4 +214,10 @@ void tsdbRecycleBufferBlock(STsdbBufPool* pPool, SListNode *pNode, bool bELastic
   }
   else
     pPool->nBufBlocks--;
-}
\ No newline at end of file
+}
+
+// Publish the free and all the blocks of the pool, must be called with the repo locked once the pool changed
+void tsdbUpdatePoolBlocks(STsdbBufPool *pPool) {
+  atomic_store_32(&pPool->nFreeBlocks, listNEles(pPool->bufBlockList));
+  atomic_store_32(&pPool->nAllBlocks, pPool->nBufBlocks + pPool->nElasticBlocks);
+}
@@ -34,6 +34,7 @@ typedef struct {
   STable *     pTable;
   SArray *     aSupBlk;  // Table super-block array
   SArray *     aSubBlk;  // table sub-block array
+  SArray *     aRollup;  // SRollupRange of the tables committed to the FSET
   SDataCols *  pDataCols;
 } SCommitH;
 
@@ -57,7 +58,7 @@ static int64_t tsTickPerHour[] = {3600000L, 3600000000L, 3600000000000L};
 #define TSDB_COMMIT_BUF(ch) TSDB_READ_BUF(&((ch)->readh))
 #define TSDB_COMMIT_COMP_BUF(ch) TSDB_READ_COMP_BUF(&((ch)->readh))
 #define TSDB_COMMIT_EXBUF(ch) TSDB_READ_EXBUF(&((ch)->readh))
-#define TSDB_COMMIT_DEFAULT_ROWS(ch) TSDB_DEFAULT_BLOCK_ROWS(TSDB_COMMIT_REPO(ch)->config.maxRowsPerFileBlock)
+#define TSDB_COMMIT_DEFAULT_ROWS(ch) TSDB_DEFAULT_BLOCK_ROWS(tsdbTableMaxBlockRows(TSDB_COMMIT_REPO(ch), TSDB_COMMIT_TABLE(ch)))
 #define TSDB_COMMIT_TXN_VERSION(ch) FS_TXN_VERSION(REPO_FS(TSDB_COMMIT_REPO(ch)))
 
 static int  tsdbCommitMeta(STsdbRepo *pRepo);
@@ -82,6 +83,7 @@ static int  tsdbWriteBlockInfo(SCommitH *pCommih);
 static int  tsdbCommitMemData(SCommitH *pCommith, SCommitIter *pIter, TSKEY keyLimit, bool toData);
 static int  tsdbMergeMemData(SCommitH *pCommith, SCommitIter *pIter, int bidx);
 static int  tsdbMoveBlock(SCommitH *pCommith, int bidx);
+static void tsdbWriteBlockBloom(SDataCols *pDataCols, SBlockData *pBlockData, void *pBloom, int32_t bloomBytes);
 static int  tsdbCommitAddBlock(SCommitH *pCommith, const SBlock *pSupBlock, const SBlock *pSubBlocks, int nSubBlocks);
 static int  tsdbMergeBlockData(SCommitH *pCommith, SCommitIter *pIter, SDataCols *pDataCols, TSKEY keyLimit,
                                bool isLastOneBlock);
@@ -137,6 +139,15 @@ int tsdbApplyRtnOnFSet(STsdbRepo *pRepo, SDFileSet *pSet, SRtn *pRtn) {
 
   level = tsdbGetFidLevel(pSet->fid, pRtn);
 
+  if (tsMigrateInterval > 0) {
+    // The FSET is copied to the higher level in background by tsdbMigrate, and commits go on with it where it is
+    if (MIN(level, tfsMaxLevel()) > TSDB_FSET_LEVEL(pSet)) {
+      tsdbDebug("vgId:%d FSET %d on level %d is left to migrate to level %d in background", REPO_ID(pRepo),
+                pSet->fid, TSDB_FSET_LEVEL(pSet), level);
+    }
+    return tsdbUpdateDFileSet(pfs, pSet);
+  }
+
   tfsAllocDisk(level, &(did.level), &(did.id));
   if (did.level == TFS_UNDECIDED_LEVEL) {
     terrno = TSDB_CODE_TDB_NO_AVAIL_DISK;
@@ -177,6 +188,7 @@ int tsdbWriteBlockInfoImpl(SDFile *pHeadf, STable *pTable, SArray *pSupA, SArray
   SBlockInfo *pBlkInfo;
   int64_t     offset;
   SBlock *    pBlock;
+  uint32_t    padding;
 
   memset(pIdx, 0, sizeof(*pIdx));
 
@@ -188,9 +200,12 @@ int tsdbWriteBlockInfoImpl(SDFile *pHeadf, STable *pTable, SArray *pSupA, SArray
     return 0;
   }
 
+  // SBlockInfo starts at an aligned offset, so the readers use it in place in the mapped head file
+  padding = (uint32_t)((sizeof(int64_t) - pHeadf->info.size % sizeof(int64_t)) % sizeof(int64_t));
   tlen = (uint32_t)(sizeof(SBlockInfo) + sizeof(SBlock) * (nSupBlocks + nSubBlocks) + sizeof(TSCKSUM));
-  if (tsdbMakeRoom(ppBuf, tlen) < 0) return -1;
-  pBlkInfo = *ppBuf;
+  if (tsdbMakeRoom(ppBuf, padding + tlen) < 0) return -1;
+  memset(*ppBuf, 0, padding);
+  pBlkInfo = POINTER_SHIFT(*ppBuf, padding);
 
   pBlkInfo->delimiter = TSDB_FILE_DELIMITER;
   pBlkInfo->tid = TABLE_TID(pTable);
@@ -211,9 +226,10 @@ int tsdbWriteBlockInfoImpl(SDFile *pHeadf, STable *pTable, SArray *pSupA, SArray
 
   taosCalcChecksumAppend(0, (uint8_t *)pBlkInfo, tlen);
 
-  if (tsdbAppendDFile(pHeadf, (void *)pBlkInfo, tlen, &offset) < 0) {
+  if (tsdbAppendDFile(pHeadf, *ppBuf, padding + tlen, &offset) < 0) {
     return -1;
   }
+  offset += padding;
 
   tsdbUpdateDFileMagic(pHeadf, POINTER_SHIFT(pBlkInfo, tlen - sizeof(TSCKSUM)));
 
@@ -396,6 +412,47 @@ void *tsdbDecodeKVRecord(void *buf, SKVRecord *pRecord) {
   return buf;
 }
 
+// Max rows of the data blocks of a table. The blocks of a wide table hold fewer rows than the blocks of a narrow one:
+// with tsBlockTargetSize set, a block holds about that many compressed bytes, from the bytes per row of the blocks
+// written so far. The blocks of a table the range queries take few rows from, counted over the queries that loaded more
+// than one of its blocks, hold a few times those rows, so that these decompress less. The rows are bounded by the rows
+// per block of the database. tsBlockTargetSize is 0 by default, and the stats behind it are in memory only, so that the
+// sizing starts over after a restart.
+//
+// The stats are moving averages, so the rows follow them only once they are off by TSDB_BLOCK_ROWS_HYSTERESIS times.
+// The blocks written meanwhile keep the size compaction scores them against, and are not rewritten for a small drift.
+int tsdbTableMaxBlockRows(STsdbRepo *pRepo, STable *pTable) {
+  STsdbCfg *pCfg = REPO_CFG(pRepo);
+  int       maxRows = pCfg->maxRowsPerFileBlock;
+  int       minRows = pCfg->minRowsPerFileBlock * 2;
+
+  if (tsBlockTargetSize <= 0) return maxRows;
+
+  STable *pStat = TABLE_BLK_STAT(pTable);
+  int32_t bytesPerRow = atomic_load_32(&pStat->blkBytesPerRow);
+  int32_t hitRows = atomic_load_32(&pStat->blkHitRows);
+  int32_t curRows = atomic_load_32(&pStat->blkMaxRows);
+  int64_t rows = maxRows;
+
+  if (bytesPerRow > 0) rows = MIN(rows, tsBlockTargetSize / bytesPerRow);
+  if (hitRows > 0) rows = MIN(rows, (int64_t)hitRows * TSDB_BLOCK_HIT_ROWS_FACTOR);
+
+  // the default rows of a block, 4/5 of the max, stay above the min rows so that blocks go to the data file
+  rows = MAX(rows, minRows);
+  rows = MIN(rows, maxRows);
+
+  if (curRows > 0) {
+    curRows = MAX(curRows, minRows);
+    curRows = MIN(curRows, maxRows);
+    if (rows * TSDB_BLOCK_ROWS_HYSTERESIS > curRows && rows < (int64_t)curRows * TSDB_BLOCK_ROWS_HYSTERESIS) {
+      return curRows;
+    }
+  }
+
+  atomic_store_32(&pStat->blkMaxRows, (int32_t)rows);
+  return (int)rows;
+}
+
 void tsdbGetRtnSnap(STsdbRepo *pRepo, SRtn *pRtn) {
   STsdbCfg *pCfg = REPO_CFG(pRepo);
   TSKEY     minKey, midKey, maxKey, now;
@@ -630,6 +687,10 @@ static int tsdbCommitTSData(STsdbRepo *pRepo) {
     return -1;
   }
 
+  if (REPO_CFG(pRepo)->rollup) {
+    tsdbApplyRollupRtn(pRepo, commith.rtn.minFid);
+  }
+
   // Skip expired memory data and expired FSET
   tsdbSeekCommitIter(&commith, commith.rtn.minKey);
   while ((pSet = tsdbFSIterNext(&(commith.fsIter)))) {
@@ -782,9 +843,16 @@ static int tsdbCommitToFile(SCommitH *pCommith, SDFileSet *pSet, int fid) {
   // Close commit file
   tsdbCloseCommitFile(pCommith, false);
 
+  if (tsdbUpdateRollup(pRepo, TSDB_COMMIT_WRITE_FSET(pCommith), pCommith->aRollup) < 0) {
+    // revert the file change
+    tsdbApplyDFileSetChange(TSDB_COMMIT_WRITE_FSET(pCommith), pSet);
+    return -1;
+  }
+
   if (tsdbUpdateDFileSet(REPO_FS(pRepo), &(pCommith->wSet)) < 0) {
     return -1;
   }
+  tsdbFSSetTblIdx(REPO_FS(pRepo), &(pCommith->wSet), pCommith->aBlkIdx, pCommith->minKey, pCommith->maxKey);
 
   return 0;
 }
@@ -895,6 +963,13 @@ static int tsdbInitCommitH(SCommitH *pCommith, STsdbRepo *pRepo) {
     return -1;
   }
 
+  pCommith->aRollup = taosArrayInit(1024, sizeof(SRollupRange));
+  if (pCommith->aRollup == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    tsdbDestroyCommitH(pCommith);
+    return -1;
+  }
+
   pCommith->pDataCols = tdNewDataCols(0, pCfg->maxRowsPerFileBlock);
   if (pCommith->pDataCols == NULL) {
     terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
@@ -907,6 +982,7 @@ static int tsdbInitCommitH(SCommitH *pCommith, STsdbRepo *pRepo) {
 
 static void tsdbDestroyCommitH(SCommitH *pCommith) {
   pCommith->pDataCols = tdFreeDataCols(pCommith->pDataCols);
+  pCommith->aRollup = taosArrayDestroy(&pCommith->aRollup);
   pCommith->aSubBlk = taosArrayDestroy(&pCommith->aSubBlk);
   pCommith->aSupBlk = taosArrayDestroy(&pCommith->aSupBlk);
   pCommith->aBlkIdx = taosArrayDestroy(&pCommith->aBlkIdx);
@@ -958,6 +1034,18 @@ static int tsdbCommitToTable(SCommitH *pCommith, int tid) {
     return 0;
   }
 
+  // The hours of the memory data are rolled up again once the FSET is written
+  if (REPO_CFG(TSDB_COMMIT_REPO(pCommith))->rollup && nextKey != TSDB_DATA_TIMESTAMP_NULL &&
+      nextKey <= pCommith->maxKey) {
+    STableData * pTableData = TSDB_COMMIT_REPO(pCommith)->imem->tData[tid];
+    SRollupRange range = {.pTable = pIter->pTable, .skey = nextKey, .ekey = MIN(pTableData->keyLast, pCommith->maxKey)};
+    if (taosArrayPush(pCommith->aRollup, &range) == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      TSDB_RUNLOCK_TABLE(pIter->pTable);
+      return -1;
+    }
+  }
+
   // Must has disk data or has memory data
   int     nBlocks;
   int     bidx = 0;
@@ -1095,6 +1183,7 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
 
   // Get # of cols not all NULL(not including key column)
   int nColsNotAllNull = 0;
+  int nBlooms = 0;
   for (int ncol = 1; ncol < pDataCols->numOfCols; ncol++) {  // ncol from 1, we skip the timestamp column
     SDataCol *   pDataCol = pDataCols->cols + ncol;
     SBlockCol *  pBlockCol = pBlockData->cols + nColsNotAllNull;
@@ -1111,6 +1200,11 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
     pBlockCol->type = pDataCol->type;
     pAggrBlkCol->colId = pDataCol->colId;
 
+    if (tsdbBloomColType(pDataCol->type)) {
+      pBlockCol->flags |= TSDB_BLOCK_COL_BLOOM;
+      nBlooms++;
+    }
+
     if (tDataTypes[pDataCol->type].statisFunc) {
 #if 0
       (*tDataTypes[pDataCol->type].statisFunc)(pDataCol->pData, rowsToWrite, &(pBlockCol->min), &(pBlockCol->max),
@@ -1126,6 +1220,15 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
 
   ASSERT(nColsNotAllNull >= 0 && nColsNotAllNull <= pDataCols->numOfCols);
 
+  int32_t bloomBytes = TSDB_BLOOM_BYTES(rowsToWrite);
+  if (nBlooms > 0) {
+    if (tsdbMakeRoom(ppExBuf, tsdbBlockAggrSize(nColsNotAllNull, SBlockVerLatest) + bloomBytes * nBlooms +
+                                  sizeof(TSCKSUM)) < 0) {
+      return -1;
+    }
+    pAggrBlkData = (SAggrBlkData *)(*ppExBuf);
+  }
+
   // Compress the data if neccessary
   int      tcol = 0;  // counter of not all NULL and written columns
   uint32_t toffset = 0;
@@ -1135,58 +1238,71 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
 
   uint32_t tsizeAggr = (uint32_t)tsdbBlockAggrSize(nColsNotAllNull, SBlockVerLatest);
 
-  for (int ncol = 0; ncol < pDataCols->numOfCols; ncol++) {
-    // All not NULL columns finish
-    if (ncol != 0 && tcol >= nColsNotAllNull) break;
+  // The data of the columns the queries load are written first after the key column, the others after them. The
+  // SBlockCol part stays sorted by column id and locates each column, the queries read the hot ones in one run.
+  uint8_t hotCols[TSDB_HOT_COLS_BYTES];
+  int     npass = tsdbGetHotCols(pTable, hotCols) ? 2 : 1;
 
-    SDataCol * pDataCol = pDataCols->cols + ncol;
-    SBlockCol *pBlockCol = pBlockData->cols + tcol;
+  for (int pass = 0; pass < npass; pass++) {
+    tcol = 0;
+    for (int ncol = 0; ncol < pDataCols->numOfCols; ncol++) {
+      // All not NULL columns finish
+      if (ncol != 0 && tcol >= nColsNotAllNull) break;
 
-    if (ncol != 0 && (pDataCol->colId != pBlockCol->colId)) continue;
+      SDataCol * pDataCol = pDataCols->cols + ncol;
+      SBlockCol *pBlockCol = pBlockData->cols + tcol;
 
-    int32_t flen;  // final length
-    int32_t tlen = dataColGetNEleLen(pDataCol, rowsToWrite);
-    void *  tptr;
+      if (ncol != 0 && (pDataCol->colId != pBlockCol->colId)) continue;
 
-    // Make room
-    if (tsdbMakeRoom(ppBuf, lsize + tlen + COMP_OVERFLOW_BYTES + sizeof(TSCKSUM)) < 0) {
-      return -1;
-    }
-    pBlockData = (SBlockData *)(*ppBuf);
-    pBlockCol = pBlockData->cols + tcol;
-    tptr = POINTER_SHIFT(pBlockData, lsize);
+      if (npass > 1 && (ncol == 0 ? pass != 0 : TSDB_IS_HOT_COL(hotCols, pDataCol->colId) != (pass == 0))) {
+        if (ncol != 0) tcol++;
+        continue;
+      }
 
-    if (pCfg->compression == TWO_STAGE_COMP &&
-        tsdbMakeRoom(ppCBuf, tlen + COMP_OVERFLOW_BYTES) < 0) {
-      return -1;
-    }
+      int32_t flen;  // final length
+      int32_t tlen = dataColGetNEleLen(pDataCol, rowsToWrite);
+      void *  tptr;
 
-    // Compress or just copy
-    if (pCfg->compression) {
-      flen = (*(tDataTypes[pDataCol->type].compFunc))((char *)pDataCol->pData, tlen, rowsToWrite, tptr,
-                                                      tlen + COMP_OVERFLOW_BYTES, pCfg->compression, *ppCBuf,
-                                                      tlen + COMP_OVERFLOW_BYTES);
-    } else {
-      flen = tlen;
-      memcpy(tptr, pDataCol->pData, flen);
-    }
+      // Make room
+      if (tsdbMakeRoom(ppBuf, lsize + tlen + COMP_OVERFLOW_BYTES + sizeof(TSCKSUM)) < 0) {
+        return -1;
+      }
+      pBlockData = (SBlockData *)(*ppBuf);
+      pBlockCol = pBlockData->cols + tcol;
+      tptr = POINTER_SHIFT(pBlockData, lsize);
 
-    // Add checksum
-    ASSERT(flen > 0);
-    flen += sizeof(TSCKSUM);
-    taosCalcChecksumAppend(0, (uint8_t *)tptr, flen);
-    tsdbUpdateDFileMagic(pDFile, POINTER_SHIFT(tptr, flen - sizeof(TSCKSUM)));
+      if (pCfg->compression == TWO_STAGE_COMP &&
+          tsdbMakeRoom(ppCBuf, tlen + COMP_OVERFLOW_BYTES) < 0) {
+        return -1;
+      }
 
-    if (ncol != 0) {
-      tsdbSetBlockColOffset(pBlockCol, toffset);
-      pBlockCol->len = flen;
-      tcol++;
-    } else {
-      keyLen = flen;
-    }
+      // Compress or just copy
+      if (pCfg->compression) {
+        flen = (*(tDataTypes[pDataCol->type].compFunc))((char *)pDataCol->pData, tlen, rowsToWrite, tptr,
+                                                        tlen + COMP_OVERFLOW_BYTES, pCfg->compression, *ppCBuf,
+                                                        tlen + COMP_OVERFLOW_BYTES);
+      } else {
+        flen = tlen;
+        memcpy(tptr, pDataCol->pData, flen);
+      }
+
+      // Add checksum
+      ASSERT(flen > 0);
+      flen += sizeof(TSCKSUM);
+      taosCalcChecksumAppend(0, (uint8_t *)tptr, flen);
+      tsdbUpdateDFileMagic(pDFile, POINTER_SHIFT(tptr, flen - sizeof(TSCKSUM)));
+
+      if (ncol != 0) {
+        tsdbSetBlockColOffset(pBlockCol, toffset);
+        pBlockCol->len = flen;
+        tcol++;
+      } else {
+        keyLen = flen;
+      }
 
-    toffset += flen;
-    lsize += flen;
+      toffset += flen;
+      lsize += flen;
+    }
   }
 
   pBlockData->delimiter = TSDB_FILE_DELIMITER;
@@ -1207,6 +1323,14 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
     taosCalcChecksumAppend(0, (uint8_t *)pAggrBlkData, tsizeAggr);
     tsdbUpdateDFileMagic(pDFileAggr, POINTER_SHIFT(pAggrBlkData, tsizeAggr - sizeof(TSCKSUM)));
 
+    if (nBlooms > 0) {
+      uint32_t tsizeBloom = (uint32_t)(bloomBytes * nBlooms + sizeof(TSCKSUM));
+      tsdbWriteBlockBloom(pDataCols, pBlockData, POINTER_SHIFT(pAggrBlkData, tsizeAggr), bloomBytes);
+      taosCalcChecksumAppend(0, (uint8_t *)POINTER_SHIFT(pAggrBlkData, tsizeAggr), tsizeBloom);
+      tsdbUpdateDFileMagic(pDFileAggr, POINTER_SHIFT(pAggrBlkData, tsizeAggr + tsizeBloom - sizeof(TSCKSUM)));
+      tsizeAggr += tsizeBloom;
+    }
+
     // Write the whole block to file
     if (tsdbAppendDFile(pDFileAggr, (void *)pAggrBlkData, tsizeAggr, &offsetAggr) < tsizeAggr) {
       return -1;
@@ -1217,6 +1341,7 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
   pBlock->last = isLast;
   pBlock->offset = offset;
   pBlock->algorithm = pCfg->compression;
+  pBlock->bloom = (aggrStatus > 0 && nBlooms > 0);
   pBlock->numOfRows = rowsToWrite;
   pBlock->len = lsize;
   pBlock->keyLen = keyLen;
@@ -1229,6 +1354,8 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
   pBlock->blkVer = SBlockVerLatest;
   pBlock->aggrOffset = (uint64_t)offsetAggr;
 
+  if (!isLast) tsdbUpdateBlkBytesPerRow(pTable, rowsToWrite, lsize);
+
   tsdbDebug("vgId:%d tid:%d a block of data is written to file %s, offset %" PRId64
             " numOfRows %d len %d numOfCols %" PRId16 " keyFirst %" PRId64 " keyLast %" PRId64,
             REPO_ID(pRepo), TABLE_TID(pTable), TSDB_FILE_FULL_NAME(pDFile), offset, rowsToWrite, pBlock->len,
@@ -1237,6 +1364,30 @@ int tsdbWriteBlockImpl(STsdbRepo *pRepo, STable *pTable, SDFile *pDFile, SDFile
   return 0;
 }
 
+// Fill the bloom filters of the columns flagged TSDB_BLOCK_COL_BLOOM, NULL values are not added
+static void tsdbWriteBlockBloom(SDataCols *pDataCols, SBlockData *pBlockData, void *pBloom, int32_t bloomBytes) {
+  int dcol = 1;
+  for (int tcol = 0; tcol < pBlockData->numOfCols; tcol++) {
+    SBlockCol *pBlockCol = pBlockData->cols + tcol;
+    if ((pBlockCol->flags & TSDB_BLOCK_COL_BLOOM) == 0) continue;
+
+    while (pDataCols->cols[dcol].colId != pBlockCol->colId) dcol++;
+    SDataCol *pDataCol = pDataCols->cols + dcol;
+
+    memset(pBloom, 0, bloomBytes);
+    for (int row = 0; row < pDataCols->numOfRows; row++) {
+      const void *val = tdGetColDataOfRow(pDataCol, row);
+      const void *key = NULL;
+      if (isNull(val, pDataCol->type)) continue;
+
+      int32_t len = tsdbBloomKey(pDataCol->type, val, &key);
+      tsdbBloomAdd((uint8_t *)pBloom, bloomBytes, key, len);
+    }
+
+    pBloom = POINTER_SHIFT(pBloom, bloomBytes);
+  }
+}
+
 static int tsdbWriteBlock(SCommitH *pCommith, SDFile *pDFile, SDataCols *pDataCols, SBlock *pBlock, bool isLast,
                           bool isSuper) {
   return tsdbWriteBlockImpl(TSDB_COMMIT_REPO(pCommith), TSDB_COMMIT_TABLE(pCommith), pDFile,
@@ -1311,6 +1462,8 @@ static int tsdbMergeMemData(SCommitH *pCommith, SCommitIter *pIter, int bidx) {
   SBlock     subBlocks[TSDB_MAX_SUBBLOCKS];
   SBlock     block, supBlock;
   SDFile *   pDFile;
+  SDataCols *pDCols = pCommith->pDataCols;
+  int        nSubBlocks;
 
   if (bidx == nBlocks - 1) {
     keyLimit = pCommith->maxKey;
@@ -1335,7 +1488,7 @@ static int tsdbMergeMemData(SCommitH *pCommith, SCommitIter *pIter, int bidx) {
     ASSERT(0);
     *(pIter->pIter) = titer;
   } else if (tsdbCanAddSubBlock(pCommith, pBlock, &mInfo)) {
-    // Add a sub-block
+    // Add the rows to the block as a sub-block
     tsdbLoadDataFromCache(pIter->pTable, pIter->pIter, keyLimit, INT32_MAX, pCommith->pDataCols,
                           pCommith->readh.pDCols[0]->cols[0].pData, pCommith->readh.pDCols[0]->numOfRows, pCfg->update,
                           &mInfo);
@@ -1345,20 +1498,35 @@ static int tsdbMergeMemData(SCommitH *pCommith, SCommitIter *pIter, int bidx) {
       pDFile = TSDB_COMMIT_DATA_FILE(pCommith);
     }
 
-    if (tsdbWriteBlock(pCommith, pDFile, pCommith->pDataCols, &block, pBlock->last, false) < 0) return -1;
-
     if (pBlock->numOfSubBlocks == 1) {
       subBlocks[0] = *pBlock;
       subBlocks[0].numOfSubBlocks = 0;
-    } else {
+      nSubBlocks = 1;
+    } else if (pBlock->numOfSubBlocks < TSDB_MAX_SUBBLOCKS) {
       memcpy(subBlocks, POINTER_SHIFT(pCommith->readh.pBlkInfo, pBlock->offset),
              sizeof(SBlock) * pBlock->numOfSubBlocks);
+      nSubBlocks = pBlock->numOfSubBlocks;
+    } else {
+      // The sub-blocks added so far are folded together with the new rows into a single sorted sub-block, the first
+      // one stays in place. A commit only writes its own rows until then, and a fold rewrites no more rows than the
+      // first sub-block holds, see tsdbCanAddSubBlock.
+      subBlocks[0] = *(SBlock *)POINTER_SHIFT(pCommith->readh.pBlkInfo, pBlock->offset);
+      if (tsdbLoadBlockDelta(&(pCommith->readh), pBlock, NULL) < 0) return -1;
+      pDCols = pCommith->readh.pDCols[0];
+      if (tdMergeDataCols(pDCols, pCommith->pDataCols, pCommith->pDataCols->numOfRows, NULL,
+                          pCfg->update != TD_ROW_PARTIAL_UPDATE) < 0) {
+        return -1;
+      }
+      nSubBlocks = 1;
     }
-    subBlocks[pBlock->numOfSubBlocks] = block;
+
+    if (tsdbWriteBlock(pCommith, pDFile, pDCols, &block, pBlock->last, false) < 0) return -1;
+
+    subBlocks[nSubBlocks++] = block;
     supBlock = *pBlock;
     supBlock.keyFirst = mInfo.keyFirst;
     supBlock.keyLast = mInfo.keyLast;
-    supBlock.numOfSubBlocks++;
+    supBlock.numOfSubBlocks = nSubBlocks;
     supBlock.numOfRows = pBlock->numOfRows + mInfo.rowsInserted - mInfo.rowsDeleteSucceed;
     supBlock.offset = taosArrayGetSize(pCommith->aSubBlk) * sizeof(SBlock);
 
@@ -1533,6 +1701,7 @@ static void tsdbResetCommitFile(SCommitH *pCommith) {
   pCommith->isDFileSame = false;
   pCommith->isLFileSame = false;
   taosArrayClear(pCommith->aBlkIdx);
+  taosArrayClear(pCommith->aRollup);
 }
 
 static void tsdbResetCommitTable(SCommitH *pCommith) {
@@ -1751,10 +1920,23 @@ static bool tsdbCanAddSubBlock(SCommitH *pCommith, SBlock *pBlock, SMergeInfo *p
   STsdbRepo *pRepo = TSDB_COMMIT_REPO(pCommith);
   STsdbCfg * pCfg = REPO_CFG(pRepo);
   int        mergeRows = pBlock->numOfRows + pInfo->rowsInserted - pInfo->rowsDeleteSucceed;
+  int        baseRows = pBlock->numOfRows;
+  int        deltaRows = 0;
 
   ASSERT(mergeRows > 0);
 
-  if (pBlock->numOfSubBlocks < TSDB_MAX_SUBBLOCKS && pInfo->nOperations <= pCfg->maxRowsPerFileBlock) {
+  if (pBlock->numOfSubBlocks > 1) {
+    SBlock *iBlock = (SBlock *)POINTER_SHIFT(pCommith->readh.pBlkInfo, pBlock->offset);
+    baseRows = iBlock[0].numOfRows;
+    for (int i = 1; i < pBlock->numOfSubBlocks; i++) {
+      deltaRows += iBlock[i].numOfRows;
+    }
+  }
+
+  // The rows added in sub-blocks are merged into the block itself once they outnumber the rows of the first sub-block,
+  // folding them is as expensive as rewriting the block by then
+  deltaRows += pInfo->nOperations;
+  if (deltaRows <= baseRows && deltaRows <= pCfg->maxRowsPerFileBlock) {
     if (pBlock->last) {
       if (pCommith->isLFileSame && mergeRows < pCfg->minRowsPerFileBlock) return true;
     } else {
@@ -1774,6 +1956,10 @@ int tsdbApplyRtn(STsdbRepo *pRepo) {
   // Get retention snapshot
   tsdbGetRtnSnap(pRepo, &rtn);
 
+  if (REPO_CFG(pRepo)->rollup) {
+    tsdbApplyRollupRtn(pRepo, rtn.minFid);
+  }
+
   tsdbFSIterInit(&fsiter, pfs, TSDB_FS_ITER_FORWARD);
   while ((pSet = tsdbFSIterNext(&fsiter))) {
     if (pSet->fid < rtn.minFid) {
@@ -14,6 +14,7 @@
  */
 
 #include "tsdbint.h"
+#include "tmetrics.h"
 
 typedef struct {
   bool            stop;
@@ -21,6 +22,7 @@ typedef struct {
   pthread_cond_t  queueNotEmpty;
   int             nthreads;
   int             refCount;
+  int             nactive;
   SList *         queue;
   pthread_t *     threads;
 } SCommitQueue;
@@ -31,9 +33,11 @@ typedef struct {
   void *     param;
 } SReq;
 
-static void *tsdbLoopCommit(void *arg);
+static void *     tsdbLoopCommit(void *arg);
+static SListNode *tsdbPopCommitReq(SCommitQueue *pQueue);
 
 static SCommitQueue tsCommitQueue = {0};
+static SMetric *    tsCommitLatency = NULL;
 
 int tsdbInitCommitQueue() {
   int nthreads = tsNumOfCommitThreads;
@@ -44,6 +48,8 @@ int tsdbInitCommitQueue() {
   pQueue->stop = false;
   pQueue->nthreads = nthreads;
 
+  tsCommitLatency = taosMetricHistogram("taosd_tsdb_commit_latency_us", "time to commit the memory table of a vnode");
+
   pQueue->queue = tdListNew(0);
   if (pQueue->queue == NULL) {
     terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
@@ -87,7 +93,9 @@ void tsdbDestroyCommitQueue() {
   }
 
   free(pQueue->threads);
-  tdListFree(pQueue->queue);
+  pQueue->threads = NULL;
+  // the queue is gone for tsdbCommitQueueIdle until it is inited again
+  pQueue->queue = tdListFree(pQueue->queue);
   pthread_cond_destroy(&(pQueue->queueNotEmpty));
   pthread_mutex_destroy(&(pQueue->lock));
 }
@@ -116,6 +124,62 @@ int tsdbScheduleCommit(STsdbRepo *pRepo, void *param, TSDB_REQ_T req) {
   return 0;
 }
 
+bool tsdbCommitQueueIdle() {
+  SCommitQueue *pQueue = &tsCommitQueue;
+
+  pthread_mutex_lock(&(pQueue->lock));
+  bool idle = (atomic_load_32(&pQueue->nactive) == 0) && (pQueue->queue != NULL) && (listNEles(pQueue->queue) == 0);
+  pthread_mutex_unlock(&(pQueue->lock));
+
+  return idle;
+}
+
+// A vnode whose memtable holds at least totalBlocks/earlyCommitFactor blocks commits ahead of the normal threshold
+// when the commit queue is idle, so vnodes filling at the same pace do not commit all at once. Off by default.
+bool tsdbNeedEarlyCommit(int totalBlocks, int nMemBlocks) {
+  int factor = tsEarlyCommitFactor;
+  if (factor < TSDB_MIN_EARLY_COMMIT_FACTOR || totalBlocks < factor) return false;
+
+  return nMemBlocks >= totalBlocks / factor;
+}
+
+// Fraction of the buffer pool still free, the lower it is the closer the vnode is to blocking its writers. Read from
+// the counters the pool publishes, as the repo lock is taken before the queue lock.
+static double tsdbRepoFreeBlockRatio(STsdbRepo *pRepo) {
+  STsdbBufPool *pPool = pRepo->pPool;
+  int32_t       total = atomic_load_32(&pPool->nAllBlocks);
+  if (total <= 0) return 0;
+  return (double)atomic_load_32(&pPool->nFreeBlocks) / total;
+}
+
+// Pop the next request to run, must be called with the queue locked. Memory commits are served by urgency: the
+// vnode with the least free buffer blocks goes first. Other requests are served in arrival order.
+static SListNode *tsdbPopCommitReq(SCommitQueue *pQueue) {
+  SListNode *pHead = listHead(pQueue->queue);
+  if (pHead == NULL || ((SReq *)pHead->data)->req != COMMIT_REQ) {
+    return tdListPopHead(pQueue->queue);
+  }
+
+  SListNode *pSelect = pHead;
+  double     minRatio = tsdbRepoFreeBlockRatio(((SReq *)pHead->data)->pRepo);
+
+  SListIter iter = {0};
+  tdListInitIter(pQueue->queue, &iter, TD_LIST_FORWARD);
+  SListNode *pNode = NULL;
+  while ((pNode = tdListNext(&iter)) != NULL) {
+    SReq *pReq = (SReq *)pNode->data;
+    if (pReq->req != COMMIT_REQ) break;
+
+    double ratio = tsdbRepoFreeBlockRatio(pReq->pRepo);
+    if (ratio < minRatio) {
+      minRatio = ratio;
+      pSelect = pNode;
+    }
+  }
+
+  return tdListPopNode(pQueue->queue, pSelect);
+}
+
 static void tsdbApplyRepoConfig(STsdbRepo *pRepo) {
   pthread_mutex_lock(&pRepo->save_mutex);
 
@@ -169,7 +233,7 @@ static void *tsdbLoopCommit(void *arg) {
     pthread_mutex_lock(&(pQueue->lock));
 
     while (true) {
-      pNode = tdListPopHead(pQueue->queue);
+      pNode = tsdbPopCommitReq(pQueue);
       if (pNode == NULL) {
         if (pQueue->stop && pQueue->refCount <= 0) {
           pthread_mutex_unlock(&(pQueue->lock));
@@ -178,6 +242,7 @@ static void *tsdbLoopCommit(void *arg) {
           pthread_cond_wait(&(pQueue->queueNotEmpty), &(pQueue->lock));
         }
       } else {
+        atomic_add_fetch_32(&pQueue->nactive, 1);
         break;
       }
     }
@@ -189,9 +254,11 @@ static void *tsdbLoopCommit(void *arg) {
     param = ((SReq *)pNode->data)->param;
 
     if (req == COMMIT_REQ) {
+      int64_t st = taosGetTimestampUs();
       tsdbCommitData(pRepo, true);
+      taosMetricObserve(tsCommitLatency, taosGetTimestampUs() - st);
     } else if (req == COMPACT_REQ) {
-      tsdbCompactImpl(pRepo);
+      tsdbCompactImpl(pRepo, (SCompactReq *)param);
     } else if (req == COMMIT_BOTH_REQ) {
       SControlDataInfo* pCtlDataInfo = (SControlDataInfo* )param;
       if(!pCtlDataInfo->memNull) {
@@ -208,6 +275,7 @@ static void *tsdbLoopCommit(void *arg) {
     }
     tfree(param);
     listNodeFree(pNode);
+    atomic_sub_fetch_32(&pQueue->nactive, 1);
   }
 
 _exit:
@@ -13,6 +13,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 #include "tsdbint.h"
+#include "tratelimit.h"
 
 typedef struct {
   STable *    pTable;
@@ -30,6 +31,9 @@ typedef struct {
   SArray *   aBlkIdx;
   SArray *   aSupBlk;
   SDataCols *pDataCols;
+  SCompactReq *pReq;        // not NULL for a background compaction
+  int64_t      readBytes;   // bytes read already paid to the rate limiter
+  int          nCompacted;  // tables compacted in the file set, the others are carried over after a yield
 } SCompactH;
 
 #define TSDB_COMPACT_WSET(pComph) (&((pComph)->wSet))
@@ -47,9 +51,14 @@ static int  tsdbAsyncCompact(STsdbRepo *pRepo);
 static void tsdbStartCompact(STsdbRepo *pRepo);
 static void tsdbEndCompact(STsdbRepo *pRepo, int eno);
 static int  tsdbCompactMeta(STsdbRepo *pRepo);
-static int  tsdbCompactTSData(STsdbRepo *pRepo);
+static int  tsdbCompactTSData(STsdbRepo *pRepo, SCompactReq *pReq);
 static int  tsdbCompactFSet(SCompactH *pComph, SDFileSet *pSet);
 static bool tsdbShouldCompact(SCompactH *pComph);
+static double tsdbGetFSetScore(SCompactH *pComph);
+static int  tsdbPickCompactFSet(STsdbRepo *pRepo, SCompactReq *pReq);
+static void tsdbSetCompactedFSet(STsdbRepo *pRepo, SDFileSet *pSet);
+static void tsdbCompactThrottle(SCompactH *pComph, int64_t written);
+static void tsdbSetCompactYield(STsdbRepo *pRepo, SCompactReq *pReq);
 static int  tsdbInitCompactH(SCompactH *pComph, STsdbRepo *pRepo);
 static void tsdbDestroyCompactH(SCompactH *pComph);
 static int  tsdbInitCompTbArray(SCompactH *pComph);
@@ -62,9 +71,51 @@ static int  tsdbWriteBlockToRightFile(SCompactH *pComph, STable *pTable, SDataCo
                                       void **ppCBuf, void **ppExBuf);
 
 enum { TSDB_NO_COMPACT, TSDB_IN_COMPACT, TSDB_WAITING_COMPACT};
+
+// shared by the background compactions of all the vnodes of the dnode
+static SRateLimiter * tsCompactLimiter = NULL;
+static pthread_once_t tsCompactLimiterInit = PTHREAD_ONCE_INIT;
+
+static void tsdbInitCompactLimiter() { tsCompactLimiter = taosOpenRateLimiter(0); }
+
 int tsdbCompact(STsdbRepo *pRepo) { return tsdbAsyncCompact(pRepo); }
 
-void *tsdbCompactImpl(STsdbRepo *pRepo) {
+int tsdbAutoCompact(STsdbRepo *pRepo) {
+  pthread_once(&tsCompactLimiterInit, tsdbInitCompactLimiter);
+  taosSetRateLimit(tsCompactLimiter, (int64_t)tsCompactRateLimit * 1024 * 1024);
+
+  if (tsdbCompactBackedOff(atomic_load_32(&pRepo->compactYields), atomic_load_64(&pRepo->compactYieldTime),
+                           taosGetTimestampMs())) {
+    return 0;
+  }
+
+  if (atomic_val_compare_exchange_8(&pRepo->compactState, TSDB_NO_COMPACT, TSDB_WAITING_COMPACT) != TSDB_NO_COMPACT) {
+    return 0;
+  }
+
+  SCompactReq *pReq = calloc(1, sizeof(SCompactReq));
+  if (pReq == NULL) {
+    pRepo->compactState = TSDB_NO_COMPACT;
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+  pReq->minScore = tsCompactMinScore;
+  pReq->fid = -1;
+
+  tsem_wait(&(pRepo->readyToCommit));
+  if (tsdbScheduleCommit(pRepo, pReq, COMPACT_REQ) != 0) {
+    pRepo->compactState = TSDB_NO_COMPACT;
+    tsem_post(&(pRepo->readyToCommit));
+    free(pReq);
+    return -1;
+  }
+
+  return 1;
+}
+
+int tsdbGetCompactCandidates(STsdbRepo *pRepo) { return atomic_load_32(&pRepo->compactCandidates); }
+
+void *tsdbCompactImpl(STsdbRepo *pRepo, SCompactReq *pReq) {
   // Check if there are files in TSDB FS to compact
   if (REPO_FS(pRepo)->cstatus->pmf == NULL) {
     pRepo->compactState = TSDB_NO_COMPACT;
@@ -73,6 +124,24 @@ void *tsdbCompactImpl(STsdbRepo *pRepo) {
     return NULL;
   }
 
+  if (pReq != NULL) {
+    if (tsdbPickCompactFSet(pRepo, pReq) < 0) {
+      tsdbError("vgId:%d failed to score file sets to compact since %s", REPO_ID(pRepo), tstrerror(terrno));
+      pReq->fid = -1;
+    }
+
+    if (pReq->fid < 0) {
+      tsdbSetCompactYield(pRepo, pReq);
+      pRepo->compactState = TSDB_NO_COMPACT;
+      tsem_post(&(pRepo->readyToCommit));
+      tsdbDebug("vgId:%d no FSET to compact in background", REPO_ID(pRepo));
+      return NULL;
+    }
+
+    tsdbInfo("vgId:%d FSET %d is picked to compact in background, %d FSETs left", REPO_ID(pRepo), pReq->fid,
+             pRepo->compactCandidates);
+  }
+
   tsdbStartCompact(pRepo);
 
   if (tsdbCompactMeta(pRepo) < 0) {
@@ -80,11 +149,12 @@ void *tsdbCompactImpl(STsdbRepo *pRepo) {
     goto _err;
   }
 
-  if (tsdbCompactTSData(pRepo) < 0) {
+  if (tsdbCompactTSData(pRepo, pReq) < 0) {
     tsdbError("vgId:%d failed to compact TS data since %s", REPO_ID(pRepo), tstrerror(terrno));
     goto _err;
   }
 
+  if (pReq != NULL) tsdbSetCompactYield(pRepo, pReq);
   tsdbEndCompact(pRepo, TSDB_CODE_SUCCESS);
   return NULL;
 
@@ -133,7 +203,7 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
   return 0;
 }
 
-  static int tsdbCompactTSData(STsdbRepo *pRepo) {
+  static int tsdbCompactTSData(STsdbRepo *pRepo, SCompactReq *pReq) {
     SCompactH  compactH;
     SDFileSet *pSet = NULL;
 
@@ -148,6 +218,7 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
     if (tsdbInitCompactH(&compactH, pRepo) < 0) {
       return -1;
     }
+    compactH.pReq = pReq;
 
     while ((pSet = tsdbFSIterNext(&(compactH.fsIter)))) {
       // Remove those expired files
@@ -163,6 +234,12 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
         continue;
       }
 
+      // a background compaction keeps the other file sets as they are
+      if (pReq != NULL && pSet->fid != pReq->fid) {
+        tsdbUpdateDFileSet(REPO_FS(pRepo), pSet);
+        continue;
+      }
+
       if (tsdbCompactFSet(&compactH, pSet) < 0) {
         tsdbDestroyCompactH(&compactH);
         tsdbError("vgId:%d failed to compact FSET %d since %s", REPO_ID(pRepo), pSet->fid, tstrerror(terrno));
@@ -186,7 +263,7 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
       return -1;
     }
 
-    if (!tsdbShouldCompact(pComph)) {
+    if (pComph->pReq == NULL && !tsdbShouldCompact(pComph)) {
       tsdbDebug("vgId:%d no need to compact FSET %d", REPO_ID(pRepo), pSet->fid);
       if (tsdbApplyRtnOnFSet(TSDB_COMPACT_REPO(pComph), pSet, &(pComph->rtn)) < 0) {
         tsdbCompactFSetEnd(pComph);
@@ -219,7 +296,14 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
 
       tsdbCloseDFileSet(TSDB_COMPACT_WSET(pComph));
       tsdbUpdateDFileSet(REPO_FS(pRepo), TSDB_COMPACT_WSET(pComph));
-      tsdbDebug("vgId:%d FSET %d compact over", REPO_ID(pRepo), pSet->fid);
+      if (pComph->pReq != NULL && pComph->pReq->yielded) {
+        // scored again next time, on what is left
+        tsdbInfo("vgId:%d FSET %d yields to the waiting commit, %d tables compacted", REPO_ID(pRepo), pSet->fid,
+                 pComph->nCompacted);
+      } else {
+        if (pComph->pReq != NULL) tsdbSetCompactedFSet(pRepo, TSDB_COMPACT_WSET(pComph));
+        tsdbDebug("vgId:%d FSET %d compact over", REPO_ID(pRepo), pSet->fid);
+      }
     }
 
     tsdbCompactFSetEnd(pComph);
@@ -230,49 +314,228 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
     if (tsdbForceCompactFile) {
       return true;
     }
+
+    return tsdbGetFSetScore(pComph) > 1.0;
+  }
+
+  // Fragmentation of the file set loaded in pComph. Each part is scaled so that 1.0 is where compaction pays off:
+  // a third of the blocks with sub-blocks, a third of the blocks out of the size of their table, or 15% of the data
+  // and last files not used by any block. Deleted rows are rewritten at once in this tree, so the dead space covers
+  // them.
+  static double tsdbGetFSetScore(SCompactH *pComph) {
     STsdbRepo *     pRepo = TSDB_COMPACT_REPO(pComph);
-    STsdbCfg *      pCfg = REPO_CFG(pRepo);
     SReadH *        pReadh = &(pComph->readh);
     STableCompactH *pTh;
     SBlock *        pBlock;
-    int             defaultRows = TSDB_DEFAULT_BLOCK_ROWS(pCfg->maxRowsPerFileBlock);
     SDFile *        pDataF = TSDB_READ_DATA_FILE(pReadh);
     SDFile *        pLastF = TSDB_READ_LAST_FILE(pReadh);
 
-    int     tblocks = 0;       // total blocks
-    int     nSubBlocks = 0;    // # of blocks with sub-blocks
-    int     nSmallBlocks = 0;  // # of blocks with rows < defaultRows
-    int64_t tsize = 0;
+    SCompactStat    stat = {0};
 
     for (size_t i = 0; i < taosArrayGetSize(pComph->tbArray); i++) {
       pTh = (STableCompactH *)taosArrayGet(pComph->tbArray, i);
 
       if (pTh->pTable == NULL || pTh->pBlkIdx == NULL) continue;
 
+      int maxRows = tsdbTableMaxBlockRows(pRepo, pTh->pTable);
+      int defaultRows = TSDB_DEFAULT_BLOCK_ROWS(maxRows);
+
       for (size_t bidx = 0; bidx < pTh->pBlkIdx->numOfBlocks; bidx++) {
-        tblocks++;
+        stat.tblocks++;
         pBlock = pTh->pInfo->blocks + bidx;
 
-        if (pBlock->numOfRows < defaultRows) {
-          nSmallBlocks++;
+        if (pBlock->numOfRows < defaultRows || pBlock->numOfRows > maxRows) {
+          stat.nSmallBlocks++;
         }
 
         if (pBlock->numOfSubBlocks > 1) {
-          nSubBlocks++;
+          stat.nSubBlocks++;
           for (int k = 0; k < pBlock->numOfSubBlocks; k++) {
             SBlock *iBlock = ((SBlock *)POINTER_SHIFT(pTh->pInfo, pBlock->offset)) + k;
-            tsize = tsize + iBlock->len;
+            stat.usedSize += iBlock->len;
           }
         } else if (pBlock->numOfSubBlocks == 1) {
-          tsize += pBlock->len;
+          stat.usedSize += pBlock->len;
         } else {
           ASSERT(0);
         }
       }
     }
 
-    return (((nSubBlocks * 1.0 / tblocks) > 0.33) || ((nSmallBlocks * 1.0 / tblocks) > 0.33) ||
-            (tsize * 1.0 / (pDataF->info.size + pLastF->info.size - 2 * TSDB_FILE_HEAD_SIZE) < 0.85));
+    stat.fileSize = pDataF->info.size + pLastF->info.size - 2 * TSDB_FILE_HEAD_SIZE;
+    return tsdbCalcCompactScore(&stat);
+  }
+
+  double tsdbCalcCompactScore(const SCompactStat *pStat) {
+    double score = 0;
+    if (pStat->tblocks > 0) {
+      score = MAX(score, pStat->nSubBlocks * 1.0 / pStat->tblocks / 0.33);
+      score = MAX(score, pStat->nSmallBlocks * 1.0 / pStat->tblocks / 0.33);
+    }
+    if (pStat->fileSize > 0) {
+      score = MAX(score, (1.0 - pStat->usedSize * 1.0 / pStat->fileSize) / 0.15);
+    }
+
+    return score;
+  }
+
+  // fid of the most fragmented file set which reaches the minimal score, -1 if none
+  int tsdbPickCompactScore(SArray *aScores, double minScore, int *candidates) {
+    double maxScore = 0;
+    int    fid = -1;
+
+    *candidates = 0;
+    for (size_t i = 0; i < taosArrayGetSize(aScores); i++) {
+      SCompactScore *pScore = (SCompactScore *)taosArrayGet(aScores, i);
+      if (pScore->score < minScore) continue;
+
+      (*candidates)++;
+      if (pScore->score > maxScore) {
+        maxScore = pScore->score;
+        fid = pScore->fid;
+      }
+    }
+
+    return fid;
+  }
+
+  static SCompactScore *tsdbGetCompactScore(SArray *aScores, int fid) {
+    if (aScores == NULL) return NULL;
+
+    for (size_t i = 0; i < taosArrayGetSize(aScores); i++) {
+      SCompactScore *pScore = (SCompactScore *)taosArrayGet(aScores, i);
+      if (pScore->fid == fid) return pScore;
+    }
+    return NULL;
+  }
+
+  static void tsdbGetCompactSizes(SDFileSet *pSet, SCompactScore *pScore) {
+    pScore->fid = pSet->fid;
+    pScore->headSize = TSDB_FILE_INFO(TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD))->size;
+    pScore->dataSize = TSDB_FILE_INFO(TSDB_DFILE_IN_SET(pSet, TSDB_FILE_DATA))->size;
+    pScore->lastSize = TSDB_FILE_INFO(TSDB_DFILE_IN_SET(pSet, TSDB_FILE_LAST))->size;
+  }
+
+  // Score the file sets and pick the most fragmented one which reaches the minimal score. Only the file sets changed
+  // since they were last scored are loaded, so a vnode without new data costs no I/O. When a commit waits, the scores
+  // got so far are kept and none is picked.
+  static int tsdbPickCompactFSet(STsdbRepo *pRepo, SCompactReq *pReq) {
+    SCompactH  compactH;
+    SDFileSet *pSet = NULL;
+    int        candidates = 0;
+
+    pReq->fid = -1;
+
+    SArray *aScores = taosArrayInit(16, sizeof(SCompactScore));
+    if (aScores == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+
+    if (tsdbInitCompactH(&compactH, pRepo) < 0) {
+      taosArrayDestroy(&aScores);
+      return -1;
+    }
+    compactH.pReq = pReq;
+
+    while ((pSet = tsdbFSIterNext(&(compactH.fsIter)))) {
+      if (pSet->fid < compactH.rtn.minFid || TSDB_FSET_LEVEL(pSet) == TFS_MAX_LEVEL) continue;
+
+      SCompactScore  score = {0};
+      SCompactScore *pOld = tsdbGetCompactScore(pRepo->compactScores, pSet->fid);
+      tsdbGetCompactSizes(pSet, &score);
+
+      if (pOld != NULL && pOld->headSize == score.headSize && pOld->dataSize == score.dataSize &&
+          pOld->lastSize == score.lastSize) {
+        score.score = pOld->score;
+      } else {
+        if (tsdbCompactFSetInit(&compactH, pSet) < 0) {
+          tsdbDestroyCompactH(&compactH);
+          taosArrayDestroy(&aScores);
+          return -1;
+        }
+        score.score = tsdbGetFSetScore(&compactH);
+        tsdbCompactFSetEnd(&compactH);
+
+        tsdbDebug("vgId:%d FSET %d is scored %.2f", REPO_ID(pRepo), pSet->fid, score.score);
+        tsdbCompactThrottle(&compactH, 0);
+      }
+
+      if (taosArrayPush(aScores, &score) == NULL) {
+        terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+        tsdbDestroyCompactH(&compactH);
+        taosArrayDestroy(&aScores);
+        return -1;
+      }
+
+      if (pReq->yielded) break;
+    }
+
+    tsdbDestroyCompactH(&compactH);
+
+    if (pReq->yielded) {
+      // the file sets not reached keep their last scores
+      for (size_t i = 0; i < taosArrayGetSize(pRepo->compactScores); i++) {
+        SCompactScore *pOld = (SCompactScore *)taosArrayGet(pRepo->compactScores, i);
+        if (tsdbGetCompactScore(aScores, pOld->fid) != NULL) continue;
+        if (taosArrayPush(aScores, pOld) == NULL) {
+          terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+          taosArrayDestroy(&aScores);
+          return -1;
+        }
+      }
+    } else {
+      pReq->fid = tsdbPickCompactScore(aScores, pReq->minScore, &candidates);
+      atomic_store_32(&pRepo->compactCandidates, MAX(candidates - 1, 0));
+    }
+
+    taosArrayDestroy(&pRepo->compactScores);
+    pRepo->compactScores = aScores;
+    return 0;
+  }
+
+  // A compacted file set is not picked again until it is changed, even if its blocks stay small
+  static void tsdbSetCompactedFSet(STsdbRepo *pRepo, SDFileSet *pSet) {
+    SCompactScore *pScore = tsdbGetCompactScore(pRepo->compactScores, pSet->fid);
+    if (pScore == NULL) return;
+
+    tsdbGetCompactSizes(pSet, pScore);
+    pScore->score = 0;
+  }
+
+  // Background compaction reads and writes under the dnode bandwidth budget. It yields when a writer of the vnode
+  // waits to commit, since the commit can not start before the compaction is over: the table in hand is finished,
+  // the others are carried over as they are, and all of it goes at full speed.
+  static void tsdbCompactThrottle(SCompactH *pComph, int64_t written) {
+    SCompactReq *pReq = pComph->pReq;
+    if (pReq == NULL) return;
+
+    if (!pReq->yielded && atomic_load_32(&(TSDB_COMPACT_REPO(pComph)->commitWaiting)) > 0) {
+      pReq->yielded = true;
+    }
+
+    int64_t read = pComph->readh.readBytes - pComph->readBytes;
+    pComph->readBytes = pComph->readh.readBytes;
+    if (!pReq->yielded) taosRateLimit(tsCompactLimiter, read + written);
+  }
+
+  // a vnode whose background compaction yielded is not picked again before it backed off
+  static void tsdbSetCompactYield(STsdbRepo *pRepo, SCompactReq *pReq) {
+    if (pReq->yielded) {
+      atomic_store_64(&pRepo->compactYieldTime, taosGetTimestampMs());
+      atomic_add_fetch_32(&pRepo->compactYields, 1);
+    } else {
+      atomic_store_32(&pRepo->compactYields, 0);
+    }
+  }
+
+  // the back off doubles with each yield in a row, from a second up to a minute
+  bool tsdbCompactBackedOff(int32_t yields, int64_t yieldTime, int64_t now) {
+    if (yields <= 0) return false;
+
+    int32_t shift = MIN(yields - 1, 6);
+    int64_t backoff = MIN((int64_t)1000 << shift, 60000);
+    return now - yieldTime < backoff;
   }
 
   static int tsdbInitCompactH(SCompactH *pComph, STsdbRepo *pRepo) {
@@ -401,6 +664,16 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
       if (tsdbLoadBlockInfo(pReadH, (void **)(&(pTh->pInfo)), &originLen) < 0) {
         return -1;
       }
+
+      // after a restart the bytes per row of a table are learnt from its blocks on disk, to size the blocks rewritten
+      if (atomic_load_32(&(TABLE_BLK_STAT(pTh->pTable)->blkBytesPerRow)) <= 0) {
+        for (int i = 0; i < pTh->pBlkIdx->numOfBlocks; i++) {
+          SBlock *pBlock = pTh->pInfo->blocks + i;
+          if (!pBlock->last && pBlock->numOfSubBlocks == 1) {
+            tsdbUpdateBlkBytesPerRow(pTh->pTable, pBlock->numOfRows, pBlock->len);
+          }
+        }
+      }
     }
 
     return 0;
@@ -432,9 +705,9 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
     void **    ppBuf = &(TSDB_COMPACT_BUF(pComph));
     void **    ppCBuf = &(TSDB_COMPACT_COMP_BUF(pComph));
     void **    ppExBuf = &(TSDB_COMPACT_EXBUF(pComph));
-    int        defaultRows = TSDB_DEFAULT_BLOCK_ROWS(pCfg->maxRowsPerFileBlock);
 
     taosArrayClear(pComph->aBlkIdx);
+    pComph->nCompacted = 0;
 
     for (int tid = 1; tid < taosArrayGetSize(pComph->tbArray); tid++) {
       STableCompactH *pTh = (STableCompactH *)taosArrayGet(pComph->tbArray, tid);
@@ -442,6 +715,13 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
 
       if (pTh->pTable == NULL || pTh->pBlkIdx == NULL) continue;
 
+      // after a yield the tables left are carried over block by block, one table is compacted at least
+      bool carry = (pComph->pReq != NULL && pComph->pReq->yielded && pComph->nCompacted > 0);
+
+      // the blocks are cut again to the size of the table
+      int maxRows = tsdbTableMaxBlockRows(pRepo, pTh->pTable);
+      int defaultRows = TSDB_DEFAULT_BLOCK_ROWS(maxRows);
+
       pSchema = tsdbGetTableSchemaImpl(pTh->pTable, true, true, -1, -1);
       taosArrayClear(pComph->aSupBlk);
       if ((tdInitDataCols(pComph->pDataCols, pSchema) < 0) || (tdInitDataCols(pReadh->pDCols[0], pSchema) < 0) ||
@@ -461,8 +741,17 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
           return -1;
         }
 
+        tsdbCompactThrottle(pComph, 0);
+
+        if (carry) {
+          if (tsdbWriteBlockToRightFile(pComph, pTh->pTable, pReadh->pDCols[0], ppBuf, ppCBuf, ppExBuf) < 0) {
+            return -1;
+          }
+          continue;
+        }
+
         // Merge pComph->pDataCols and pReadh->pDCols[0] and write data to file
-        if (pComph->pDataCols->numOfRows == 0 && pBlock->numOfRows >= defaultRows) {
+        if (pComph->pDataCols->numOfRows == 0 && pBlock->numOfRows >= defaultRows && pBlock->numOfRows <= maxRows) {
           if (tsdbWriteBlockToRightFile(pComph, pTh->pTable, pReadh->pDCols[0], ppBuf, ppCBuf, ppExBuf) < 0) {
             return -1;
           }
@@ -501,6 +790,8 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
         terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
         return -1;
       }
+
+      if (!carry) pComph->nCompacted++;
     }
 
     if (tsdbWriteBlockIdx(TSDB_COMPACT_HEAD_FILE(pComph), pComph->aBlkIdx, ppBuf) < 0) {
@@ -539,6 +830,7 @@ static int tsdbCompactMeta(STsdbRepo *pRepo) {
       return -1;
     }
 
+    tsdbCompactThrottle(pComph, block.len);
     return 0;
   }
 
@@ -80,6 +80,7 @@ static int   tsdbBlockSolve(SDeleteH *pdh, SBlock *pBlock);
 static int   tsdbWriteBlockToFile(SDeleteH *pdh, STable *pTable, SDataCols *pDCols, void **ppBuf,
                                        void **ppCBuf, void **ppExBuf, SBlock * pBlock);
 static int   tsdbDeleteImplCommon(STsdbRepo *pRepo, SControlDataInfo* pCtlInfo);
+static int   tsdbDeleteRollup(SDeleteH *pdh);
 
 
 // delete
@@ -339,6 +340,14 @@ static int tsdbFSetDelete(SDeleteH *pdh, SDFileSet *pSet) {
   }
 
   tsdbCloseDFileSet(TSDB_DELETE_WSET(pdh));
+
+  if (tsdbDeleteRollup(pdh) < 0) {
+    // only the .head file is new
+    tsdbRemoveDFile(TSDB_DELETE_HEAD_FILE(pdh));
+    tsdbFSetEnd(pdh);
+    return -1;
+  }
+
   tsdbUpdateDFileSet(REPO_FS(pRepo), TSDB_DELETE_WSET(pdh));
   tsdbDebug("vgId:%d :SDEL FSET %d delete data over", REPO_ID(pRepo), pSet->fid);
 
@@ -778,6 +787,41 @@ static int tsdbKeepIntactBlocks(SDeleteH *pdh, STableDeleteH * pItem) {
   return ret;
 }
 
+// roll up again the hours of the deleted window in the FSET, for the tables the rows are deleted from
+static int tsdbDeleteRollup(SDeleteH *pdh) {
+  STsdbRepo *pRepo = TSDB_DELETE_REPO(pdh);
+  STsdbCfg * pCfg = REPO_CFG(pRepo);
+  SDFileSet *pWSet = TSDB_DELETE_WSET(pdh);
+  TSKEY      minKey, maxKey;
+
+  if (!pCfg->rollup) return 0;
+
+  SArray *aRanges = taosArrayInit(pdh->pCtlInfo->tnum, sizeof(SRollupRange));
+  if (aRanges == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, pWSet->fid, &minKey, &maxKey);
+  for (size_t tid = 1; tid < taosArrayGetSize(pdh->tblArray); ++tid) {
+    STableDeleteH *pItem = (STableDeleteH *)taosArrayGet(pdh->tblArray, tid);
+    if (pItem->pTable == NULL || pItem->pBlkIdx == NULL || !tableInDel(pdh, (int32_t)tid)) continue;
+
+    SRollupRange range = {.pTable = pItem->pTable,
+                          .skey = MAX(pdh->pCtlInfo->win.skey, minKey),
+                          .ekey = MIN(pdh->pCtlInfo->win.ekey, maxKey)};
+    if (taosArrayPush(aRanges, &range) == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      taosArrayDestroy(&aRanges);
+      return -1;
+    }
+  }
+
+  int code = tsdbUpdateRollup(pRepo, pWSet, aRanges);
+  taosArrayDestroy(&aRanges);
+  return code;
+}
+
 static int tsdbFSetDeleteImpl(SDeleteH *pdh) {
   void **   ppBuf  = &(TSDB_DELETE_BUF(pdh));
   int32_t   ret    = TSDB_CODE_SUCCESS;
@@ -37,6 +37,7 @@ static void tsdbScanAndTryFixDFilesHeader(STsdbRepo *pRepo, int32_t *nExpired);
 static int  tsdbProcessExpiredFS(STsdbRepo *pRepo);
 static int  tsdbCreateMeta(STsdbRepo *pRepo);
 static int  tsdbFetchTFileSet(STsdbRepo *pRepo, SArray **fArray);
+static void tsdbPruneTblIdx(STsdbFS *pfs);
 
 // For backward compatibility
 // ================== CURRENT file header info
@@ -230,6 +231,20 @@ STsdbFS *tsdbNewFS(STsdbCfg *pCfg) {
   pfs->intxn = false;
   pfs->metaCacheComp = NULL;
 
+  code = pthread_mutex_init(&(pfs->tblIdxMutex), NULL);
+  if (code) {
+    terrno = TAOS_SYSTEM_ERROR(code);
+    tsdbFreeFS(pfs);
+    return NULL;
+  }
+
+  pfs->tblIdx = taosArrayInit(maxFSet, sizeof(SFSetTblIdx));
+  if (pfs->tblIdx == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    tsdbFreeFS(pfs);
+    return NULL;
+  }
+
   pfs->nstatus = tsdbNewFSStatus(maxFSet);
   if (pfs->nstatus == NULL) {
     tsdbFreeFS(pfs);
@@ -245,6 +260,11 @@ void *tsdbFreeFS(STsdbFS *pfs) {
     taosHashCleanup(pfs->metaCache);
     pfs->metaCache = NULL;
     pfs->cstatus = tsdbFreeFSStatus(pfs->cstatus);
+    for (size_t i = 0; i < taosArrayGetSize(pfs->tblIdx); i++) {
+      tfree(((SFSetTblIdx *)taosArrayGet(pfs->tblIdx, i))->lastParts);
+    }
+    taosArrayDestroy(&pfs->tblIdx);
+    pthread_mutex_destroy(&(pfs->tblIdxMutex));
     pthread_rwlock_destroy(&(pfs->lock));
     free(pfs);
   }
@@ -393,6 +413,7 @@ int tsdbEndFSTxn(STsdbRepo *pRepo) {
 
   // Apply actual change to each file and SDFileSet
   tsdbApplyFSTxnOnDisk(pfs->nstatus, pfs->cstatus);
+  tsdbPruneTblIdx(pfs);
 
   pfs->intxn = false;
   return 0;
@@ -400,6 +421,7 @@ int tsdbEndFSTxn(STsdbRepo *pRepo) {
 
 int tsdbEndFSTxnWithError(STsdbFS *pfs) {
   tsdbApplyFSTxnOnDisk(pfs->nstatus, pfs->cstatus);
+  tsdbPruneTblIdx(pfs);
   // TODO: if mf change, reload pfs->metaCache
   pfs->intxn = false;
   return 0;
@@ -551,6 +573,115 @@ static void tsdbApplyFSTxnOnDisk(SFSStatus *pFrom, SFSStatus *pTo) {
   }
 }
 
+// ================== SFSetTblIdx
+// The index of a file set version is built by the commit which writes the version, or by the first reader of the
+// version after the repository is opened, from the SBlockIdx array of the head file. It is kept in memory only, it
+// is small enough to be built again after a restart but not to be written into the current file on each commit.
+static int tsdbComparFidTblIdx(const void *arg1, const void *arg2) {
+  int fid = *(int *)arg1;
+  int fid2 = ((SFSetTblIdx *)arg2)->fid;
+  return (fid < fid2) ? -1 : ((fid == fid2) ? 0 : 1);
+}
+
+static bool tsdbIsTblIdxOfFSet(const SFSetTblIdx *pIdx, const SDFileSet *pSet) {
+  const SDFile *pHeadf = TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD);
+  return pIdx->fid == pSet->fid && pIdx->hmagic == pHeadf->info.magic &&
+         strcmp(pIdx->hname, TSDB_FILE_FULL_NAME(pHeadf)) == 0;
+}
+
+void tsdbFSSetTblIdx(STsdbFS *pfs, const SDFileSet *pSet, SArray *aBlkIdx, TSKEY minKey, TSKEY maxKey) {
+  SFSetTblIdx  tIdx = {0};
+  SFSetTblIdx *pIdx;
+  size_t       nIdx = taosArrayGetSize(aBlkIdx);
+
+  pthread_mutex_lock(&(pfs->tblIdxMutex));
+  pIdx = taosbsearch(&(pSet->fid), TARRAY_GET_START(pfs->tblIdx), taosArrayGetSize(pfs->tblIdx), sizeof(SFSetTblIdx),
+                     tsdbComparFidTblIdx, TD_EQ);
+  bool indexed = (pIdx != NULL && tsdbIsTblIdxOfFSet(pIdx, pSet));
+  pthread_mutex_unlock(&(pfs->tblIdxMutex));
+  if (indexed) return;
+
+  // SBlockIdx are sorted by tid
+  tIdx.fid = pSet->fid;
+  tstrncpy(tIdx.hname, TSDB_FILE_FULL_NAME(TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD)), TSDB_FILENAME_LEN);
+  tIdx.hmagic = TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD)->info.magic;
+  tIdx.maxTid = (nIdx > 0) ? ((SBlockIdx *)taosArrayGetLast(aBlkIdx))->tid : 0;
+  tIdx.minKey = minKey;
+  tIdx.partLen = (maxKey - minKey) / TSDB_TBLIDX_PARTS + 1;
+  tIdx.lastParts = calloc(1, tIdx.maxTid + 1);
+  if (tIdx.lastParts == NULL) return;
+  for (size_t i = 0; i < nIdx; i++) {
+    SBlockIdx *pBlkIdx = (SBlockIdx *)taosArrayGet(aBlkIdx, i);
+    // a key out of the range of the file set is not expected, the table is never skipped by its key then
+    int64_t part = TSDB_TBLIDX_PARTS;
+    if (pBlkIdx->maxKey >= minKey && pBlkIdx->maxKey <= maxKey) part = (pBlkIdx->maxKey - minKey) / tIdx.partLen + 1;
+    tIdx.lastParts[pBlkIdx->tid] = (uint8_t)part;
+  }
+
+  pthread_mutex_lock(&(pfs->tblIdxMutex));
+  size_t size = taosArrayGetSize(pfs->tblIdx);
+  pIdx = taosbsearch(&(pSet->fid), TARRAY_GET_START(pfs->tblIdx), size, sizeof(SFSetTblIdx), tsdbComparFidTblIdx,
+                     TD_GE);
+  if (pIdx != NULL && pIdx->fid == pSet->fid) {
+    uint8_t *lastParts = pIdx->lastParts;
+    *pIdx = tIdx;
+    tIdx.lastParts = lastParts;
+  } else {
+    size_t pos = (pIdx == NULL) ? size : TARRAY_ELEM_IDX(pfs->tblIdx, pIdx);
+    if (taosArrayInsert(pfs->tblIdx, pos, &tIdx) != NULL) tIdx.lastParts = NULL;
+  }
+  pthread_mutex_unlock(&(pfs->tblIdxMutex));
+
+  tfree(tIdx.lastParts);
+}
+
+// Return 1 if any of the tables may have blocks in the file set with keys from skey on, 0 if none of them has, -1 if
+// the file set version is not indexed yet
+int tsdbFSetHasTables(STsdbFS *pfs, const SDFileSet *pSet, const int32_t *tids, int ntids, TSKEY skey) {
+  int ret = -1;
+
+  pthread_mutex_lock(&(pfs->tblIdxMutex));
+  SFSetTblIdx *pIdx = taosbsearch(&(pSet->fid), TARRAY_GET_START(pfs->tblIdx), taosArrayGetSize(pfs->tblIdx),
+                                  sizeof(SFSetTblIdx), tsdbComparFidTblIdx, TD_EQ);
+  if (pIdx != NULL && tsdbIsTblIdxOfFSet(pIdx, pSet)) {
+    ret = 0;
+    for (int i = 0; i < ntids; i++) {
+      if (tids[i] > pIdx->maxTid || pIdx->lastParts[tids[i]] == 0) continue;
+
+      // the last key of the table is before the end of its part
+      int part = pIdx->lastParts[tids[i]];
+      if (part < TSDB_TBLIDX_PARTS && pIdx->minKey + part * pIdx->partLen <= skey) continue;
+
+      ret = 1;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&(pfs->tblIdxMutex));
+
+  return ret;
+}
+
+// Drop the index of the file set versions not in the current status any more
+static void tsdbPruneTblIdx(STsdbFS *pfs) {
+  SArray *df = pfs->cstatus->df;
+
+  pthread_mutex_lock(&(pfs->tblIdxMutex));
+  size_t nIdx = 0;
+  for (size_t i = 0; i < taosArrayGetSize(pfs->tblIdx); i++) {
+    SFSetTblIdx *pIdx = taosArrayGet(pfs->tblIdx, i);
+    SDFileSet *  pSet =
+        taosbsearch(&(pIdx->fid), TARRAY_GET_START(df), taosArrayGetSize(df), sizeof(SDFileSet), tsdbComparFidFSet, TD_EQ);
+    if (pSet == NULL || !tsdbIsTblIdxOfFSet(pIdx, pSet)) {
+      tfree(pIdx->lastParts);
+    } else {
+      if (nIdx != i) taosArraySet(pfs->tblIdx, nIdx, pIdx);
+      nIdx++;
+    }
+  }
+  taosArraySetSize(pfs->tblIdx, nIdx);
+  pthread_mutex_unlock(&(pfs->tblIdxMutex));
+}
+
 // ================== SFSIter
 // ASSUMPTIONS: the FS Should be read locked when calling these functions
 void tsdbFSIterInit(SFSIter *pIter, STsdbFS *pfs, int direction) {
@@ -929,8 +1060,9 @@ static int tsdbScanRootDir(STsdbRepo *pRepo) {
   while ((pf = tfsReaddir(tdir))) {
     tfsbasename(pf, bname);
 
-    if (strcmp(bname, tsdbTxnFname[TSDB_TXN_CURR_FILE]) == 0 || strcmp(bname, "data") == 0) {
-      // Skip current file and data directory
+    if (strcmp(bname, tsdbTxnFname[TSDB_TXN_CURR_FILE]) == 0 || strcmp(bname, "data") == 0 ||
+        strcmp(bname, TSDB_ROLLUP_DIR) == 0) {
+      // Skip current file, data and rollup directories
       continue;
     }
 
@@ -1016,8 +1148,8 @@ static int tsdbRestoreMeta(STsdbRepo *pRepo) {
   while ((pf = tfsReaddir(tdir))) {
     tfsbasename(pf, bname);
 
-    if (strcmp(bname, "data") == 0) {
-      // Skip the data/ directory
+    if (strcmp(bname, "data") == 0 || strcmp(bname, TSDB_ROLLUP_DIR) == 0) {
+      // Skip the data/ and rollup/ directories
       continue;
     }
 
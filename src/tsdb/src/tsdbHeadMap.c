@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdbint.h"
+
+// The head file of a file set version is never written again once the version is committed, so it is mapped
+// read-only the first time a reader opens it and its SBlockIdx part is decoded once. Every reader of the version
+// shares the mapping and the decoded SBlockIdx array until a newer version of the file set replaces it, or until it is
+// among the least recently used ones once more than TSDB_MAX_HEAD_MAPS are mapped.
+
+#define TSDB_MAX_HEAD_MAPS 64
+
+static SHeadMap *tsdbNewHeadMap(STsdbRepo *pRepo, SDFileSet *pSet, struct stat *pStat);
+static void      tsdbFreeHeadMap(SHeadMap *pMap);
+static void      tsdbDropHeadMap(SHeadMapCache *pCache, SHeadMap *pMap);
+static void      tsdbSweepHeadMaps(SHeadMapCache *pCache, SHeadMap *pNew);
+static void      tsdbEvictHeadMaps(SHeadMapCache *pCache);
+
+int tsdbInitHeadMaps(STsdbRepo *pRepo) {
+  SHeadMapCache *pCache = &(pRepo->headMaps);
+
+  pCache->maps = NULL;
+  pCache->nmaps = 0;
+  pCache->maxMaps = TSDB_MAX_HEAD_MAPS;
+  int code = pthread_mutex_init(&(pCache->mutex), NULL);
+  if (code != 0) {
+    terrno = TAOS_SYSTEM_ERROR(code);
+    return -1;
+  }
+
+  return 0;
+}
+
+void tsdbDestroyHeadMaps(STsdbRepo *pRepo) {
+  SHeadMapCache *pCache = &(pRepo->headMaps);
+
+  // all the readers are closed with the repository
+  while (pCache->maps) {
+    SHeadMap *pMap = pCache->maps;
+    pCache->maps = pMap->next;
+    ASSERT(pMap->refCount == 0);
+    tsdbFreeHeadMap(pMap);
+  }
+  pCache->nmaps = 0;
+
+  pthread_mutex_destroy(&(pCache->mutex));
+}
+
+SHeadMap *tsdbAcquireHeadMap(STsdbRepo *pRepo, SDFileSet *pSet) {
+  SHeadMapCache *pCache = &(pRepo->headMaps);
+  SDFile *       pHeadf = TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD);
+  SHeadMap *     pMap;
+  struct stat    st;
+
+  if (!TSDB_FILE_OPENED(pHeadf) || fstat(TSDB_FILE_FD(pHeadf), &st) < 0) return NULL;
+
+  pthread_mutex_lock(&(pCache->mutex));
+  for (SHeadMap **ppMap = &(pCache->maps); (pMap = *ppMap) != NULL; ppMap = &(pMap->next)) {
+    if (strcmp(pMap->fname, TSDB_FILE_FULL_NAME(pHeadf)) != 0) continue;
+
+    if (pMap->ino == st.st_ino && pMap->size == st.st_size) {
+      // move it to the front
+      *ppMap = pMap->next;
+      pMap->next = pCache->maps;
+      pCache->maps = pMap;
+      pMap->refCount++;
+      pthread_mutex_unlock(&(pCache->mutex));
+      return pMap;
+    }
+
+    // the file is written again under the same name
+    tsdbDropHeadMap(pCache, pMap);
+    break;
+  }
+  pthread_mutex_unlock(&(pCache->mutex));
+
+  // map the file out of the lock, the readers of the other file sets go on meanwhile
+  SHeadMap *pNew = tsdbNewHeadMap(pRepo, pSet, &st);
+  if (pNew == NULL) return NULL;
+
+  pthread_mutex_lock(&(pCache->mutex));
+  for (pMap = pCache->maps; pMap; pMap = pMap->next) {
+    if (strcmp(pMap->fname, pNew->fname) == 0 && pMap->ino == pNew->ino && pMap->size == pNew->size) break;
+  }
+
+  if (pMap) {
+    // another reader mapped it first
+    pMap->refCount++;
+  } else {
+    tsdbSweepHeadMaps(pCache, pNew);
+    pNew->next = pCache->maps;
+    pCache->maps = pNew;
+    pCache->nmaps++;
+    tsdbEvictHeadMaps(pCache);
+    pMap = pNew;
+    pNew = NULL;
+  }
+  pthread_mutex_unlock(&(pCache->mutex));
+
+  if (pNew) tsdbFreeHeadMap(pNew);
+  return pMap;
+}
+
+void tsdbReleaseHeadMap(STsdbRepo *pRepo, SHeadMap *pMap) {
+  SHeadMapCache *pCache = &(pRepo->headMaps);
+  bool           toFree = false;
+
+  if (pMap == NULL) return;
+
+  pthread_mutex_lock(&(pCache->mutex));
+  ASSERT(pMap->refCount > 0);
+  pMap->refCount--;
+  toFree = (pMap->refCount == 0 && pMap->stale);
+  pthread_mutex_unlock(&(pCache->mutex));
+
+  if (toFree) tsdbFreeHeadMap(pMap);
+}
+
+static SHeadMap *tsdbNewHeadMap(STsdbRepo *pRepo, SDFileSet *pSet, struct stat *pStat) {
+  SDFile *  pHeadf = TSDB_DFILE_IN_SET(pSet, TSDB_FILE_HEAD);
+  SBlockIdx blkIdx;
+
+  if (pHeadf->info.offset <= 0 || (int64_t)pHeadf->info.offset + pHeadf->info.len > pStat->st_size) return NULL;
+
+  SHeadMap *pMap = (SHeadMap *)calloc(1, sizeof(*pMap));
+  if (pMap == NULL) return NULL;
+
+  tstrncpy(pMap->fname, TSDB_FILE_FULL_NAME(pHeadf), TSDB_FILENAME_LEN);
+  pMap->fid = TSDB_FSET_FID(pSet);
+  pMap->ino = pStat->st_ino;
+  pMap->size = pStat->st_size;
+  pMap->refCount = 1;
+
+  pMap->addr = mmap(NULL, (size_t)pMap->size, PROT_READ, MAP_SHARED, TSDB_FILE_FD(pHeadf), 0);
+  if (pMap->addr == MAP_FAILED) {
+    tsdbDebug("vgId:%d failed to map file %s since %s, read it instead", REPO_ID(pRepo), pMap->fname,
+              strerror(errno));
+    pMap->addr = NULL;
+    tsdbFreeHeadMap(pMap);
+    return NULL;
+  }
+
+  pMap->aBlkIdx = taosArrayInit(1024, sizeof(SBlockIdx));
+  if (pMap->aBlkIdx == NULL) {
+    tsdbFreeHeadMap(pMap);
+    return NULL;
+  }
+
+  // A file which does not pass the checks is left to the reading path, which reports it
+  void *pIdx = POINTER_SHIFT(pMap->addr, pHeadf->info.offset);
+  if (!taosCheckChecksumWhole((uint8_t *)pIdx, pHeadf->info.len)) {
+    tsdbFreeHeadMap(pMap);
+    return NULL;
+  }
+
+  void *ptr = pIdx;
+  while (POINTER_DISTANCE(ptr, pIdx) < (pHeadf->info.len - sizeof(TSCKSUM))) {
+    ptr = tsdbDecodeSBlockIdx(ptr, &blkIdx);
+    ASSERT(ptr != NULL);
+
+    if ((int64_t)blkIdx.offset + blkIdx.len > pMap->size) {
+      tsdbFreeHeadMap(pMap);
+      return NULL;
+    }
+
+    if (taosArrayPush(pMap->aBlkIdx, (void *)(&blkIdx)) == NULL) {
+      tsdbFreeHeadMap(pMap);
+      return NULL;
+    }
+  }
+
+  return pMap;
+}
+
+static void tsdbFreeHeadMap(SHeadMap *pMap) {
+  if (pMap->addr) munmap(pMap->addr, (size_t)pMap->size);
+  taosArrayDestroy(&pMap->aBlkIdx);
+  free(pMap);
+}
+
+// Take the mapping out of the list, it is unmapped at once if no reader holds it
+static void tsdbDropHeadMap(SHeadMapCache *pCache, SHeadMap *pMap) {
+  SHeadMap **ppMap = &(pCache->maps);
+  while (*ppMap != pMap) ppMap = &((*ppMap)->next);
+  *ppMap = pMap->next;
+  pCache->nmaps--;
+
+  if (pMap->refCount == 0) {
+    tsdbFreeHeadMap(pMap);
+  } else {
+    pMap->stale = true;
+  }
+}
+
+// A new version of a file set is mapped after each commit into it, the older versions of the set and the file sets
+// removed since are not read by new readers any more. Their mappings are dropped, so that the disk space of the
+// removed files is released.
+static void tsdbSweepHeadMaps(SHeadMapCache *pCache, SHeadMap *pNew) {
+  SHeadMap *pMap = pCache->maps;
+  while (pMap) {
+    SHeadMap *pNext = pMap->next;
+    if (pMap->fid == pNew->fid || (pMap->refCount == 0 && access(pMap->fname, F_OK) != 0)) {
+      tsdbDropHeadMap(pCache, pMap);
+    }
+    pMap = pNext;
+  }
+}
+
+// Drop the maps beyond maxMaps in the order of use which no reader holds, the held ones stay until a later acquire
+static void tsdbEvictHeadMaps(SHeadMapCache *pCache) {
+  SHeadMap *pMap = pCache->maps;
+  int       pos = 0;
+
+  while (pMap && pCache->nmaps > pCache->maxMaps) {
+    SHeadMap *pNext = pMap->next;
+    if (pos >= pCache->maxMaps && pMap->refCount == 0) {
+      tsdbDropHeadMap(pCache, pMap);
+    } else {
+      pos++;
+    }
+    pMap = pNext;
+  }
+}
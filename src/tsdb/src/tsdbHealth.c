@@ -40,6 +40,7 @@ int32_t tsdbInsertNewBlock(STsdbRepo * pRepo) {
           tsdbFreeBufBlock(pBufBlock);
         } else {
           pPool->nElasticBlocks ++;
+          tsdbUpdatePoolBlocks(pPool);
           cnt ++ ;
         }
     }
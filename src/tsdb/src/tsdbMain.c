@@ -202,6 +202,13 @@ int tsdbCheckCommit(STsdbRepo *pRepo) {
       ((listNEles(pRepo->mem->bufBlockList) >= pCfg->totalBlocks / 3) && (pBufBlock->remain < TSDB_BUFFER_RESERVE))) {
     // trigger commit
     if (tsdbAsyncCommit(pRepo, NULL) < 0) return -1;
+  } else if ((pBufBlock->remain < TSDB_BUFFER_RESERVE) &&
+             tsdbNeedEarlyCommit(pCfg->totalBlocks, (int)listNEles(pRepo->mem->bufBlockList)) &&
+             tsdbCommitQueueIdle()) {
+    // commit threads are idle, commit ahead of time to stagger the commits of vnodes filling together
+    tsdbDebug("vgId:%d commit early with %d buffer blocks in memtable", REPO_ID(pRepo),
+              (int)listNEles(pRepo->mem->bufBlockList));
+    if (tsdbAsyncCommit(pRepo, NULL) < 0) return -1;
   }
   return 0;
 }
@@ -562,6 +569,9 @@ static int32_t tsdbCheckAndSetDefaultCfg(STsdbCfg *pCfg) {
     if (pCfg->cacheLastRow > 3)
       pCfg->cacheLastRow = 1;
   }
+
+  // rollup check
+  if (pCfg->rollup < TSDB_MIN_DB_ROLLUP || pCfg->rollup > TSDB_MAX_DB_ROLLUP) pCfg->rollup = TSDB_DEFAULT_DB_ROLLUP;
   return 0;
 }
 
@@ -599,6 +609,11 @@ static STsdbRepo *tsdbNewRepo(STsdbCfg *pCfg, STsdbAppH *pAppH) {
   pRepo->config_changed = false;
   pRepo->cacheLastConfigVersion = 0;
 
+  if (tsdbInitHeadMaps(pRepo) < 0) {
+    tsdbFreeRepo(pRepo);
+    return NULL;
+  }
+
   code = tsem_init(&(pRepo->readyToCommit), 0, 1);
   if (code != 0) {
     code = errno;
@@ -637,6 +652,8 @@ static void tsdbFreeRepo(STsdbRepo *pRepo) {
     tsdbFreeBufPool(pRepo->pPool);
     tsdbFreeMeta(pRepo->tsdbMeta);
     tsdbFreeMergeBuf(pRepo->mergeBuf);
+    taosArrayDestroy(&pRepo->compactScores);
+    tsdbDestroyHeadMaps(pRepo);
     // tsdbFreeMemTable(pRepo->mem);
     // tsdbFreeMemTable(pRepo->imem);
     tsem_destroy(&(pRepo->readyToCommit));
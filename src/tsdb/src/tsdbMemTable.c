@@ -128,6 +128,7 @@ int tsdbUnRefMemTable(STsdbRepo *pRepo, SMemTable *pMemTable) {
         }
       }      
     }
+    tsdbUpdatePoolBlocks(pBufPool);
     if (addNew) {
       int code = pthread_cond_signal(&pBufPool->poolNotEmpty);
       if (code != 0) {
@@ -318,7 +319,10 @@ int tsdbSyncCommitConfig(STsdbRepo* pRepo) {
 }
 
 int tsdbAsyncCommit(STsdbRepo *pRepo, SControlDataInfo* pCtlDataInfo) {
+  // a background compaction gives up when it sees a writer waiting here
+  atomic_add_fetch_32(&pRepo->commitWaiting, 1);
   tsem_wait(&(pRepo->readyToCommit));
+  atomic_sub_fetch_32(&pRepo->commitWaiting, 1);
 
   ASSERT(pRepo->imem == NULL);
 
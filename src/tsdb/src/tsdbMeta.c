@@ -614,6 +614,77 @@ void tsdbUnRefTable(STable *pTable) {
   }
 }
 
+// The block sizing stats of a table are moving averages over the blocks written and the blocks loaded by the
+// queries, each sample weighs a quarter. They are kept in memory only and learnt again after a restart.
+#define TSDB_BLK_STAT_AVG(avg, sample) (((avg) <= 0) ? (sample) : (int32_t)(((int64_t)(avg)*3 + (sample)) / 4))
+
+void tsdbUpdateBlkBytesPerRow(STable *pTable, int rows, int len) {
+  STable *pStat = TABLE_BLK_STAT(pTable);
+  int32_t sample = MAX(len / rows, 1);
+
+  atomic_store_32(&pStat->blkBytesPerRow, TSDB_BLK_STAT_AVG(atomic_load_32(&pStat->blkBytesPerRow), sample));
+}
+
+// The hit rows start from the max rows of a block, as if the queries scanned whole blocks, so that blocks shrink only
+// after a run of point lookups
+void tsdbUpdateBlkHitRows(STable *pTable, int64_t rows, int64_t blocks, int32_t maxRows) {
+  STable *pStat = TABLE_BLK_STAT(pTable);
+  int32_t sample = (int32_t)MAX(rows / blocks, 1);
+  int32_t avg = atomic_load_32(&pStat->blkHitRows);
+
+  atomic_store_32(&pStat->blkHitRows, TSDB_BLK_STAT_AVG((avg > 0) ? avg : maxRows, sample));
+}
+
+// The columns loaded by the last queries of a table, in two generations so that the columns the queries stop reading
+// cool down. The bits are set and cleared without lock, a column may be missed or kept for a generation, it only
+// changes the order the columns are written in.
+#define TSDB_HOT_COLS_GEN_QUERIES 256
+
+typedef struct SHotCols {
+  int32_t nQueries;
+  int8_t  gen;
+  uint8_t bitmap[2][TSDB_HOT_COLS_BYTES];
+} SHotCols;
+
+void tsdbUpdateHotCols(STable *pTable, int16_t *colIds, int numOfColIds) {
+  STable *  pStat = TABLE_BLK_STAT(pTable);
+  SHotCols *pHot = atomic_load_ptr(&pStat->hotCols);
+
+  if (pHot == NULL) {
+    SHotCols *pNew = calloc(1, sizeof(SHotCols));
+    if (pNew == NULL) return;
+    pHot = atomic_val_compare_exchange_ptr(&pStat->hotCols, NULL, pNew);
+    if (pHot == NULL) {
+      pHot = pNew;
+    } else {
+      free(pNew);
+    }
+  }
+
+  int8_t gen = atomic_load_8(&pHot->gen);
+  for (int i = 0; i < numOfColIds; i++) {
+    if (colIds[i] < 0 || colIds[i] >= TSDB_MAX_COLUMNS) continue;
+    atomic_or_fetch_8(&pHot->bitmap[gen][colIds[i] / 8], (uint8_t)(1 << (colIds[i] % 8)));
+  }
+
+  if (atomic_add_fetch_32(&pHot->nQueries, 1) % TSDB_HOT_COLS_GEN_QUERIES == 0) {
+    memset(pHot->bitmap[1 - gen], 0, TSDB_HOT_COLS_BYTES);
+    atomic_store_8(&pHot->gen, 1 - gen);
+  }
+}
+
+// Get the hot columns of a table, return false if none is known
+bool tsdbGetHotCols(STable *pTable, uint8_t *bitmap) {
+  SHotCols *pHot = atomic_load_ptr(&TABLE_BLK_STAT(pTable)->hotCols);
+  if (pHot == NULL) return false;
+
+  for (int i = 0; i < TSDB_HOT_COLS_BYTES; i++) {
+    bitmap[i] = pHot->bitmap[0][i] | pHot->bitmap[1][i];
+  }
+
+  return true;
+}
+
 void tsdbFreeLastColumns(STable* pTable) {
   if (pTable->lastCols == NULL) {
     return;
@@ -951,6 +1022,7 @@ static void tsdbFreeTable(STable *pTable) {
     tfree(pTable->sql);
 
     tsdbFreeLastColumns(pTable);
+    tfree(pTable->hotCols);
     free(pTable);
   }
 }
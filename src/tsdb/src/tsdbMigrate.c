@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "tsdbint.h"
+#include "tratelimit.h"
+
+/*
+ * Background tier migration. An aged FSET is copied to a disk of its level outside of the commit, under the rate
+ * limit of tsMigrateRateLimit. The copies are named as temporary files, commits keep writing the FSET where it is
+ * meanwhile. Once copied, the FSET is swapped in by a FS transaction, unless a commit or a compaction has changed
+ * it during the copy, in which case the copy is dropped and tried again in the next round.
+ */
+
+#define TSDB_MIGRATE_CHUNK_SIZE (1024 * 1024)
+#define TSDB_MIGRATE_TMP_SUFFIX ".migrate"
+
+// shared by the migrations of all the vnodes of the dnode
+static SRateLimiter * tsMigrateLimiter = NULL;
+static pthread_once_t tsMigrateLimiterInit = PTHREAD_ONCE_INIT;
+
+static void tsdbInitMigrateLimiter() { tsMigrateLimiter = taosOpenRateLimiter(0); }
+
+static bool tsdbPickMigrateFSet(STsdbRepo *pRepo, int fid, SDFileSet *pSet, int *level);
+static int  tsdbMigrateFSet(STsdbRepo *pRepo, SDFileSet *pSet, int level, FMigrateStop fpStop, void *param);
+static int  tsdbCopyDFileThrottled(SDFile *pSrc, TFILE *pDest, FMigrateStop fpStop, void *param);
+static int  tsdbSwapMigratedFSet(STsdbRepo *pRepo, SDFileSet *pOSet, SDiskID did, TFILE *tfiles);
+static bool tsdbIsSameFSet(SDFileSet *pSet1, SDFileSet *pSet2);
+static void tsdbGetMigrateTFile(SDFileSet *pSet, TSDB_FILE_T ftype, SDiskID did, TFILE *pf);
+
+int tsdbMigrate(STsdbRepo *pRepo, FMigrateStop fpStop, void *param) {
+  SDFileSet set;
+  int       level;
+  int       fid = INT32_MIN;
+  int       nmigrated = 0;
+
+  pthread_once(&tsMigrateLimiterInit, tsdbInitMigrateLimiter);
+  taosSetRateLimit(tsMigrateLimiter, (int64_t)tsMigrateRateLimit * 1024 * 1024);
+
+  while (!fpStop(param) && tsdbPickMigrateFSet(pRepo, fid, &set, &level)) {
+    int code = tsdbMigrateFSet(pRepo, &set, level, fpStop, param);
+    if (code < 0) return -1;
+
+    nmigrated += code;
+    if (set.fid == INT32_MAX) break;
+    fid = set.fid + 1;
+  }
+
+  return nmigrated;
+}
+
+// Take the first FSET from fid which is on a lower level than its age asks for
+static bool tsdbPickMigrateFSet(STsdbRepo *pRepo, int fid, SDFileSet *pSet, int *level) {
+  STsdbFS *  pfs = REPO_FS(pRepo);
+  SFSIter    fsiter;
+  SRtn       rtn;
+  SDFileSet *pCSet;
+  bool       found = false;
+
+  tsdbGetRtnSnap(pRepo, &rtn);
+
+  tsdbRLockFS(pfs);
+  tsdbFSIterInit(&fsiter, pfs, TSDB_FS_ITER_FORWARD);
+  tsdbFSIterSeek(&fsiter, MAX(fid, rtn.minFid));
+  while ((pCSet = tsdbFSIterNext(&fsiter))) {
+    *level = MIN(tsdbGetFidLevel(pCSet->fid, &rtn), tfsMaxLevel());
+    if (*level > TSDB_FSET_LEVEL(pCSet)) {
+      *pSet = *pCSet;
+      found = true;
+      break;
+    }
+  }
+  tsdbUnLockFS(pfs);
+
+  return found;
+}
+
+// Returns 1 if the FSET is migrated, 0 if it is skipped for now
+static int tsdbMigrateFSet(STsdbRepo *pRepo, SDFileSet *pSet, int level, FMigrateStop fpStop, void *param) {
+  SDiskID did;
+  TFILE   tfiles[TSDB_FILE_MAX];
+  int64_t size = 0;
+  int     ncopied = 0;
+  int     code = 0;
+
+  for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pSet); ftype++) {
+    size += TSDB_DFILE_IN_SET(pSet, ftype)->info.size;
+  }
+
+  tfsAllocDiskBySize(level, size, &(did.level), &(did.id));
+  if (did.level <= TSDB_FSET_LEVEL(pSet)) {
+    tsdbDebug("vgId:%d FSET %d is not migrated since no disk on level %d has %" PRId64 " bytes free", REPO_ID(pRepo),
+              pSet->fid, level, size);
+    return 0;
+  }
+
+  int64_t st = taosGetTimestampMs();
+  tsdbDebug("vgId:%d FSET %d start to migrate from level %d disk id %d to level %d disk id %d, %" PRId64 " bytes",
+            REPO_ID(pRepo), pSet->fid, TSDB_FSET_LEVEL(pSet), TSDB_FSET_ID(pSet), did.level, did.id, size);
+
+  for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pSet); ftype++) {
+    tsdbGetMigrateTFile(pSet, ftype, did, tfiles + ftype);
+    if (tsdbCopyDFileThrottled(TSDB_DFILE_IN_SET(pSet, ftype), tfiles + ftype, fpStop, param) < 0) break;
+    ncopied++;
+  }
+
+  if (ncopied < tsdbGetNFiles(pSet)) {
+    if (terrno != TSDB_CODE_SUCCESS) {
+      tsdbError("vgId:%d failed to migrate FSET %d since %s", REPO_ID(pRepo), pSet->fid, tstrerror(terrno));
+    } else {
+      tsdbDebug("vgId:%d FSET %d stops migrating since it is rewritten or the vnode stops", REPO_ID(pRepo), pSet->fid);
+    }
+  } else {
+    // the swap takes the slot of a commit, so it never runs in the middle of one
+    tsem_wait(&(pRepo->readyToCommit));
+    if (!fpStop(param)) {
+      code = tsdbSwapMigratedFSet(pRepo, pSet, did, tfiles);
+      // the copies are renamed into the FSET once swapped in, and are dropped otherwise
+      if (code > 0) ncopied = 0;
+    }
+    tsem_post(&(pRepo->readyToCommit));
+  }
+
+  for (int i = 0; i < ncopied; i++) {
+    (void)tfsremove(tfiles + i);
+  }
+
+  if (code > 0) {
+    tsdbInfo("vgId:%d FSET %d is migrated from level %d disk id %d to level %d disk id %d in %" PRId64 " ms",
+             REPO_ID(pRepo), pSet->fid, TSDB_FSET_LEVEL(pSet), TSDB_FSET_ID(pSet), did.level, did.id,
+             taosGetTimestampMs() - st);
+  }
+
+  return (code < 0) ? -1 : code;
+}
+
+static void tsdbGetMigrateTFile(SDFileSet *pSet, TSDB_FILE_T ftype, SDiskID did, TFILE *pf) {
+  char fname[TSDB_FILENAME_LEN + sizeof(TSDB_MIGRATE_TMP_SUFFIX)];
+
+  snprintf(fname, sizeof(fname), "%s%s", TFILE_REL_NAME(TSDB_FILE_F(TSDB_DFILE_IN_SET(pSet, ftype))),
+           TSDB_MIGRATE_TMP_SUFFIX);
+  tfsInitFile(pf, did.level, did.id, fname);
+}
+
+// Copy the file chunk by chunk, so the copy can be throttled and stopped, and the pages it goes through are dropped
+// from the page cache on the way, the FSET is cold and shall not evict the hot data
+static int tsdbCopyDFileThrottled(SDFile *pSrc, TFILE *pDest, FMigrateStop fpStop, void *param) {
+  int     sfd = -1;
+  int     dfd = -1;
+  char *  buf = NULL;
+  int64_t offset = 0;
+  int64_t size;
+
+  terrno = TSDB_CODE_SUCCESS;
+
+  sfd = open(TSDB_FILE_FULL_NAME(pSrc), O_RDONLY | O_BINARY);
+  if (sfd < 0) {
+    // a commit has rewritten the FSET to its level already
+    if (errno != ENOENT) terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  size = taosLSeek(sfd, 0, SEEK_END);
+  if (size < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  if (taosMkdirP(TFILE_NAME(pDest), 0) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+  dfd = open(TFILE_NAME(pDest), O_WRONLY | O_CREAT | O_TRUNC | O_BINARY, 0755);
+  if (dfd < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+#ifdef _TD_LINUX
+  (void)posix_fadvise(sfd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  while (offset < size) {
+    if (fpStop(param)) goto _err;
+
+    int64_t nbytes = MIN(size - offset, TSDB_MIGRATE_CHUNK_SIZE);
+    int64_t ncopied = -1;
+
+#if defined(_TD_LINUX) && defined(SYS_copy_file_range)
+    // in kernel copy, it falls back to read and write when the kernel or the file systems do not support it
+    if (buf == NULL) {
+      int64_t soff = offset;
+      ncopied = syscall(SYS_copy_file_range, sfd, &soff, dfd, NULL, (size_t)nbytes, 0);
+      if (ncopied < 0 && errno != ENOSYS && errno != EXDEV && errno != EINVAL && errno != EOPNOTSUPP) {
+        terrno = TAOS_SYSTEM_ERROR(errno);
+        goto _err;
+      }
+    }
+#endif
+
+    if (ncopied <= 0) {
+      if (buf == NULL && (buf = malloc(TSDB_MIGRATE_CHUNK_SIZE)) == NULL) {
+        terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+        goto _err;
+      }
+
+      ncopied = pread(sfd, buf, (size_t)nbytes, offset);
+      if (ncopied <= 0) {
+        terrno = (ncopied < 0) ? TAOS_SYSTEM_ERROR(errno) : TSDB_CODE_TDB_FILE_CORRUPTED;
+        goto _err;
+      }
+
+      if (taosWrite(dfd, buf, ncopied) < ncopied) {
+        terrno = TAOS_SYSTEM_ERROR(errno);
+        goto _err;
+      }
+    }
+
+#ifdef _TD_LINUX
+    (void)posix_fadvise(sfd, offset, ncopied, POSIX_FADV_DONTNEED);
+#endif
+
+    offset += ncopied;
+    taosRateLimit(tsMigrateLimiter, ncopied);
+  }
+
+  if (taosFsync(dfd) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    goto _err;
+  }
+
+#ifdef _TD_LINUX
+  (void)posix_fadvise(dfd, 0, 0, POSIX_FADV_DONTNEED);
+#endif
+
+  tfree(buf);
+  close(sfd);
+  close(dfd);
+  return 0;
+
+_err:
+  tfree(buf);
+  if (sfd >= 0) close(sfd);
+  if (dfd >= 0) {
+    close(dfd);
+    (void)tfsremove(pDest);
+  }
+  return -1;
+}
+
+// Must be called with readyToCommit taken. Returns 1 if swapped, 0 if the FSET has changed during the copy
+static int tsdbSwapMigratedFSet(STsdbRepo *pRepo, SDFileSet *pOSet, SDiskID did, TFILE *tfiles) {
+  STsdbFS *  pfs = REPO_FS(pRepo);
+  SDFileSet  nSet;
+  SDFileSet *pSet;
+  SFSIter    fsiter;
+  int        nrenamed = 0;
+
+  tsdbFSIterInit(&fsiter, pfs, TSDB_FS_ITER_FORWARD);
+  tsdbFSIterSeek(&fsiter, pOSet->fid);
+  pSet = tsdbFSIterNext(&fsiter);
+  if (pSet == NULL || !tsdbIsSameFSet(pSet, pOSet)) {
+    tsdbDebug("vgId:%d FSET %d is changed while migrating, try it later", REPO_ID(pRepo), pOSet->fid);
+    return 0;
+  }
+
+  tsdbStartFSTxn(pRepo, 0, 0);
+
+  tsdbInitDFileSet(&nSet, did, REPO_ID(pRepo), pOSet->fid, FS_TXN_VERSION(pfs), pOSet->ver);
+  for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(&nSet); ftype++) {
+    SDFile *pDFile = TSDB_DFILE_IN_SET(&nSet, ftype);
+    if (tfsrename(tfiles + ftype, TSDB_FILE_F(pDFile)) < 0) {
+      terrno = TAOS_SYSTEM_ERROR(errno);
+      goto _err;
+    }
+    nrenamed++;
+    tsdbSetDFileInfo(pDFile, TSDB_FILE_INFO(TSDB_DFILE_IN_SET(pOSet, ftype)));
+  }
+
+  tsdbUpdateMFile(pfs, pfs->cstatus->pmf);
+
+  tsdbFSIterInit(&fsiter, pfs, TSDB_FS_ITER_FORWARD);
+  while ((pSet = tsdbFSIterNext(&fsiter))) {
+    if (tsdbUpdateDFileSet(pfs, (pSet->fid == nSet.fid) ? &nSet : pSet) < 0) {
+      goto _err;
+    }
+  }
+
+  if (tsdbEndFSTxn(pRepo) < 0) {
+    // the new files are removed by the transaction
+    return -1;
+  }
+
+  return 1;
+
+_err:
+  tsdbError("vgId:%d failed to swap in migrated FSET %d since %s", REPO_ID(pRepo), pOSet->fid, tstrerror(terrno));
+  for (int i = 0; i < nrenamed; i++) {
+    (void)tfsrename(TSDB_FILE_F(TSDB_DFILE_IN_SET(&nSet, i)), tfiles + i);
+  }
+  tsdbEndFSTxnWithError(pfs);
+  return -1;
+}
+
+// commits append to the data file of a FSET in place, so the sizes and checksums are compared besides the names
+static bool tsdbIsSameFSet(SDFileSet *pSet1, SDFileSet *pSet2) {
+  if (pSet1->fid != pSet2->fid || pSet1->ver != pSet2->ver) return false;
+
+  for (TSDB_FILE_T ftype = 0; ftype < tsdbGetNFiles(pSet1); ftype++) {
+    SDFile *pDFile1 = TSDB_DFILE_IN_SET(pSet1, ftype);
+    SDFile *pDFile2 = TSDB_DFILE_IN_SET(pSet2, ftype);
+    if (!tfsIsSameFile(TSDB_FILE_F(pDFile1), TSDB_FILE_F(pDFile2)) || pDFile1->info.size != pDFile2->info.size ||
+        pDFile1->info.magic != pDFile2->info.magic) {
+      return false;
+    }
+  }
+
+  return true;
+}
@@ -97,6 +97,8 @@ typedef struct STableCheckInfo {
   bool          initBuf;        // whether to initialize the in-memory skip list iterator or not
   SSkipListIterator* iter;      // mem buffer skip list iterator
   SSkipListIterator* iiter;     // imem buffer skip list iterator
+  int64_t       fileRows;       // rows taken from the file blocks of the table, for block sizing
+  int64_t       fileBlocks;     // file blocks of the table loaded, for block sizing
 } STableCheckInfo;
 
 typedef struct STableBlockInfo {
@@ -117,6 +119,9 @@ typedef struct SIOCostSummary {
   int64_t checkForNextTime;
   int64_t headFileLoad;
   int64_t headFileLoadTime;
+  int64_t memRows;
+  int64_t fileRows;
+  int64_t fileBlocks;
 } SIOCostSummary;
 
 typedef struct STsdbQueryHandle {
@@ -1441,6 +1446,34 @@ static int32_t loadBlockInfo(STsdbQueryHandle * pQueryHandle, int32_t tsd_index,
   return 0;
 }
 
+// check with the table index of the file set if none of the tables to load has blocks in it which reach the query
+// window, so that the file set is skipped without being opened. The FS should be read locked.
+static bool fileSetHasNoQueryTables(STsdbQueryHandle* pQueryHandle, SDFileSet* pSet) {
+  STsdbFS* pfs = REPO_FS(pQueryHandle->pTsdb);
+  TSKEY    skey = MIN(pQueryHandle->window.skey, pQueryHandle->window.ekey);
+
+  if (pQueryHandle->loadType == BLOCK_LOAD_TABLE_SEQ_ORDER) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, pQueryHandle->activeIndex);
+    int32_t          tid = TABLE_TID(pCheckInfo->pTableObj);
+    return tsdbFSetHasTables(pfs, pSet, &tid, 1, skey) == 0;
+  }
+
+  size_t   numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
+  int32_t* tids = malloc(numOfTables * sizeof(int32_t));
+  if (tids == NULL) {
+    return false;
+  }
+
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
+    tids[i] = TABLE_TID(pCheckInfo->pTableObj);
+  }
+
+  bool noTables = (tsdbFSetHasTables(pfs, pSet, tids, (int)numOfTables, skey) == 0);
+  free(tids);
+  return noTables;
+}
+
 static int32_t getFileCompInfo(STsdbQueryHandle* pQueryHandle, int32_t* numOfBlocks) {
   // load all the comp offset value for all tables in this file
   int32_t code = TSDB_CODE_SUCCESS;
@@ -1528,6 +1561,8 @@ static int32_t doLoadFileDataBlock(STsdbQueryHandle* pQueryHandle, SBlock* pBloc
 
   int64_t elapsedTime = (taosGetTimestampUs() - st);
   pQueryHandle->cost.blockLoadTime += elapsedTime;
+  pQueryHandle->cost.fileBlocks += 1;
+  pCheckInfo->fileBlocks += 1;
 
   tsdbDebug("%p load file block into buffer, index:%d, brange:%"PRId64"-%"PRId64", rows:%d, elapsed time:%"PRId64 " us, 0x%"PRIx64,
       pQueryHandle, slotIndex, pBlock->keyFirst, pBlock->keyLast, pBlock->numOfRows, elapsedTime, pQueryHandle->qId);
@@ -1542,7 +1577,7 @@ _error:
 }
 
 static int32_t getEndPosInDataBlock(STsdbQueryHandle* pQueryHandle, SDataBlockInfo* pBlockInfo);
-static int32_t doCopyRowsFromFileBlock(STsdbQueryHandle* pQueryHandle, int32_t capacity, int32_t numOfRows, int32_t start, int32_t end);
+static int32_t doCopyRowsFromFileBlock(STsdbQueryHandle* pQueryHandle, STableCheckInfo* pCheckInfo, int32_t capacity, int32_t numOfRows, int32_t start, int32_t end);
 static void moveDataToFront(STsdbQueryHandle* pQueryHandle, int32_t numOfRows, int32_t numOfCols);
 static void doCheckGeneratedBlockRange(STsdbQueryHandle* pQueryHandle);
 static void copyAllRemainRowsFromFileBlock(STsdbQueryHandle* pQueryHandle, STableCheckInfo* pCheckInfo, SDataBlockInfo* pBlockInfo, int32_t endPos);
@@ -1755,7 +1790,7 @@ static int doBinarySearchKey(TSKEY* keyList, int num, int pos, TSKEY key, int or
     }
 }
 
-static int32_t doCopyRowsFromFileBlock(STsdbQueryHandle* pQueryHandle, int32_t capacity, int32_t numOfRows, int32_t start, int32_t end) {
+static int32_t doCopyRowsFromFileBlock(STsdbQueryHandle* pQueryHandle, STableCheckInfo* pCheckInfo, int32_t capacity, int32_t numOfRows, int32_t start, int32_t end) {
   char* pData = NULL;
   int32_t step = ASCENDING_TRAVERSE(pQueryHandle->order)? 1 : -1;
 
@@ -1769,6 +1804,9 @@ static int32_t doCopyRowsFromFileBlock(STsdbQueryHandle* pQueryHandle, int32_t c
     return numOfRows;
   }
 
+  pQueryHandle->cost.fileRows += num;
+  pCheckInfo->fileRows += num;
+
   int32_t requiredNumOfCols = (int32_t)taosArrayGetSize(pQueryHandle->pColumns);
 
   //data in buffer has greater timestamp, copy data in file block
@@ -1865,6 +1903,8 @@ static void mergeTwoRowFromMem(STsdbQueryHandle* pQueryHandle, int32_t capacity,
   int32_t chosen_itr;
   void *value;
 
+  pQueryHandle->cost.memRows += 1;
+
   // the schema version info is embedded in SDataRow
   int32_t numOfColsOfRow1 = 0;
 
@@ -2136,7 +2176,7 @@ static void copyAllRemainRowsFromFileBlock(STsdbQueryHandle* pQueryHandle, STabl
   }
 
   assert(pQueryHandle->outputCapacity >= (end - start + 1));
-  int32_t numOfRows = doCopyRowsFromFileBlock(pQueryHandle, pQueryHandle->outputCapacity, 0, start, end);
+  int32_t numOfRows = doCopyRowsFromFileBlock(pQueryHandle, pCheckInfo, pQueryHandle->outputCapacity, 0, start, end);
 
   // the time window should always be ascending order: skey <= ekey
   cur->win = (STimeWindow) {.skey = tsArray[start], .ekey = tsArray[end]};
@@ -2277,7 +2317,7 @@ static void doMergeTwoLevelData(STsdbQueryHandle* pQueryHandle, STableCheckInfo*
       } else if (keyMem == keyFile[pos]) {
         if (pCfg->update) {
           if(pCfg->update == TD_ROW_PARTIAL_UPDATE) {
-            doCopyRowsFromFileBlock(pQueryHandle, pQueryHandle->outputCapacity, numOfRows, pos, pos);
+            doCopyRowsFromFileBlock(pQueryHandle, pCheckInfo, pQueryHandle->outputCapacity, numOfRows, pos, pos);
           }
           if (rv1 != memRowVersion(row1)) {
             pSchema1 = tsdbGetTableSchemaByVersion(pTable, memRowVersion(row1), (int8_t)memRowType(row1));
@@ -2331,7 +2371,7 @@ static void doMergeTwoLevelData(STsdbQueryHandle* pQueryHandle, STableCheckInfo*
 
         if(qend >= qstart) {
           // copy qend - qstart + 1 rows from file
-          numOfRows = doCopyRowsFromFileBlock(pQueryHandle, pQueryHandle->outputCapacity, numOfRows, qstart, qend);
+          numOfRows = doCopyRowsFromFileBlock(pQueryHandle, pCheckInfo, pQueryHandle->outputCapacity, numOfRows, qstart, qend);
           int32_t num = qend - qstart + 1;
           pos += num * step;
         } else {
@@ -2362,7 +2402,7 @@ static void doMergeTwoLevelData(STsdbQueryHandle* pQueryHandle, STableCheckInfo*
         int32_t start = -1, end = -1;
         getQualifiedRowsPos(pQueryHandle, pos, endPos, numOfRows, &start, &end);
 
-        numOfRows = doCopyRowsFromFileBlock(pQueryHandle, pQueryHandle->outputCapacity, numOfRows, start, end);
+        numOfRows = doCopyRowsFromFileBlock(pQueryHandle, pCheckInfo, pQueryHandle->outputCapacity, numOfRows, start, end);
         pos += (end - start + 1) * step;
 
         cur->win.ekey = ASCENDING_TRAVERSE(pQueryHandle->order)? keyFile[end] : keyFile[start];
@@ -2675,6 +2715,13 @@ static int32_t getFirstFileDataBlock(STsdbQueryHandle* pQueryHandle, bool* exist
       break;
     }
 
+    if (fileSetHasNoQueryTables(pQueryHandle, pQueryHandle->pFileGroup)) {
+      tsdbUnLockFS(REPO_FS(pQueryHandle->pTsdb));
+      tsdbDebug("%p no block of %d table(s) in file, fid:%d, ignore, 0x%"PRIx64, pQueryHandle, numOfTables,
+                pQueryHandle->pFileGroup->fid, pQueryHandle->qId);
+      continue;
+    }
+
     if (tsdbSetAndOpenReadFSet(&pQueryHandle->rhelper, pQueryHandle->pFileGroup) < 0) {
       tsdbUnLockFS(REPO_FS(pQueryHandle->pTsdb));
       code = terrno;
@@ -2825,6 +2872,11 @@ int32_t tsdbGetFileBlocksDistInfo(TsdbQueryHandleT* queryHandle, STableBlockDist
     }
 
     pTableBlockInfo->numOfFiles += 1;
+    if (fileSetHasNoQueryTables(pQueryHandle, pQueryHandle->pFileGroup)) {
+      tsdbUnLockFS(REPO_FS(pQueryHandle->pTsdb));
+      continue;
+    }
+
     if (tsdbSetAndOpenReadFSet(&pQueryHandle->rhelper, pQueryHandle->pFileGroup) < 0) {
       tsdbUnLockFS(REPO_FS(pQueryHandle->pTsdb));
       code = terrno;
@@ -3791,6 +3843,29 @@ int32_t tsdbRetrieveDataBlockStatisInfo(TsdbQueryHandleT* pQueryHandle, SDataSta
   return TSDB_CODE_SUCCESS;
 }
 
+bool tsdbDataBlockMayHaveValue(TsdbQueryHandleT* pQueryHandle, int16_t colId, int8_t type, const void* val) {
+  STsdbQueryHandle* pHandle = (STsdbQueryHandle*) pQueryHandle;
+
+  SQueryFilePos* c = &pHandle->cur;
+  if (c->fid == INT32_MIN || c->mixBlock) {
+    return true;
+  }
+
+  STableBlockInfo* pBlockInfo = &pHandle->pDataBlockInfo[c->slot];
+
+  int64_t stime = taosGetTimestampUs();
+  int     code = tsdbBlockMayHaveValue(&pHandle->rhelper, pBlockInfo->compBlock, colId, type, val);
+  pHandle->cost.statisInfoLoadTime += (taosGetTimestampUs() - stime);
+
+  if (code < 0) {
+    tsdbWarn("%p failed to check the bloom filter of column %d since %s, 0x%"PRIx64, pHandle, colId, tstrerror(terrno),
+             pHandle->qId);
+    return true;
+  }
+
+  return code > 0;
+}
+
 SArray* tsdbRetrieveDataBlock(TsdbQueryHandleT* pQueryHandle, SArray* pIdList) {
   /**
    * In the following two cases, the data has been loaded to SColumnInfoData.
@@ -3823,7 +3898,7 @@ SArray* tsdbRetrieveDataBlock(TsdbQueryHandleT* pQueryHandle, SArray* pIdList) {
         }
 
         // todo refactor
-        int32_t numOfRows = doCopyRowsFromFileBlock(pHandle, pHandle->outputCapacity, 0, 0, pBlock->numOfRows - 1);
+        int32_t numOfRows = doCopyRowsFromFileBlock(pHandle, pCheckInfo, pHandle->outputCapacity, 0, 0, pBlock->numOfRows - 1);
 
         // if the buffer is not full in case of descending order query, move the data in the front of the buffer
         if (!ASCENDING_TRAVERSE(pHandle->order) && numOfRows < pHandle->outputCapacity) {
@@ -4256,12 +4331,41 @@ static void* destroyTableCheckInfo(SArray* pTableCheckInfo) {
   return NULL;
 }
 
+// Once per query, each table it loaded file blocks of learns the rows taken from each block, which size its blocks,
+// and the columns loaded, which are written next to each other in its blocks. Child tables share the stats of their
+// super table. The rows taken per block are learnt only from the queries that loaded more than one block of a table:
+// a last row or a narrow range loads a single block whatever its size, and would shrink the blocks of full scans.
+static void updateTableBlkStats(STsdbQueryHandle* pQueryHandle) {
+  if (pQueryHandle->pTableCheckInfo == NULL || pQueryHandle->defaultLoadColumn == NULL) {
+    return;
+  }
+
+  int16_t* colIds = pQueryHandle->defaultLoadColumn->pData;
+  int32_t  numOfCols = (int32_t)taosArrayGetSize(pQueryHandle->defaultLoadColumn);
+
+  size_t numOfTables = taosArrayGetSize(pQueryHandle->pTableCheckInfo);
+  for (int32_t i = 0; i < numOfTables; ++i) {
+    STableCheckInfo* pCheckInfo = taosArrayGet(pQueryHandle->pTableCheckInfo, i);
+    if (pCheckInfo->fileBlocks == 0) {
+      continue;
+    }
+
+    if (pCheckInfo->fileBlocks > 1) {
+      tsdbUpdateBlkHitRows(pCheckInfo->pTableObj, pCheckInfo->fileRows, pCheckInfo->fileBlocks,
+                           pQueryHandle->pTsdb->config.maxRowsPerFileBlock);
+    }
+    tsdbUpdateHotCols(pCheckInfo->pTableObj, colIds, numOfCols);
+  }
+}
+
 void tsdbCleanupQueryHandle(TsdbQueryHandleT queryHandle) {
   STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
   if (pQueryHandle == NULL) {
     return;
   }
 
+  updateTableBlkStats(pQueryHandle);
+
   pQueryHandle->pColumns = doFreeColumnInfoData(pQueryHandle->pColumns);
 
   taosArrayDestroy(&pQueryHandle->defaultLoadColumn);
@@ -4684,6 +4788,19 @@ int64_t tsdbSkipOffset(TsdbQueryHandleT queryHandle) {
   return 0;
 }
 
+void tsdbGetQueryCost(TsdbQueryHandleT queryHandle, STsdbQueryCost *pCost) {
+  STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
+  memset(pCost, 0, sizeof(STsdbQueryCost));
+  if (pQueryHandle == NULL) {
+    return;
+  }
+
+  pCost->memRows     = pQueryHandle->cost.memRows;
+  pCost->fileRows    = pQueryHandle->cost.fileRows;
+  pCost->readBytes   = pQueryHandle->rhelper.readBytes;
+  pCost->decodeBytes = pQueryHandle->rhelper.decodeBytes;
+}
+
 // add scan table need callback 
 void tsdbAddScanCallback(TsdbQueryHandleT* queryHandle, readover_callback callback, void* param) {
   STsdbQueryHandle* pQueryHandle = (STsdbQueryHandle*)queryHandle;
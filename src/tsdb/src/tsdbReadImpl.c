@@ -16,6 +16,13 @@
 #include "tsdbint.h"
 
 #define TSDB_KEY_COL_OFFSET 0
+#define TSDB_COL_READ_GAP 4096  // bytes between two columns to load read through rather than sought over
+#define TSDB_BLOOM_COLIDS_SIZE(ncols) (((ncols) * sizeof(int16_t) + 7) / 8 * 8)  // ahead of the bloom filters loaded
+
+typedef struct {
+  SBlockCol blockCol;
+  SDataCol *pDataCol;
+} SColLoad;
 
 static void tsdbResetReadTable(SReadH *pReadh);
 static void tsdbResetReadFile(SReadH *pReadh);
@@ -24,9 +31,12 @@ static int  tsdbCheckAndDecodeColumnData(SDataCol *pDataCol, void *content, int3
                                          int maxPoints, char *buffer, int bufferSize);
 static int  tsdbLoadBlockDataColsImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDataCols, int16_t *colIds,
                                       int numOfColIds);
-static int  tsdbLoadColData(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, SBlockCol *pBlockCol, SDataCol *pDataCol);
+static int  tsdbLoadColsData(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, SColLoad *pLoads, int nLoads);
+static int  tsdbComparColLoadOffset(const void *arg1, const void *arg2);
 static int  tsdbLoadBlockStatisFromDFile(SReadH *pReadh, SBlock *pBlock);
 static int  tsdbLoadBlockStatisFromAggr(SReadH *pReadh, SBlock *pBlock);
+static int  tsdbLoadBlockBloom(SReadH *pReadh, SBlock *pBlock);
+static void tsdbReadSetTblIdx(SReadH *pReadh, SArray *aBlkIdx);
 
 int tsdbInitReadH(SReadH *pReadh, STsdbRepo *pRepo) {
   ASSERT(pReadh != NULL && pRepo != NULL);
@@ -69,8 +79,12 @@ void tsdbDestroyReadH(SReadH *pReadh) {
   pReadh->pDCols[0] = tdFreeDataCols(pReadh->pDCols[0]);
   pReadh->pDCols[1] = tdFreeDataCols(pReadh->pDCols[1]);
   pReadh->pAggrBlkData = taosTZfree(pReadh->pAggrBlkData);
+  pReadh->pBloomBuf = taosTZfree(pReadh->pBloomBuf);
   pReadh->pBlkData = taosTZfree(pReadh->pBlkData);
-  pReadh->pBlkInfo = taosTZfree(pReadh->pBlkInfo);
+  tsdbReleaseHeadMap(pReadh->pRepo, pReadh->pHeadMap);
+  pReadh->pHeadMap = NULL;
+  pReadh->pBlkInfoBuf = taosTZfree(pReadh->pBlkInfoBuf);
+  pReadh->pBlkInfo = NULL;
   pReadh->cidx = 0;
   pReadh->pBlkIdx = NULL;
   pReadh->pTable = NULL;
@@ -100,10 +114,21 @@ int tsdbLoadBlockIdx(SReadH *pReadh) {
   SDFile *  pHeadf = TSDB_READ_HEAD_FILE(pReadh);
   SBlockIdx blkIdx;
 
-  ASSERT(taosArrayGetSize(pReadh->aBlkIdx) == 0);
+  ASSERT(taosArrayGetSize(pReadh->aBlkIdx) == 0 && pReadh->pHeadMap == NULL);
 
   // No data at all, just return
-  if (pHeadf->info.offset <= 0) return 0;
+  if (pHeadf->info.offset <= 0) {
+    tsdbReadSetTblIdx(pReadh, pReadh->aBlkIdx);
+    return 0;
+  }
+
+  pReadh->pHeadMap = tsdbAcquireHeadMap(TSDB_READ_REPO(pReadh), TSDB_READ_FSET(pReadh));
+  if (pReadh->pHeadMap != NULL) {
+    // the part is read through the map instead of the file, it is counted the same
+    pReadh->readBytes += pHeadf->info.len;
+    tsdbReadSetTblIdx(pReadh, pReadh->pHeadMap->aBlkIdx);
+    return 0;
+  }
 
   if (tsdbSeekDFile(pHeadf, pHeadf->info.offset, SEEK_SET) < 0) {
     tsdbError("vgId:%d failed to load SBlockIdx part while seek file %s since %s, offset:%u len :%u",
@@ -128,6 +153,7 @@ int tsdbLoadBlockIdx(SReadH *pReadh) {
               TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), pHeadf->info.offset, pHeadf->info.len, nread);
     return -1;
   }
+  pReadh->readBytes += nread;
 
   if (!taosCheckChecksumWhole((uint8_t *)TSDB_READ_BUF(pReadh), pHeadf->info.len)) {
     terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
@@ -152,9 +178,18 @@ int tsdbLoadBlockIdx(SReadH *pReadh) {
                              ((SBlockIdx *)taosArrayGet(pReadh->aBlkIdx, tsize - 1))->tid);
   }
 
+  tsdbReadSetTblIdx(pReadh, pReadh->aBlkIdx);
   return 0;
 }
 
+static void tsdbReadSetTblIdx(SReadH *pReadh, SArray *aBlkIdx) {
+  STsdbCfg *pCfg = REPO_CFG(TSDB_READ_REPO(pReadh));
+  TSKEY     minKey, maxKey;
+
+  tsdbGetFidKeyRange(pCfg->daysPerFile, pCfg->precision, TSDB_FSET_FID(TSDB_READ_FSET(pReadh)), &minKey, &maxKey);
+  tsdbFSSetTblIdx(REPO_FS(TSDB_READ_REPO(pReadh)), TSDB_READ_FSET(pReadh), aBlkIdx, minKey, maxKey);
+}
+
 int tsdbSetReadTable(SReadH *pReadh, STable *pTable) {
   STSchema *pSchema = tsdbGetTableSchemaImpl(pTable, false, false, -1, -1);
 
@@ -170,12 +205,13 @@ int tsdbSetReadTable(SReadH *pReadh, STable *pTable) {
     return -1;
   }
 
-  size_t size = taosArrayGetSize(pReadh->aBlkIdx);
+  SArray *aBlkIdx = TSDB_READ_BLKIDX_ARRAY(pReadh);
+  size_t  size = taosArrayGetSize(aBlkIdx);
   if (size > 0) {
     int64_t left = 0, right = size - 1;
     while (left <= right) {
       int64_t mid = (left + right) / 2;
-      SBlockIdx *pBlkIdx = taosArrayGet(pReadh->aBlkIdx, (size_t)mid);
+      SBlockIdx *pBlkIdx = taosArrayGet(aBlkIdx, (size_t)mid);
       if (pBlkIdx->tid == TABLE_TID(pTable)) {
         if (pBlkIdx->uid == TABLE_UID(pTable)) {
           pReadh->pBlkIdx = pBlkIdx;
@@ -229,6 +265,7 @@ int tsdbLoadBlockInfo(SReadH *pReadh, void *pTarget) {
               TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), pBlkIdx->offset, pBlkIdx->len, nread);
     return -1;
   }
+  pReadh->readBytes += nread;
 
   if (!taosCheckChecksumWhole((uint8_t *)(pReadh->pBlkInfo), pBlkIdx->len)) {
     terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
@@ -314,27 +351,46 @@ int tsdbLoadBlockInfo(SReadH *pReadh, void **pTarget, uint32_t *extendedLen) {
 
   SDFile *    pHeadf = TSDB_READ_HEAD_FILE(pReadh);
   SBlockIdx * pBlkIdx = pReadh->pBlkIdx;
+  SHeadMap *  pMap = pReadh->pHeadMap;
 
-  if (tsdbSeekDFile(pHeadf, pBlkIdx->offset, SEEK_SET) < 0) {
-    tsdbError("vgId:%d failed to load SBlockInfo part while seek file %s since %s, offset:%u len:%u",
-              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), tstrerror(terrno), pBlkIdx->offset, pBlkIdx->len);
-    return -1;
-  }
+  if (pMap != NULL) {
+    pReadh->readBytes += pBlkIdx->len;
 
-  if (tsdbMakeRoom((void **)(&pReadh->pBlkInfo), pBlkIdx->len) < 0) return -1;
+    // The SBlockInfo is used in place if it needs no refactor and is aligned, it is copied otherwise
+    SBlockInfo *pBlkInfo = (SBlockInfo *)POINTER_SHIFT(pMap->addr, pBlkIdx->offset);
+    if (tsdbGetSBlockVer(pHeadf->info.fver) > TSDB_SBLK_VER_0 && ((uintptr_t)pBlkInfo & (sizeof(int64_t) - 1)) == 0) {
+      pReadh->pBlkInfo = pBlkInfo;
+    } else {
+      if (tsdbMakeRoom((void **)(&pReadh->pBlkInfoBuf), pBlkIdx->len) < 0) return -1;
+      memcpy((void *)(pReadh->pBlkInfoBuf), (void *)pBlkInfo, pBlkIdx->len);
+      pReadh->pBlkInfo = pReadh->pBlkInfoBuf;
+    }
+  } else {
+    if (tsdbSeekDFile(pHeadf, pBlkIdx->offset, SEEK_SET) < 0) {
+      tsdbError("vgId:%d failed to load SBlockInfo part while seek file %s since %s, offset:%u len:%u",
+                TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), tstrerror(terrno), pBlkIdx->offset,
+                pBlkIdx->len);
+      return -1;
+    }
 
-  int64_t nread = tsdbReadDFile(pHeadf, (void *)(pReadh->pBlkInfo), pBlkIdx->len);
-  if (nread < 0) {
-    tsdbError("vgId:%d failed to load SBlockInfo part while read file %s since %s, offset:%u len :%u",
-              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), tstrerror(terrno), pBlkIdx->offset, pBlkIdx->len);
-    return -1;
-  }
+    if (tsdbMakeRoom((void **)(&pReadh->pBlkInfoBuf), pBlkIdx->len) < 0) return -1;
+    pReadh->pBlkInfo = pReadh->pBlkInfoBuf;
 
-  if (nread < pBlkIdx->len) {
-    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
-    tsdbError("vgId:%d SBlockInfo part in file %s is corrupted, offset:%u expected bytes:%u read bytes:%" PRId64,
-              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), pBlkIdx->offset, pBlkIdx->len, nread);
-    return -1;
+    int64_t nread = tsdbReadDFile(pHeadf, (void *)(pReadh->pBlkInfo), pBlkIdx->len);
+    if (nread < 0) {
+      tsdbError("vgId:%d failed to load SBlockInfo part while read file %s since %s, offset:%u len :%u",
+                TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), tstrerror(terrno), pBlkIdx->offset,
+                pBlkIdx->len);
+      return -1;
+    }
+
+    if (nread < pBlkIdx->len) {
+      terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+      tsdbError("vgId:%d SBlockInfo part in file %s is corrupted, offset:%u expected bytes:%u read bytes:%" PRId64,
+                TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pHeadf), pBlkIdx->offset, pBlkIdx->len, nread);
+      return -1;
+    }
+    pReadh->readBytes += nread;
   }
 
   if (!taosCheckChecksumWhole((uint8_t *)(pReadh->pBlkInfo), pBlkIdx->len)) {
@@ -347,8 +403,13 @@ int tsdbLoadBlockInfo(SReadH *pReadh, void **pTarget, uint32_t *extendedLen) {
   ASSERT(pBlkIdx->tid == pReadh->pBlkInfo->tid && pBlkIdx->uid == pReadh->pBlkInfo->uid);
 
   uint32_t dstBlkInfoLen = 0;
-  if (tsdbSBlkInfoRefactor(pHeadf, &(pReadh->pBlkInfo), pBlkIdx, &dstBlkInfoLen) < 0) {
-    return -1;
+  if (pReadh->pBlkInfo == pReadh->pBlkInfoBuf) {
+    if (tsdbSBlkInfoRefactor(pHeadf, &(pReadh->pBlkInfoBuf), pBlkIdx, &dstBlkInfoLen) < 0) {
+      return -1;
+    }
+    pReadh->pBlkInfo = pReadh->pBlkInfoBuf;
+  } else {
+    dstBlkInfoLen = pBlkIdx->len;
   }
 
   if (extendedLen != NULL) {
@@ -396,6 +457,24 @@ int tsdbLoadBlockData(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo) {
   return 0;
 }
 
+// Load the sub-blocks after the first one of a super block, which hold the out-of-order rows committed into the block,
+// and merge them into pReadh->pDCols[0]. The result is what the sub-blocks add to the first one.
+int tsdbLoadBlockDelta(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo) {
+  ASSERT(pBlock->numOfSubBlocks > 1);
+  int8_t update = pReadh->pRepo->config.update;
+
+  SBlock *iBlock = (SBlock *)POINTER_SHIFT(pBlkInfo ? pBlkInfo : pReadh->pBlkInfo, pBlock->offset) + 1;
+
+  if (tsdbLoadBlockDataImpl(pReadh, iBlock, pReadh->pDCols[0]) < 0) return -1;
+  for (int i = 2; i < pBlock->numOfSubBlocks; i++) {
+    iBlock++;
+    if (tsdbLoadBlockDataImpl(pReadh, iBlock, pReadh->pDCols[1]) < 0) return -1;
+    if (tdMergeDataCols(pReadh->pDCols[0], pReadh->pDCols[1], pReadh->pDCols[1]->numOfRows, NULL, update != TD_ROW_PARTIAL_UPDATE) < 0) return -1;
+  }
+
+  return 0;
+}
+
 int tsdbLoadBlockDataCols(SReadH *pReadh, SBlock *pBlock, SBlockInfo *pBlkInfo, int16_t *colIds, int numOfColsIds) {
   ASSERT(pBlock->numOfSubBlocks > 0);
   int8_t update = pReadh->pRepo->config.update;
@@ -448,6 +527,7 @@ static int tsdbLoadBlockStatisFromDFile(SReadH *pReadh, SBlock *pBlock) {
               TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), (int64_t)pBlock->offset, size, nread);
     return -1;
   }
+  pReadh->readBytes += nread;
 
   if (!taosCheckChecksumWhole((uint8_t *)(pReadh->pBlkData), (uint32_t)size)) {
     terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
@@ -488,6 +568,7 @@ static int tsdbLoadBlockStatisFromAggr(SReadH *pReadh, SBlock *pBlock) {
               nreadAggr);
     return -1;
   }
+  pReadh->readBytes += nreadAggr;
 
   if (!taosCheckChecksumWhole((uint8_t *)(pReadh->pAggrBlkData), (uint32_t)sizeAggr)) {
     terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
@@ -515,6 +596,84 @@ int tsdbLoadBlockOffset(SReadH *pReadh, SBlock *pBlock) {
   return tsdbLoadBlockStatisFromDFile(pReadh, pBlock);
 }
 
+// Return 0 if no row of the block has the value in the column by its bloom filter, 1 if some row may have it or the
+// column has no bloom filter in the block, -1 on error. A block flagged without filters is not read at all.
+int tsdbBlockMayHaveValue(SReadH *pReadh, SBlock *pBlock, int16_t colId, int8_t type, const void *val) {
+  if (!pBlock->bloom || pBlock->numOfSubBlocks > 1 || pBlock->blkVer == TSDB_SBLK_VER_0 || !pBlock->aggrStat) return 1;
+
+  const void *key = NULL;
+  int32_t     len = tsdbBloomKey(type, val, &key);
+  if (len < 0) return 1;
+
+  if (pReadh->bloomOffset != pBlock->offset || pReadh->bloomLast != pBlock->last) {
+    if (tsdbLoadBlockBloom(pReadh, pBlock) < 0) return -1;
+  }
+
+  int16_t *colIds = (int16_t *)pReadh->pBloomBuf;
+  int32_t  bloomBytes = TSDB_BLOOM_BYTES(pBlock->numOfRows);
+  void *   pBloom = POINTER_SHIFT(pReadh->pBloomBuf, TSDB_BLOOM_COLIDS_SIZE(pBlock->numOfCols));
+  for (int i = 0; i < pReadh->nBlooms; i++) {
+    if (colIds[i] == colId) {
+      return tsdbBloomMayContain(POINTER_SHIFT(pBloom, bloomBytes * i), bloomBytes, key, len) ? 1 : 0;
+    }
+  }
+
+  return 1;
+}
+
+// Load the ids of the columns with bloom filters from the SBlockCol part of the block, and the bloom filters after
+// them in pBloomBuf
+static int tsdbLoadBlockBloom(SReadH *pReadh, SBlock *pBlock) {
+  SDFile *pDFileAggr = pBlock->last ? TSDB_READ_SMAL_FILE(pReadh) : TSDB_READ_SMAD_FILE(pReadh);
+  size_t  colIdsSize = TSDB_BLOOM_COLIDS_SIZE(pBlock->numOfCols);
+  int32_t bloomBytes = TSDB_BLOOM_BYTES(pBlock->numOfRows);
+
+  pReadh->bloomOffset = 0;
+  if (tsdbLoadBlockOffset(pReadh, pBlock) < 0) return -1;
+
+  if (tsdbMakeRoom(&(pReadh->pBloomBuf), colIdsSize) < 0) return -1;
+  pReadh->nBlooms = 0;
+  for (int i = 0; i < pBlock->numOfCols; i++) {
+    SBlockCol *pBlockCol = pReadh->pBlkData->cols + i;
+    if (pBlockCol->flags & TSDB_BLOCK_COL_BLOOM) {
+      ((int16_t *)pReadh->pBloomBuf)[pReadh->nBlooms++] = pBlockCol->colId;
+    }
+  }
+
+  if (pReadh->nBlooms > 0) {
+    int64_t offset = (int64_t)pBlock->aggrOffset + tsdbBlockAggrSize(pBlock->numOfCols, (uint32_t)pBlock->blkVer);
+    size_t  size = (size_t)bloomBytes * pReadh->nBlooms + sizeof(TSCKSUM);
+
+    if (tsdbMakeRoom(&(pReadh->pBloomBuf), colIdsSize + size) < 0) return -1;
+    void *pBloom = POINTER_SHIFT(pReadh->pBloomBuf, colIdsSize);
+
+    if (tsdbSeekDFile(pDFileAggr, offset, SEEK_SET) < 0) {
+      tsdbError("vgId:%d failed to load block bloom part while seek file %s to offset %" PRId64 " since %s",
+                TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFileAggr), offset, tstrerror(terrno));
+      return -1;
+    }
+
+    int64_t nread = tsdbReadDFile(pDFileAggr, pBloom, size);
+    if (nread < 0) {
+      tsdbError("vgId:%d failed to load block bloom part while read file %s since %s, offset:%" PRId64 " len :%" PRIzu,
+                TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFileAggr), tstrerror(terrno), offset, size);
+      return -1;
+    }
+
+    if (nread < size || !taosCheckChecksumWhole((uint8_t *)pBloom, (uint32_t)size)) {
+      terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+      tsdbError("vgId:%d block bloom part in file %s is corrupted, offset:%" PRId64 " len :%" PRIzu,
+                TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFileAggr), offset, size);
+      return -1;
+    }
+    pReadh->readBytes += nread;
+  }
+
+  pReadh->bloomOffset = pBlock->offset;
+  pReadh->bloomLast = pBlock->last;
+  return 0;
+}
+
 int tsdbEncodeSBlockIdx(void **buf, SBlockIdx *pIdx) {
   int tlen = 0;
 
@@ -616,6 +775,10 @@ static void tsdbResetReadTable(SReadH *pReadh) {
 static void tsdbResetReadFile(SReadH *pReadh) {
   tsdbResetReadTable(pReadh);
   taosArrayClear(pReadh->aBlkIdx);
+  tsdbReleaseHeadMap(TSDB_READ_REPO(pReadh), pReadh->pHeadMap);
+  pReadh->pHeadMap = NULL;
+  pReadh->pBlkInfo = pReadh->pBlkInfoBuf;
+  pReadh->bloomOffset = 0;
   tsdbCloseDFileSet(TSDB_READ_FSET(pReadh));
 }
 
@@ -650,6 +813,7 @@ static int tsdbLoadBlockDataImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDat
               TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), (int64_t)pBlock->offset, pBlock->len, nread);
     return -1;
   }
+  pReadh->readBytes += nread;
 
   int32_t tsize = (int32_t)tsdbBlockStatisSize(pBlock->numOfCols, (uint32_t)pBlock->blkVer);
   if (!taosCheckChecksumWhole((uint8_t *)TSDB_READ_BUF(pReadh), tsize)) {
@@ -704,6 +868,7 @@ static int tsdbLoadBlockDataImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *pDat
                   TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), tcolId, (int64_t)pBlock->offset, toffset);
         return -1;
       }
+      pReadh->decodeBytes += pDataCol->len;
 
       if (dcol != 0) {
         ccol++;
@@ -761,12 +926,17 @@ static int tsdbLoadBlockDataColsImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *
 
   SDFile *  pDFile = (pBlock->last) ? TSDB_READ_LAST_FILE(pReadh) : TSDB_READ_DATA_FILE(pReadh);
   SBlockCol blockCol = {0};
+  SColLoad *pLoads;
+  int       nLoads = 0;
 
   tdResetDataCols(pDataCols);
 
   // If only load timestamp column, no need to load SBlockData part
   if (numOfColIds > 1 && tsdbLoadBlockOffset(pReadh, pBlock) < 0) return -1;
 
+  if (tsdbMakeRoom((void **)(&TSDB_READ_EXBUF(pReadh)), sizeof(SColLoad) * numOfColIds) < 0) return -1;
+  pLoads = (SColLoad *)TSDB_READ_EXBUF(pReadh);
+
   pDataCols->numOfRows = pBlock->numOfRows;
 
   int dcol = 0;
@@ -827,50 +997,89 @@ static int tsdbLoadBlockDataColsImpl(SReadH *pReadh, SBlock *pBlock, SDataCols *
       ASSERT(pBlockCol->colId == pDataCol->colId);
     }
 
-    if (tsdbLoadColData(pReadh, pDFile, pBlock, pBlockCol, pDataCol) < 0) return -1;
+    pLoads[nLoads].blockCol = *pBlockCol;
+    pLoads[nLoads].pDataCol = pDataCol;
+    nLoads++;
+  }
+
+  // The columns are read in the order they are laid in the block, the ones next to each other in one read
+  qsort(pLoads, nLoads, sizeof(SColLoad), tsdbComparColLoadOffset);
+
+  for (int i = 0; i < nLoads;) {
+    int      n = 1;
+    uint32_t end = tsdbGetBlockColOffset(&(pLoads[i].blockCol)) + pLoads[i].blockCol.len;
+    while (i + n < nLoads && tsdbGetBlockColOffset(&(pLoads[i + n].blockCol)) <= end + TSDB_COL_READ_GAP) {
+      end = tsdbGetBlockColOffset(&(pLoads[i + n].blockCol)) + pLoads[i + n].blockCol.len;
+      n++;
+    }
+
+    if (tsdbLoadColsData(pReadh, pDFile, pBlock, pLoads + i, n) < 0) return -1;
+    i += n;
   }
 
   return 0;
 }
 
-static int tsdbLoadColData(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, SBlockCol *pBlockCol, SDataCol *pDataCol) {
-  ASSERT(pDataCol->colId == pBlockCol->colId);
+static int tsdbComparColLoadOffset(const void *arg1, const void *arg2) {
+  uint32_t offset1 = tsdbGetBlockColOffset(&(((SColLoad *)arg1)->blockCol));
+  uint32_t offset2 = tsdbGetBlockColOffset(&(((SColLoad *)arg2)->blockCol));
+  return (offset1 < offset2) ? -1 : ((offset1 == offset2) ? 0 : 1);
+}
 
+// Load a run of columns sorted by offset with one read, from the first one to the end of the last one
+static int tsdbLoadColsData(SReadH *pReadh, SDFile *pDFile, SBlock *pBlock, SColLoad *pLoads, int nLoads) {
   STsdbRepo *pRepo = TSDB_READ_REPO(pReadh);
   STsdbCfg * pCfg = REPO_CFG(pRepo);
-  int        tsize = pDataCol->bytes * pBlock->numOfRows + COMP_OVERFLOW_BYTES;
+  SBlockCol *pFirst = &(pLoads[0].blockCol);
+  SBlockCol *pLast = &(pLoads[nLoads - 1].blockCol);
+  uint32_t   start = tsdbGetBlockColOffset(pFirst);
+  int32_t    len = (int32_t)(tsdbGetBlockColOffset(pLast) + pLast->len - start);
+  int        tsize = 0;
+
+  for (int i = 0; i < nLoads; i++) {
+    tsize = MAX(tsize, pLoads[i].pDataCol->bytes * pBlock->numOfRows + COMP_OVERFLOW_BYTES);
+  }
 
-  if (tsdbMakeRoom((void **)(&TSDB_READ_BUF(pReadh)), pBlockCol->len) < 0) return -1;
+  if (tsdbMakeRoom((void **)(&TSDB_READ_BUF(pReadh)), len) < 0) return -1;
   if (tsdbMakeRoom((void **)(&TSDB_READ_COMP_BUF(pReadh)), tsize) < 0) return -1;
 
-  int64_t offset = pBlock->offset + tsdbBlockStatisSize(pBlock->numOfCols, (uint32_t)pBlock->blkVer) +
-                   tsdbGetBlockColOffset(pBlockCol);
+  int64_t offset = pBlock->offset + tsdbBlockStatisSize(pBlock->numOfCols, (uint32_t)pBlock->blkVer) + start;
   if (tsdbSeekDFile(pDFile, offset, SEEK_SET) < 0) {
     tsdbError("vgId:%d failed to load block column data while seek file %s to offset %" PRId64 " since %s",
               TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), offset, tstrerror(terrno));
     return -1;
   }
 
-  int64_t nread = tsdbReadDFile(pDFile, TSDB_READ_BUF(pReadh), pBlockCol->len);
+  int64_t nread = tsdbReadDFile(pDFile, TSDB_READ_BUF(pReadh), len);
   if (nread < 0) {
     tsdbError("vgId:%d failed to load block column data while read file %s since %s, offset:%" PRId64 " len :%d",
-              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), tstrerror(terrno), offset, pBlockCol->len);
+              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), tstrerror(terrno), offset, len);
     return -1;
   }
 
-  if (nread < pBlockCol->len) {
+  if (nread < len) {
     terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
-    tsdbError("vgId:%d block column data in file %s is corrupted, offset:%" PRId64 " expected bytes:%d" PRIzu
+    tsdbError("vgId:%d block column data in file %s is corrupted, offset:%" PRId64 " expected bytes:%d"
               " read bytes: %" PRId64,
-              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), offset, pBlockCol->len, nread);
+              TSDB_READ_REPO_ID(pReadh), TSDB_FILE_FULL_NAME(pDFile), offset, len, nread);
     return -1;
   }
-
-  if (tsdbCheckAndDecodeColumnData(pDataCol, pReadh->pBuf, pBlockCol->len, pBlock->algorithm, pBlock->numOfRows,
-                                   pCfg->maxRowsPerFileBlock, pReadh->pCBuf, (int32_t)taosTSizeof(pReadh->pCBuf)) < 0) {
-    tsdbError("vgId:%d file %s is broken at column %d offset %" PRId64, REPO_ID(pRepo), TSDB_FILE_FULL_NAME(pDFile),
-              pBlockCol->colId, offset);
-    return -1;
+  pReadh->readBytes += nread;
+
+  for (int i = 0; i < nLoads; i++) {
+    SBlockCol *pBlockCol = &(pLoads[i].blockCol);
+    SDataCol * pDataCol = pLoads[i].pDataCol;
+    uint32_t   coffset = tsdbGetBlockColOffset(pBlockCol) - start;
+
+    ASSERT(pDataCol->colId == pBlockCol->colId);
+    if (tsdbCheckAndDecodeColumnData(pDataCol, POINTER_SHIFT(TSDB_READ_BUF(pReadh), coffset), pBlockCol->len,
+                                     pBlock->algorithm, pBlock->numOfRows, pCfg->maxRowsPerFileBlock, pReadh->pCBuf,
+                                     (int32_t)taosTSizeof(pReadh->pCBuf)) < 0) {
+      tsdbError("vgId:%d file %s is broken at column %d offset %" PRId64, REPO_ID(pRepo), TSDB_FILE_FULL_NAME(pDFile),
+                pBlockCol->colId, offset + coffset);
+      return -1;
+    }
+    pReadh->decodeBytes += pDataCol->len;
   }
 
   return 0;
@@ -0,0 +1,512 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tsdbint.h"
+
+// With the rollup option, a file set has an hourly tier of the numeric columns of its tables: one file of SRollupRec
+// sorted by (uid, skey, colId), named after the fid and kept on the primary disk whatever the tier of the file set.
+// The hours the rows of a commit or a delete fall in are rolled up again from the new file set before it is swapped
+// in, and replace the old records of those hours. Compaction and migration move rows but do not change them, and
+// leave the tier as it is. The tier of a fid is removed once the file set expires.
+//
+// The file is renamed in before the FS transaction ends. If the transaction then fails, the rows it has are still to
+// be committed and their hours are rolled up again by the commit that writes them.
+
+#define TSDB_ROLLUP_MAGIC 0x52313048  // "R10H"
+#define TSDB_ROLLUP_VER 0
+
+static int64_t tsRollupTicks[] = {3600000L, 3600000000L, 3600000000000L};
+
+static void  tsdbGetRollupFname(int vid, int fid, bool tmp, char *fname);
+static TSKEY tsdbRollupHour(TSKEY key, int64_t ticks);
+static int   tsdbEncodeRollupRec(void **buf, SRollupRec *pRec);
+static void *tsdbDecodeRollupRec(void *buf, SRollupRec *pRec);
+static int   tsdbLoadRollupFile(STsdbRepo *pRepo, int fid, uint64_t uid, TSKEY skey, TSKEY ekey, SArray *pRecs);
+static int   tsdbWriteRollupFile(STsdbRepo *pRepo, int fid, SArray *pRecs);
+static int   tsdbRollupTable(SReadH *pReadh, SRollupRange *pRange, int64_t ticks, SArray *pRecs);
+static int   tsdbFlushRollup(SRollupRec *aCurr, int nCols, TSKEY hour, SArray *pRecs);
+static void  tsdbRollupValue(SRollupRec *pRec, const void *val);
+static int   tsdbComparRollupRange(const void *arg1, const void *arg2);
+static int   tsdbComparRollupRec(const void *arg1, const void *arg2);
+static int   tsdbComparFid(const void *arg1, const void *arg2);
+
+int tsdbUpdateRollup(STsdbRepo *pRepo, SDFileSet *pSet, SArray *aRanges) {
+  STsdbCfg *pCfg = REPO_CFG(pRepo);
+  int64_t   ticks = tsRollupTicks[pCfg->precision];
+  size_t    nRanges = taosArrayGetSize(aRanges);
+  SArray *  aOld = NULL;
+  SArray *  aNew = NULL;
+  SReadH    readh;
+  int       code = -1;
+
+  if (!pCfg->rollup || nRanges == 0) return 0;
+
+  // one range per table, over the whole hours of its rows
+  taosArraySort(aRanges, tsdbComparRollupRange);
+  size_t n = 0;
+  for (size_t i = 0; i < nRanges; i++) {
+    SRollupRange *pRange = taosArrayGet(aRanges, i);
+    SRollupRange *pLast = (n > 0) ? taosArrayGet(aRanges, n - 1) : NULL;
+
+    TSKEY skey = tsdbRollupHour(pRange->skey, ticks);
+    TSKEY ekey = tsdbRollupHour(pRange->ekey, ticks) + ticks - 1;
+    if (pLast && TABLE_UID(pLast->pTable) == TABLE_UID(pRange->pTable)) {
+      pLast->skey = MIN(pLast->skey, skey);
+      pLast->ekey = MAX(pLast->ekey, ekey);
+    } else {
+      SRollupRange *pNext = taosArrayGet(aRanges, n++);
+      pNext->pTable = pRange->pTable;
+      pNext->skey = skey;
+      pNext->ekey = ekey;
+    }
+  }
+  taosArraySetSize(aRanges, n);
+
+  aOld = taosArrayInit(1024, sizeof(SRollupRec));
+  aNew = taosArrayInit(1024, sizeof(SRollupRec));
+  if (aOld == NULL || aNew == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    taosArrayDestroy(&aOld);
+    taosArrayDestroy(&aNew);
+    return -1;
+  }
+
+  if (tsdbInitReadH(&readh, pRepo) < 0) {
+    taosArrayDestroy(&aOld);
+    taosArrayDestroy(&aNew);
+    return -1;
+  }
+
+  if (tsdbSetAndOpenReadFSet(&readh, pSet) < 0) goto _exit;
+  if (tsdbLoadBlockIdx(&readh) < 0) goto _exit;
+
+  for (size_t i = 0; i < n; i++) {
+    if (tsdbRollupTable(&readh, taosArrayGet(aRanges, i), ticks, aNew) < 0) goto _exit;
+  }
+
+  // keep the old records of the other hours
+  if (tsdbLoadRollupFile(pRepo, pSet->fid, 0, INT64_MIN, INT64_MAX, aOld) < 0) goto _exit;
+  for (size_t i = 0; i < taosArrayGetSize(aOld); i++) {
+    SRollupRec *  pRec = taosArrayGet(aOld, i);
+    SRollupRange *pRange = NULL;
+
+    // search by uid, the table is not looked at
+    int lo = 0, hi = (int)n - 1;
+    while (lo <= hi) {
+      int           mid = (lo + hi) / 2;
+      SRollupRange *pMid = taosArrayGet(aRanges, mid);
+      if (TABLE_UID(pMid->pTable) == pRec->uid) {
+        pRange = pMid;
+        break;
+      } else if (TABLE_UID(pMid->pTable) < pRec->uid) {
+        lo = mid + 1;
+      } else {
+        hi = mid - 1;
+      }
+    }
+
+    if (pRange && pRec->skey >= pRange->skey && pRec->skey <= pRange->ekey) continue;
+    if (taosArrayPush(aNew, pRec) == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      goto _exit;
+    }
+  }
+
+  taosArraySort(aNew, tsdbComparRollupRec);
+  if (tsdbWriteRollupFile(pRepo, pSet->fid, aNew) < 0) goto _exit;
+
+  tsdbDebug("vgId:%d rollup of FSET %d updated over %d tables, %d records", REPO_ID(pRepo), pSet->fid, (int)n,
+            (int)taosArrayGetSize(aNew));
+  code = 0;
+
+_exit:
+  if (code < 0) {
+    tsdbError("vgId:%d failed to update the rollup of FSET %d since %s", REPO_ID(pRepo), pSet->fid,
+              tstrerror(terrno));
+  }
+  tsdbDestroyReadH(&readh);
+  taosArrayDestroy(&aOld);
+  taosArrayDestroy(&aNew);
+  return code;
+}
+
+int tsdbApplyRollupRtn(STsdbRepo *pRepo, int minFid) {
+  char         dirName[TSDB_FILENAME_LEN];
+  char         bname[TSDB_FILENAME_LEN];
+  const TFILE *pf;
+  int          vid, fid;
+
+  snprintf(dirName, TSDB_FILENAME_LEN, "vnode/vnode%d/tsdb/%s", REPO_ID(pRepo), TSDB_ROLLUP_DIR);
+  TDIR *tdir = tfsOpendir(dirName);
+  if (tdir == NULL) return 0;
+
+  while ((pf = tfsReaddir(tdir))) {
+    tfsbasename(pf, bname);
+    if (sscanf(bname, "v%df%d", &vid, &fid) != 2 || fid >= minFid) continue;
+
+    tsdbInfo("vgId:%d rollup %s expires, remove it", REPO_ID(pRepo), TFILE_NAME(pf));
+    (void)tfsremove(pf);
+  }
+
+  tfsClosedir(tdir);
+  return 0;
+}
+
+int tsdbReadRollup(STsdbRepo *pRepo, uint64_t uid, TSKEY skey, TSKEY ekey, SArray *pRecs) {
+  STsdbCfg *   pCfg = REPO_CFG(pRepo);
+  int          sfid = TSDB_KEY_FID(skey, pCfg->daysPerFile, pCfg->precision);
+  int          efid = TSDB_KEY_FID(ekey, pCfg->daysPerFile, pCfg->precision);
+  char         dirName[TSDB_FILENAME_LEN];
+  char         bname[TSDB_FILENAME_LEN];
+  const TFILE *pf;
+  int          vid, fid;
+
+  // the fids of the tier files in the range
+  SArray *aFids = taosArrayInit(16, sizeof(int));
+  if (aFids == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  snprintf(dirName, TSDB_FILENAME_LEN, "vnode/vnode%d/tsdb/%s", REPO_ID(pRepo), TSDB_ROLLUP_DIR);
+  TDIR *tdir = tfsOpendir(dirName);
+  while (tdir && (pf = tfsReaddir(tdir))) {
+    tfsbasename(pf, bname);
+    if (sscanf(bname, "v%df%d", &vid, &fid) != 2 || strstr(bname, ".t") != NULL) continue;
+    if (fid < sfid || fid > efid) continue;
+    taosArrayPush(aFids, &fid);
+  }
+  if (tdir) tfsClosedir(tdir);
+
+  taosArraySort(aFids, tsdbComparFid);
+  skey = tsdbRollupHour(skey, tsRollupTicks[pCfg->precision]);
+  for (size_t i = 0; i < taosArrayGetSize(aFids); i++) {
+    if (tsdbLoadRollupFile(pRepo, *(int *)taosArrayGet(aFids, i), uid, skey, ekey, pRecs) < 0) {
+      taosArrayDestroy(&aFids);
+      return -1;
+    }
+  }
+
+  taosArrayDestroy(&aFids);
+  return 0;
+}
+
+static void tsdbGetRollupFname(int vid, int fid, bool tmp, char *fname) {
+  snprintf(fname, TSDB_FILENAME_LEN, "vnode/vnode%d/tsdb/%s/v%df%d.1h%s", vid, TSDB_ROLLUP_DIR, vid, fid,
+           tmp ? ".t" : "");
+}
+
+static TSKEY tsdbRollupHour(TSKEY key, int64_t ticks) {
+  TSKEY rem = key % ticks;
+  return (rem < 0) ? (key - rem - ticks) : (key - rem);
+}
+
+static int tsdbEncodeRollupRec(void **buf, SRollupRec *pRec) {
+  int tlen = 0;
+
+  tlen += taosEncodeFixedU64(buf, pRec->uid);
+  tlen += taosEncodeFixedI64(buf, pRec->skey);
+  tlen += taosEncodeFixedI16(buf, pRec->colId);
+  tlen += taosEncodeFixedI8(buf, pRec->type);
+  tlen += taosEncodeFixedI64(buf, pRec->count);
+  tlen += taosEncodeFixedU64(buf, pRec->sum.u64);
+  tlen += taosEncodeFixedU64(buf, pRec->min.u64);
+  tlen += taosEncodeFixedU64(buf, pRec->max.u64);
+
+  return tlen;
+}
+
+static void *tsdbDecodeRollupRec(void *buf, SRollupRec *pRec) {
+  buf = taosDecodeFixedU64(buf, &(pRec->uid));
+  buf = taosDecodeFixedI64(buf, &(pRec->skey));
+  buf = taosDecodeFixedI16(buf, &(pRec->colId));
+  buf = taosDecodeFixedI8(buf, &(pRec->type));
+  buf = taosDecodeFixedI64(buf, &(pRec->count));
+  buf = taosDecodeFixedU64(buf, &(pRec->sum.u64));
+  buf = taosDecodeFixedU64(buf, &(pRec->min.u64));
+  buf = taosDecodeFixedU64(buf, &(pRec->max.u64));
+
+  return buf;
+}
+
+// the records of the fid of the hours starting in [skey, ekey], of the table of uid or of all of them with uid 0
+static int tsdbLoadRollupFile(STsdbRepo *pRepo, int fid, uint64_t uid, TSKEY skey, TSKEY ekey, SArray *pRecs) {
+  char        fname[TSDB_FILENAME_LEN];
+  TFILE       tf;
+  struct stat st;
+  void *      pBuf = NULL;
+  uint32_t    magic, ver, nRecs;
+
+  tsdbGetRollupFname(REPO_ID(pRepo), fid, false, fname);
+  tfsInitFile(&tf, TFS_PRIMARY_LEVEL, TFS_PRIMARY_ID, fname);
+
+  int fd = tfsopen(&tf, O_RDONLY);
+  if (fd < 0) {
+    if (errno == ENOENT) return 0;
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    return -1;
+  }
+
+  if (fstat(fd, &st) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tfsclose(fd);
+    return -1;
+  }
+
+  if (st.st_size < sizeof(uint32_t) * 3 + sizeof(TSCKSUM)) {
+    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+    tfsclose(fd);
+    return -1;
+  }
+
+  if ((pBuf = malloc(st.st_size)) == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    tfsclose(fd);
+    return -1;
+  }
+
+  int64_t nread = taosRead(fd, pBuf, st.st_size);
+  tfsclose(fd);
+  if (nread < st.st_size) {
+    terrno = (nread < 0) ? TAOS_SYSTEM_ERROR(errno) : TSDB_CODE_TDB_FILE_CORRUPTED;
+    free(pBuf);
+    return -1;
+  }
+
+  if (!taosCheckChecksumWhole((uint8_t *)pBuf, (uint32_t)st.st_size)) {
+    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+    free(pBuf);
+    return -1;
+  }
+
+  void *ptr = pBuf;
+  ptr = taosDecodeFixedU32(ptr, &magic);
+  ptr = taosDecodeFixedU32(ptr, &ver);
+  ptr = taosDecodeFixedU32(ptr, &nRecs);
+  if (magic != TSDB_ROLLUP_MAGIC || ver != TSDB_ROLLUP_VER) {
+    terrno = TSDB_CODE_TDB_FILE_CORRUPTED;
+    free(pBuf);
+    return -1;
+  }
+
+  for (uint32_t i = 0; i < nRecs; i++) {
+    SRollupRec rec;
+    ptr = tsdbDecodeRollupRec(ptr, &rec);
+
+    if (uid != 0 && rec.uid != uid) continue;
+    if (rec.skey < skey || rec.skey > ekey) continue;
+    if (taosArrayPush(pRecs, &rec) == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      free(pBuf);
+      return -1;
+    }
+  }
+
+  free(pBuf);
+  return 0;
+}
+
+static int tsdbWriteRollupFile(STsdbRepo *pRepo, int fid, SArray *pRecs) {
+  char   dirName[TSDB_FILENAME_LEN];
+  char   fname[TSDB_FILENAME_LEN];
+  char   tname[TSDB_FILENAME_LEN];
+  TFILE  tf, ttf;
+  size_t nRecs = taosArrayGetSize(pRecs);
+
+  tsdbGetRollupFname(REPO_ID(pRepo), fid, false, fname);
+  tfsInitFile(&tf, TFS_PRIMARY_LEVEL, TFS_PRIMARY_ID, fname);
+
+  if (nRecs == 0) {
+    (void)tfsremove(&tf);
+    return 0;
+  }
+
+  snprintf(dirName, TSDB_FILENAME_LEN, "vnode/vnode%d/tsdb/%s", REPO_ID(pRepo), TSDB_ROLLUP_DIR);
+  if (tfsMkdirAt(dirName, TFS_PRIMARY_LEVEL, TFS_PRIMARY_ID) < 0) return -1;
+
+  tsdbGetRollupFname(REPO_ID(pRepo), fid, true, tname);
+  tfsInitFile(&ttf, TFS_PRIMARY_LEVEL, TFS_PRIMARY_ID, tname);
+
+  int64_t tlen = sizeof(uint32_t) * 3 + nRecs * tsdbEncodeRollupRec(NULL, taosArrayGet(pRecs, 0)) + sizeof(TSCKSUM);
+  void *  pBuf = malloc(tlen);
+  if (pBuf == NULL) {
+    terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+    return -1;
+  }
+
+  void *ptr = pBuf;
+  taosEncodeFixedU32(&ptr, TSDB_ROLLUP_MAGIC);
+  taosEncodeFixedU32(&ptr, TSDB_ROLLUP_VER);
+  taosEncodeFixedU32(&ptr, (uint32_t)nRecs);
+  for (size_t i = 0; i < nRecs; i++) {
+    tsdbEncodeRollupRec(&ptr, taosArrayGet(pRecs, i));
+  }
+  taosCalcChecksumAppend(0, (uint8_t *)pBuf, (uint32_t)tlen);
+
+  int fd = tfsopen(&ttf, O_WRONLY | O_CREAT | O_TRUNC);
+  if (fd < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    free(pBuf);
+    return -1;
+  }
+
+  if (taosWrite(fd, pBuf, tlen) < tlen || taosFsync(fd) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    tfsclose(fd);
+    (void)tfsremove(&ttf);
+    free(pBuf);
+    return -1;
+  }
+
+  tfsclose(fd);
+  free(pBuf);
+
+  if (tfsrename(&ttf, &tf) < 0) {
+    terrno = TAOS_SYSTEM_ERROR(errno);
+    (void)tfsremove(&ttf);
+    return -1;
+  }
+
+  return 0;
+}
+
+// roll up the hours of the range from the rows of the table in the file set, the blocks come in key order
+static int tsdbRollupTable(SReadH *pReadh, SRollupRange *pRange, int64_t ticks, SArray *pRecs) {
+  SRollupRec *aCurr = NULL;  // of the hour rolled up, by column
+  int         nCols = 0;
+  TSKEY       hour = INT64_MIN;
+
+  if (tsdbSetReadTable(pReadh, pRange->pTable) < 0) return -1;
+  if (pReadh->pBlkIdx == NULL) return 0;
+  if (tsdbLoadBlockInfo(pReadh, NULL, NULL) < 0) return -1;
+
+  for (int i = 0; i < (int)pReadh->pBlkIdx->numOfBlocks; i++) {
+    SBlock *pBlock = pReadh->pBlkInfo->blocks + i;
+    if (pBlock->keyLast < pRange->skey) continue;
+    if (pBlock->keyFirst > pRange->ekey) break;
+
+    if (tsdbLoadBlockData(pReadh, pBlock, NULL) < 0) goto _err;
+
+    SDataCols *pCols = pReadh->pDCols[0];
+    if (aCurr == NULL) {
+      nCols = pCols->numOfCols;
+      if ((aCurr = calloc(nCols, sizeof(SRollupRec))) == NULL) {
+        terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+        return -1;
+      }
+    }
+
+    for (int r = 0; r < pCols->numOfRows; r++) {
+      TSKEY key = dataColsKeyAt(pCols, r);
+      if (key < pRange->skey) continue;
+      if (key > pRange->ekey) break;
+
+      TSKEY kHour = tsdbRollupHour(key, ticks);
+      if (kHour != hour) {
+        if (tsdbFlushRollup(aCurr, nCols, hour, pRecs) < 0) goto _err;
+        hour = kHour;
+      }
+
+      // the first column is the primary key
+      for (int c = 1; c < nCols; c++) {
+        SDataCol *pCol = pCols->cols + c;
+        if (!IS_NUMERIC_TYPE(pCol->type)) continue;
+
+        const void *val = tdGetColDataOfRow(pCol, r);
+        if (isNull(val, pCol->type)) continue;
+
+        aCurr[c].uid = TABLE_UID(pRange->pTable);
+        aCurr[c].colId = pCol->colId;
+        aCurr[c].type = pCol->type;
+        tsdbRollupValue(aCurr + c, val);
+      }
+    }
+  }
+
+  if (tsdbFlushRollup(aCurr, nCols, hour, pRecs) < 0) goto _err;
+
+  tfree(aCurr);
+  return 0;
+
+_err:
+  tfree(aCurr);
+  return -1;
+}
+
+static int tsdbFlushRollup(SRollupRec *aCurr, int nCols, TSKEY hour, SArray *pRecs) {
+  for (int c = 0; c < nCols; c++) {
+    if (aCurr[c].count == 0) continue;
+
+    aCurr[c].skey = hour;
+    if (taosArrayPush(pRecs, aCurr + c) == NULL) {
+      terrno = TSDB_CODE_TDB_OUT_OF_MEMORY;
+      return -1;
+    }
+  }
+
+  memset(aCurr, 0, sizeof(SRollupRec) * nCols);
+  return 0;
+}
+
+static void tsdbRollupValue(SRollupRec *pRec, const void *val) {
+  if (IS_SIGNED_NUMERIC_TYPE(pRec->type)) {
+    int64_t v;
+    GET_TYPED_DATA(v, int64_t, pRec->type, val);
+    pRec->sum.i64 = (pRec->count == 0) ? v : pRec->sum.i64 + v;
+    pRec->min.i64 = (pRec->count == 0 || v < pRec->min.i64) ? v : pRec->min.i64;
+    pRec->max.i64 = (pRec->count == 0 || v > pRec->max.i64) ? v : pRec->max.i64;
+  } else if (IS_UNSIGNED_NUMERIC_TYPE(pRec->type)) {
+    uint64_t v;
+    GET_TYPED_DATA(v, uint64_t, pRec->type, val);
+    pRec->sum.u64 = (pRec->count == 0) ? v : pRec->sum.u64 + v;
+    pRec->min.u64 = (pRec->count == 0 || v < pRec->min.u64) ? v : pRec->min.u64;
+    pRec->max.u64 = (pRec->count == 0 || v > pRec->max.u64) ? v : pRec->max.u64;
+  } else {
+    double v;
+    GET_TYPED_DATA(v, double, pRec->type, val);
+    pRec->sum.f64 = (pRec->count == 0) ? v : pRec->sum.f64 + v;
+    pRec->min.f64 = (pRec->count == 0 || v < pRec->min.f64) ? v : pRec->min.f64;
+    pRec->max.f64 = (pRec->count == 0 || v > pRec->max.f64) ? v : pRec->max.f64;
+  }
+  pRec->count++;
+}
+
+static int tsdbComparRollupRange(const void *arg1, const void *arg2) {
+  uint64_t uid1 = TABLE_UID(((SRollupRange *)arg1)->pTable);
+  uint64_t uid2 = TABLE_UID(((SRollupRange *)arg2)->pTable);
+
+  if (uid1 < uid2) return -1;
+  if (uid1 > uid2) return 1;
+  return 0;
+}
+
+static int tsdbComparRollupRec(const void *arg1, const void *arg2) {
+  const SRollupRec *pRec1 = arg1;
+  const SRollupRec *pRec2 = arg2;
+
+  if (pRec1->uid != pRec2->uid) return (pRec1->uid < pRec2->uid) ? -1 : 1;
+  if (pRec1->skey != pRec2->skey) return (pRec1->skey < pRec2->skey) ? -1 : 1;
+  if (pRec1->colId != pRec2->colId) return (pRec1->colId < pRec2->colId) ? -1 : 1;
+  return 0;
+}
+
+static int tsdbComparFid(const void *arg1, const void *arg2) {
+  int fid1 = *(const int *)arg1;
+  int fid2 = *(const int *)arg2;
+
+  if (fid1 < fid2) return -1;
+  if (fid1 > fid2) return 1;
+  return 0;
+}
@@ -0,0 +1,249 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int vgId = 6;
+
+STable *getTable(STsdbRepo *pRepo, uint64_t uid) { return tsdbGetTableByUid(tsdbGetMeta(pRepo), uid); }
+
+// offset of the data of a column in the block, from the SBlockCol part loaded last
+uint32_t getColOffset(SReadH *pReadh, SBlock *pBlock, int16_t colId) {
+  for (int i = 0; i < pBlock->numOfCols; i++) {
+    SBlockCol *pBlockCol = pReadh->pBlkData->cols + i;
+    if (pBlockCol->colId == colId) return tsdbGetBlockColOffset(pBlockCol);
+  }
+  return 0;
+}
+
+// load the columns of colIds from each block of the table in the first FSET, and check them against the rows inserted
+// from skey. Returns the rows loaded
+int loadCols(STsdbRepo *pRepo, uint64_t uid, TSKEY skey, std::vector<int16_t> colIds, bool checkLayout) {
+  SReadH  readh;
+  SFSIter fsiter;
+  int     nrows = 0;
+
+  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_FORWARD);
+  SDFileSet *pSet = tsdbFSIterNext(&fsiter);
+  EXPECT_TRUE(pSet != NULL);
+  if (pSet == NULL) return 0;
+
+  EXPECT_EQ(tsdbInitReadH(&readh, pRepo), 0);
+  EXPECT_EQ(tsdbSetAndOpenReadFSet(&readh, pSet), 0);
+  EXPECT_EQ(tsdbLoadBlockIdx(&readh), 0);
+  EXPECT_EQ(tsdbSetReadTable(&readh, getTable(pRepo, uid)), 0);
+  EXPECT_TRUE(readh.pBlkIdx != NULL);
+  EXPECT_EQ(tsdbLoadBlockInfo(&readh, NULL, NULL), 0);
+
+  for (uint32_t i = 0; readh.pBlkIdx != NULL && i < readh.pBlkIdx->numOfBlocks; i++) {
+    SBlock *pBlock = readh.pBlkInfo->blocks + i;
+    EXPECT_EQ(tsdbLoadBlockDataCols(&readh, pBlock, NULL, colIds.data(), (int)colIds.size()), 0);
+
+    if (checkLayout) {
+      // s is written before v, the SBlockCol part stays in column id order
+      EXPECT_LT(getColOffset(&readh, pBlock, 2), getColOffset(&readh, pBlock, 1));
+      for (int c = 1; c < pBlock->numOfCols; c++) {
+        EXPECT_LT(readh.pBlkData->cols[c - 1].colId, readh.pBlkData->cols[c].colId);
+      }
+    }
+
+    SDataCols *pCols = readh.pDCols[0];
+    SDataCol * pV = NULL;
+    SDataCol * pS = NULL;
+    for (int c = 0; c < pCols->numOfCols; c++) {
+      bool loaded = std::find(colIds.begin(), colIds.end(), pCols->cols[c].colId) != colIds.end();
+      if (pCols->cols[c].colId == 1 && loaded) pV = pCols->cols + c;
+      if (pCols->cols[c].colId == 2 && loaded) pS = pCols->cols + c;
+    }
+
+    for (int r = 0; r < pCols->numOfRows; r++, nrows++) {
+      // v is the row number from 0, the rows are a second apart
+      int32_t v = (int32_t)((dataColsKeyAt(pCols, r) - skey) / 1000);
+      if (pV != NULL) {
+        EXPECT_EQ(*(int32_t *)tdGetColDataOfRow(pV, r), v);
+      }
+      if (pS != NULL) {
+        const void *sval = tdGetColDataOfRow(pS, r);
+        EXPECT_EQ(std::string((char *)varDataVal(sval), varDataLen(sval)), "s" + std::to_string(v));
+      }
+    }
+  }
+
+  tsdbCloseAndUnsetFSet(&readh);
+  tsdbDestroyReadH(&readh);
+  return nrows;
+}
+
+}  // namespace
+
+// The rows of the blocks of a table follow its stats only once they are off by twice, so that the blocks written
+// meanwhile are not scored out of size by compaction
+TEST(TsdbBlockSizeTest, hysteresis) {
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, 1, 101), 0);
+
+  int32_t targetSize = tsBlockTargetSize;
+  tsBlockTargetSize = 1048576;
+
+  // narrow rows, so that the hit rows size the blocks between 2 * minRows 20 and maxRows 200
+  STable *pTable = getTable(pRepo, 101);
+  pTable->blkBytesPerRow = 10;
+  pTable->blkHitRows = 8;
+  EXPECT_EQ(tsdbTableMaxBlockRows(pRepo, pTable), 8 * TSDB_BLOCK_HIT_ROWS_FACTOR);
+
+  // a drift within twice keeps the rows
+  pTable->blkHitRows = 10;
+  EXPECT_EQ(tsdbTableMaxBlockRows(pRepo, pTable), 128);
+  pTable->blkHitRows = 5;
+  EXPECT_EQ(tsdbTableMaxBlockRows(pRepo, pTable), 128);
+
+  // beyond it the rows move, and stay there for the drift back
+  pTable->blkHitRows = 3;
+  EXPECT_EQ(tsdbTableMaxBlockRows(pRepo, pTable), 48);
+  pTable->blkHitRows = 5;
+  EXPECT_EQ(tsdbTableMaxBlockRows(pRepo, pTable), 48);
+  pTable->blkHitRows = 13;
+  EXPECT_EQ(tsdbTableMaxBlockRows(pRepo, pTable), cfg.maxRowsPerFileBlock);
+
+  // and the bounds of the database hold whatever the rows kept
+  pTable->blkMaxRows = 1000;
+  EXPECT_EQ(tsdbTableMaxBlockRows(pRepo, pTable), cfg.maxRowsPerFileBlock);
+
+  tsBlockTargetSize = targetSize;
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
+
+// The rows a query takes from each block it loads are learnt by the tables it loaded more than one block of. A query
+// loading a single block of a table, a point lookup or a last row, takes few rows from it whatever its size
+TEST(TsdbBlockSizeTest, hitRows) {
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  for (int tid = 1; tid <= 3; tid++) ASSERT_EQ(tsdbTestCreateTable(pRepo, tid, 100 + tid), 0);
+
+  // blocks of 160 and 90 rows for t2 on day 0, and one of 50 rows for t3 on day 1. t1 has none
+  TSKEY       day0 = (taosGetTimestampMs() / TSDB_TEST_DAY_MS - 2) * TSDB_TEST_DAY_MS;
+  TSKEY       day1 = day0 + TSDB_TEST_DAY_MS;
+  STestExpect expect2, expect3;
+  STestRows   rows;
+
+  ASSERT_EQ(tsdbTestInsert(pRepo, 2, 102, day0, 1000, 250, 0), 0);
+  ASSERT_EQ(tsdbTestInsert(pRepo, 3, 103, day1, 1000, 50, 1000), 0);
+  tsdbTestExpect(&expect2, day0, 1000, 250, 0);
+  tsdbTestExpect(&expect3, day1, 1000, 50, 1000);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+  STable *pTables[] = {getTable(pRepo, 101), getTable(pRepo, 102), getTable(pRepo, 103)};
+  for (STable *pTable : pTables) EXPECT_EQ(pTable->blkHitRows, 0);
+
+  // a scan of the two blocks of t2, the second table of the query
+  int32_t hitRows2 = (cfg.maxRowsPerFileBlock * 3 + 125) / 4;
+  ASSERT_EQ(tsdbTestReadTables(pRepo, {101, 102, 103}, day0, day1 - 1, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect2, day0, day1 - 1));
+  EXPECT_EQ(pTables[0]->blkHitRows, 0);
+  EXPECT_EQ(pTables[1]->blkHitRows, hitRows2);
+  EXPECT_EQ(pTables[2]->blkHitRows, 0);
+
+  // a scan of the single block of t3 and a point lookup in a block of t2 are not learnt
+  ASSERT_EQ(tsdbTestReadTables(pRepo, {103}, day1, day1 + TSDB_TEST_DAY_MS - 1, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect3, day1, day1 + TSDB_TEST_DAY_MS - 1));
+  ASSERT_EQ(tsdbTestReadTables(pRepo, {101, 102}, day0 + 10 * 1000, day0 + 10 * 1000, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect2, day0 + 10 * 1000, day0 + 10 * 1000));
+  EXPECT_EQ(pTables[1]->blkHitRows, hitRows2);
+  EXPECT_EQ(pTables[2]->blkHitRows, 0);
+
+  // a range over the end of the first block of t2 and the start of the second is
+  ASSERT_EQ(tsdbTestReadTables(pRepo, {102}, day0 + 159 * 1000, day0 + 160 * 1000, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect2, day0 + 159 * 1000, day0 + 160 * 1000));
+  EXPECT_EQ(pTables[1]->blkHitRows, (hitRows2 * 3 + 1) / 4);
+
+  // the columns loaded are learnt once per query by the same tables
+  uint8_t hotCols[TSDB_HOT_COLS_BYTES];
+  EXPECT_FALSE(tsdbGetHotCols(pTables[0], hotCols));
+  ASSERT_TRUE(tsdbGetHotCols(pTables[2], hotCols));
+  for (int16_t colId = 0; colId < 3; colId++) EXPECT_TRUE(TSDB_IS_HOT_COL(hotCols, colId));
+  EXPECT_FALSE(TSDB_IS_HOT_COL(hotCols, 3));
+
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
+
+// The columns the queries stop loading cool down after two generations of queries, and the column ids beyond the
+// bitmap are never hot
+TEST(TsdbBlockSizeTest, hotCols) {
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, 1, 101), 0);
+
+  STable *pTable = getTable(pRepo, 101);
+  uint8_t hotCols[TSDB_HOT_COLS_BYTES];
+  int16_t oldCols[] = {0, 1, TSDB_MAX_COLUMNS, INT16_MAX};
+  int16_t newCols[] = {0, 2};
+
+  tsdbUpdateHotCols(pTable, oldCols, 4);
+  ASSERT_TRUE(tsdbGetHotCols(pTable, hotCols));
+  EXPECT_TRUE(TSDB_IS_HOT_COL(hotCols, 1));
+  EXPECT_FALSE(TSDB_IS_HOT_COL(hotCols, 2));
+  EXPECT_FALSE(TSDB_IS_HOT_COL(hotCols, TSDB_MAX_COLUMNS));
+  EXPECT_FALSE(TSDB_IS_HOT_COL(hotCols, INT16_MAX));
+
+  for (int i = 0; i < 256 * 2; i++) tsdbUpdateHotCols(pTable, newCols, 2);
+  ASSERT_TRUE(tsdbGetHotCols(pTable, hotCols));
+  EXPECT_TRUE(TSDB_IS_HOT_COL(hotCols, 0));
+  EXPECT_FALSE(TSDB_IS_HOT_COL(hotCols, 1));
+  EXPECT_TRUE(TSDB_IS_HOT_COL(hotCols, 2));
+
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
+
+// The blocks of a table with s hot and v cold hold the data of s before v, and read back whichever columns are loaded
+TEST(TsdbBlockSizeTest, hotColsLayout) {
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, 1, 101), 0);
+
+  int16_t hotCols[] = {0, 2};
+  tsdbUpdateHotCols(getTable(pRepo, 101), hotCols, 2);
+
+  // blocks of 160 and 90 rows
+  TSKEY day0 = (taosGetTimestampMs() / TSDB_TEST_DAY_MS - 2) * TSDB_TEST_DAY_MS;
+  ASSERT_EQ(tsdbTestInsert(pRepo, 1, 101, day0, 1000, 250, 0), 0);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+  EXPECT_EQ(loadCols(pRepo, 101, day0, {0, 1, 2}, true), 250);
+  EXPECT_EQ(loadCols(pRepo, 101, day0, {0, 1}, true), 250);
+  EXPECT_EQ(loadCols(pRepo, 101, day0, {0, 2}, true), 250);
+  EXPECT_EQ(loadCols(pRepo, 101, day0, {0}, false), 250);
+
+  // and the queries read them the same
+  STestRows   rows;
+  STestExpect expect;
+  tsdbTestExpect(&expect, day0, 1000, 250, 0);
+  ASSERT_EQ(tsdbTestRead(pRepo, 101, day0, day0 + TSDB_TEST_DAY_MS - 1, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect, day0, day0 + TSDB_TEST_DAY_MS - 1));
+
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
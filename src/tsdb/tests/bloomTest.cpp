@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+#include <functional>
+#include <iostream>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int      vgId = 7;
+const int      tid = 1;
+const uint64_t uid = 100;
+const int16_t  vColId = 1;
+const int16_t  sColId = 2;
+
+// a value of the type as stored in a block: the fixed bytes of an integer, a var data of the payload otherwise
+std::string makeVal(int8_t type, int64_t v) {
+  if (!IS_VAR_DATA_TYPE(type)) {
+    return std::string((char *)&v, TYPE_BYTES[type]);
+  }
+
+  char        buf[VARSTR_HEADER_SIZE + 128] = {0};
+  std::string str = "v" + std::to_string(v);
+  if (type == TSDB_DATA_TYPE_NCHAR) {
+    // the UCS-4 code points of the string and of a CJK character
+    uint32_t *ucs4 = (uint32_t *)varDataVal(buf);
+    for (size_t i = 0; i < str.size(); i++) ucs4[i] = (uint8_t)str[i];
+    ucs4[str.size()] = 0x503C;
+    varDataSetLen(buf, (str.size() + 1) * TSDB_NCHAR_SIZE);
+  } else {
+    STR_WITH_SIZE_TO_VARSTR(buf, str.c_str(), (VarDataLenT)str.size());
+  }
+  return std::string(buf, varDataTLen(buf));
+}
+
+std::string sval(int32_t v) {
+  std::string s = "s" + std::to_string(v);
+  char        buf[VARSTR_HEADER_SIZE + 32];
+  STR_WITH_SIZE_TO_VARSTR(buf, s.c_str(), (VarDataLenT)s.size());
+  return std::string(buf, varDataTLen(buf));
+}
+
+// call fp with the reader set on the data blocks of the table in the FSET of fid
+void withBlocks(STsdbRepo *pRepo, int fid, std::function<void(SReadH *, SBlock *)> fp) {
+  SReadH     readh;
+  SFSIter    fsiter;
+  SDFileSet *pSet;
+
+  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_FORWARD);
+  while ((pSet = tsdbFSIterNext(&fsiter)) && pSet->fid != fid) {
+  }
+  ASSERT_TRUE(pSet != NULL);
+
+  ASSERT_EQ(tsdbInitReadH(&readh, pRepo), 0);
+  ASSERT_EQ(tsdbSetAndOpenReadFSet(&readh, pSet), 0);
+  ASSERT_EQ(tsdbLoadBlockIdx(&readh), 0);
+  ASSERT_EQ(tsdbSetReadTable(&readh, tsdbGetTableByUid(tsdbGetMeta(pRepo), uid)), 0);
+  ASSERT_TRUE(readh.pBlkIdx != NULL);
+  ASSERT_EQ(tsdbLoadBlockInfo(&readh, NULL, NULL), 0);
+  for (uint32_t i = 0; i < readh.pBlkIdx->numOfBlocks; i++) {
+    fp(&readh, readh.pBlkInfo->blocks + i);
+  }
+  tsdbCloseAndUnsetFSet(&readh);
+  tsdbDestroyReadH(&readh);
+}
+
+// flags of the column in the SBlockCol part of the block
+uint8_t getColFlags(SReadH *pReadh, SBlock *pBlock, int16_t colId) {
+  EXPECT_EQ(tsdbLoadBlockOffset(pReadh, pBlock), 0);
+  for (int i = 0; i < pBlock->numOfCols; i++) {
+    if (pReadh->pBlkData->cols[i].colId == colId) return pReadh->pBlkData->cols[i].flags;
+  }
+  return 0;
+}
+
+}  // namespace
+
+// A value added to a filter is always found again, by the payload of a var data and the bytes of an integer
+TEST(TsdbBloomTest, roundTrip) {
+  int8_t  types[] = {TSDB_DATA_TYPE_TINYINT,  TSDB_DATA_TYPE_SMALLINT,  TSDB_DATA_TYPE_INT,
+                    TSDB_DATA_TYPE_BIGINT,   TSDB_DATA_TYPE_UTINYINT,  TSDB_DATA_TYPE_USMALLINT,
+                    TSDB_DATA_TYPE_UINT,     TSDB_DATA_TYPE_UBIGINT,   TSDB_DATA_TYPE_BINARY,
+                    TSDB_DATA_TYPE_NCHAR};
+  int32_t saved = tsBloomFilter;
+  int     nrows = 100;
+  int32_t nbytes = TSDB_BLOOM_BYTES(nrows);
+
+  for (int8_t type : types) {
+    std::vector<uint8_t> bloom(nbytes, 0);
+    const void *         key = NULL;
+
+    tsBloomFilter = 1;
+    EXPECT_EQ(tsdbBloomColType(type), IS_VAR_DATA_TYPE(type));
+    tsBloomFilter = 2;
+    EXPECT_TRUE(tsdbBloomColType(type));
+
+    for (int v = 0; v < nrows; v++) {
+      std::string val = makeVal(type, v);
+      int32_t     len = tsdbBloomKey(type, val.data(), &key);
+      ASSERT_GT(len, 0);
+      tsdbBloomAdd(bloom.data(), nbytes, key, len);
+    }
+
+    // a var data is found by its payload whatever the bytes after it, so the value of a condition finds it too
+    int falsePositives = 0;
+    for (int v = 0; v < nrows; v++) {
+      std::string val = makeVal(type, v) + std::string(8, 'x');
+      int32_t     len = tsdbBloomKey(type, val.data(), &key);
+      EXPECT_TRUE(tsdbBloomMayContain(bloom.data(), nbytes, key, len)) << "type " << (int)type << " value " << v;
+
+      val = makeVal(type, nrows + v);
+      len = tsdbBloomKey(type, val.data(), &key);
+      if (tsdbBloomMayContain(bloom.data(), nbytes, key, len)) falsePositives++;
+    }
+    EXPECT_LE(falsePositives, nrows / 10) << "type " << (int)type;
+  }
+
+  // the other types have no filter
+  int8_t  others[] = {TSDB_DATA_TYPE_BOOL, TSDB_DATA_TYPE_FLOAT, TSDB_DATA_TYPE_DOUBLE, TSDB_DATA_TYPE_TIMESTAMP};
+  int64_t v = 0;
+  for (int8_t type : others) {
+    const void *key = NULL;
+    EXPECT_FALSE(tsdbBloomColType(type));
+    EXPECT_EQ(tsdbBloomKey(type, &v, &key), -1);
+  }
+
+  tsBloomFilter = saved;
+}
+
+// The blocks written without filters are read as before, the ones with filters are ruled out only for values none of
+// their rows has
+TEST(TsdbBloomTest, blocks) {
+  int32_t saved = tsBloomFilter;
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, tid, uid), 0);
+
+  // day 0 without filters, day 1 with filters of s, day 2 of v and s
+  TSKEY       day0 = (taosGetTimestampMs() / TSDB_TEST_DAY_MS - 3) * TSDB_TEST_DAY_MS;
+  STestExpect expect;
+  for (int day = 0; day < 3; day++) {
+    tsBloomFilter = day;
+    ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, day0 + day * TSDB_TEST_DAY_MS, 1000, 50, day * 100), 0);
+    tsdbTestExpect(&expect, day0 + day * TSDB_TEST_DAY_MS, 1000, 50, day * 100);
+    ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+  }
+  tsBloomFilter = saved;
+
+  int fid0 = (int)(day0 / TSDB_TEST_DAY_MS);
+
+  // a block without filters is flagged so, and the checks do not read it
+  withBlocks(pRepo, fid0, [](SReadH *pReadh, SBlock *pBlock) {
+    EXPECT_FALSE(pBlock->bloom);
+    EXPECT_EQ(getColFlags(pReadh, pBlock, sColId) & TSDB_BLOCK_COL_BLOOM, 0);
+
+    SBlockData *pBlkData = pReadh->pBlkData;
+    pReadh->pBlkData = NULL;
+    for (int32_t v = 0; v < 200; v++) {
+      EXPECT_EQ(tsdbBlockMayHaveValue(pReadh, pBlock, sColId, TSDB_DATA_TYPE_BINARY, sval(v).data()), 1);
+      EXPECT_EQ(tsdbBlockMayHaveValue(pReadh, pBlock, vColId, TSDB_DATA_TYPE_INT, &v), 1);
+    }
+    EXPECT_TRUE(pReadh->pBlkData == NULL);
+    EXPECT_EQ(pReadh->bloomOffset, 0);
+    pReadh->pBlkData = pBlkData;
+  });
+
+  for (int day = 1; day < 3; day++) {
+    withBlocks(pRepo, fid0 + day, [day](SReadH *pReadh, SBlock *pBlock) {
+      EXPECT_TRUE(pBlock->bloom);
+      EXPECT_NE(getColFlags(pReadh, pBlock, sColId) & TSDB_BLOCK_COL_BLOOM, 0);
+      EXPECT_EQ(getColFlags(pReadh, pBlock, vColId) & TSDB_BLOCK_COL_BLOOM, (day == 2) ? TSDB_BLOCK_COL_BLOOM : 0);
+
+      int32_t vbase = day * 100;
+      int     sAbsent = 0, vAbsent = 0;
+      for (int32_t v = vbase; v < vbase + 50; v++) {
+        EXPECT_EQ(tsdbBlockMayHaveValue(pReadh, pBlock, sColId, TSDB_DATA_TYPE_BINARY, sval(v).data()), 1);
+        EXPECT_EQ(tsdbBlockMayHaveValue(pReadh, pBlock, vColId, TSDB_DATA_TYPE_INT, &v), 1);
+      }
+      for (int32_t v = 1000; v < 1100; v++) {
+        sAbsent += (tsdbBlockMayHaveValue(pReadh, pBlock, sColId, TSDB_DATA_TYPE_BINARY, sval(v).data()) == 0);
+        vAbsent += (tsdbBlockMayHaveValue(pReadh, pBlock, vColId, TSDB_DATA_TYPE_INT, &v) == 0);
+      }
+      EXPECT_GE(sAbsent, 90);
+      EXPECT_GE(vAbsent, (day == 2) ? 90 : 0);
+      if (day == 1) {
+        EXPECT_EQ(vAbsent, 0);
+      }
+    });
+  }
+
+  // and the queries read them all
+  STestRows rows;
+  ASSERT_EQ(tsdbTestRead(pRepo, uid, 0, INT64_MAX, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect, 0, INT64_MAX));
+
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
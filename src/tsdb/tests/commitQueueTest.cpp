@@ -0,0 +1,37 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "tsdbint.h"
+
+int main(int argc, char **argv) {
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+TEST(TsdbCommitQueueTest, earlyCommit) {
+  int32_t saved = tsEarlyCommitFactor;
+
+  // off by default
+  tsEarlyCommitFactor = 0;
+  EXPECT_FALSE(tsdbNeedEarlyCommit(60, 59));
+
+  // a factor not above 3 never commits before the totalBlocks/3 threshold
+  tsEarlyCommitFactor = 3;
+  EXPECT_FALSE(tsdbNeedEarlyCommit(60, 30));
+
+  tsEarlyCommitFactor = 6;
+  EXPECT_FALSE(tsdbNeedEarlyCommit(60, 9));
+  EXPECT_TRUE(tsdbNeedEarlyCommit(60, 10));
+  EXPECT_FALSE(tsdbNeedEarlyCommit(5, 5));
+
+  tsEarlyCommitFactor = saved;
+}
+
+TEST(TsdbCommitQueueTest, idle) {
+  // not idle before the queue exists
+  EXPECT_FALSE(tsdbCommitQueueIdle());
+
+  ASSERT_EQ(tsdbInitCommitQueue(), 0);
+  EXPECT_TRUE(tsdbCommitQueueIdle());
+  tsdbDestroyCommitQueue();
+}
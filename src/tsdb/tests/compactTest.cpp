@@ -0,0 +1,69 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "tsdbint.h"
+
+TEST(TsdbCompactTest, score) {
+  SCompactStat stat = {0};
+
+  // nothing to score
+  EXPECT_DOUBLE_EQ(tsdbCalcCompactScore(&stat), 0);
+
+  // well formed file set
+  stat.tblocks = 100;
+  stat.usedSize = 1000;
+  stat.fileSize = 1000;
+  EXPECT_DOUBLE_EQ(tsdbCalcCompactScore(&stat), 0);
+
+  // a third of the blocks with sub-blocks is where it pays off
+  stat.nSubBlocks = 33;
+  EXPECT_NEAR(tsdbCalcCompactScore(&stat), 1.0, 1e-9);
+
+  // the worst part counts
+  stat.nSmallBlocks = 66;
+  EXPECT_NEAR(tsdbCalcCompactScore(&stat), 2.0, 1e-9);
+
+  // 30% of the files not used by any block
+  stat.nSubBlocks = 0;
+  stat.nSmallBlocks = 0;
+  stat.usedSize = 700;
+  EXPECT_NEAR(tsdbCalcCompactScore(&stat), 2.0, 1e-9);
+}
+
+TEST(TsdbCompactTest, pick) {
+  SArray *aScores = (SArray *)taosArrayInit(4, sizeof(SCompactScore));
+  int     candidates = -1;
+
+  EXPECT_EQ(tsdbPickCompactScore(aScores, 1.0, &candidates), -1);
+  EXPECT_EQ(candidates, 0);
+
+  SCompactScore scores[] = {{1, 0, 0, 0, 0.5}, {2, 0, 0, 0, 1.5}, {3, 0, 0, 0, 3.0}, {4, 0, 0, 0, 1.0}};
+  for (int i = 0; i < 4; i++) taosArrayPush(aScores, scores + i);
+
+  EXPECT_EQ(tsdbPickCompactScore(aScores, 1.0, &candidates), 3);
+  EXPECT_EQ(candidates, 3);
+
+  EXPECT_EQ(tsdbPickCompactScore(aScores, 5.0, &candidates), -1);
+  EXPECT_EQ(candidates, 0);
+
+  taosArrayDestroy(&aScores);
+}
+
+TEST(TsdbCompactTest, backoff) {
+  int64_t now = 1000000;
+
+  // never yielded, or the last one did not
+  EXPECT_FALSE(tsdbCompactBackedOff(0, now, now));
+
+  // a second after one yield
+  EXPECT_TRUE(tsdbCompactBackedOff(1, now, now + 999));
+  EXPECT_FALSE(tsdbCompactBackedOff(1, now, now + 1000));
+
+  // doubles with each yield in a row
+  EXPECT_TRUE(tsdbCompactBackedOff(3, now, now + 3999));
+  EXPECT_FALSE(tsdbCompactBackedOff(3, now, now + 4000));
+
+  // up to a minute
+  EXPECT_TRUE(tsdbCompactBackedOff(100, now, now + 59999));
+  EXPECT_FALSE(tsdbCompactBackedOff(100, now, now + 60000));
+}
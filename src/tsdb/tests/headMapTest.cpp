@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int      vgId = 4;
+const int      tid = 1;
+const uint64_t uid = 100;
+
+SDFileSet *getFSet(STsdbRepo *pRepo, int fid) {
+  SFSIter    fsiter;
+  SDFileSet *pSet;
+
+  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_FORWARD);
+  while ((pSet = tsdbFSIterNext(&fsiter)) && pSet->fid != fid) {
+  }
+  return pSet;
+}
+
+// fids of the mapped head files, the most recently acquired first
+std::vector<int> getMappedFids(STsdbRepo *pRepo) {
+  std::vector<int> fids;
+  for (SHeadMap *pMap = pRepo->headMaps.maps; pMap; pMap = pMap->next) fids.push_back(pMap->fid);
+  EXPECT_EQ(pRepo->headMaps.nmaps, (int)fids.size());
+  return fids;
+}
+
+// map the head file of the FSET and hold it
+void openFSet(STsdbRepo *pRepo, int fid, SReadH *pReadh) {
+  ASSERT_EQ(tsdbInitReadH(pReadh, pRepo), 0);
+  ASSERT_EQ(tsdbSetAndOpenReadFSet(pReadh, getFSet(pRepo, fid)), 0);
+  ASSERT_EQ(tsdbLoadBlockIdx(pReadh), 0);
+  ASSERT_TRUE(pReadh->pHeadMap != NULL);
+}
+
+void closeFSet(SReadH *pReadh) {
+  tsdbCloseAndUnsetFSet(pReadh);
+  tsdbDestroyReadH(pReadh);
+}
+
+}  // namespace
+
+TEST(TsdbHeadMapTest, evict) {
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, tid, uid), 0);
+
+  // a FSET for each of the last 5 days
+  TSKEY       today = (taosGetTimestampMs() / TSDB_TEST_DAY_MS) * TSDB_TEST_DAY_MS;
+  int         fids[5];
+  STestExpect expect;
+  for (int i = 0; i < 5; i++) {
+    TSKEY skey = today - (5 - i) * TSDB_TEST_DAY_MS;
+    fids[i] = (int)(skey / TSDB_TEST_DAY_MS);
+    ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, skey, 1000, 50, i * 100), 0);
+    tsdbTestExpect(&expect, skey, 1000, 50, i * 100);
+  }
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+  pRepo->headMaps.maxMaps = 2;
+  SReadH readh[5];
+
+  // the least recently used one goes
+  for (int i = 0; i < 3; i++) {
+    openFSet(pRepo, fids[i], readh + i);
+    closeFSet(readh + i);
+  }
+  EXPECT_EQ(getMappedFids(pRepo), std::vector<int>({fids[2], fids[1]}));
+
+  // an acquire makes it the most recently used
+  openFSet(pRepo, fids[1], readh + 1);
+  closeFSet(readh + 1);
+  openFSet(pRepo, fids[3], readh + 3);
+  closeFSet(readh + 3);
+  EXPECT_EQ(getMappedFids(pRepo), std::vector<int>({fids[3], fids[1]}));
+
+  // a map held by a reader stays beyond the cap, and goes once it is released and not used again
+  openFSet(pRepo, fids[0], readh + 0);
+  openFSet(pRepo, fids[1], readh + 1);
+  openFSet(pRepo, fids[2], readh + 2);
+  EXPECT_EQ(getMappedFids(pRepo), std::vector<int>({fids[2], fids[1], fids[0]}));
+  closeFSet(readh + 0);
+  closeFSet(readh + 1);
+  closeFSet(readh + 2);
+
+  openFSet(pRepo, fids[4], readh + 4);
+  EXPECT_EQ(getMappedFids(pRepo), std::vector<int>({fids[4], fids[2]}));
+  closeFSet(readh + 4);
+
+  // the queries go on reading all of them
+  STestRows rows;
+  ASSERT_EQ(tsdbTestRead(pRepo, uid, 0, INT64_MAX, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect, 0, INT64_MAX));
+  EXPECT_LE(pRepo->headMaps.nmaps, 2);
+
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
+
+// The parts of the head file taken through the map are counted in the bytes read, as if read from the file
+TEST(TsdbHeadMapTest, readBytes) {
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, tid, uid), 0);
+
+  TSKEY skey = (taosGetTimestampMs() / TSDB_TEST_DAY_MS - 1) * TSDB_TEST_DAY_MS;
+  ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, skey, 1000, 50, 0), 0);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+  SReadH readh;
+  openFSet(pRepo, (int)(skey / TSDB_TEST_DAY_MS), &readh);
+  SDFile *pHeadf = TSDB_READ_HEAD_FILE(&readh);
+  EXPECT_EQ(readh.readBytes, (int64_t)pHeadf->info.len);
+
+  ASSERT_EQ(tsdbSetReadTable(&readh, tsdbGetTableByUid(tsdbGetMeta(pRepo), uid)), 0);
+  ASSERT_TRUE(readh.pBlkIdx != NULL);
+  ASSERT_EQ(tsdbLoadBlockInfo(&readh, NULL, NULL), 0);
+  EXPECT_EQ(readh.readBytes, (int64_t)pHeadf->info.len + readh.pBlkIdx->len);
+  closeFSet(&readh);
+
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
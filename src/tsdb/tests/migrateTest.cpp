@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+#include <dirent.h>
+#include <iostream>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int      vgId = 2;
+const int      tid = 1;
+const uint64_t uid = 100;
+
+STsdbRepo *pTestRepo = NULL;
+
+// level of the FSET of fid, -1 if there is none
+int getFSetLevel(STsdbRepo *pRepo, int fid) {
+  SFSIter    fsiter;
+  SDFileSet *pSet;
+
+  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_FORWARD);
+  while ((pSet = tsdbFSIterNext(&fsiter))) {
+    if (pSet->fid == fid) return TSDB_FSET_LEVEL(pSet);
+  }
+  return -1;
+}
+
+// number of temporary copies left on the disk of the level
+int countMigrateTmpFiles(int level) {
+  std::string dir = tsdbTestRoot() + "/level" + std::to_string(level) + "/vnode/vnode" + std::to_string(vgId) +
+                    "/tsdb/data";
+  DIR *pDir = opendir(dir.c_str());
+  if (pDir == NULL) return 0;
+
+  int            num = 0;
+  struct dirent *pEntry;
+  while ((pEntry = readdir(pDir)) != NULL) {
+    if (strstr(pEntry->d_name, ".migrate") != NULL) num++;
+  }
+  closedir(pDir);
+  return num;
+}
+
+bool neverStop(void *param) { return false; }
+bool alwaysStop(void *param) { return true; }
+
+// a commit rewrites the FSET once nTmpFiles of its files are being copied
+typedef struct {
+  TSKEY skey;
+  int   nTmpFiles;
+  bool  written;
+} SRewriteParam;
+
+bool rewriteOnce(void *param) {
+  SRewriteParam *pParam = (SRewriteParam *)param;
+  if (!pParam->written && countMigrateTmpFiles(1) >= pParam->nTmpFiles) {
+    pParam->written = true;
+    EXPECT_EQ(tsdbTestInsert(pTestRepo, tid, uid, pParam->skey, 1000, 50, 5000), 0);
+    EXPECT_EQ(tsdbSyncCommit(pTestRepo), 0);
+  }
+  return false;
+}
+
+}  // namespace
+
+TEST(TsdbMigrateTest, migrateFSet) {
+  ASSERT_EQ(tsdbTestInitFS(2), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  cfg.keep1 = 30;
+  cfg.keep2 = 30;
+  pTestRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pTestRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pTestRepo, tid, uid), 0);
+
+  // all the rows are on level 0 until the retention is shortened below
+  TSKEY       today = (taosGetTimestampMs() / TSDB_TEST_DAY_MS) * TSDB_TEST_DAY_MS;
+  TSKEY       keys[] = {today - 6 * TSDB_TEST_DAY_MS, today - 5 * TSDB_TEST_DAY_MS, today};
+  int         fids[3];
+  STestExpect expect;
+
+  for (int i = 0; i < 3; i++) {
+    fids[i] = (int)(keys[i] / TSDB_TEST_DAY_MS);
+    ASSERT_EQ(tsdbTestInsert(pTestRepo, tid, uid, keys[i], 1000, 300, i * 1000), 0);
+    tsdbTestExpect(&expect, keys[i], 1000, 300, i * 1000);
+  }
+  ASSERT_EQ(tsdbSyncCommit(pTestRepo), 0);
+  for (int i = 0; i < 3; i++) EXPECT_EQ(getFSetLevel(pTestRepo, fids[i]), 0);
+
+  // now the 5 and 6 days old rows belong to level 1, and a commit leaves their FSETs to the background migration
+  tsdbTestCloseRepo(pTestRepo);
+  cfg.keep1 = 2;
+  pTestRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pTestRepo != NULL);
+  ASSERT_GT(tsMigrateInterval, 0);
+  ASSERT_EQ(tsdbTestInsert(pTestRepo, tid, uid, today + 300 * 1000, 1000, 10, 3000), 0);
+  tsdbTestExpect(&expect, today + 300 * 1000, 1000, 10, 3000);
+  ASSERT_EQ(tsdbSyncCommit(pTestRepo), 0);
+  for (int i = 0; i < 3; i++) EXPECT_EQ(getFSetLevel(pTestRepo, fids[i]), 0);
+
+  // a stopped copy leaves nothing behind
+  EXPECT_EQ(tsdbMigrate(pTestRepo, alwaysStop, NULL), 0);
+  for (int i = 0; i < 3; i++) EXPECT_EQ(getFSetLevel(pTestRepo, fids[i]), 0);
+  EXPECT_EQ(countMigrateTmpFiles(1), 0);
+
+  // the copy of the first FSET is dropped since a commit rewrites it meanwhile, and the second one is migrated
+  SRewriteParam param = {keys[0] + 100 * 1000, 1, false};
+  EXPECT_EQ(tsdbMigrate(pTestRepo, rewriteOnce, &param), 1);
+  EXPECT_TRUE(param.written);
+  tsdbTestExpect(&expect, param.skey, 1000, 50, 5000);
+  EXPECT_EQ(getFSetLevel(pTestRepo, fids[0]), 1);
+  EXPECT_EQ(getFSetLevel(pTestRepo, fids[1]), 1);
+  EXPECT_EQ(getFSetLevel(pTestRepo, fids[2]), 0);
+  EXPECT_EQ(countMigrateTmpFiles(1), 0);
+
+  // nothing left to migrate
+  EXPECT_EQ(tsdbMigrate(pTestRepo, neverStop, NULL), 0);
+
+  STestRows rows;
+  ASSERT_EQ(tsdbTestRead(pTestRepo, uid, 0, INT64_MAX, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect, 0, INT64_MAX));
+
+  // and after a restart, from the swapped in FSETs
+  tsdbTestCloseRepo(pTestRepo);
+  pTestRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pTestRepo != NULL);
+  EXPECT_EQ(getFSetLevel(pTestRepo, fids[1]), 1);
+  ASSERT_EQ(tsdbTestRead(pTestRepo, uid, 0, INT64_MAX, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect, 0, INT64_MAX));
+
+  tsdbTestCloseRepo(pTestRepo);
+  pTestRepo = NULL;
+  tsdbTestCleanupFS();
+}
+
+// A FSET changed by a commit after all its files are copied is not swapped in, and its copies are dropped
+TEST(TsdbMigrateTest, changedAfterCopy) {
+  ASSERT_EQ(tsdbTestInitFS(2), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  cfg.keep1 = 30;
+  cfg.keep2 = 30;
+  pTestRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pTestRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pTestRepo, tid, uid), 0);
+
+  TSKEY       skey = (taosGetTimestampMs() / TSDB_TEST_DAY_MS - 6) * TSDB_TEST_DAY_MS;
+  int         fid = (int)(skey / TSDB_TEST_DAY_MS);
+  STestExpect expect;
+  ASSERT_EQ(tsdbTestInsert(pTestRepo, tid, uid, skey, 1000, 300, 0), 0);
+  tsdbTestExpect(&expect, skey, 1000, 300, 0);
+  ASSERT_EQ(tsdbSyncCommit(pTestRepo), 0);
+
+  tsdbTestCloseRepo(pTestRepo);
+  cfg.keep1 = 2;
+  pTestRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pTestRepo != NULL);
+  ASSERT_EQ(getFSetLevel(pTestRepo, fid), 0);
+
+  // the commit comes while the last file of the FSET is copied, so the copy completes on the files it had opened
+  SRewriteParam param = {skey + 500 * 1000, TSDB_FILE_MAX, false};
+  EXPECT_EQ(tsdbMigrate(pTestRepo, rewriteOnce, &param), 0);
+  EXPECT_TRUE(param.written);
+  tsdbTestExpect(&expect, param.skey, 1000, 50, 5000);
+  EXPECT_EQ(getFSetLevel(pTestRepo, fid), 1);
+  EXPECT_EQ(countMigrateTmpFiles(0), 0);
+  EXPECT_EQ(countMigrateTmpFiles(1), 0);
+
+  STestRows rows;
+  ASSERT_EQ(tsdbTestRead(pTestRepo, uid, 0, INT64_MAX, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect, 0, INT64_MAX));
+
+  tsdbTestCloseRepo(pTestRepo);
+  pTestRepo = NULL;
+  tsdbTestCleanupFS();
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int   vgId = 8;
+const TSKEY hour = 3600 * 1000L;
+
+struct SHourAgg {
+  TSKEY   skey;
+  int64_t count;
+  int64_t sum;
+  int64_t min;
+  int64_t max;
+
+  bool operator==(const SHourAgg &o) const {
+    return skey == o.skey && count == o.count && sum == o.sum && min == o.min && max == o.max;
+  }
+};
+
+std::ostream &operator<<(std::ostream &os, const SHourAgg &agg) {
+  return os << "{" << agg.skey << " count " << agg.count << " sum " << agg.sum << " min " << agg.min << " max "
+            << agg.max << "}";
+}
+
+// the hours of the v column of a table from the tier, in [skey, ekey]
+std::vector<SHourAgg> readRollup(STsdbRepo *pRepo, uint64_t uid, TSKEY skey, TSKEY ekey) {
+  std::vector<SHourAgg> aggs;
+  SArray *              pRecs = (SArray *)taosArrayInit(16, sizeof(SRollupRec));
+
+  EXPECT_EQ(tsdbReadRollup(pRepo, uid, skey, ekey, pRecs), 0);
+  for (size_t i = 0; i < taosArrayGetSize(pRecs); i++) {
+    SRollupRec *pRec = (SRollupRec *)taosArrayGet(pRecs, i);
+    EXPECT_EQ(pRec->uid, uid);
+    EXPECT_EQ(pRec->colId, 1);
+    EXPECT_EQ(pRec->type, TSDB_DATA_TYPE_INT);
+    aggs.push_back({pRec->skey, pRec->count, pRec->sum.i64, pRec->min.i64, pRec->max.i64});
+  }
+
+  taosArrayDestroy(&pRecs);
+  return aggs;
+}
+
+// the same from the rows the inserts leave
+std::vector<SHourAgg> expectRollup(const STestExpect &expect, TSKEY skey, TSKEY ekey) {
+  std::vector<SHourAgg> aggs;
+
+  for (auto &kv : expect) {
+    if (kv.first < skey || kv.first > ekey) continue;
+
+    TSKEY h = kv.first - kv.first % hour;
+    if (aggs.empty() || aggs.back().skey != h) aggs.push_back({h, 0, 0, INT64_MAX, INT64_MIN});
+
+    SHourAgg &agg = aggs.back();
+    agg.count++;
+    agg.sum += kv.second;
+    agg.min = std::min(agg.min, (int64_t)kv.second);
+    agg.max = std::max(agg.max, (int64_t)kv.second);
+  }
+
+  return aggs;
+}
+
+}  // namespace
+
+// The commit rolls up the hours its rows fall in from the rows of the file set, overwritten rows included, and keeps
+// the records of the other hours and of the other tables
+TEST(TsdbRollupTest, commit) {
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  cfg.rollup = 1;
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, 1, 101), 0);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, 2, 102), 0);
+
+  TSKEY       day0 = (taosGetTimestampMs() / TSDB_TEST_DAY_MS - 2) * TSDB_TEST_DAY_MS;
+  STestExpect expect1, expect2;
+
+  // three hours of t1 a row a minute, and t2 in the first one
+  ASSERT_EQ(tsdbTestInsert(pRepo, 1, 101, day0, 60 * 1000, 180, 0), 0);
+  ASSERT_EQ(tsdbTestInsert(pRepo, 2, 102, day0 + 30 * 1000, 60 * 1000, 60, -1000), 0);
+  tsdbTestExpect(&expect1, day0, 60 * 1000, 180, 0);
+  tsdbTestExpect(&expect2, day0 + 30 * 1000, 60 * 1000, 60, -1000);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+  std::vector<SHourAgg> aggs = readRollup(pRepo, 101, day0, day0 + TSDB_TEST_DAY_MS - 1);
+  ASSERT_EQ(aggs.size(), 3);
+  EXPECT_EQ(aggs, expectRollup(expect1, day0, day0 + TSDB_TEST_DAY_MS - 1));
+  EXPECT_EQ(aggs[1], (SHourAgg{day0 + hour, 60, (60 + 119) * 60 / 2, 60, 119}));
+  EXPECT_EQ(readRollup(pRepo, 102, day0, day0 + TSDB_TEST_DAY_MS - 1),
+            expectRollup(expect2, day0, day0 + TSDB_TEST_DAY_MS - 1));
+
+  // overwrite the second half of the second hour of t1 and add a fifth hour
+  ASSERT_EQ(tsdbTestInsert(pRepo, 1, 101, day0 + hour + 30 * 60 * 1000, 60 * 1000, 30, 10000), 0);
+  ASSERT_EQ(tsdbTestInsert(pRepo, 1, 101, day0 + 4 * hour, 60 * 1000, 10, 20000), 0);
+  tsdbTestExpect(&expect1, day0 + hour + 30 * 60 * 1000, 60 * 1000, 30, 10000);
+  tsdbTestExpect(&expect1, day0 + 4 * hour, 60 * 1000, 10, 20000);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+  aggs = readRollup(pRepo, 101, day0, day0 + TSDB_TEST_DAY_MS - 1);
+  ASSERT_EQ(aggs.size(), 4);
+  EXPECT_EQ(aggs, expectRollup(expect1, day0, day0 + TSDB_TEST_DAY_MS - 1));
+  EXPECT_EQ(aggs[1].count, 60);
+  EXPECT_EQ(aggs[1].max, 10029);
+  EXPECT_EQ(readRollup(pRepo, 102, day0, day0 + TSDB_TEST_DAY_MS - 1),
+            expectRollup(expect2, day0, day0 + TSDB_TEST_DAY_MS - 1));
+
+  // a range takes the hours starting in it, from the hour of its start
+  aggs = readRollup(pRepo, 101, day0 + hour + 1, day0 + 2 * hour);
+  ASSERT_EQ(aggs.size(), 2);
+  EXPECT_EQ(aggs[0].skey, day0 + hour);
+  EXPECT_EQ(aggs[1].skey, day0 + 2 * hour);
+
+  // the tier is kept over a restart
+  tsdbTestCloseRepo(pRepo);
+  pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  EXPECT_EQ(readRollup(pRepo, 101, day0, day0 + TSDB_TEST_DAY_MS - 1),
+            expectRollup(expect1, day0, day0 + TSDB_TEST_DAY_MS - 1));
+
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
+
+// Without the option no tier is written
+TEST(TsdbRollupTest, noRollup) {
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, 1, 101), 0);
+
+  TSKEY day0 = (taosGetTimestampMs() / TSDB_TEST_DAY_MS - 2) * TSDB_TEST_DAY_MS;
+  ASSERT_EQ(tsdbTestInsert(pRepo, 1, 101, day0, 60 * 1000, 120, 0), 0);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+  EXPECT_TRUE(readRollup(pRepo, 101, day0, day0 + TSDB_TEST_DAY_MS - 1).empty());
+
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
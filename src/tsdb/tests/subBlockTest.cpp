@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <iostream>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int      vgId = 3;
+const int      tid = 1;
+const uint64_t uid = 100;
+
+// numOfSubBlocks of the blocks of the table in the FSET of fid
+std::vector<int> getSubBlocks(STsdbRepo *pRepo, int fid) {
+  std::vector<int> nSubBlocks;
+  SReadH           readh;
+  SFSIter          fsiter;
+  SDFileSet *      pSet;
+
+  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_FORWARD);
+  while ((pSet = tsdbFSIterNext(&fsiter)) && pSet->fid != fid) {
+  }
+  if (pSet == NULL) return nSubBlocks;
+
+  EXPECT_EQ(tsdbInitReadH(&readh, pRepo), 0);
+  EXPECT_EQ(tsdbSetAndOpenReadFSet(&readh, pSet), 0);
+  EXPECT_EQ(tsdbLoadBlockIdx(&readh), 0);
+  EXPECT_EQ(tsdbSetReadTable(&readh, tsdbGetTableByUid(tsdbGetMeta(pRepo), uid)), 0);
+  if (readh.pBlkIdx != NULL && tsdbLoadBlockInfo(&readh, NULL, NULL) == 0) {
+    for (uint32_t i = 0; i < readh.pBlkIdx->numOfBlocks; i++) {
+      nSubBlocks.push_back(readh.pBlkInfo->blocks[i].numOfSubBlocks);
+    }
+  }
+  tsdbCloseAndUnsetFSet(&readh);
+  tsdbDestroyReadH(&readh);
+  return nSubBlocks;
+}
+
+}  // namespace
+
+// Late rows committed into a block, new keys among its rows and updates of its keys, are added as sub-blocks up to
+// TSDB_MAX_SUBBLOCKS, then folded into one, and the rows read back the same all along
+TEST(TsdbSubBlockTest, lateRows) {
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  ASSERT_EQ(tsdbTestCreateTable(pRepo, tid, uid), 0);
+
+  TSKEY       skey = (taosGetTimestampMs() / TSDB_TEST_DAY_MS - 1) * TSDB_TEST_DAY_MS;
+  int         fid = (int)(skey / TSDB_TEST_DAY_MS);
+  STestExpect expect;
+  STestRows   rows;
+
+  // one block of 100 rows 10s apart
+  ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, skey, 10000, 100, 0), 0);
+  tsdbTestExpect(&expect, skey, 10000, 100, 0);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+  EXPECT_EQ(getSubBlocks(pRepo, fid), std::vector<int>({1}));
+
+  int maxSubBlocks = 0;
+  for (int round = 0; round < 10; round++) {
+    // 3 new keys between the rows of the block, and 2 of its keys updated
+    TSKEY lateKey = skey + round * 10000 * 9 + 5000;
+    TSKEY updateKey = skey + round * 10000 * 9 + 20000;
+    ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, lateKey, 30000, 3, 1000 + round * 10), 0);
+    ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, updateKey, 10000, 2, 2000 + round * 10), 0);
+    tsdbTestExpect(&expect, lateKey, 30000, 3, 1000 + round * 10);
+    tsdbTestExpect(&expect, updateKey, 10000, 2, 2000 + round * 10);
+    ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+    std::vector<int> nSubBlocks = getSubBlocks(pRepo, fid);
+    ASSERT_EQ(nSubBlocks.size(), 1);
+    EXPECT_LE(nSubBlocks[0], 8);
+    EXPECT_GE(nSubBlocks[0], 2);
+    if (round < 7) {
+      EXPECT_EQ(nSubBlocks[0], round + 2);
+    }
+    maxSubBlocks = MAX(maxSubBlocks, nSubBlocks[0]);
+
+    ASSERT_EQ(tsdbTestRead(pRepo, uid, 0, INT64_MAX, &rows), 0);
+    EXPECT_EQ(rows, tsdbTestRowsOf(expect, 0, INT64_MAX));
+
+    // and a window inside the block
+    TSKEY wskey = skey + 15000;
+    TSKEY wekey = skey + 455000;
+    ASSERT_EQ(tsdbTestRead(pRepo, uid, wskey, wekey, &rows), 0);
+    EXPECT_EQ(rows, tsdbTestRowsOf(expect, wskey, wekey));
+  }
+  EXPECT_EQ(maxSubBlocks, 8);
+
+  // the sub-blocks are merged into the block once they hold more rows than it
+  for (int round = 0; round < 20; round++) {
+    ASSERT_EQ(tsdbTestInsert(pRepo, tid, uid, skey + 1000 + round * 10, 10000, 10, 3000 + round * 10), 0);
+    tsdbTestExpect(&expect, skey + 1000 + round * 10, 10000, 10, 3000 + round * 10);
+    ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+  }
+  for (int nSubBlocks : getSubBlocks(pRepo, fid)) EXPECT_LE(nSubBlocks, 8);
+  ASSERT_EQ(tsdbTestRead(pRepo, uid, 0, INT64_MAX, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect, 0, INT64_MAX));
+
+  // and after a restart
+  tsdbTestCloseRepo(pRepo);
+  pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  ASSERT_EQ(tsdbTestRead(pRepo, uid, 0, INT64_MAX, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect, 0, INT64_MAX));
+
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
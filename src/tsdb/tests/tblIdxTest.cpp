@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <iostream>
+
+#include "tsdbTestUtil.h"
+
+namespace {
+
+const int vgId = 5;
+
+SDFileSet *getFSet(STsdbRepo *pRepo, int fid) {
+  SFSIter    fsiter;
+  SDFileSet *pSet;
+
+  tsdbFSIterInit(&fsiter, REPO_FS(pRepo), TSDB_FS_ITER_FORWARD);
+  while ((pSet = tsdbFSIterNext(&fsiter)) && pSet->fid != fid) {
+  }
+  return pSet;
+}
+
+bool isMapped(STsdbRepo *pRepo, int fid) {
+  for (SHeadMap *pMap = pRepo->headMaps.maps; pMap; pMap = pMap->next) {
+    if (pMap->fid == fid) return true;
+  }
+  return false;
+}
+
+}  // namespace
+
+// A file set is skipped if none of the tables of the query has blocks in it, or if all their blocks in it end before
+// the query window
+TEST(TsdbTblIdxTest, skipFSet) {
+  ASSERT_EQ(tsdbTestInitFS(1), 0);
+
+  STsdbCfg cfg;
+  tsdbTestInitCfg(&cfg, vgId);
+  STsdbRepo *pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  for (int tid = 1; tid <= 3; tid++) ASSERT_EQ(tsdbTestCreateTable(pRepo, tid, 100 + tid), 0);
+
+  // day 0: t1 in its first minute, t2 from its 20th hour on. day 1: t1 and t3
+  TSKEY       day0 = (taosGetTimestampMs() / TSDB_TEST_DAY_MS - 2) * TSDB_TEST_DAY_MS;
+  TSKEY       day1 = day0 + TSDB_TEST_DAY_MS;
+  TSKEY       hour = 3600 * 1000L;
+  int         fid0 = (int)(day0 / TSDB_TEST_DAY_MS);
+  int         fid1 = fid0 + 1;
+  STestExpect expect1;
+
+  ASSERT_EQ(tsdbTestInsert(pRepo, 1, 101, day0, 1000, 50, 0), 0);
+  ASSERT_EQ(tsdbTestInsert(pRepo, 2, 102, day0 + 20 * hour, 1000, 50, 100), 0);
+  ASSERT_EQ(tsdbTestInsert(pRepo, 1, 101, day1, 1000, 50, 200), 0);
+  ASSERT_EQ(tsdbTestInsert(pRepo, 3, 103, day1, 1000, 50, 300), 0);
+  tsdbTestExpect(&expect1, day0, 1000, 50, 0);
+  tsdbTestExpect(&expect1, day1, 1000, 50, 200);
+  ASSERT_EQ(tsdbSyncCommit(pRepo), 0);
+
+  // the commit indexes the file sets it writes
+  STsdbFS *  pfs = REPO_FS(pRepo);
+  SDFileSet *pSet0 = getFSet(pRepo, fid0);
+  ASSERT_TRUE(pSet0 != NULL);
+  int32_t t1 = 1, t3 = 3;
+  int32_t t12[] = {1, 2};
+  int32_t t2 = 2;
+
+  EXPECT_EQ(tsdbFSetHasTables(pfs, pSet0, &t1, 1, day0), 1);
+  EXPECT_EQ(tsdbFSetHasTables(pfs, pSet0, &t1, 1, day0 + 49 * 1000), 1);
+  EXPECT_EQ(tsdbFSetHasTables(pfs, pSet0, &t1, 1, day0 + hour), 0);
+  EXPECT_EQ(tsdbFSetHasTables(pfs, pSet0, &t3, 1, day0), 0);
+  EXPECT_EQ(tsdbFSetHasTables(pfs, pSet0, t12, 2, day0 + hour), 1);
+  EXPECT_EQ(tsdbFSetHasTables(pfs, pSet0, &t2, 1, day0 + 20 * hour + 49 * 1000), 1);
+  EXPECT_EQ(tsdbFSetHasTables(pfs, pSet0, &t2, 1, day0 + 21 * hour), 0);
+
+  // a skipped file set is not opened, so its head file is not mapped
+  STestRows rows;
+  ASSERT_EQ(pRepo->headMaps.nmaps, 0);
+  ASSERT_EQ(tsdbTestRead(pRepo, 101, day0 + hour, INT64_MAX, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect1, day0 + hour, INT64_MAX));
+  EXPECT_FALSE(isMapped(pRepo, fid0));
+  EXPECT_TRUE(isMapped(pRepo, fid1));
+
+  ASSERT_EQ(tsdbTestRead(pRepo, 101, day0 + 10 * 1000, INT64_MAX, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect1, day0 + 10 * 1000, INT64_MAX));
+  EXPECT_TRUE(isMapped(pRepo, fid0));
+
+  // and after a restart, when the file sets are indexed again by the readers
+  tsdbTestCloseRepo(pRepo);
+  pRepo = tsdbTestOpenRepo(&cfg);
+  ASSERT_TRUE(pRepo != NULL);
+  pfs = REPO_FS(pRepo);
+  pSet0 = getFSet(pRepo, fid0);
+  ASSERT_EQ(tsdbTestRead(pRepo, 101, 0, INT64_MAX, &rows), 0);
+  EXPECT_EQ(rows, tsdbTestRowsOf(expect1, 0, INT64_MAX));
+  EXPECT_EQ(tsdbFSetHasTables(pfs, pSet0, &t1, 1, day0 + hour), 0);
+  EXPECT_EQ(tsdbFSetHasTables(pfs, pSet0, &t2, 1, day0 + hour), 1);
+
+  tsdbTestCloseRepo(pRepo);
+  tsdbTestCleanupFS();
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include "tsdbTestUtil.h"
+
+#define TSDB_TEST_BINARY_BYTES 16
+
+static std::string tsTestRoot;
+
+const std::string &tsdbTestRoot() { return tsTestRoot; }
+
+int tsdbTestInitFS(int nlevel) {
+  SDiskCfg cfgs[TSDB_MAX_TIERS] = {0};
+
+  tsTestRoot = "/tmp/tsdbTest-" + std::to_string(getpid());
+  taosRemoveDir((char *)tsTestRoot.c_str());
+
+  for (int level = 0; level < nlevel; level++) {
+    std::string dir = tsTestRoot + "/level" + std::to_string(level);
+    if (taosMkdirP(dir.c_str(), 1) < 0) return -1;
+
+    tstrncpy(cfgs[level].dir, dir.c_str(), TSDB_FILENAME_LEN);
+    cfgs[level].level = level;
+    cfgs[level].primary = (level == 0);
+  }
+
+  if (tfsInit(cfgs, nlevel) < 0) return -1;
+  return tsdbInitCommitQueue();
+}
+
+void tsdbTestCleanupFS() {
+  tsdbDestroyCommitQueue();
+  tfsDestroy();
+  taosRemoveDir((char *)tsTestRoot.c_str());
+}
+
+void tsdbTestInitCfg(STsdbCfg *pCfg, int vgId) {
+  memset(pCfg, 0, sizeof(*pCfg));
+  pCfg->tsdbId = vgId;
+  pCfg->cacheBlockSize = 1;
+  pCfg->totalBlocks = 4;
+  pCfg->daysPerFile = 1;
+  pCfg->keep = 30;
+  pCfg->minRowsPerFileBlock = 10;
+  pCfg->maxRowsPerFileBlock = 200;
+  pCfg->precision = TSDB_TIME_PRECISION_MILLI;
+  pCfg->compression = 2;
+  pCfg->update = 1;
+}
+
+STsdbRepo *tsdbTestOpenRepo(STsdbCfg *pCfg) {
+  STsdbAppH appH = {0};
+  char      vnodeDir[TSDB_FILENAME_LEN] = "\0";
+
+  // the dirs the vnode would have made
+  snprintf(vnodeDir, TSDB_FILENAME_LEN, "/vnode/vnode%d", pCfg->tsdbId);
+  if (tfsMkdir("vnode") < 0 || tfsMkdir(vnodeDir) < 0) return NULL;
+  if (tsdbCreateRepo(pCfg->tsdbId) < 0) return NULL;
+  return tsdbOpenRepo(pCfg, &appH);
+}
+
+void tsdbTestCloseRepo(STsdbRepo *pRepo) { tsdbCloseRepo(pRepo, 0); }
+
+int tsdbTestCreateTable(STsdbRepo *pRepo, int tid, uint64_t uid) {
+  STSchemaBuilder builder = {0};
+  STableCfg *     pCfg = (STableCfg *)calloc(1, sizeof(STableCfg));
+  char            name[32];
+
+  tdInitTSchemaBuilder(&builder, 0);
+  tdAddColToSchema(&builder, TSDB_DATA_TYPE_TIMESTAMP, 0, 8);
+  tdAddColToSchema(&builder, TSDB_DATA_TYPE_INT, 1, 4);
+  tdAddColToSchema(&builder, TSDB_DATA_TYPE_BINARY, 2, TSDB_TEST_BINARY_BYTES);
+
+  snprintf(name, sizeof(name), "t%d", tid);
+  pCfg->type = TSDB_NORMAL_TABLE;
+  pCfg->superUid = TSDB_INVALID_SUPER_TABLE_ID;
+  pCfg->tableId.tid = tid;
+  pCfg->tableId.uid = uid;
+  pCfg->schema = tdGetSchemaFromBuilder(&builder);
+  pCfg->name = strdup(name);
+  tdDestroyTSchemaBuilder(&builder);
+
+  int code = tsdbCreateTable(pRepo, pCfg);
+  tsdbClearTableCfg(pCfg);
+  return code;
+}
+
+int tsdbTestInsert(STsdbRepo *pRepo, int tid, uint64_t uid, TSKEY skey, TSKEY step, int nrows, int32_t vbase) {
+  STable *  pTable = tsdbGetTableByUid(tsdbGetMeta(pRepo), uid);
+  STSchema *pSchema = tsdbGetTableSchemaImpl(pTable, false, false, -1, -1);
+  int       maxRows = 100;  // numOfRows of a submit block is int16_t
+
+  for (int start = 0; start < nrows; start += maxRows) {
+    int         rows = MIN(maxRows, nrows - start);
+    size_t      len = sizeof(SSubmitMsg) + sizeof(SSubmitBlk) + memRowMaxBytesFromSchema(pSchema) * rows;
+    SSubmitMsg *pMsg = (SSubmitMsg *)calloc(1, len);
+    SSubmitBlk *pBlock = (SSubmitBlk *)pMsg->blocks;
+
+    for (int i = start; i < start + rows; i++) {
+      TSKEY   key = skey + i * step;
+      int32_t v = vbase + i;
+      char    sval[VARSTR_HEADER_SIZE + TSDB_TEST_BINARY_BYTES];
+      SMemRow row = (SMemRow)(pBlock->data + pBlock->dataLen);
+
+      varDataSetLen(sval, snprintf(sval + VARSTR_HEADER_SIZE, TSDB_TEST_BINARY_BYTES, "s%d", v));
+
+      memRowSetType(row, SMEM_ROW_DATA);
+      tdInitDataRow(memRowDataBody(row), pSchema);
+      tdAppendDataColVal(memRowDataBody(row), &key, true, TSDB_DATA_TYPE_TIMESTAMP, schemaColAt(pSchema, 0)->offset);
+      tdAppendDataColVal(memRowDataBody(row), &v, true, TSDB_DATA_TYPE_INT, schemaColAt(pSchema, 1)->offset);
+      tdAppendDataColVal(memRowDataBody(row), sval, true, TSDB_DATA_TYPE_BINARY, schemaColAt(pSchema, 2)->offset);
+      pBlock->dataLen += memRowTLen(row);
+    }
+
+    pBlock->uid = htobe64(uid);
+    pBlock->tid = htonl(tid);
+    pBlock->sversion = htonl(schemaVersion(pSchema));
+    pBlock->numOfRows = htons(rows);
+    pMsg->length = htonl((int32_t)(sizeof(SSubmitMsg) + sizeof(SSubmitBlk) + pBlock->dataLen));
+    pBlock->dataLen = htonl(pBlock->dataLen);
+    pMsg->numOfBlocks = htonl(1);
+
+    int code = tsdbInsertData(pRepo, pMsg, NULL, NULL);
+    free(pMsg);
+    if (code < 0) return -1;
+  }
+
+  return 0;
+}
+
+int tsdbTestRead(STsdbRepo *pRepo, uint64_t uid, TSKEY skey, TSKEY ekey, STestRows *pRows) {
+  return tsdbTestReadTables(pRepo, std::vector<uint64_t>({uid}), skey, ekey, pRows);
+}
+
+int tsdbTestReadTables(STsdbRepo *pRepo, const std::vector<uint64_t> &uids, TSKEY skey, TSKEY ekey, STestRows *pRows) {
+  SColumnInfo cols[3] = {{0, TSDB_DATA_TYPE_TIMESTAMP, 8},
+                         {1, TSDB_DATA_TYPE_INT, 4},
+                         {2, TSDB_DATA_TYPE_BINARY, VARSTR_HEADER_SIZE + TSDB_TEST_BINARY_BYTES}};
+  STsdbQueryCond  cond = {0};
+  STableGroupInfo groupInfo = {0};
+  SMemRef         memRef = {0};
+
+  cond.twindow.skey = skey;
+  cond.twindow.ekey = ekey;
+  cond.order = TSDB_ORDER_ASC;
+  cond.numOfCols = 3;
+  cond.type = BLOCK_LOAD_OFFSET_SEQ_ORDER;
+  cond.colList = cols;
+
+  SArray *group = (SArray *)taosArrayInit(uids.size(), sizeof(STableKeyInfo));
+  groupInfo.pGroupList = (SArray *)taosArrayInit(1, POINTER_BYTES);
+  taosArrayPush(groupInfo.pGroupList, &group);
+  for (uint64_t uid : uids) {
+    STable *pTable = tsdbGetTableByUid(tsdbGetMeta(pRepo), uid);
+    if (pTable == NULL) {
+      tsdbDestroyTableGroup(&groupInfo);
+      return -1;
+    }
+    tsdbRefTable(pTable);
+
+    STableKeyInfo info = {pTable, skey};
+    taosArrayPush(group, &info);
+    groupInfo.numOfTables++;
+  }
+
+  TsdbQueryHandleT *pHandle = tsdbQueryTables(pRepo, &cond, &groupInfo, 0, &memRef);
+  if (pHandle == NULL) {
+    tsdbDestroyTableGroup(&groupInfo);
+    return -1;
+  }
+
+  pRows->clear();
+  while (tsdbNextDataBlock(pHandle)) {
+    SDataBlockInfo binfo = {0};
+    tsdbRetrieveDataBlockInfo(pHandle, &binfo);
+
+    SArray *pCols = tsdbRetrieveDataBlock(pHandle, NULL);
+    if (pCols == NULL) break;
+
+    SColumnInfoData *pTs = (SColumnInfoData *)taosArrayGet(pCols, 0);
+    SColumnInfoData *pV = (SColumnInfoData *)taosArrayGet(pCols, 1);
+    SColumnInfoData *pS = (SColumnInfoData *)taosArrayGet(pCols, 2);
+    for (int i = 0; i < binfo.rows; i++) {
+      TSKEY   key = ((TSKEY *)pTs->pData)[i];
+      int32_t v = ((int32_t *)pV->pData)[i];
+      char *  sval = pS->pData + i * pS->info.bytes;
+
+      std::string expect = "s" + std::to_string(v);
+      EXPECT_EQ(std::string((char *)varDataVal(sval), varDataLen(sval)), expect);
+      pRows->push_back(std::make_pair(key, v));
+    }
+  }
+
+  tsdbCleanupQueryHandle(pHandle);
+  tsdbDestroyTableGroup(&groupInfo);
+  return 0;
+}
+
+void tsdbTestExpect(STestExpect *pExpect, TSKEY skey, TSKEY step, int nrows, int32_t vbase) {
+  for (int i = 0; i < nrows; i++) {
+    (*pExpect)[skey + i * step] = vbase + i;
+  }
+}
+
+STestRows tsdbTestRowsOf(const STestExpect &expect, TSKEY skey, TSKEY ekey) {
+  STestRows rows;
+  for (auto it = expect.lower_bound(skey); it != expect.end() && it->first <= ekey; ++it) {
+    rows.push_back(*it);
+  }
+  return rows;
+}
@@ -0,0 +1,43 @@
+#ifndef TDENGINE_TSDB_TEST_UTIL_H
+#define TDENGINE_TSDB_TEST_UTIL_H
+
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tsdbint.h"
+
+// A scratch repo for the tests: tables of (ts timestamp, v int, s binary(16)), where s is "s<v>"
+
+typedef std::vector<std::pair<TSKEY, int32_t>> STestRows;
+
+#define TSDB_TEST_DAY_MS (86400 * 1000L)
+
+// mount nlevel tiers of one disk each under a new scratch dir, and start the commit queue
+int  tsdbTestInitFS(int nlevel);
+void tsdbTestCleanupFS();
+
+const std::string &tsdbTestRoot();
+
+void       tsdbTestInitCfg(STsdbCfg *pCfg, int vgId);
+STsdbRepo *tsdbTestOpenRepo(STsdbCfg *pCfg);
+void       tsdbTestCloseRepo(STsdbRepo *pRepo);
+
+int tsdbTestCreateTable(STsdbRepo *pRepo, int tid, uint64_t uid);
+
+// rows of keys skey + i * step with v = vbase + i
+int tsdbTestInsert(STsdbRepo *pRepo, int tid, uint64_t uid, TSKEY skey, TSKEY step, int nrows, int32_t vbase);
+
+// all the rows of the table in [skey, ekey] in ascending order, the s column is checked against v on the way
+int tsdbTestRead(STsdbRepo *pRepo, uint64_t uid, TSKEY skey, TSKEY ekey, STestRows *pRows);
+
+// the same over the tables of uids, one after the other in the order given
+int tsdbTestReadTables(STsdbRepo *pRepo, const std::vector<uint64_t> &uids, TSKEY skey, TSKEY ekey, STestRows *pRows);
+
+// the rows an insert leaves, the last written of a key wins
+typedef std::map<TSKEY, int32_t> STestExpect;
+void      tsdbTestExpect(STestExpect *pExpect, TSKEY skey, TSKEY step, int nrows, int32_t vbase);
+STestRows tsdbTestRowsOf(const STestExpect &expect, TSKEY skey, TSKEY ekey);
+
+#endif  // TDENGINE_TSDB_TEST_UTIL_H
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TMETRICS_H
+#define TDENGINE_TMETRICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+#define TSDB_METRIC_MAX_NUM   64
+#define TSDB_METRIC_NAME_LEN  64
+#define TSDB_METRIC_HELP_LEN  128
+#define TSDB_METRIC_SHARDS    8
+
+// values of a histogram fall into log-linear buckets, 8 sub-buckets per power of two keep the error below 12.5%
+#define TSDB_METRIC_SUB_BITS  3
+#define TSDB_METRIC_MAX_BITS  40
+#define TSDB_METRIC_BUCKETS   ((TSDB_METRIC_MAX_BITS - TSDB_METRIC_SUB_BITS + 1) << TSDB_METRIC_SUB_BITS)
+
+// upper bound of the prometheus text of a single metric
+#define TSDB_METRIC_TEXT_LEN  1024
+
+typedef enum {
+  TSDB_METRIC_COUNTER,
+  TSDB_METRIC_GAUGE,
+  TSDB_METRIC_HISTOGRAM
+} EMetricType;
+
+typedef struct SMetric SMetric;
+
+typedef struct {
+  const char *name;
+  const char *help;
+  int8_t      type;
+  int64_t     value;  // value of a counter or gauge, number of observations of a histogram
+  int64_t     sum;
+  int64_t     p50;
+  int64_t     p90;
+  int64_t     p99;
+  int64_t     p999;
+  int64_t     max;
+} SMetricSnapshot;
+
+// register a metric, registering an existing name returns the same metric. Metrics live until the process exits,
+// so the returned pointer can be kept by the caller. On error, NULL is returned and the updates below are no-ops
+SMetric *taosMetricCounter(const char *name, const char *help);
+SMetric *taosMetricGauge(const char *name, const char *help);
+SMetric *taosMetricHistogram(const char *name, const char *help);
+
+// counters and histograms are sharded by thread, so concurrent updates do not contend on one cache line
+void    taosMetricAdd(SMetric *pMetric, int64_t val);
+void    taosMetricSet(SMetric *pMetric, int64_t val);
+void    taosMetricObserve(SMetric *pMetric, int64_t val);
+int64_t taosMetricValue(SMetric *pMetric);
+
+void    taosMetricGetSnapshot(SMetric *pMetric, SMetricSnapshot *pSnap);
+int32_t taosMetricsGetSnapshots(SMetricSnapshot *pSnaps, int32_t maxNum);
+int32_t taosMetricsNum();
+
+// write all metrics in the prometheus text exposition format, returns the length of the text
+int32_t taosMetricsToPrometheus(char *buf, int32_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TMETRICS_H
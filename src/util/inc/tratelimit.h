@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_TRATELIMIT_H
+#define TDENGINE_TRATELIMIT_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "os.h"
+
+typedef struct SRateLimiter SRateLimiter;
+
+// a token bucket shared by threads, the rate is in bytes per second and 0 means no limit. The bucket holds at most
+// one second of tokens, so an idle period does not allow a burst larger than that
+SRateLimiter *taosOpenRateLimiter(int64_t rate);
+void          taosCloseRateLimiter(SRateLimiter *pLimiter);
+void          taosSetRateLimit(SRateLimiter *pLimiter, int64_t rate);
+
+// take the tokens of the bytes read or written, the caller sleeps until the bucket pays them back. A request larger
+// than the bucket is allowed, it is paid by the time after it
+void          taosRateLimit(SRateLimiter *pLimiter, int64_t bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif  // TDENGINE_TRATELIMIT_H
@@ -0,0 +1,258 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tulog.h"
+#include "tutil.h"
+#include "tmetrics.h"
+
+#define METRIC_SUB_BUCKETS (1 << TSDB_METRIC_SUB_BITS)
+
+// one shard per cache line, a thread always updates the shard picked by its id
+typedef struct {
+  int64_t value;
+  int64_t sum;
+  int64_t max;
+  char    padding[40];
+} SMetricShard;
+
+struct SMetric {
+  char          name[TSDB_METRIC_NAME_LEN];
+  char          help[TSDB_METRIC_HELP_LEN];
+  int8_t        type;
+  SMetricShard  shards[TSDB_METRIC_SHARDS];
+  int64_t      *buckets;  // TSDB_METRIC_SHARDS * TSDB_METRIC_BUCKETS, for histograms only
+};
+
+static SMetric        *tsMetrics[TSDB_METRIC_MAX_NUM];
+static int32_t         tsNumOfMetrics = 0;
+static pthread_mutex_t tsMetricsMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static SMetric *taosMetricRegister(const char *name, const char *help, int8_t type) {
+  SMetric *pMetric = NULL;
+
+  pthread_mutex_lock(&tsMetricsMutex);
+
+  for (int32_t i = 0; i < tsNumOfMetrics; ++i) {
+    if (strcmp(tsMetrics[i]->name, name) == 0) {
+      pMetric = tsMetrics[i];
+      break;
+    }
+  }
+
+  if (pMetric == NULL) {
+    if (tsNumOfMetrics >= TSDB_METRIC_MAX_NUM) {
+      uError("metric:%s, failed to register since more than %d metrics", name, TSDB_METRIC_MAX_NUM);
+    } else {
+      pMetric = calloc(1, sizeof(SMetric));
+      if (pMetric != NULL && type == TSDB_METRIC_HISTOGRAM) {
+        pMetric->buckets = calloc(TSDB_METRIC_SHARDS * TSDB_METRIC_BUCKETS, sizeof(int64_t));
+        if (pMetric->buckets == NULL) tfree(pMetric);
+      }
+
+      if (pMetric != NULL) {
+        tstrncpy(pMetric->name, name, TSDB_METRIC_NAME_LEN);
+        tstrncpy(pMetric->help, help, TSDB_METRIC_HELP_LEN);
+        pMetric->type = type;
+        tsMetrics[tsNumOfMetrics++] = pMetric;
+      } else {
+        uError("metric:%s, failed to register since out of memory", name);
+      }
+    }
+  } else if (pMetric->type != type) {
+    uError("metric:%s, already registered with type:%d", name, pMetric->type);
+    pMetric = NULL;
+  }
+
+  pthread_mutex_unlock(&tsMetricsMutex);
+  return pMetric;
+}
+
+SMetric *taosMetricCounter(const char *name, const char *help) {
+  return taosMetricRegister(name, help, TSDB_METRIC_COUNTER);
+}
+
+SMetric *taosMetricGauge(const char *name, const char *help) {
+  return taosMetricRegister(name, help, TSDB_METRIC_GAUGE);
+}
+
+SMetric *taosMetricHistogram(const char *name, const char *help) {
+  return taosMetricRegister(name, help, TSDB_METRIC_HISTOGRAM);
+}
+
+static FORCE_INLINE int32_t taosMetricShard() {
+  return (int32_t)((uint64_t)taosGetSelfPthreadId() % TSDB_METRIC_SHARDS);
+}
+
+static int32_t taosMetricBucket(int64_t val) {
+  if (val < METRIC_SUB_BUCKETS) return (val < 0) ? 0 : (int32_t)val;
+
+  int32_t msb = 63 - BUILDIN_CLZL((uint64_t)val);
+  if (msb >= TSDB_METRIC_MAX_BITS) return TSDB_METRIC_BUCKETS - 1;
+
+  int32_t shift = msb - TSDB_METRIC_SUB_BITS;
+  return ((shift + 1) << TSDB_METRIC_SUB_BITS) + (int32_t)((val >> shift) & (METRIC_SUB_BUCKETS - 1));
+}
+
+// the largest value which falls into the bucket
+static int64_t taosMetricBucketUpper(int32_t bucket) {
+  if (bucket < METRIC_SUB_BUCKETS) return bucket;
+
+  int32_t shift = (bucket >> TSDB_METRIC_SUB_BITS) - 1;
+  int64_t lower = (int64_t)(METRIC_SUB_BUCKETS + (bucket & (METRIC_SUB_BUCKETS - 1))) << shift;
+  return lower + ((int64_t)1 << shift) - 1;
+}
+
+void taosMetricAdd(SMetric *pMetric, int64_t val) {
+  if (pMetric == NULL) return;
+
+  if (pMetric->type == TSDB_METRIC_GAUGE) {
+    atomic_add_fetch_64(&pMetric->shards[0].value, val);
+  } else {
+    atomic_add_fetch_64(&pMetric->shards[taosMetricShard()].value, val);
+  }
+}
+
+void taosMetricSet(SMetric *pMetric, int64_t val) {
+  if (pMetric == NULL || pMetric->type != TSDB_METRIC_GAUGE) return;
+  atomic_store_64(&pMetric->shards[0].value, val);
+}
+
+void taosMetricObserve(SMetric *pMetric, int64_t val) {
+  if (pMetric == NULL || pMetric->type != TSDB_METRIC_HISTOGRAM) return;
+
+  int32_t       shard = taosMetricShard();
+  SMetricShard *pShard = &pMetric->shards[shard];
+
+  atomic_add_fetch_64(&pMetric->buckets[shard * TSDB_METRIC_BUCKETS + taosMetricBucket(val)], 1);
+  atomic_add_fetch_64(&pShard->sum, val);
+  atomic_add_fetch_64(&pShard->value, 1);
+
+  int64_t max = atomic_load_64(&pShard->max);
+  while (val > max) {
+    int64_t old = atomic_val_compare_exchange_64(&pShard->max, max, val);
+    if (old == max) break;
+    max = old;
+  }
+}
+
+int64_t taosMetricValue(SMetric *pMetric) {
+  if (pMetric == NULL) return 0;
+  if (pMetric->type == TSDB_METRIC_GAUGE) return atomic_load_64(&pMetric->shards[0].value);
+
+  int64_t value = 0;
+  for (int32_t i = 0; i < TSDB_METRIC_SHARDS; ++i) {
+    value += atomic_load_64(&pMetric->shards[i].value);
+  }
+  return value;
+}
+
+static int64_t taosMetricQuantile(int64_t *buckets, int64_t count, int64_t max, double quantile) {
+  if (count <= 0) return 0;
+
+  int64_t rank = (int64_t)ceil(quantile * (double)count);
+  if (rank <= 0) rank = 1;
+
+  int64_t seen = 0;
+  for (int32_t b = 0; b < TSDB_METRIC_BUCKETS; ++b) {
+    seen += buckets[b];
+    if (seen >= rank) return MIN(taosMetricBucketUpper(b), max);
+  }
+
+  return max;
+}
+
+void taosMetricGetSnapshot(SMetric *pMetric, SMetricSnapshot *pSnap) {
+  memset(pSnap, 0, sizeof(SMetricSnapshot));
+  pSnap->name = pMetric->name;
+  pSnap->help = pMetric->help;
+  pSnap->type = pMetric->type;
+
+  if (pMetric->type != TSDB_METRIC_HISTOGRAM) {
+    pSnap->value = taosMetricValue(pMetric);
+    return;
+  }
+
+  // merge the shards, concurrent updates may make count and buckets differ slightly, which is fine for reporting
+  int64_t buckets[TSDB_METRIC_BUCKETS] = {0};
+  int64_t count = 0;
+  for (int32_t i = 0; i < TSDB_METRIC_SHARDS; ++i) {
+    int64_t *shardBuckets = pMetric->buckets + i * TSDB_METRIC_BUCKETS;
+    for (int32_t b = 0; b < TSDB_METRIC_BUCKETS; ++b) {
+      int64_t num = atomic_load_64(&shardBuckets[b]);
+      buckets[b] += num;
+      count += num;
+    }
+    pSnap->sum += atomic_load_64(&pMetric->shards[i].sum);
+    pSnap->max = MAX(pSnap->max, atomic_load_64(&pMetric->shards[i].max));
+  }
+
+  pSnap->value = count;
+  pSnap->p50 = taosMetricQuantile(buckets, count, pSnap->max, 0.5);
+  pSnap->p90 = taosMetricQuantile(buckets, count, pSnap->max, 0.9);
+  pSnap->p99 = taosMetricQuantile(buckets, count, pSnap->max, 0.99);
+  pSnap->p999 = taosMetricQuantile(buckets, count, pSnap->max, 0.999);
+}
+
+int32_t taosMetricsNum() { return atomic_load_32(&tsNumOfMetrics); }
+
+int32_t taosMetricsGetSnapshots(SMetricSnapshot *pSnaps, int32_t maxNum) {
+  pthread_mutex_lock(&tsMetricsMutex);
+  int32_t num = MIN(maxNum, tsNumOfMetrics);
+  pthread_mutex_unlock(&tsMetricsMutex);
+
+  // registered metrics are never removed or moved, so they can be read without the lock
+  for (int32_t i = 0; i < num; ++i) {
+    taosMetricGetSnapshot(tsMetrics[i], &pSnaps[i]);
+  }
+
+  return num;
+}
+
+static int32_t taosMetricToPrometheus(SMetricSnapshot *pSnap, char *buf, int32_t size) {
+  static const char *types[] = {"counter", "gauge", "summary"};
+
+  int32_t len = snprintf(buf, size, "# HELP %s %s\n# TYPE %s %s\n", pSnap->name, pSnap->help, pSnap->name,
+                         types[pSnap->type]);
+  if (len >= size) return size;
+
+  if (pSnap->type != TSDB_METRIC_HISTOGRAM) {
+    len += snprintf(buf + len, size - len, "%s %" PRId64 "\n", pSnap->name, pSnap->value);
+  } else {
+    len += snprintf(buf + len, size - len,
+                    "%s{quantile=\"0.5\"} %" PRId64 "\n%s{quantile=\"0.9\"} %" PRId64 "\n"
+                    "%s{quantile=\"0.99\"} %" PRId64 "\n%s{quantile=\"0.999\"} %" PRId64 "\n"
+                    "%s{quantile=\"1\"} %" PRId64 "\n%s_sum %" PRId64 "\n%s_count %" PRId64 "\n",
+                    pSnap->name, pSnap->p50, pSnap->name, pSnap->p90, pSnap->name, pSnap->p99, pSnap->name,
+                    pSnap->p999, pSnap->name, pSnap->max, pSnap->name, pSnap->sum, pSnap->name, pSnap->value);
+  }
+
+  return MIN(len, size);
+}
+
+int32_t taosMetricsToPrometheus(char *buf, int32_t size) {
+  SMetricSnapshot snaps[TSDB_METRIC_MAX_NUM];
+  int32_t         num = taosMetricsGetSnapshots(snaps, TSDB_METRIC_MAX_NUM);
+  int32_t         len = 0;
+
+  for (int32_t i = 0; i < num && len < size - 1; ++i) {
+    len += taosMetricToPrometheus(&snaps[i], buf + len, size - len);
+  }
+
+  len = MIN(len, size - 1);
+  buf[len] = 0;
+  return len;
+}
@@ -18,6 +18,27 @@
 #include "taoserror.h"
 #include "tqueue.h"
 
+#ifdef _TD_LINUX
+#include <linux/futex.h>
+#endif
+
+/*
+ * Writers never lock: an item is pushed onto the 'incoming' stack of the queue by CAS. A reader owns the queue
+ * while 'reading' is set, it swaps the whole stack out and reverses it into the FIFO list 'head/tail', so that
+ * one atomic exchange dequeues all the items written since the last read.
+ *
+ * A qset counts the written items in 'avail', a reader takes one before looking for an item and only parks
+ * itself (futex on linux, semaphore elsewhere) when there is none, a writer only wakes a reader when one is parked.
+ * A batched read takes one more for each extra item it drains, 'avail' may go below zero until the writers of
+ * those items add them. A reader which finds nothing, since the queues are not searched atomically, gives its one
+ * back and, unless an item is written meanwhile, parks until one is, so that a count no reader can take any more
+ * never makes the readers spin. It only returns without an item when an exit is signaled by taosQsetThreadResume.
+ *
+ * The items of a queue are added to 'avail' when it joins a qset and taken off when it leaves. A writer looks the
+ * qset up both before it counts its item and after it pushes it, so that an item counted by a join or a leave is
+ * always notified to the qset, it may be counted twice, never lost.
+ */
+
 typedef struct STaosQnode {
   int                 type;
   struct STaosQnode  *next;
@@ -27,20 +48,28 @@ typedef struct STaosQnode {
 typedef struct STaosQueue {
   int32_t             itemSize;
   int32_t             numOfItems;
-  struct STaosQnode  *head;
+  struct STaosQnode  *incoming; // pushed by writers, in reverse order
+  char                padding[48];
+  struct STaosQnode  *head;     // owned by the reader which sets 'reading'
   struct STaosQnode  *tail;
+  int32_t             numOfPending;
+  int8_t              reading;
   struct STaosQueue  *next;    // for queue set
   struct STaosQset   *qset;    // for queue set
   void               *ahandle; // for queue set
-  pthread_mutex_t     mutex;  
 } STaosQueue;
 
 typedef struct STaosQset {
   STaosQueue        *head;
   STaosQueue        *current;
-  pthread_mutex_t    mutex;
+  pthread_rwlock_t   lock;     // protects the list of queues, readers share it
   int32_t            numOfQueues;
-  int32_t            numOfItems;
+  char               padding[64];
+  int32_t            avail;    // items not taken by readers yet, may be negative after a batched read
+  int32_t            waiters;
+  int32_t            seq;      // bumped by every notify, the readers which found nothing park on it
+  int32_t            stalls;   // readers parked on 'seq'
+  int32_t            resumes;  // exits signaled to the readers and not taken yet
   tsem_t             sem;
 } STaosQset;
 
@@ -50,7 +79,128 @@ typedef struct STaosQall {
   int32_t       itemSize;
   int32_t       numOfItems;
 } STaosQall; 
-  
+
+static bool taosTryLockQueue(STaosQueue *queue) {
+  return atomic_val_compare_exchange_8(&queue->reading, 0, 1) == 0;
+}
+
+static void taosLockQueue(STaosQueue *queue) {
+  while (!taosTryLockQueue(queue)) sched_yield();
+}
+
+static void taosUnlockQueue(STaosQueue *queue) { atomic_store_8(&queue->reading, 0); }
+
+// move the items written since the last read to the end of the pending list, in the order they were written
+static void taosFetchIncoming(STaosQueue *queue) {
+  STaosQnode *pNode = atomic_exchange_ptr(&queue->incoming, NULL);
+  if (pNode == NULL) return;
+
+  STaosQnode *first = NULL;
+  STaosQnode *last = pNode;
+  while (pNode) {
+    STaosQnode *next = pNode->next;
+    pNode->next = first;
+    first = pNode;
+    pNode = next;
+    queue->numOfPending++;
+  }
+
+  if (queue->tail) {
+    queue->tail->next = first;
+  } else {
+    queue->head = first;
+  }
+  queue->tail = last;
+}
+
+// the queue shall be locked by the caller
+static STaosQnode *taosPopQnode(STaosQueue *queue) {
+  if (queue->head == NULL) taosFetchIncoming(queue);
+
+  STaosQnode *pNode = queue->head;
+  if (pNode == NULL) return NULL;
+
+  queue->head = pNode->next;
+  if (queue->head == NULL) queue->tail = NULL;
+  queue->numOfPending--;
+
+  atomic_sub_fetch_32(&queue->numOfItems, 1);
+  return pNode;
+}
+
+// the queue shall be locked by the caller, the number of items is returned and the list is linked by 'next'
+static int32_t taosPopAllQnodes(STaosQueue *queue, STaosQnode **ppNode) {
+  taosFetchIncoming(queue);
+
+  int32_t num = queue->numOfPending;
+  *ppNode = queue->head;
+  queue->head = NULL;
+  queue->tail = NULL;
+  queue->numOfPending = 0;
+
+  if (num > 0) atomic_sub_fetch_32(&queue->numOfItems, num);
+  return num;
+}
+
+#ifdef _TD_LINUX
+static void taosParkOn(int32_t *addr, int32_t val, tsem_t *sem) {
+  syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, NULL, NULL, 0);
+}
+
+static void taosUnparkOn(int32_t *addr, int32_t num, tsem_t *sem) {
+  syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, num, NULL, NULL, 0);
+}
+#else
+// both park on the semaphore, a reader woken for the other one checks again and parks back
+static void taosParkOn(int32_t *addr, int32_t val, tsem_t *sem) { tsem_wait(sem); }
+
+static void taosUnparkOn(int32_t *addr, int32_t num, tsem_t *sem) {
+  for (int32_t i = 0; i < num; ++i) tsem_post(sem);
+}
+#endif
+
+static void taosWaitQset(STaosQset *qset) {
+  while (1) {
+    int32_t avail = atomic_load_32(&qset->avail);
+    if (avail > 0) {
+      if (atomic_val_compare_exchange_32(&qset->avail, avail, avail - 1) == avail) return;
+      continue;
+    }
+
+    // a writer adds to 'avail' before it checks 'waiters', so 'avail' is checked again after 'waiters' is set
+    atomic_add_fetch_32(&qset->waiters, 1);
+    avail = atomic_load_32(&qset->avail);
+    if (avail <= 0) taosParkOn(&qset->avail, avail, &qset->sem);
+    atomic_sub_fetch_32(&qset->waiters, 1);
+  }
+}
+
+static void taosNotifyQset(STaosQset *qset, int32_t num) {
+  atomic_add_fetch_32(&qset->avail, num);
+  atomic_add_fetch_32(&qset->seq, 1);
+  if (atomic_load_32(&qset->waiters) > 0) taosUnparkOn(&qset->avail, num, &qset->sem);
+  if (atomic_load_32(&qset->stalls) > 0) taosUnparkOn(&qset->seq, num, &qset->sem);
+}
+
+// a reader which found no item exits if an exit is signaled. Otherwise it gives back what it took from 'avail', and
+// parks if nothing is notified since 'seq' was read before the search: then the items notified before were all
+// there to be found, and what is left in 'avail' is taken by other readers or not found by any
+static bool taosQsetReadNothing(STaosQset *qset, int32_t seq) {
+  while (1) {
+    int32_t resumes = atomic_load_32(&qset->resumes);
+    if (resumes <= 0) break;
+    if (atomic_val_compare_exchange_32(&qset->resumes, resumes, resumes - 1) == resumes) return true;
+  }
+
+  atomic_add_fetch_32(&qset->avail, 1);
+
+  // a writer bumps 'seq' before it checks 'stalls', so 'seq' is checked again after 'stalls' is set
+  atomic_add_fetch_32(&qset->stalls, 1);
+  if (atomic_load_32(&qset->seq) == seq) taosParkOn(&qset->seq, seq, &qset->sem);
+  atomic_sub_fetch_32(&qset->stalls, 1);
+  return false;
+}
+
 taos_queue taosOpenQueue() {
   
   STaosQueue *queue = (STaosQueue *) calloc(sizeof(STaosQueue), 1);
@@ -59,8 +209,6 @@ taos_queue taosOpenQueue() {
     return NULL;
   }
 
-  pthread_mutex_init(&queue->mutex, NULL);
-
   uTrace("queue:%p is opened", queue);
   return queue;
 }
@@ -69,15 +217,14 @@ void taosCloseQueue(taos_queue param) {
   if (param == NULL) return;
   STaosQueue *queue = (STaosQueue *)param;
   STaosQnode *pTemp;
-  STaosQset  *qset;
+  STaosQnode *pNode;
 
-  pthread_mutex_lock(&queue->mutex);
-  STaosQnode *pNode = queue->head;  
-  queue->head = NULL;
-  qset = queue->qset;
-  pthread_mutex_unlock(&queue->mutex);
+  STaosQset *qset = atomic_load_ptr(&queue->qset);
+  if (qset) taosRemoveFromQset(qset, queue);
 
-  if (queue->qset) taosRemoveFromQset(qset, queue); 
+  taosLockQueue(queue);
+  taosPopAllQnodes(queue, &pNode);
+  taosUnlockQueue(queue);
 
   while (pNode) {
     pTemp = pNode;
@@ -85,7 +232,6 @@ void taosCloseQueue(taos_queue param) {
     free (pTemp);
   }
 
-  pthread_mutex_destroy(&queue->mutex);
   uTrace("queue:%p is closed", queue);
   free(queue);
 }
@@ -111,50 +257,45 @@ int taosWriteQitem(taos_queue param, int type, void *item) {
   STaosQueue *queue = (STaosQueue *)param;
   STaosQnode *pNode = (STaosQnode *)(((char *)item) - sizeof(STaosQnode));
   pNode->type = type;
-  pNode->next = NULL;
 
-  pthread_mutex_lock(&queue->mutex);
+  // looked up before the item is counted, see taosRemoveFromQset
+  STaosQset *qset = atomic_load_ptr(&queue->qset);
 
-  if (queue->tail) {
-    queue->tail->next = pNode;
-    queue->tail = pNode;
-  } else {
-    queue->head = pNode;
-    queue->tail = pNode; 
-  }
+  // counted before it is pushed, so a reader never sees the number go below zero
+  int32_t items = atomic_add_fetch_32(&queue->numOfItems, 1);
 
-  queue->numOfItems++;
-  if (queue->qset) atomic_add_fetch_32(&queue->qset->numOfItems, 1);
-  uTrace("item:%p is put into queue:%p, type:%d items:%d", item, queue, type, queue->numOfItems);
+  while (1) {
+    STaosQnode *top = atomic_load_ptr(&queue->incoming);
+    pNode->next = top;
+    if (atomic_val_compare_exchange_ptr(&queue->incoming, top, pNode) == top) break;
+  }
 
-  pthread_mutex_unlock(&queue->mutex);
+  uTrace("item:%p is put into queue:%p, type:%d items:%d", item, queue, type, items);
 
-  if (queue->qset) tsem_post(&queue->qset->sem);
+  // and after it is pushed, see taosAddIntoQset
+  STaosQset *nset = atomic_load_ptr(&queue->qset);
+  if (nset) qset = nset;
+  if (qset) taosNotifyQset(qset, 1);
 
   return 0;
 }
 
 int taosReadQitem(taos_queue param, int *type, void **pitem) {
   STaosQueue *queue = (STaosQueue *)param;
-  STaosQnode *pNode = NULL;
   int         code = 0;
 
-  pthread_mutex_lock(&queue->mutex);
-
-  if (queue->head) {
-      pNode = queue->head;
-      *pitem = pNode->item;
-      *type = pNode->type;
-      queue->head = pNode->next;
-      if (queue->head == NULL) 
-        queue->tail = NULL;
-      queue->numOfItems--;
-      if (queue->qset) atomic_sub_fetch_32(&queue->qset->numOfItems, 1);
-      code = 1;
-      uDebug("item:%p is read out from queue:%p, type:%d items:%d", *pitem, queue, *type, queue->numOfItems);
-  } 
+  if (atomic_load_32(&queue->numOfItems) <= 0) return 0;
+
+  taosLockQueue(queue);
+  STaosQnode *pNode = taosPopQnode(queue);
+  taosUnlockQueue(queue);
 
-  pthread_mutex_unlock(&queue->mutex);
+  if (pNode) {
+    *pitem = pNode->item;
+    *type = pNode->type;
+    code = 1;
+    uDebug("item:%p is read out from queue:%p, type:%d items:%d", *pitem, queue, *type, queue->numOfItems);
+  }
 
   return code;
 }
@@ -171,35 +312,21 @@ void taosFreeQall(void *param) {
 int taosReadAllQitems(taos_queue param, taos_qall p2) {
   STaosQueue *queue = (STaosQueue *)param;
   STaosQall  *qall = (STaosQall *)p2;
-  int         code = 0;
-  bool        empty;
-
-  pthread_mutex_lock(&queue->mutex);
-
-  empty = queue->head == NULL;
-  if (!empty) {
-    memset(qall, 0, sizeof(STaosQall));
-    qall->current = queue->head;
-    qall->start = queue->head;
-    qall->numOfItems = queue->numOfItems;
-    qall->itemSize = queue->itemSize;
-    code = qall->numOfItems;
-
-    queue->head = NULL;
-    queue->tail = NULL;
-    queue->numOfItems = 0;
-    if (queue->qset) atomic_sub_fetch_32(&queue->qset->numOfItems, qall->numOfItems);
-  }
+  STaosQnode *pNode = NULL;
+  int32_t     num = 0;
 
-  pthread_mutex_unlock(&queue->mutex);
+  if (atomic_load_32(&queue->numOfItems) > 0) {
+    taosLockQueue(queue);
+    num = taosPopAllQnodes(queue, &pNode);
+    taosUnlockQueue(queue);
+  }
 
   // if source queue is empty, we set destination qall to empty too.
-  if (empty) {
-    qall->current = NULL;
-    qall->start = NULL;
-    qall->numOfItems = 0;
-  }
-  return code;
+  qall->current = pNode;
+  qall->start = pNode;
+  qall->numOfItems = num;
+  qall->itemSize = queue->itemSize;
+  return num;
 }
 
 int taosGetQitem(taos_qall param, int *type, void **pitem) {
@@ -234,7 +361,7 @@ taos_qset taosOpenQset() {
     return NULL;
   }
 
-  pthread_mutex_init(&qset->mutex, NULL);
+  pthread_rwlock_init(&qset->lock, NULL);
   tsem_init(&qset->sem, 0, 0);
 
   uTrace("qset:%p is opened", qset);
@@ -246,29 +373,29 @@ void taosCloseQset(taos_qset param) {
   STaosQset *qset = (STaosQset *)param;
 
   // remove all the queues from qset
-  pthread_mutex_lock(&qset->mutex);
+  pthread_rwlock_wrlock(&qset->lock);
   while (qset->head) {
     STaosQueue *queue = qset->head;
     qset->head = qset->head->next;
 
-    queue->qset = NULL;
+    atomic_store_ptr(&queue->qset, NULL);
     queue->next = NULL;
   }
-  pthread_mutex_unlock(&qset->mutex);
+  pthread_rwlock_unlock(&qset->lock);
 
-  pthread_mutex_destroy(&qset->mutex);
+  pthread_rwlock_destroy(&qset->lock);
   uTrace("qset:%p is closed", qset);
   tsem_destroy(&qset->sem);
   free(qset);
 }
 
-// tsem_post 'qset->sem', so that reader threads waiting for it
-// resumes execution and return, should only be used to signal the
-// thread to exit.
+// wake up a reader thread waiting on the qset, it resumes execution and returns with no item,
+// should only be used to signal the thread to exit.
 void taosQsetThreadResume(taos_qset param) {
   STaosQset *qset = (STaosQset *)param;
   uDebug("qset:%p, it will exit", qset);
-  tsem_post(&qset->sem);
+  atomic_add_fetch_32(&qset->resumes, 1);
+  taosNotifyQset(qset, 1);
 }
 
 int taosAddIntoQset(taos_qset p1, taos_queue p2, void *ahandle) {
@@ -277,19 +404,21 @@ int taosAddIntoQset(taos_qset p1, taos_queue p2, void *ahandle) {
 
   if (queue->qset) return -1; 
 
-  pthread_mutex_lock(&qset->mutex);
+  pthread_rwlock_wrlock(&qset->lock);
 
   queue->next = qset->head;
   queue->ahandle = ahandle;
   qset->head = queue;
   qset->numOfQueues++;
 
-  pthread_mutex_lock(&queue->mutex);
-  atomic_add_fetch_32(&qset->numOfItems, queue->numOfItems);
-  queue->qset = qset;
-  pthread_mutex_unlock(&queue->mutex);
+  atomic_store_ptr(&queue->qset, qset);
+
+  // counted after the qset is set, a writer which counts its item before has pushed it before it looks the qset up
+  // the second time, the item is counted here and by the writer at worst
+  int32_t items = atomic_load_32(&queue->numOfItems);
+  if (items > 0) taosNotifyQset(qset, items);
 
-  pthread_mutex_unlock(&qset->mutex);
+  pthread_rwlock_unlock(&qset->lock);
 
   uTrace("queue:%p is added into qset:%p", queue, qset);
   return 0;
@@ -301,7 +430,7 @@ void taosRemoveFromQset(taos_qset p1, taos_queue p2) {
  
   STaosQueue *tqueue = NULL;
 
-  pthread_mutex_lock(&qset->mutex);
+  pthread_rwlock_wrlock(&qset->lock);
 
   if (qset->head) {
     if (qset->head == queue) {
@@ -326,15 +455,16 @@ void taosRemoveFromQset(taos_qset p1, taos_queue p2) {
       if (qset->current == queue) qset->current = tqueue->next;
       qset->numOfQueues--;
 
-      pthread_mutex_lock(&queue->mutex);
-      atomic_sub_fetch_32(&qset->numOfItems, queue->numOfItems);
-      queue->qset = NULL;
+      // the items left are not for the readers of the qset any more. They are counted before the qset is unset, a
+      // writer which counts its item before has looked the qset up before too, so it notifies the items taken off
+      int32_t items = atomic_load_32(&queue->numOfItems);
+      atomic_store_ptr(&queue->qset, NULL);
       queue->next = NULL;
-      pthread_mutex_unlock(&queue->mutex);
+      if (items > 0) atomic_sub_fetch_32(&qset->avail, items);
     }
   } 
   
-  pthread_mutex_unlock(&qset->mutex);
+  pthread_rwlock_unlock(&qset->lock);
 
   uTrace("queue:%p is removed from qset:%p", queue, qset);
 }
@@ -343,88 +473,104 @@ int taosGetQueueNumber(taos_qset param) {
   return ((STaosQset *)param)->numOfQueues;
 }
 
+// pick the queues round robin, the qset shall be read locked by the caller. Each reader only moves the shared
+// start point once and walks the whole list by itself, so it visits every queue even if other readers move it too.
+// In the first pass, the queues owned by other readers are skipped, in the second pass, the reader waits for them,
+// since the item it was notified of may be there
+static STaosQueue *taosLockNextQueue(STaosQset *qset, int32_t pass) {
+  STaosQueue *queue = atomic_load_ptr(&qset->current);
+  if (queue == NULL) queue = qset->head;
+  if (queue == NULL) return NULL;
+  atomic_store_ptr(&qset->current, queue->next);
+
+  for (int32_t i = 0; i < qset->numOfQueues; ++i, queue = (queue->next != NULL) ? queue->next : qset->head) {
+    if (atomic_load_32(&queue->numOfItems) <= 0) continue;
+
+    if (pass == 0) {
+      if (!taosTryLockQueue(queue)) continue;
+    } else {
+      taosLockQueue(queue);
+    }
+
+    if (queue->head != NULL || atomic_load_ptr(&queue->incoming) != NULL) return queue;
+    taosUnlockQueue(queue);
+  }
+
+  return NULL;
+}
+
 int taosReadQitemFromQset(taos_qset param, int *type, void **pitem, void **phandle) {
   STaosQset  *qset = (STaosQset *)param;
   STaosQnode *pNode = NULL;
   int         code = 0;
-   
-  tsem_wait(&qset->sem);
 
-  pthread_mutex_lock(&qset->mutex);
+  while (code == 0) {
+    taosWaitQset(qset);
+    int32_t seq = atomic_load_32(&qset->seq);
+
+    pthread_rwlock_rdlock(&qset->lock);
 
-  for(int i=0; i<qset->numOfQueues; ++i) {
-    if (qset->current == NULL) 
-      qset->current = qset->head;   
-    STaosQueue *queue = qset->current;
-    if (queue) qset->current = queue->next;
-    if (queue == NULL) break;
-    if (queue->head == NULL) continue;
+    for (int32_t pass = 0; pass < 2 && pNode == NULL; ++pass) {
+      STaosQueue *queue = taosLockNextQueue(qset, pass);
+      if (queue == NULL) continue;
 
-    pthread_mutex_lock(&queue->mutex);
+      pNode = taosPopQnode(queue);
+      taosUnlockQueue(queue);
 
-    if (queue->head) {
-        pNode = queue->head;
+      if (pNode) {
         *pitem = pNode->item;
         if (type) *type = pNode->type;
         if (phandle) *phandle = queue->ahandle;
-        queue->head = pNode->next;
-        if (queue->head == NULL) 
-          queue->tail = NULL;
-        queue->numOfItems--;
-        atomic_sub_fetch_32(&qset->numOfItems, 1);
         code = 1;
         uTrace("item:%p is read out from queue:%p, type:%d items:%d", *pitem, queue, pNode->type, queue->numOfItems);
-    } 
+      }
+    }
 
-    pthread_mutex_unlock(&queue->mutex);
-    if (pNode) break;
-  }
+    pthread_rwlock_unlock(&qset->lock);
 
-  pthread_mutex_unlock(&qset->mutex);
+    if (code == 0 && taosQsetReadNothing(qset, seq)) break;
+  }
 
   return code; 
 }
 
 int taosReadAllQitemsFromQset(taos_qset param, taos_qall p2, void **phandle) {
   STaosQset  *qset = (STaosQset *)param;
-  STaosQueue *queue;
   STaosQall  *qall = (STaosQall *)p2;
+  STaosQnode *pNode = NULL;
   int         code = 0;
 
-  tsem_wait(&qset->sem);
-  pthread_mutex_lock(&qset->mutex);
-
-  for(int i=0; i<qset->numOfQueues; ++i) {
-    if (qset->current == NULL) 
-      qset->current = qset->head;   
-    queue = qset->current;
-    if (queue) qset->current = queue->next;
-    if (queue == NULL) break;
-    if (queue->head == NULL) continue;
-
-    pthread_mutex_lock(&queue->mutex);
-
-    if (queue->head) {
-      qall->current = queue->head;
-      qall->start = queue->head;
-      qall->numOfItems = queue->numOfItems;
-      qall->itemSize = queue->itemSize;
-      code = qall->numOfItems;
-      *phandle = queue->ahandle;
-          
-      queue->head = NULL;
-      queue->tail = NULL;
-      queue->numOfItems = 0;
-      atomic_sub_fetch_32(&qset->numOfItems, qall->numOfItems);
-      for (int j=1; j<qall->numOfItems; ++j) tsem_wait(&qset->sem);
-    } 
-
-    pthread_mutex_unlock(&queue->mutex);
-
-    if (code != 0) break;  
+  while (code == 0) {
+    taosWaitQset(qset);
+    int32_t seq = atomic_load_32(&qset->seq);
+
+    pthread_rwlock_rdlock(&qset->lock);
+
+    for (int32_t pass = 0; pass < 2 && code == 0; ++pass) {
+      STaosQueue *queue = taosLockNextQueue(qset, pass);
+      if (queue == NULL) continue;
+
+      code = taosPopAllQnodes(queue, &pNode);
+      taosUnlockQueue(queue);
+
+      if (code > 0) {
+        qall->current = pNode;
+        qall->start = pNode;
+        qall->numOfItems = code;
+        qall->itemSize = queue->itemSize;
+        *phandle = queue->ahandle;
+
+        // one was taken by the wait above, the rest are taken here, the writers of the items may not have added
+        // them yet, then 'avail' stays negative until they do
+        if (code > 1) atomic_sub_fetch_32(&qset->avail, code - 1);
+      }
+    }
+
+    pthread_rwlock_unlock(&qset->lock);
+
+    if (code == 0 && taosQsetReadNothing(qset, seq)) break;
   }
 
-  pthread_mutex_unlock(&qset->mutex);
   return code;
 }
 
@@ -432,20 +578,19 @@ int taosGetQueueItemsNumber(taos_queue param) {
   STaosQueue *queue = (STaosQueue *)param;
   if (!queue) return 0;
 
-  int num;
-  pthread_mutex_lock(&queue->mutex);
-  num = queue->numOfItems;
-  pthread_mutex_unlock(&queue->mutex);
-  return num;
+  return atomic_load_32(&queue->numOfItems);
 }
 
 int taosGetQsetItemsNumber(taos_qset param) {
   STaosQset *qset = (STaosQset *)param;
   if (!qset) return 0;
 
+  // summed up on demand, so the writers do not contend on a counter of the qset
   int num = 0;
-  pthread_mutex_lock(&qset->mutex);
-  num = qset->numOfItems;
-  pthread_mutex_unlock(&qset->mutex);
+  pthread_rwlock_rdlock(&qset->lock);
+  for (STaosQueue *queue = qset->head; queue != NULL; queue = queue->next) {
+    num += atomic_load_32(&queue->numOfItems);
+  }
+  pthread_rwlock_unlock(&qset->lock);
   return num;
 }
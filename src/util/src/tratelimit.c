@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tratelimit.h"
+
+struct SRateLimiter {
+  pthread_mutex_t mutex;
+  int64_t         rate;
+  int64_t         tokens;  // negative when the bucket is in debt
+  int64_t         lastUs;
+};
+
+SRateLimiter *taosOpenRateLimiter(int64_t rate) {
+  SRateLimiter *pLimiter = calloc(1, sizeof(SRateLimiter));
+  if (pLimiter == NULL) return NULL;
+
+  pthread_mutex_init(&pLimiter->mutex, NULL);
+  pLimiter->rate = MAX(rate, 0);
+  pLimiter->tokens = pLimiter->rate;
+  pLimiter->lastUs = taosGetTimestampUs();
+  return pLimiter;
+}
+
+void taosCloseRateLimiter(SRateLimiter *pLimiter) {
+  if (pLimiter == NULL) return;
+  pthread_mutex_destroy(&pLimiter->mutex);
+  free(pLimiter);
+}
+
+void taosSetRateLimit(SRateLimiter *pLimiter, int64_t rate) {
+  if (pLimiter == NULL) return;
+
+  pthread_mutex_lock(&pLimiter->mutex);
+  pLimiter->rate = MAX(rate, 0);
+  pLimiter->tokens = MIN(pLimiter->tokens, pLimiter->rate);
+  pthread_mutex_unlock(&pLimiter->mutex);
+}
+
+void taosRateLimit(SRateLimiter *pLimiter, int64_t bytes) {
+  if (pLimiter == NULL || bytes <= 0) return;
+
+  int64_t waitUs = 0;
+
+  pthread_mutex_lock(&pLimiter->mutex);
+  if (pLimiter->rate > 0) {
+    // the balance is capped at one second of tokens, not the time, so that the debt of a request larger than the
+    // bucket is paid back by the time it is waited for
+    int64_t now = taosGetTimestampUs();
+    int64_t elapsed = now - pLimiter->lastUs;
+    int64_t fullUs = (pLimiter->rate - pLimiter->tokens) * 1000000 / pLimiter->rate;
+    int64_t refill = (elapsed >= fullUs) ? (pLimiter->rate - pLimiter->tokens) : elapsed * pLimiter->rate / 1000000;
+    if (refill > 0) {
+      pLimiter->tokens = MIN(pLimiter->tokens + refill, pLimiter->rate);
+      pLimiter->lastUs = now;
+    }
+
+    pLimiter->tokens -= bytes;
+    if (pLimiter->tokens < 0) waitUs = -pLimiter->tokens * 1000000 / pLimiter->rate;
+  }
+  pthread_mutex_unlock(&pLimiter->mutex);
+
+  if (waitUs > 0) taosMsleep((int32_t)((waitUs + 999) / 1000));
+}
@@ -0,0 +1,7 @@
+char version[12] = "2.7.0.0";
+char compatible_version[12] = "2.0.0.0";
+char gitinfo[48] = "9cd717fa6a8bb20eae1b17f5bdfad8d7f53c0eb7";
+char gitinfoOfInternal[48] = "9cd717fa6a8bb20eae1b17f5bdfad8d7f53c0eb7";
+char buildinfo[64] = "Built at 2026-10-19 06:43:31";
+
+void libtaos_2_7_0_0_Linux_x32_stable() {};
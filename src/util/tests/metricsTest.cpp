@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "tmetrics.h"
+
+namespace {
+
+const int32_t numOfThreads = 4;
+const int32_t numOfAdds = 100000;
+
+void *addCounter(void *param) {
+  SMetric *pCounter = (SMetric *)param;
+  for (int32_t i = 0; i < numOfAdds; ++i) {
+    taosMetricAdd(pCounter, 1);
+  }
+  return NULL;
+}
+
+}  // namespace
+
+TEST(testCase, metrics_register_test) {
+  SMetric *pCounter = taosMetricCounter("test_register_total", "test counter");
+  ASSERT_TRUE(pCounter != NULL);
+  EXPECT_EQ(taosMetricCounter("test_register_total", "test counter"), pCounter);
+
+  // the same name can not be used by a metric of another type
+  EXPECT_TRUE(taosMetricGauge("test_register_total", "test gauge") == NULL);
+}
+
+TEST(testCase, metrics_counter_test) {
+  SMetric *pCounter = taosMetricCounter("test_counter_total", "test counter");
+
+  pthread_t threads[numOfThreads];
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    pthread_create(&threads[i], NULL, addCounter, pCounter);
+  }
+  for (int32_t i = 0; i < numOfThreads; ++i) {
+    pthread_join(threads[i], NULL);
+  }
+
+  EXPECT_EQ(taosMetricValue(pCounter), (int64_t)numOfThreads * numOfAdds);
+}
+
+TEST(testCase, metrics_gauge_test) {
+  SMetric *pGauge = taosMetricGauge("test_gauge", "test gauge");
+
+  taosMetricSet(pGauge, 10);
+  taosMetricAdd(pGauge, 5);
+  taosMetricAdd(pGauge, -3);
+  EXPECT_EQ(taosMetricValue(pGauge), 12);
+}
+
+TEST(testCase, metrics_histogram_test) {
+  SMetric *pHisto = taosMetricHistogram("test_latency_us", "test histogram");
+
+  for (int64_t i = 1; i <= 10000; ++i) {
+    taosMetricObserve(pHisto, i);
+  }
+
+  SMetricSnapshot snap;
+  taosMetricGetSnapshot(pHisto, &snap);
+  EXPECT_EQ(snap.value, 10000);
+  EXPECT_EQ(snap.sum, 10000 * 10001 / 2);
+  EXPECT_EQ(snap.max, 10000);
+
+  // the buckets guarantee a relative error below 1/8
+  EXPECT_GE(snap.p50, 5000);
+  EXPECT_LE(snap.p50, 5000 * 9 / 8);
+  EXPECT_GE(snap.p99, 9900);
+  EXPECT_LE(snap.p99, 10000);
+  EXPECT_LE(snap.p90, snap.p99);
+  EXPECT_LE(snap.p99, snap.p999);
+
+  // small values are exact
+  SMetric *pSmall = taosMetricHistogram("test_small_us", "test histogram");
+  taosMetricObserve(pSmall, 3);
+  taosMetricGetSnapshot(pSmall, &snap);
+  EXPECT_EQ(snap.p50, 3);
+  EXPECT_EQ(snap.p999, 3);
+}
+
+TEST(testCase, metrics_prometheus_test) {
+  SMetric *pCounter = taosMetricCounter("test_prometheus_total", "test prometheus");
+  taosMetricAdd(pCounter, 42);
+
+  int32_t size = taosMetricsNum() * TSDB_METRIC_TEXT_LEN + 1;
+  char   *buf = (char *)malloc(size);
+  int32_t len = taosMetricsToPrometheus(buf, size);
+
+  EXPECT_EQ(len, (int32_t)strlen(buf));
+  EXPECT_TRUE(strstr(buf, "# TYPE test_prometheus_total counter\ntest_prometheus_total 42\n") != NULL);
+  EXPECT_TRUE(strstr(buf, "# TYPE test_latency_us summary\n") != NULL);
+  EXPECT_TRUE(strstr(buf, "test_latency_us_count 10000\n") != NULL);
+
+  // the text is cut when the buffer is not large enough
+  len = taosMetricsToPrometheus(buf, 16);
+  EXPECT_EQ(len, 15);
+
+  free(buf);
+}
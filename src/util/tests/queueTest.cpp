@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <sys/time.h>
+#include <time.h>
+
+#include "os.h"
+#include "tqueue.h"
+
+namespace {
+
+const int32_t numOfQueues = 4;
+const int32_t numOfWriters = 8;
+const int32_t numOfReaders = 4;
+const int32_t numOfItemsPerWriter = 100000;
+
+typedef struct {
+  taos_queue queue;
+  int32_t    writerId;
+} SWriterParam;
+
+typedef struct {
+  taos_qset qset;
+  bool      readAll;
+  int64_t   numOfItems;
+  int64_t   sum;
+  int8_t    exited;
+  int64_t   cpuUs;  // the CPU time of the reader thread when it exits
+} SReaderParam;
+
+int64_t getTimeUs() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return (int64_t)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+void *writeItems(void *param) {
+  SWriterParam *pParam = (SWriterParam *)param;
+  for (int32_t i = 0; i < numOfItemsPerWriter; ++i) {
+    int64_t *pItem = (int64_t *)taosAllocateQitem(sizeof(int64_t));
+    *pItem = (int64_t)pParam->writerId * numOfItemsPerWriter + i;
+    taosWriteQitem(pParam->queue, pParam->writerId, pItem);
+  }
+  return NULL;
+}
+
+void *readItems(void *param) {
+  SReaderParam *pParam = (SReaderParam *)param;
+  taos_qall     qall = taosAllocateQall();
+  int32_t       type;
+  void *        pItem;
+  void *        ahandle;
+
+  while (1) {
+    if (pParam->readAll) {
+      int32_t num = taosReadAllQitemsFromQset(pParam->qset, qall, &ahandle);
+      if (num == 0) break;
+      for (int32_t i = 0; i < num; ++i) {
+        taosGetQitem(qall, &type, &pItem);
+        pParam->sum += *(int64_t *)pItem;
+        pParam->numOfItems++;
+        taosFreeQitem(pItem);
+      }
+    } else {
+      if (taosReadQitemFromQset(pParam->qset, &type, &pItem, &ahandle) == 0) break;
+      pParam->sum += *(int64_t *)pItem;
+      pParam->numOfItems++;
+      taosFreeQitem(pItem);
+    }
+  }
+
+  taosFreeQall(qall);
+
+  struct timespec ts;
+  clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+  pParam->cpuUs = (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+  atomic_store_8(&pParam->exited, 1);
+  return NULL;
+}
+
+// writers put items into the queues of a qset while readers drain it, every item shall be read exactly once
+void runQsetContention(int32_t readers, bool readAll) {
+  taos_qset  qset = taosOpenQset();
+  taos_queue queues[numOfQueues];
+  for (int32_t i = 0; i < numOfQueues; ++i) {
+    queues[i] = taosOpenQueue();
+    taosAddIntoQset(qset, queues[i], NULL);
+  }
+
+  pthread_t    writerThreads[numOfWriters];
+  pthread_t    readerThreads[numOfReaders];
+  SWriterParam writers[numOfWriters];
+  SReaderParam readerParams[numOfReaders];
+
+  int64_t start = getTimeUs();
+  for (int32_t i = 0; i < readers; ++i) {
+    readerParams[i] = {qset, readAll, 0, 0, 0, 0};
+    pthread_create(&readerThreads[i], NULL, readItems, &readerParams[i]);
+  }
+  for (int32_t i = 0; i < numOfWriters; ++i) {
+    writers[i] = {queues[i % numOfQueues], i};
+    pthread_create(&writerThreads[i], NULL, writeItems, &writers[i]);
+  }
+  for (int32_t i = 0; i < numOfWriters; ++i) {
+    pthread_join(writerThreads[i], NULL);
+  }
+
+  int64_t total = (int64_t)numOfWriters * numOfItemsPerWriter;
+  while (1) {
+    int64_t read = 0;
+    for (int32_t i = 0; i < readers; ++i) read += atomic_load_64(&readerParams[i].numOfItems);
+    if (read >= total) break;
+    taosMsleep(1);
+  }
+  int64_t elapsed = getTimeUs() - start;
+
+  // a reader only returns without an item when it is told to exit
+  for (int32_t i = 0; i < readers; ++i) EXPECT_EQ(atomic_load_8(&readerParams[i].exited), 0);
+
+  for (int32_t i = 0; i < readers; ++i) taosQsetThreadResume(qset);
+  for (int32_t i = 0; i < readers; ++i) pthread_join(readerThreads[i], NULL);
+
+  int64_t numOfItems = 0;
+  int64_t sum = 0;
+  for (int32_t i = 0; i < readers; ++i) {
+    numOfItems += readerParams[i].numOfItems;
+    sum += readerParams[i].sum;
+  }
+
+  EXPECT_EQ(numOfItems, total);
+  EXPECT_EQ(sum, total * (total - 1) / 2);
+  EXPECT_EQ(taosGetQsetItemsNumber(qset), 0);
+
+  printf("writers:%d readers:%d readAll:%d, %" PRId64 " items in %" PRId64 " us, %.2f Mops/s\n", numOfWriters,
+         readers, readAll, total, elapsed, (double)total / (elapsed > 0 ? elapsed : 1));
+
+  for (int32_t i = 0; i < numOfQueues; ++i) {
+    taosCloseQueue(queues[i]);
+  }
+  taosCloseQset(qset);
+}
+
+int64_t writeItem(taos_queue queue, int64_t v) {
+  int64_t *pItem = (int64_t *)taosAllocateQitem(sizeof(int64_t));
+  *pItem = v;
+  taosWriteQitem(queue, 0, pItem);
+  return v;
+}
+
+// a queue closed with items still in it takes them off the qset, so that the reader parks instead of looking for them
+// again and again, and the items of a queue written before it joins a qset are read from the qset
+void runQsetClose(bool readAll) {
+  taos_qset  qset = taosOpenQset();
+  taos_queue closed = taosOpenQueue();
+  taos_queue queue = taosOpenQueue();
+
+  taosAddIntoQset(qset, closed, NULL);
+  for (int32_t i = 0; i < 10; ++i) writeItem(closed, 100 + i);
+  taosCloseQueue(closed);
+
+  int64_t sum = writeItem(queue, 1) + writeItem(queue, 2);
+  EXPECT_EQ(taosGetQsetItemsNumber(qset), 0);
+
+  SReaderParam param = {qset, readAll, 0, 0, 0, 0};
+  pthread_t    thread;
+  pthread_create(&thread, NULL, readItems, &param);
+  taosMsleep(300);
+  EXPECT_EQ(atomic_load_64(&param.numOfItems), 0);
+
+  taosAddIntoQset(qset, queue, NULL);
+  sum += writeItem(queue, 3);
+  while (atomic_load_64(&param.numOfItems) < 3) taosMsleep(1);
+  taosMsleep(300);
+
+  taosQsetThreadResume(qset);
+  pthread_join(thread, NULL);
+
+  EXPECT_EQ(param.numOfItems, 3);
+  EXPECT_EQ(param.sum, sum);
+  EXPECT_LT(param.cpuUs, 100000) << "readAll:" << readAll;
+
+  taosCloseQueue(queue);
+  taosCloseQset(qset);
+}
+
+}  // namespace
+
+TEST(testCase, queue_read_test) {
+  taos_queue queue = taosOpenQueue();
+  taos_qall  qall = taosAllocateQall();
+  int32_t    type;
+  void *     pItem;
+
+  EXPECT_EQ(taosReadQitem(queue, &type, &pItem), 0);
+
+  for (int32_t i = 0; i < 10; ++i) {
+    int32_t *p = (int32_t *)taosAllocateQitem(sizeof(int32_t));
+    *p = i;
+    taosWriteQitem(queue, i, p);
+  }
+  EXPECT_EQ(taosGetQueueItemsNumber(queue), 10);
+
+  // the items are read in the order they are written
+  ASSERT_EQ(taosReadQitem(queue, &type, &pItem), 1);
+  EXPECT_EQ(type, 0);
+  EXPECT_EQ(*(int32_t *)pItem, 0);
+  taosFreeQitem(pItem);
+
+  ASSERT_EQ(taosReadAllQitems(queue, qall), 9);
+  for (int32_t i = 1; i < 10; ++i) {
+    ASSERT_EQ(taosGetQitem(qall, &type, &pItem), 1);
+    EXPECT_EQ(*(int32_t *)pItem, i);
+    taosFreeQitem(pItem);
+  }
+  EXPECT_EQ(taosGetQitem(qall, &type, &pItem), 0);
+  EXPECT_EQ(taosGetQueueItemsNumber(queue), 0);
+  EXPECT_EQ(taosReadAllQitems(queue, qall), 0);
+
+  taosFreeQall(qall);
+  taosCloseQueue(queue);
+}
+
+TEST(testCase, qset_contention_test) {
+  runQsetContention(1, false);
+  runQsetContention(numOfReaders, false);
+}
+
+TEST(testCase, qset_batch_contention_test) {
+  runQsetContention(1, true);
+  runQsetContention(numOfReaders, true);
+}
+
+TEST(testCase, qset_close_queue_test) {
+  runQsetClose(false);
+  runQsetClose(true);
+}
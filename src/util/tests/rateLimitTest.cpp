@@ -0,0 +1,46 @@
+#include <gtest/gtest.h>
+
+#include "os.h"
+#include "tratelimit.h"
+
+TEST(testCase, rate_limit_test) {
+  const int64_t rate = 10 * 1024 * 1024;
+  SRateLimiter *pLimiter = taosOpenRateLimiter(rate);
+  ASSERT_TRUE(pLimiter != NULL);
+
+  // the first second is in the bucket, the next half second has to be waited for
+  int64_t st = taosGetTimestampUs();
+  for (int32_t i = 0; i < 30; ++i) {
+    taosRateLimit(pLimiter, rate / 20);
+  }
+  int64_t elapsed = taosGetTimestampUs() - st;
+  EXPECT_GE(elapsed, 400000);
+  EXPECT_LE(elapsed, 1500000);
+
+  // no limit
+  taosSetRateLimit(pLimiter, 0);
+  st = taosGetTimestampUs();
+  taosRateLimit(pLimiter, rate * 100);
+  EXPECT_LE(taosGetTimestampUs() - st, 100000);
+
+  taosCloseRateLimiter(pLimiter);
+}
+
+TEST(testCase, rate_limit_large_request_test) {
+  const int64_t rate = 1024 * 1024;
+  SRateLimiter *pLimiter = taosOpenRateLimiter(rate);
+  ASSERT_TRUE(pLimiter != NULL);
+
+  // a request of 1.5 seconds of tokens waits for the half second the bucket lacks, and each next one for its own 1.5
+  // seconds, the debt does not grow from one request to the next
+  int64_t expectUs[] = {500000, 1500000, 1500000};
+  for (int32_t i = 0; i < 3; ++i) {
+    int64_t st = taosGetTimestampUs();
+    taosRateLimit(pLimiter, rate * 3 / 2);
+    int64_t elapsed = taosGetTimestampUs() - st;
+    EXPECT_GE(elapsed, expectUs[i] - 50000) << "request " << i;
+    EXPECT_LE(elapsed, expectUs[i] + 250000) << "request " << i;
+  }
+
+  taosCloseRateLimiter(pLimiter);
+}
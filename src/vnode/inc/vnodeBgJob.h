@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TDENGINE_VNODE_BG_JOB_H
+#define TDENGINE_VNODE_BG_JOB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+#include "vnodeInt.h"
+
+// A background job of the dnode, a thread which runs fp on the vnodes one after another every interval seconds
+typedef struct SVBgJob {
+  const char     *name;
+  int32_t         interval;
+  void          (*fp)(struct SVBgJob *pJob, int32_t vgId);
+  pthread_t       thread;
+  bool            stop;
+  pthread_mutex_t mutex;
+  pthread_cond_t  cond;
+} SVBgJob;
+
+int32_t vnodeStartBgJob(SVBgJob *pJob);
+void    vnodeStopBgJob(SVBgJob *pJob);
+bool    vnodeBgJobSleep(SVBgJob *pJob, int32_t ms);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
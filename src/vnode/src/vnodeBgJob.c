@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "vnodeMgmt.h"
+#include "vnodeBgJob.h"
+
+// return false if the job is stopped while sleeping
+bool vnodeBgJobSleep(SVBgJob *pJob, int32_t ms) {
+  pthread_mutex_lock(&pJob->mutex);
+  if (!pJob->stop) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+      ts.tv_sec++;
+      ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&pJob->cond, &pJob->mutex, &ts);
+  }
+  bool stop = pJob->stop;
+  pthread_mutex_unlock(&pJob->mutex);
+  return !stop;
+}
+
+static void *vnodeBgJobFunc(void *param) {
+  SVBgJob *pJob = param;
+  setThreadName(pJob->name);
+
+  while (vnodeBgJobSleep(pJob, pJob->interval * 1000)) {
+    int32_t vnodeList[TSDB_MAX_VNODES] = {0};
+    int32_t numOfVnodes = 0;
+    vnodeGetVnodeList(vnodeList, &numOfVnodes);
+
+    vTrace("%s starts on %d vnodes", pJob->name, numOfVnodes);
+    for (int32_t i = 0; i < numOfVnodes && !pJob->stop; ++i) {
+      (*pJob->fp)(pJob, vnodeList[i]);
+    }
+  }
+
+  return NULL;
+}
+
+// the thread is only launched if the interval is positive, the job can be stopped either way
+int32_t vnodeStartBgJob(SVBgJob *pJob) {
+  pJob->stop = false;
+  pthread_mutex_init(&pJob->mutex, NULL);
+  pthread_cond_init(&pJob->cond, NULL);
+
+  if (pJob->interval <= 0) return 0;
+
+  pthread_attr_t thAttr;
+  pthread_attr_init(&thAttr);
+  pthread_attr_setdetachstate(&thAttr, PTHREAD_CREATE_JOINABLE);
+
+  int32_t code = pthread_create(&pJob->thread, &thAttr, vnodeBgJobFunc, pJob);
+  if (code != 0) {
+    vError("failed to create thread of %s, reason:%s", pJob->name, strerror(code));
+  }
+
+  pthread_attr_destroy(&thAttr);
+  return 0;
+}
+
+void vnodeStopBgJob(SVBgJob *pJob) {
+  pthread_mutex_lock(&pJob->mutex);
+  pJob->stop = true;
+  pthread_cond_broadcast(&pJob->cond);
+  pthread_mutex_unlock(&pJob->mutex);
+
+  if (taosCheckPthreadValid(pJob->thread)) {
+    pthread_join(pJob->thread, NULL);
+  }
+
+  pthread_cond_destroy(&pJob->cond);
+  pthread_mutex_destroy(&pJob->mutex);
+}
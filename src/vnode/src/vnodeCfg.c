@@ -36,6 +36,7 @@ static void vnodeLoadCfg(SVnodeObj *pVnode, SCreateVnodeMsg* vnodeMsg) {
   pVnode->tsdbCfg.compression = vnodeMsg->cfg.compression;
   pVnode->tsdbCfg.update = vnodeMsg->cfg.update;
   pVnode->tsdbCfg.cacheLastRow = vnodeMsg->cfg.cacheLastRow;
+  pVnode->tsdbCfg.rollup = vnodeMsg->cfg.rollup;
   pVnode->walCfg.walLevel = vnodeMsg->cfg.walLevel;
   pVnode->walCfg.fsyncPeriod = vnodeMsg->cfg.fsyncPeriod;
   pVnode->walCfg.keep = TAOS_WAL_NOT_KEEP;
@@ -255,6 +256,14 @@ int32_t vnodeReadCfg(SVnodeObj *pVnode) {
     vnodeMsg.cfg.dbType = (int8_t)dbType->valueint;
   }
 
+  // written since the rollup option, none before
+  cJSON *rollup = cJSON_GetObjectItem(root, "rollup");
+  if (!rollup || rollup->type != cJSON_Number) {
+    vnodeMsg.cfg.rollup = 0;
+  } else {
+    vnodeMsg.cfg.rollup = (int8_t)rollup->valueint;
+  }
+
   cJSON *nodeInfos = cJSON_GetObjectItem(root, "nodeInfos");
   if (!nodeInfos || nodeInfos->type != cJSON_Array) {
     vError("vgId:%d, failed to read %s, nodeInfos not found", pVnode->vgId, file);
@@ -347,6 +356,7 @@ int32_t vnodeWriteCfg(SCreateVnodeMsg *pMsg) {
   len += snprintf(content + len, maxLen - len, "  \"update\": %d,\n", pMsg->cfg.update);
   len += snprintf(content + len, maxLen - len, "  \"cacheLastRow\": %d,\n", pMsg->cfg.cacheLastRow);
   len += snprintf(content + len, maxLen - len, "  \"dbType\": %d,\n", pMsg->cfg.dbType);
+  len += snprintf(content + len, maxLen - len, "  \"rollup\": %d,\n", pMsg->cfg.rollup);
   len += snprintf(content + len, maxLen - len, "  \"nodeInfos\": [{\n");
   for (int32_t i = 0; i < pMsg->cfg.vgReplica; i++) {
     SVnodeDesc *node = &pMsg->nodes[i];
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tglobal.h"
+#include "vnodeStatus.h"
+#include "vnodeMgmt.h"
+#include "vnodeBgJob.h"
+#include "vnodeCompact.h"
+
+// Background compaction, the file sets of the vnodes are scored by fragmentation every compactInterval seconds and
+// the worst ones are compacted one at a time in the dnode, when no commit is queued
+
+static void vnodeAutoCompact(SVBgJob *pJob, int32_t vgId);
+
+static SVBgJob tsVCompact = {.name = "vnodeCompact", .fp = vnodeAutoCompact};
+
+// 1 if a compaction is scheduled, 0 if not, -1 if the vnode is gone
+static int32_t vnodeStartAutoCompact(int32_t vgId) {
+  SVnodeObj *pVnode = vnodeAcquireNotClose(vgId);
+  if (pVnode == NULL) return -1;
+
+  int32_t code = 0;
+  if (pVnode->tsdb != NULL && vnodeInReadyStatus(pVnode)) {
+    code = tsdbAutoCompact(pVnode->tsdb);
+  }
+
+  vnodeRelease(pVnode);
+  return code;
+}
+
+// 1 if the compaction is over and file sets are left to compact, 0 if it is over, -1 if the vnode is gone
+static int32_t vnodeCheckAutoCompact(int32_t vgId) {
+  SVnodeObj *pVnode = vnodeAcquireNotClose(vgId);
+  if (pVnode == NULL || pVnode->tsdb == NULL) {
+    if (pVnode != NULL) vnodeRelease(pVnode);
+    return -1;
+  }
+
+  int32_t code = 2;
+  if (tsdbGetCompactState(pVnode->tsdb) == 0) {
+    code = (tsdbGetCompactCandidates(pVnode->tsdb) > 0) ? 1 : 0;
+  }
+
+  vnodeRelease(pVnode);
+  return code;
+}
+
+static void vnodeAutoCompact(SVBgJob *pJob, int32_t vgId) {
+  while (1) {
+    // commits go first, a compaction holds the commits of its vnode until it is over, and yields to the ones which
+    // queue up meanwhile, then the vnode is not started again before it backed off
+    while (!tsdbCommitQueueIdle()) {
+      if (!vnodeBgJobSleep(pJob, 1000)) return;
+    }
+
+    if (vnodeStartAutoCompact(vgId) <= 0) return;
+
+    int32_t code = 2;
+    while (code == 2) {
+      if (!vnodeBgJobSleep(pJob, 200)) return;
+      code = vnodeCheckAutoCompact(vgId);
+    }
+
+    if (code <= 0) return;
+    vDebug("vgId:%d, more file sets to compact in background", vgId);
+  }
+}
+
+int32_t vnodeInitCompact() {
+  tsVCompact.interval = tsCompactInterval;
+  vnodeStartBgJob(&tsVCompact);
+
+  if (tsCompactInterval <= 0) {
+    vInfo("background compaction is disabled");
+  } else {
+    vDebug("background compaction is launched, interval:%ds rate:%dMB/s", tsCompactInterval, tsCompactRateLimit);
+  }
+  return 0;
+}
+
+void vnodeCleanupCompact() {
+  vnodeStopBgJob(&tsVCompact);
+  vDebug("background compaction is closed");
+}
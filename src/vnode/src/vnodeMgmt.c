@@ -18,6 +18,8 @@
 #include "dnode.h"
 #include "vnodeStatus.h"
 #include "vnodeBackup.h"
+#include "vnodeCompact.h"
+#include "vnodeMigrate.h"
 #include "vnodeWorker.h"
 #include "vnodeRead.h"
 #include "vnodeWrite.h"
@@ -35,7 +37,9 @@ static SStep tsVnodeSteps[] = {
   {"vnode-write",  vnodeInitWrite,      vnodeCleanupWrite},
   {"vnode-read",   vnodeInitRead,       vnodeCleanupRead},
   {"vnode-hash",   vnodeInitHash,       vnodeCleanupHash},
-  {"tsdb-queue",   tsdbInitCommitQueue, tsdbDestroyCommitQueue}
+  {"tsdb-queue",   tsdbInitCommitQueue, tsdbDestroyCommitQueue},
+  {"vnode-compact", vnodeInitCompact,   vnodeCleanupCompact},
+  {"vnode-migrate", vnodeInitMigrate,   vnodeCleanupMigrate}
 };
 
 int32_t vnodeInitMgmt() {
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2019 TAOS Data, Inc. <jhtao@taosdata.com>
+ *
+ * This program is free software: you can use, redistribute, and/or modify
+ * it under the terms of the GNU Affero General Public License, version 3
+ * or later ("AGPL"), as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _DEFAULT_SOURCE
+#include "os.h"
+#include "tglobal.h"
+#include "vnodeStatus.h"
+#include "vnodeMgmt.h"
+#include "vnodeBgJob.h"
+#include "vnodeMigrate.h"
+
+// Background tier migration, every migrateInterval seconds the file sets which have aged past the boundary of their
+// tier are copied to the next tier, one vnode after another, while the commits of the vnodes go on
+
+static void vnodeMigrate(SVBgJob *pJob, int32_t vgId);
+
+static SVBgJob tsVMigrate = {.name = "vnodeMigrate", .fp = vnodeMigrate};
+
+// a copy in progress is given up when the dnode stops or the vnode is closed or leaves the ready status
+static bool vnodeMigrateStopped(void *param) {
+  SVnodeObj *pVnode = param;
+  return tsVMigrate.stop || pVnode->preClose == 1 || !vnodeInReadyStatus(pVnode);
+}
+
+static void vnodeMigrate(SVBgJob *pJob, int32_t vgId) {
+  SVnodeObj *pVnode = vnodeAcquireNotClose(vgId);
+  if (pVnode == NULL) return;
+
+  if (pVnode->tsdb != NULL && vnodeInReadyStatus(pVnode)) {
+    int32_t num = tsdbMigrate(pVnode->tsdb, vnodeMigrateStopped, pVnode);
+    if (num < 0) {
+      vError("vgId:%d, failed to migrate file sets in background since %s", vgId, tstrerror(terrno));
+    } else if (num > 0) {
+      vInfo("vgId:%d, %d file sets are migrated in background", vgId, num);
+    }
+  }
+
+  vnodeRelease(pVnode);
+}
+
+int32_t vnodeInitMigrate() {
+  tsVMigrate.interval = tsMigrateInterval;
+  vnodeStartBgJob(&tsVMigrate);
+
+  if (tsMigrateInterval <= 0) {
+    vInfo("background tier migration is disabled, file sets are migrated in commit");
+  } else {
+    vDebug("background tier migration is launched, interval:%ds rate:%dMB/s", tsMigrateInterval, tsMigrateRateLimit);
+  }
+  return 0;
+}
+
+void vnodeCleanupMigrate() {
+  vnodeStopBgJob(&tsVMigrate);
+  vDebug("background tier migration is closed");
+}
@@ -18,6 +18,7 @@
 #include "taosmsg.h"
 #include "tqueue.h"
 #include "tglobal.h"
+#include "tmetrics.h"
 #include "query.h"
 #include "vnodeStatus.h"
 #include "tgrant.h"
@@ -30,9 +31,13 @@ static int32_t  vnodeProcessFetchMsg(SVnodeObj *pVnode, SVReadMsg *pRead);
 
 static int32_t  vnodeNotifyCurrentQhandle(void* handle, uint64_t qId, void* qhandle, int32_t vgId);
 
+static SMetric *tsReadLatency = NULL;
+
 int32_t vnodeInitRead(void) {
   vnodeProcessReadMsgFp[TSDB_MSG_TYPE_QUERY] = vnodeProcessQueryMsg;
   vnodeProcessReadMsgFp[TSDB_MSG_TYPE_FETCH] = vnodeProcessFetchMsg;
+
+  tsReadLatency = taosMetricHistogram("taosd_vnode_read_latency_us", "time to process a query or fetch msg in vnode");
   return 0;
 }
 
@@ -52,7 +57,11 @@ int32_t vnodeProcessRead(void *vparam, SVReadMsg *pRead) {
     return TSDB_CODE_VND_MSG_NOT_PROCESSED;
   }
 
-  return (*vnodeProcessReadMsgFp[msgType])(pVnode, pRead);
+  int64_t st = taosGetTimestampUs();
+  int32_t code = (*vnodeProcessReadMsgFp[msgType])(pVnode, pRead);
+  taosMetricObserve(tsReadLatency, taosGetTimestampUs() - st);
+
+  return code;
 }
 
 static int32_t vnodeCheckRead(SVnodeObj *pVnode) {
@@ -21,6 +21,7 @@
 #include "tglobal.h"
 #include "tqueue.h"
 #include "ttimer.h"
+#include "tmetrics.h"
 #include "dnode.h"
 #include "vnodeStatus.h"
 
@@ -31,6 +32,9 @@ static int64_t tsSubmitReqSucNum = 0;
 static int64_t tsSubmitRowNum = 0;
 static int64_t tsSubmitRowSucNum = 0;
 
+static SMetric *tsWriteLatency = NULL;
+static SMetric *tsWriteRows = NULL;
+
 extern void *  tsDnodeTmr;
 static int32_t (*vnodeProcessWriteMsgFp[TSDB_MSG_TYPE_MAX])(SVnodeObj *, void *pCont, SRspRet *);
 static int32_t vnodeProcessSubmitMsg(SVnodeObj *pVnode, void *pCont, SRspRet *);
@@ -50,6 +54,9 @@ int32_t vnodeInitWrite(void) {
   vnodeProcessWriteMsgFp[TSDB_MSG_TYPE_MD_DROP_STABLE]  = vnodeProcessDropStableMsg;
   vnodeProcessWriteMsgFp[TSDB_MSG_TYPE_UPDATE_TAG_VAL]  = vnodeProcessUpdateTagValMsg;
 
+  tsWriteLatency = taosMetricHistogram("taosd_vnode_write_latency_us", "time to apply a write msg to wal and tsdb");
+  tsWriteRows = taosMetricCounter("taosd_vnode_write_rows_total", "rows written into vnodes");
+
   return 0;
 }
 
@@ -98,6 +105,7 @@ int32_t vnodeProcessWrite(void *vparam, void *wparam, int32_t qtype, void *rpara
   }
 
   // forward to peers, even it is WAL/FWD, it shall be called to update version in sync
+  int64_t st = taosGetTimestampUs();
   int32_t syncCode = 0;
   bool    force = (pWrite == NULL ? false : pWrite->walHead.msgType != TSDB_MSG_TYPE_SUBMIT);
   syncCode = syncForwardToPeer(pVnode->sync, pHead, pWrite, qtype, force);
@@ -121,6 +129,7 @@ int32_t vnodeProcessWrite(void *vparam, void *wparam, int32_t qtype, void *rpara
 
   // write data locally
   code = (*vnodeProcessWriteMsgFp[pHead->msgType])(pVnode, pHead->cont, pRspRet);
+  taosMetricObserve(tsWriteLatency, taosGetTimestampUs() - st);
   if (code < 0) {
     if (syncCode > 0 && pWrite) atomic_sub_fetch_32(&pWrite->processedCount, 1);
     return code;
@@ -184,6 +193,7 @@ static int32_t vnodeProcessSubmitMsg(SVnodeObj *pVnode, void *pCont, SRspRet *pR
   if (pRsp) {
     atomic_fetch_add_64(&tsSubmitRowNum, ntohl(pRsp->numOfRows));
     atomic_fetch_add_64(&tsSubmitRowSucNum, ntohl(pRsp->affectedRows));
+    taosMetricAdd(tsWriteRows, ntohl(pRsp->affectedRows));
   }
 
   return code;
@@ -21,8 +21,10 @@ extern "C" {
 #endif
 
 #include "tlog.h"
+#include "tmetrics.h"
 
 extern int32_t wDebugFlag;
+extern SMetric *tsWalFsyncLatency;
 
 #define wFatal(...) { if (wDebugFlag & DEBUG_FATAL) { taosPrintLog("WAL FATAL ", 255, __VA_ARGS__); }}
 #define wError(...) { if (wDebugFlag & DEBUG_ERROR) { taosPrintLog("WAL ERROR ", 255, __VA_ARGS__); }}
@@ -60,6 +62,7 @@ typedef struct {
 int32_t walGetNextFile(SWal *pWal, int64_t *nextFileId);
 int32_t walGetOldFile(SWal *pWal, int64_t curFileId, int32_t minDiff, int64_t *oldFileId);
 int32_t walGetNewFile(SWal *pWal, int64_t *newFileId);
+void    walInitMetrics();
 
 #ifdef __cplusplus
 }
@@ -51,6 +51,8 @@ int32_t walInit() {
     return code;
   }
 
+  walInitMetrics();
+
   wInfo("wal module is initialized, rsetId:%d", tsWal.refId);
   return code;
 }
@@ -181,10 +183,12 @@ static void walFsyncAll() {
   while (pWal) {
     if (walNeedFsync(pWal)) {
       wTrace("vgId:%d, do fsync, level:%d seq:%d rseq:%d", pWal->vgId, pWal->level, pWal->fsyncSeq, tsWal.seq);
+      int64_t st = taosGetTimestampUs();
       int32_t code = tfFsync(pWal->tfd);
       if (code != 0) {
         wError("vgId:%d, file:%s, failed to fsync since %s", pWal->vgId, pWal->name, strerror(code));
       }
+      taosMetricObserve(tsWalFsyncLatency, taosGetTimestampUs() - st);
     }
     pWal = taosIterateRef(tsWal.refId, pWal->rid);
   }
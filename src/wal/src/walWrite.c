@@ -25,6 +25,16 @@
 
 static int32_t walRestoreWalFile(SWal *pWal, void *pVnode, FWalWrite writeFp, char *name, int64_t fileId);
 
+SMetric *       tsWalFsyncLatency = NULL;
+static SMetric *tsWalWriteLatency = NULL;
+static SMetric *tsWalWriteBytes = NULL;
+
+void walInitMetrics() {
+  tsWalWriteLatency = taosMetricHistogram("taosd_wal_write_latency_us", "time to append a record to wal");
+  tsWalWriteBytes = taosMetricCounter("taosd_wal_write_bytes_total", "bytes appended to wal");
+  tsWalFsyncLatency = taosMetricHistogram("taosd_wal_fsync_latency_us", "time to fsync a wal file");
+}
+
 int32_t walRenew(void *handle) {
   if (handle == NULL) return 0;
 
@@ -154,6 +164,7 @@ int32_t walWrite(void *handle, SWalHead *pHead) {
 #endif
 
   int32_t contLen = pHead->len + sizeof(SWalHead);
+  int64_t st = taosGetTimestampUs();
 
   pthread_mutex_lock(&pWal->mutex);
 
@@ -168,6 +179,9 @@ int32_t walWrite(void *handle, SWalHead *pHead) {
 
   pthread_mutex_unlock(&pWal->mutex);
 
+  taosMetricObserve(tsWalWriteLatency, taosGetTimestampUs() - st);
+  taosMetricAdd(tsWalWriteBytes, contLen);
+
   ASSERT(contLen == pHead->len + sizeof(SWalHead));
 
   return code;
@@ -179,9 +193,11 @@ void walFsync(void *handle, bool forceFsync) {
 
   if (forceFsync || (pWal->level == TAOS_WAL_FSYNC && pWal->fsyncPeriod == 0)) {
     wTrace("vgId:%d, fileId:%" PRId64 ", do fsync", pWal->vgId, pWal->fileId);
+    int64_t st = taosGetTimestampUs();
     if (tfFsync(pWal->tfd) < 0) {
       wError("vgId:%d, fileId:%" PRId64 ", fsync failed since %s", pWal->vgId, pWal->fileId, strerror(errno));
     }
+    taosMetricObserve(tsWalFsyncLatency, taosGetTimestampUs() - st);
   }
 }
 
@@ -259,6 +259,7 @@ python3 ./test.py -f query/bug2117.py
 python3 ./test.py -f query/bug2118.py
 python3 ./test.py -f query/bug2143.py
 python3 ./test.py -f query/sliding.py
+python3 ./test.py -f query/slidingPane.py
 python3 ./test.py -f query/unionAllTest.py
 python3 ./test.py -f query/bug2281.py
 python3 ./test.py -f query/udf.py
@@ -0,0 +1,118 @@
+###################################################################
+#           Copyright (c) 2016 by TAOS Technologies, Inc.
+#                     All rights reserved.
+#
+#  This file is proprietary and confidential to TAOS Technologies.
+#  No part of this file may be reproduced, stored, transmitted,
+#  disclosed or used in any form or by any means other than as
+#  expressly provided by the written permission from Jianhui Tao
+#
+###################################################################
+
+# -*- coding: utf-8 -*-
+
+import sys
+import taos
+from util.log import tdLog
+from util.cases import tdCases
+from util.sql import tdSql
+
+
+class TDTestCase:
+    def init(self, conn, logSql):
+        tdLog.debug("start to execute %s" % __file__)
+        tdSql.init(conn.cursor(), logSql)
+
+        self.ts = 1600000000000
+
+    def genRows(self):
+        # a row every 500ms, NULL on every 12th row and on the last millisecond of each 2s, so that the NULL values
+        # fall on both edges of the panes of interval(10s) sliding(4s)
+        rows = []
+        for i in range(6000):
+            ts = self.ts + i * 500
+            rows.append((ts, None if i % 12 == 0 else (i * 37) % 1001 - 500))
+        for k in range(1, 1500):
+            rows.append((self.ts + k * 2000 - 1, None))
+        rows.sort()
+        return rows
+
+    def insertRows(self, tb, rows):
+        for start in range(0, len(rows), 300):
+            sql = "insert into %s values" % tb
+            for ts, v in rows[start:start + 300]:
+                if v is None:
+                    sql += "(%d, NULL, NULL, NULL, NULL, NULL)" % ts
+                else:
+                    sql += "(%d, %d, %d, %f, %f, %d)" % (ts, v, v * 100000, v / 4.0, v / 8.0, v)
+            tdSql.execute(sql)
+
+    def checkEqualRows(self, res1, res2, numOfCols):
+        tdSql.checkEqual(len(res1), len(res2))
+        for r1, r2 in zip(res1, res2):
+            for i in range(numOfCols):
+                if isinstance(r1[i], float) and isinstance(r2[i], float):
+                    if abs(r1[i] - r2[i]) > 1e-9 * max(1.0, abs(r1[i])):
+                        tdLog.exit("%s != %s, sql:%s" % (r1, r2, tdSql.sql))
+                elif r1[i] != r2[i]:
+                    tdLog.exit("%s != %s, sql:%s" % (r1, r2, tdSql.sql))
+
+    def refResult(self, rows, interval, sliding):
+        windows = {}
+        for ts, v in rows:
+            w = ts - ts % sliding
+            while w + interval > ts:
+                windows.setdefault(w, []).append(v)
+                w -= sliding
+
+        result = []
+        for w in sorted(windows):
+            vals = [v for v in windows[w] if v is not None]
+            if len(vals) == 0:
+                result.append((0, None, None, None))
+            else:
+                result.append((len(vals), sum(vals), min(vals), max(vals)))
+        return result
+
+    def run(self):
+        tdSql.prepare()
+
+        tdSql.execute("create table t(ts timestamp, c1 int, c2 bigint, c3 float, c4 double, c5 smallint)")
+        rows = self.genRows()
+        self.insertRows("t", rows)
+
+        # the statistics functions alone are aggregated per pane, adding last() takes the row by row path
+        for interval, sliding in ((10000, 4000), (9000, 6000), (10000, 5000), (7000, 3000)):
+            for col in ("c1", "c2", "c3", "c4", "c5"):
+                funcs = "count(%s), sum(%s), min(%s), max(%s), avg(%s), spread(%s)" % ((col, ) * 6)
+                pane = tdSql.getResult("select %s from t interval(%da) sliding(%da)" % (funcs, interval, sliding))
+                row = tdSql.getResult("select %s, last(%s) from t interval(%da) sliding(%da)" %
+                                      (funcs, col, interval, sliding))
+                self.checkEqualRows(pane, row, 7)
+
+            ref = self.refResult(rows, interval, sliding)
+            tdSql.query("select count(c1), sum(c1), min(c1), max(c1) from t interval(%da) sliding(%da)" %
+                        (interval, sliding))
+            tdSql.checkRows(len(ref))
+            for i in range(len(ref)):
+                for j in range(4):
+                    tdSql.checkData(i, j + 1, ref[i][j])
+
+        # a super table query merges the panes of each table
+        tdSql.execute("create table st(ts timestamp, c1 int, c2 bigint, c3 float, c4 double, c5 smallint) tags(id int)")
+        tdSql.execute("create table st0 using st tags(0)")
+        tdSql.execute("create table st1 using st tags(1)")
+        self.insertRows("st0", rows)
+        self.insertRows("st1", rows[::3])
+        funcs = "count(c3), sum(c3), min(c3), max(c3), avg(c3), spread(c3)"
+        pane = tdSql.getResult("select %s from st interval(10s) sliding(4s)" % funcs)
+        row = tdSql.getResult("select %s, last(c3) from st interval(10s) sliding(4s)" % funcs)
+        self.checkEqualRows(pane, row, 7)
+
+    def stop(self):
+        tdSql.close()
+        tdLog.success("%s successfully executed" % __file__)
+
+
+tdCases.addWindows(__file__, TDTestCase())
+tdCases.addLinux(__file__, TDTestCase())
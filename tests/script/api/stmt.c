@@ -405,6 +405,81 @@ void taos_stmt_execute_test() {
   printf("finish taos_stmt_execute test\n");
 }
 
+static int64_t query_count(void *taos, char *sql) {
+  TAOS_RES *res = taos_query(taos, sql);
+  assert(res != NULL && taos_errno(res) == 0);
+  TAOS_ROW row = taos_fetch_row(res);
+  int64_t  count = (row != NULL) ? *(int64_t *)row[0] : 0;
+  taos_free_result(res);
+  return count;
+}
+
+void taos_stmt_bind_multi_tables_batch_test() {
+  printf("start taos_stmt_bind_multi_tables_batch test\n");
+  void *taos = taos_connect("127.0.0.1", "root", "taosdata", NULL, 0);
+  if (taos == NULL) {
+    printf("Cannot connect to tdengine server\n");
+    exit(EXIT_FAILURE);
+  }
+  execute_simple_sql(taos, "drop database if exists stmt_test");
+  execute_simple_sql(taos, "create database stmt_test");
+  execute_simple_sql(taos, "use stmt_test");
+  execute_simple_sql(taos, "create stable super(ts timestamp, c1 int) tags (id int)");
+  TAOS_STMT *stmt = taos_stmt_init(taos);
+  assert(stmt != NULL);
+  assert(taos_stmt_prepare(stmt, "insert into ? using super tags (?) values (?,?)", 0) == 0);
+
+  // rows [0, 3) go to t0, rows [3, 5) go to t1
+  int64_t ts[5] = {1591060628000, 1591060628001, 1591060628002, 1591060628003, 1591060628004};
+  int32_t c1[5] = {1, 2, 3, 4, 5};
+  TAOS_MULTI_BIND bind[2] = {0};
+  bind[0].buffer_type = TSDB_DATA_TYPE_TIMESTAMP;
+  bind[0].buffer_length = sizeof(int64_t);
+  bind[0].buffer = ts;
+  bind[0].num = 5;
+  bind[1].buffer_type = TSDB_DATA_TYPE_INT;
+  bind[1].buffer_length = sizeof(int32_t);
+  bind[1].buffer = c1;
+  bind[1].num = 5;
+
+  // t1 has a NULL tag, both tables are created by the bind
+  int32_t   id = 1;
+  int       isNull = 1;
+  TAOS_BIND tag0 = {0}, tag1 = {0};
+  tag0.buffer_type = TSDB_DATA_TYPE_INT;
+  tag0.buffer_length = sizeof(int32_t);
+  tag0.buffer = &id;
+  tag0.length = &tag0.buffer_length;
+  tag1.buffer_type = TSDB_DATA_TYPE_INT;
+  tag1.is_null = &isNull;
+
+  const char *names[2] = {"t0", "t1"};
+  TAOS_BIND * tags[2] = {&tag0, &tag1};
+  int         offsets[2] = {0, 3};
+  assert(taos_stmt_bind_multi_tables_batch(stmt, names, tags, offsets, 2, bind) == 0);
+  assert(taos_stmt_execute(stmt) == 0);
+  assert(taos_stmt_affected_rows(stmt) == 5);
+  assert(query_count(taos, "select count(*) from super") == 5);
+  assert(query_count(taos, "select count(*) from super where id is null") == 2);
+
+  // the second name is invalid, the rows of t0 bound before it are discarded along with the failed batch
+  const char *badNames[2] = {"t0", "1 t"};
+  for (int32_t i = 0; i < 5; ++i) ts[i] += 1000;
+  assert(taos_stmt_bind_multi_tables_batch(stmt, badNames, tags, offsets, 2, bind) != 0);
+  assert(taos_stmt_execute(stmt) != 0);
+
+  // the statement is usable again after the failure
+  assert(taos_stmt_bind_multi_tables_batch(stmt, names + 1, tags + 1, offsets, 1, bind) == 0);
+  assert(taos_stmt_execute(stmt) == 0);
+  assert(taos_stmt_affected_rows(stmt) == 10);
+  assert(query_count(taos, "select count(*) from t0") == 3);
+  assert(query_count(taos, "select count(*) from t1") == 7);
+
+  assert(taos_stmt_close(stmt) == 0);
+  taos_close(taos);
+  printf("finish taos_stmt_bind_multi_tables_batch test\n");
+}
+
 void taos_stmt_use_result_query(void *taos, char *col, int type) {
   TAOS_STMT *stmt = taos_stmt_init(taos);
   assert(stmt != NULL);
@@ -704,6 +779,7 @@ void test_api_reliability() {
   taos_stmt_bind_param_batch_test();
   taos_stmt_add_batch_test();
   taos_stmt_execute_test();
+  taos_stmt_bind_multi_tables_batch_test();
   taos_stmt_close_test();
 }
 